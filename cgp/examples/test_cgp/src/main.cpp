@@ -10,9 +10,21 @@
 #include "cgp/04_grid_container/grid/test/test_grid.hpp"
 #include "cgp/02_numarray/numarray/test/test_numarray.hpp"
 #include "cgp/02_numarray/numarray_stack/test/test_numarray_stack.hpp"
+#include "cgp/02_numarray/numarray_soa/test/test_numarray_soa.hpp"
+#include "cgp/02_numarray/numarray_view/test/test_numarray_view.hpp"
+#include "cgp/02_numarray/numarray_parallel/test/test_numarray_parallel.hpp"
 #include "cgp/19_camera_controller/test/test_camera_controller.hpp"
 #include "cgp/06_mat/test/test_matrix_stack.hpp"
 #include "cgp/06_mat/functions/test/test_vec_mat.hpp"
+#include "cgp/11_mesh/mesh_adjacency/test/test_mesh_adjacency.hpp"
+#include "cgp/12_shape/spatial_hash_grid/test/test_spatial_hash_grid.hpp"
+#include "cgp/22_simulation/particle_system/test/test_particle_system.hpp"
+#include "cgp/22_simulation/matrix_sparse_block3/test/test_matrix_sparse_block3.hpp"
+#include "cgp/22_simulation/cloth_implicit/test/test_cloth_implicit.hpp"
+#include "cgp/20_format_parser/mesh_loader/obj/test/test_obj_parser.hpp"
+#include "cgp/20_format_parser/mesh_loader/ply/test/test_ply_stl.hpp"
+#include "cgp/20_format_parser/mesh_loader/mesh_binary/test/test_mesh_binary.hpp"
+#include "cgp/20_format_parser/mesh_loader/vertex_index_map/test/test_vertex_index_map.hpp"
 
 
 using namespace cgp;
@@ -27,9 +39,21 @@ int main(int, char* argv[])
 	cgp_test::test_grid_3D();
 	cgp_test::test_numarray();
 	cgp_test::test_numarray_stack();
+	cgp_test::test_numarray_soa();
+	cgp_test::test_numarray_view();
+	cgp_test::test_numarray_parallel();
 	cgp_test::test_camera_controller();
 	cgp_test::test_matrix_stack();
 	cgp_test::test_vec_mat();
+	cgp_test::test_mesh_adjacency();
+	cgp_test::test_spatial_hash_grid();
+	cgp_test::test_particle_system();
+	cgp_test::test_matrix_sparse_block3();
+	cgp_test::test_cloth_implicit();
+	cgp_test::test_obj_parser();
+	cgp_test::test_ply_stl();
+	cgp_test::test_mesh_binary();
+	cgp_test::test_vertex_index_map();
 
 
 	return 0;
@@ -6,4 +6,6 @@
 #include "stl/stl.hpp"
 #include "types/types.hpp"
 #include "string/string.hpp"
+#include "parallel/parallel.hpp"
+#include "simd/simd.hpp"
 
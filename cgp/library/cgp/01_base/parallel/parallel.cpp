@@ -0,0 +1,219 @@
+#include "parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace cgp
+{
+	static std::atomic<int>& parallel_number_of_threads_setting()
+	{
+		static std::atomic<int> number_of_threads(0); // 0: hardware threads
+		return number_of_threads;
+	}
+
+	int parallel_number_of_threads()
+	{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+		return 1;
+#else
+		int const N_setting = parallel_number_of_threads_setting();
+		if (N_setting > 0)
+			return N_setting;
+		int const N = static_cast<int>(std::thread::hardware_concurrency());
+		return N > 0 ? N : 1;
+#endif
+	}
+
+	int parallel_number_of_threads(size_t N, int number_of_threads)
+	{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+		(void)N; (void)number_of_threads;
+		return 1;
+#else
+		size_t T = number_of_threads > 0 ? size_t(number_of_threads) : size_t(parallel_number_of_threads());
+		if (T > N)
+			T = N;
+		return T > 0 ? static_cast<int>(T) : 1;
+#endif
+	}
+
+
+	static std::atomic<size_t> parallel_grain_size(4096);
+	static std::atomic<bool> parallel_deterministic(false);
+
+	size_t parallel_default_grain_size()
+	{
+		return parallel_grain_size;
+	}
+	void parallel_set_default_grain_size(size_t grain_size)
+	{
+		parallel_grain_size = grain_size > 0 ? grain_size : 1;
+	}
+
+	void parallel_set_deterministic(bool deterministic)
+	{
+		parallel_deterministic = deterministic;
+	}
+	bool parallel_get_deterministic()
+	{
+		return parallel_deterministic;
+	}
+
+	// True in the threads running the tasks of the pool (and in the calling thread while it takes part in parallel_run): nested calls run serially
+	static thread_local bool parallel_inside_task = false;
+
+	size_t parallel_chunk_size(size_t N, size_t grain_size)
+	{
+		size_t const grain = grain_size > 0 ? grain_size : parallel_default_grain_size();
+		if (parallel_deterministic)
+			return grain;
+
+		int const T = parallel_number_of_threads();
+		if (T <= 1 || parallel_inside_task || N < 2 * grain)
+			return N;
+		// A few chunks per thread to balance the load
+		size_t const chunk = (N + 4 * size_t(T) - 1) / (4 * size_t(T));
+		return std::max(grain, chunk);
+	}
+
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+	// Pool of threads waiting for the tasks of parallel_run.
+	// A job is a function called on the indices [0,N_task[, the indices are handed out by an atomic counter to the workers and to the calling thread.
+	class parallel_thread_pool
+	{
+	public:
+		explicit parallel_thread_pool(int number_of_workers)
+		{
+			for (int k = 0; k < number_of_workers; ++k)
+				workers.push_back(std::thread([this]() { worker_loop(); }));
+		}
+
+		~parallel_thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+			cv_job.notify_all();
+			for (auto& t : workers)
+				t.join();
+		}
+
+		int number_of_workers() const { return int(workers.size()); }
+
+		void run(size_t number_of_tasks, std::function<void(size_t)> const& task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				job = &task;
+				job_size = number_of_tasks;
+				next_task = 0;
+				completed_tasks = 0;
+				++generation;
+			}
+			cv_job.notify_all();
+
+			parallel_inside_task = true;
+			execute_tasks(task, number_of_tasks);
+			parallel_inside_task = false;
+
+			// The job must not be released while a worker can still read it
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_done.wait(lock, [this]() { return completed_tasks == job_size && active_workers == 0; });
+			job = nullptr;
+		}
+
+	private:
+		void execute_tasks(std::function<void(size_t)> const& task, size_t number_of_tasks)
+		{
+			size_t done = 0;
+			for (size_t k = next_task++; k < number_of_tasks; k = next_task++) {
+				task(k);
+				++done;
+			}
+			if (done > 0) {
+				std::lock_guard<std::mutex> lock(mutex);
+				completed_tasks += done;
+			}
+			cv_done.notify_all();
+		}
+
+		void worker_loop()
+		{
+			parallel_inside_task = true;
+			size_t generation_seen = 0;
+			while (true) {
+				std::function<void(size_t)> const* task = nullptr;
+				size_t number_of_tasks = 0;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					cv_job.wait(lock, [&]() { return stop || (generation != generation_seen && job != nullptr); });
+					if (stop)
+						return;
+					generation_seen = generation;
+					task = job;
+					number_of_tasks = job_size;
+					++active_workers;
+				}
+
+				execute_tasks(*task, number_of_tasks);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					--active_workers;
+				}
+				cv_done.notify_all();
+			}
+		}
+
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable cv_job;
+		std::condition_variable cv_done;
+
+		std::function<void(size_t)> const* job = nullptr;
+		size_t job_size = 0;
+		std::atomic<size_t> next_task{ 0 };
+		size_t completed_tasks = 0;
+		int active_workers = 0;
+		size_t generation = 0;
+		bool stop = false;
+	};
+
+	// The pool is shared by all the calls. It runs one job at a time: a call made while the pool is busy runs serially instead of waiting for the pool
+	//  (waiting could deadlock if the running job waits on the calling thread, ex. a thread spawned by parallel_for_chunk inside a task)
+	static std::mutex parallel_pool_mutex;
+	static std::unique_ptr<parallel_thread_pool> parallel_pool;
+#endif
+
+	void parallel_set_number_of_threads(int number_of_threads)
+	{
+		parallel_number_of_threads_setting() = number_of_threads > 0 ? number_of_threads : 0;
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+		// The pool is rebuilt with the new size at the next call
+		std::lock_guard<std::mutex> lock(parallel_pool_mutex);
+		parallel_pool.reset();
+#endif
+	}
+
+	void parallel_run(size_t number_of_tasks, std::function<void(size_t)> const& task)
+	{
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+		int const T = parallel_number_of_threads();
+		if (number_of_tasks > 1 && T > 1 && !parallel_inside_task) {
+			std::unique_lock<std::mutex> lock(parallel_pool_mutex, std::try_to_lock);
+			if (lock.owns_lock()) {
+				if (parallel_pool == nullptr || parallel_pool->number_of_workers() != T - 1)
+					parallel_pool.reset(new parallel_thread_pool(T - 1));
+				parallel_pool->run(number_of_tasks, task);
+				return;
+			}
+		}
+#endif
+		for (size_t k = 0; k < number_of_tasks; ++k)
+			task(k);
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Helper functions to split a loop over several threads
+//
+// - parallel_for_chunk( N, number_of_threads, f ) : split [0,N[ into contiguous chunks and call f(k_begin, k_end, thread_index) on each chunk from a different thread.
+//   The chunks are ordered by thread_index: chunk k only contains indices smaller than chunk k+1.
+//   number_of_threads<=0 uses the default number of threads (see parallel_number_of_threads).
+//
+// Parallel algorithms running on a persistent pool of threads (created at the first call, no thread creation per loop)
+//
+// - parallel_for( N, f, grain_size ) : call f(k) for all k in [0,N[
+// - parallel_for_range( N, f, grain_size ) : call f(k_begin, k_end) on chunks covering [0,N[
+// - parallel_reduce( N, identity, f, combine, grain_size ) : each chunk computes f(k_begin, k_end, identity) (the value accumulated over the chunk),
+//   and the partial values are combined in the order of the chunks: combine(combine(value_0, value_1), value_2) ...
+//
+//   The chunks contain at least grain_size elements (grain_size=0: parallel_default_grain_size), loops of less than 2*grain_size elements run serially.
+//   By default the number of chunks is a small multiple of the number of threads, the result of a floating point reduction then depends on the number of threads.
+//   In deterministic mode (parallel_set_deterministic), the chunks have exactly grain_size elements whatever the number of threads: the result of parallel_reduce is reproducible.
+//   Calls made from inside a parallel loop, or while the pool is used by another thread, run serially (no nested parallelism, no waiting for the pool).
+//   parallel_set_number_of_threads(T) resizes the pool and sets the default number of threads of parallel_for_chunk.
+//
+// Threads are not used when compiling with Emscripten without pthread support: the chunks are then called sequentially.
+
+namespace cgp
+{
+	// Default number of threads used by the parallel helpers (number of hardware threads unless set by parallel_set_number_of_threads, at least 1)
+	int parallel_number_of_threads();
+	// Set the default number of threads and the size of the pool (number_of_threads<=0: number of hardware threads)
+	void parallel_set_number_of_threads(int number_of_threads);
+
+	// Number of threads actually used for a loop of size N given the requested number of threads (never larger than N)
+	int parallel_number_of_threads(size_t N, int number_of_threads);
+
+	template <typename F>
+	void parallel_for_chunk(size_t N, int number_of_threads, F const& f);
+
+	// Default minimal number of elements per chunk of parallel_for/parallel_reduce (4096 by default)
+	size_t parallel_default_grain_size();
+	void parallel_set_default_grain_size(size_t grain_size);
+
+	// Enable/disable the deterministic chunking of parallel_reduce (default: disabled)
+	void parallel_set_deterministic(bool deterministic);
+	bool parallel_get_deterministic();
+
+	template <typename F>
+	void parallel_for(size_t N, F const& f, size_t grain_size = 0);
+	template <typename F>
+	void parallel_for_range(size_t N, F const& f, size_t grain_size = 0);
+	template <typename T, typename F, typename OP>
+	T parallel_reduce(size_t N, T const& identity, F const& f, OP const& combine, size_t grain_size = 0);
+
+	// Size of the chunks used for a loop of size N (N if the loop runs as a single chunk)
+	size_t parallel_chunk_size(size_t N, size_t grain_size);
+	// Run task(0), ..., task(number_of_tasks-1) on the pool and return when all of them are completed
+	void parallel_run(size_t number_of_tasks, std::function<void(size_t)> const& task);
+}
+
+
+// Template implementation
+
+namespace cgp
+{
+	template <typename F>
+	void parallel_for_chunk(size_t N, int number_of_threads, F const& f)
+	{
+		int const T = parallel_number_of_threads(N, number_of_threads);
+		if (T <= 1) {
+			if (N > 0)
+				f(size_t(0), N, 0);
+			return;
+		}
+
+		// Chunk k covers [k*N/T, (k+1)*N/T[
+		std::vector<std::thread> threads;
+		threads.reserve(T - 1);
+		for (int k = 1; k < T; ++k) {
+			size_t const k_begin = (k * N) / T;
+			size_t const k_end = ((k + 1) * N) / T;
+			threads.push_back(std::thread([&f, k_begin, k_end, k]() { f(k_begin, k_end, k); }));
+		}
+		// The current thread handles the first chunk
+		f(size_t(0), N / T, 0);
+
+		for (auto& t : threads)
+			t.join();
+	}
+
+	template <typename F>
+	void parallel_for_range(size_t N, F const& f, size_t grain_size)
+	{
+		size_t const chunk = parallel_chunk_size(N, grain_size);
+		if (chunk >= N) {
+			if (N > 0)
+				f(size_t(0), N);
+			return;
+		}
+		parallel_run((N + chunk - 1) / chunk, [&](size_t c) { f(c * chunk, std::min(N, (c + 1) * chunk)); });
+	}
+
+	template <typename F>
+	void parallel_for(size_t N, F const& f, size_t grain_size)
+	{
+		parallel_for_range(N, [&f](size_t k_begin, size_t k_end) {
+			for (size_t k = k_begin; k < k_end; ++k)
+				f(k);
+		}, grain_size);
+	}
+
+	template <typename T, typename F, typename OP>
+	T parallel_reduce(size_t N, T const& identity, F const& f, OP const& combine, size_t grain_size)
+	{
+		size_t const chunk = parallel_chunk_size(N, grain_size);
+		if (chunk >= N)
+			return N > 0 ? f(size_t(0), N, identity) : identity;
+
+		// Partial value of each chunk (wrapped to avoid std::vector<bool> for boolean reductions)
+		struct partial_value { T value; };
+		size_t const N_chunk = (N + chunk - 1) / chunk;
+		std::vector<partial_value> partial(N_chunk, partial_value{ identity });
+		parallel_run(N_chunk, [&](size_t c) { partial[c].value = f(c * chunk, std::min(N, (c + 1) * chunk), identity); });
+
+		T value = partial[0].value;
+		for (size_t c = 1; c < N_chunk; ++c)
+			value = combine(value, partial[c].value);
+		return value;
+	}
+}
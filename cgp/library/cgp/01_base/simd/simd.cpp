@@ -0,0 +1,69 @@
+#include "simd.hpp"
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+#if defined(CGP_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace cgp
+{
+#ifdef CGP_SIMD_X86
+	static bool simd_detect_avx2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		bool const osxsave = (info[2] & (1 << 27)) != 0;
+		bool const avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx)
+			return false;
+		// The OS must save the YMM registers
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+#endif
+
+	bool simd_support_avx2()
+	{
+#ifdef CGP_SIMD_X86
+		static bool const support = simd_detect_avx2();
+		return support;
+#else
+		return false;
+#endif
+	}
+
+	void* simd_aligned_malloc(size_t size)
+	{
+		size_t const alignment = 32;
+#if defined(_MSC_VER)
+		return _aligned_malloc(size, alignment);
+#else
+		void* p = nullptr;
+		if (posix_memalign(&p, alignment, size) != 0)
+			return nullptr;
+		return p;
+#endif
+	}
+
+	void simd_aligned_free(void* p)
+	{
+#if defined(_MSC_VER)
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Compile-time and run-time detection of the SIMD instruction sets used by the vectorized kernels of the library
+//
+// - CGP_SIMD_X86 is defined when compiling for x86-64 (SSE2 is then always available)
+//   Defining CGP_NO_SIMD before compilation disables all the SIMD kernels (scalar code is used instead).
+// - simd_support_avx2() checks at run-time if the CPU (and the OS) supports AVX2.
+//   The AVX2 kernels are compiled without requiring a specific compilation flag and are only called when this function returns true.
+// - simd_aligned_allocator<T> is an STL allocator returning memory aligned on 32 bytes (size of an AVX register),
+//   ex. std::vector<float, simd_aligned_allocator<float>>.
+
+#if !defined(CGP_NO_SIMD) && !defined(__EMSCRIPTEN__) && (defined(__x86_64__) || defined(_M_X64))
+#define CGP_SIMD_X86
+#endif
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace cgp
+{
+	// True if the AVX2 kernels can be used on the current CPU (always false if CGP_SIMD_X86 is not defined)
+	bool simd_support_avx2();
+
+	// Memory allocation aligned on 32 bytes (release with simd_aligned_free)
+	void* simd_aligned_malloc(size_t size);
+	void simd_aligned_free(void* p);
+
+	template <typename T>
+	struct simd_aligned_allocator
+	{
+		typedef T value_type;
+		static size_t const alignment = 32;
+
+		simd_aligned_allocator() {}
+		template <typename U> simd_aligned_allocator(simd_aligned_allocator<U> const&) {}
+		template <typename U> struct rebind { typedef simd_aligned_allocator<U> other; };
+
+		T* allocate(size_t n)
+		{
+			if (n == 0)
+				return nullptr;
+			void* p = simd_aligned_malloc(n * sizeof(T));
+			if (p == nullptr)
+				throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+		void deallocate(T* p, size_t) { simd_aligned_free(p); }
+	};
+	template <typename T, typename U> bool operator==(simd_aligned_allocator<T> const&, simd_aligned_allocator<U> const&) { return true; }
+	template <typename T, typename U> bool operator!=(simd_aligned_allocator<T> const&, simd_aligned_allocator<U> const&) { return false; }
+}
@@ -2,3 +2,6 @@
 
 #include "numarray_stack/numarray_stack.hpp"
 #include "numarray/numarray.hpp"
+#include "numarray_soa/numarray_soa.hpp"
+#include "numarray_view/numarray_view.hpp"
+#include "numarray_parallel/numarray_parallel.hpp"
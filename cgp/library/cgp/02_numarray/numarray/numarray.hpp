@@ -1,6 +1,8 @@
 #pragma once
 
 #include "cgp/01_base/base.hpp"
+#include "numarray_expression.hpp"
+#include "numarray_simd/numarray_simd.hpp"
 
 #include <vector>
 #include <iostream>
@@ -12,27 +14,47 @@
 namespace cgp
 {
 
+/** Allocator of the internal std::vector of numarray<T> */
+template <typename T> struct numarray_allocator { typedef std::allocator<T> type; };
+#ifdef CGP_NUMARRAY_ALIGNED
+template <> struct numarray_allocator<float> { typedef simd_aligned_allocator<float> type; };
+template <> struct numarray_allocator<numarray_stack<float, 2>> { typedef simd_aligned_allocator<numarray_stack<float, 2>> type; };
+template <> struct numarray_allocator<numarray_stack<float, 3>> { typedef simd_aligned_allocator<numarray_stack<float, 3>> type; };
+template <> struct numarray_allocator<numarray_stack<float, 4>> { typedef simd_aligned_allocator<numarray_stack<float, 4>> type; };
+#endif
+
 /** Dynamic-sized container for numerical data
  *
  * The numarray structure is a wrapper around an std::vector with additional convenient functionalities
  * - Overloaded operators + - * / as well as common outputs
+ *   The operators return lazy expressions evaluated in a single loop when assigned to a numarray (see numarray_expression.hpp)
  * - Strict bound checking with operator [] and () (unless cgp_NO_DEBUG is defined)
  *
  * Numarray follows the main syntax than std::vector
  * Elements in a numarray are stored contiguously in memory (use std::vector internally)
+ * The arithmetic operators and reductions of numarray<float>, numarray<vec2>, numarray<vec3> and numarray<vec4> use vectorized kernels (see numarray_simd.hpp)
  *
  **/
 template <typename T>
 struct numarray
 {
+    /** Type of the internal std::vector (uses an allocator aligned for SIMD for float and vec2/3/4 if CGP_NUMARRAY_ALIGNED is defined) */
+    typedef std::vector<T, typename numarray_allocator<T>::type> container_type;
+
     /** Internal data stored as std::vector */
-    std::vector<T> data;
+    container_type data;
 
     // Constructors
     numarray();                             // Empty numarray - no elements 
     numarray(int size);                     // numarray with a given size 
     numarray(std::initializer_list<T> arg); // Inline initialization using { } 
     numarray(std::vector<T> const& arg);    // Direct initialization from std::vector 
+    template <typename E>
+    numarray(numarray_expression<E> const& e); // Evaluation of an expression (ex. numarray<float> c = a+2*b;)
+
+    /** Evaluate an expression into the numarray. No allocation is performed if the size is unchanged (ex. c = a+2*b;) */
+    template <typename E>
+    numarray<T>& operator=(numarray_expression<E> const& e);
 
     /** Similar to matlab linespace 
     * Linear interpolation between p1 and p2 along N variable */
@@ -69,12 +91,12 @@ struct numarray
     /** Iterators
      * Iterators on numarray are compatible with STL syntax
      * allows "forall" loops (for(auto& e : numarray) {...}) */
-    typename std::vector<T>::iterator begin();
-    typename std::vector<T>::iterator end();
-    typename std::vector<T>::const_iterator begin() const;
-    typename std::vector<T>::const_iterator end() const;
-    typename std::vector<T>::const_iterator cbegin() const;
-    typename std::vector<T>::const_iterator cend() const;
+    typename container_type::iterator begin();
+    typename container_type::iterator end();
+    typename container_type::const_iterator begin() const;
+    typename container_type::const_iterator end() const;
+    typename container_type::const_iterator cbegin() const;
+    typename container_type::const_iterator cend() const;
 
     /** Direct access to the value - doesn't check index bounds*/
     // Depreciated function - use at() instead
@@ -116,36 +138,20 @@ template <typename T> T sum(numarray<T> const& a);
 
 
 /** Math operators
- * Common mathematical operations between numarrays, and scalar or element values. */
-template <typename T> numarray<T>  operator-(numarray<T> const& a);
-
+ * Common mathematical operations between numarrays, and scalar or element values.
+ * The binary operators (+ - * /) and the componentwise operations (add, sub, mul, div) are declared in numarray_expression.hpp */
 template <typename T> numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b);
-
 template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b);
-
 template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b);
 template <typename T> numarray<T>& operator*=(numarray<T>& a, float b);
-template <typename T> numarray<T>  operator*(numarray<T> const& a, float b);
-template <typename T> numarray<T>  operator*(float a, numarray<T> const& b);
-
 template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const& b);
 template <typename T> numarray<T>& operator/=(numarray<T>& a, float b);
-template <typename T> numarray<T>  operator/(numarray<T> const& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator/(numarray<T> const& a, float b);
-
-// Allow componentwise operations
-template <typename T> numarray<T>  sub(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  add(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  mul(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  div(numarray<T> const& a, T const& b);
 
-template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  add(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  div(T const& a, numarray<T> const& b);
+/** In-place operations with an expression, evaluated in a single loop (ex. a += dt*b;) */
+template <typename T, typename E> numarray<T>& operator+=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator-=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator*=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator/=(numarray<T>& a, numarray_expression<E> const& b);
 
 }
 
@@ -175,9 +181,34 @@ numarray<T>::numarray(std::initializer_list<T> arg)
 
 template <typename T>
 numarray<T>::numarray(const std::vector<T>& arg)
-    :data(arg)
+    :data(arg.begin(), arg.end())
 {}
 
+template <typename T>
+template <typename E>
+numarray<T>::numarray(numarray_expression<E> const& e)
+    :data()
+{
+    E const& expression = e.derived();
+    int const N = expression.size();
+    data.reserve(N);
+    for (int k = 0; k < N; ++k)
+        data.push_back(expression.at(k));
+}
+
+template <typename T>
+template <typename E>
+numarray<T>& numarray<T>::operator=(numarray_expression<E> const& e)
+{
+    // The expressions are element-wise: the element k only depends on the elements k of the operands, *this can also be an operand
+    E const& expression = e.derived();
+    int const N = expression.size();
+    data.resize(N);
+    for (int k = 0; k < N; ++k)
+        data[k] = expression.at(k);
+    return *this;
+}
+
 template <typename T>
 int numarray<T>::size() const
 {
@@ -346,37 +377,37 @@ T& numarray<T>::at_unsafe(int index)
 
 
 template <typename T>
-typename std::vector<T>::iterator numarray<T>::begin()
+typename numarray<T>::container_type::iterator numarray<T>::begin()
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::iterator numarray<T>::end()
+typename numarray<T>::container_type::iterator numarray<T>::end()
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::begin() const
+typename numarray<T>::container_type::const_iterator numarray<T>::begin() const
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::end() const
+typename numarray<T>::container_type::const_iterator numarray<T>::end() const
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::cbegin() const
+typename numarray<T>::container_type::const_iterator numarray<T>::cbegin() const
 {
     return data.cbegin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::cend() const
+typename numarray<T>::container_type::const_iterator numarray<T>::cend() const
 {
     return data.cend();
 }
@@ -402,14 +433,55 @@ template <typename T> int size_in_memory(numarray<T> const& v)
     return s;
 }
 
+namespace detail
+{
+    // Calls to the vectorized kernels for the numarrays of floats, vec2, vec3 and vec4. The functions return false for the other types (the scalar loop is then used).
+    template <typename T, bool enabled = (numarray_simd_components<T>::value > 0)>
+    struct numarray_simd_dispatch
+    {
+        static bool add(numarray<T>&, numarray<T> const&) { return false; }
+        static bool sub(numarray<T>&, numarray<T> const&) { return false; }
+        static bool mul(numarray<T>&, numarray<T> const&) { return false; }
+        static bool div(numarray<T>&, numarray<T> const&) { return false; }
+        static bool mul(numarray<T>&, float) { return false; }
+        static bool div(numarray<T>&, float) { return false; }
+        static bool sum(numarray<T> const&, T&) { return false; }
+        static bool max(numarray<T> const&, T&) { return false; }
+        static bool min(numarray<T> const&, T&) { return false; }
+    };
+
+    template <typename T>
+    struct numarray_simd_dispatch<T, true>
+    {
+        static int const components = numarray_simd_components<T>::value;
+        static_assert(sizeof(T) == components * sizeof(float), "Elements of the vectorized kernels must be made of contiguous floats");
+        static float* ptr(numarray<T>& a) { return reinterpret_cast<float*>(a.data.data()); }
+        static float const* ptr(numarray<T> const& a) { return reinterpret_cast<float const*>(a.data.data()); }
+        static size_t n(numarray<T> const& a) { return size_t(a.size()) * components; }
+
+        static bool add(numarray<T>& a, numarray<T> const& b) { numarray_simd::add(ptr(a), ptr(b), n(a)); return true; }
+        static bool sub(numarray<T>& a, numarray<T> const& b) { numarray_simd::sub(ptr(a), ptr(b), n(a)); return true; }
+        static bool mul(numarray<T>& a, numarray<T> const& b) { numarray_simd::mul(ptr(a), ptr(b), n(a)); return true; }
+        static bool div(numarray<T>& a, numarray<T> const& b) { numarray_simd::div(ptr(a), ptr(b), n(a)); return true; }
+        static bool mul(numarray<T>& a, float s) { numarray_simd::mul(ptr(a), s, n(a)); return true; }
+        static bool div(numarray<T>& a, float s) { numarray_simd::div(ptr(a), s, n(a)); return true; }
+        static bool sum(numarray<T> const& a, T& value) { numarray_simd::sum(reinterpret_cast<float*>(&value), ptr(a), n(a), components); return true; }
+        // min/max only for float (no ordering of vec2/3/4)
+        static bool max(numarray<T> const& a, T& value) { return max_float(a, value); }
+        static bool min(numarray<T> const& a, T& value) { return min_float(a, value); }
+        template <typename U> static bool max_float(numarray<U> const&, U&) { return false; }
+        template <typename U> static bool min_float(numarray<U> const&, U&) { return false; }
+        static bool max_float(numarray<float> const& a, float& value) { value = numarray_simd::max(ptr(a), n(a)); return true; }
+        static bool min_float(numarray<float> const& a, float& value) { value = numarray_simd::min(ptr(a), n(a)); return true; }
+    };
+}
+
 template <typename T> T average(numarray<T> const& a)
 {
     int const N = a.size();
     assert_cgp(N>0, "Cannot compute average on empty numarray");
 
-    T value = {}; // assume value start at zero
-    for(int k=0; k<N; ++k)
-        value += a[k];
+    T value = sum(a);
     value /= float(N);
 
     return value;
@@ -419,8 +491,11 @@ template <typename T> T sum(numarray<T> const& a) {
     assert_cgp(N>0, "Cannot compute sum on empty numarray");
 
     T value = {}; // assume value start at zero
+    if (detail::numarray_simd_dispatch<T>::sum(a, value))
+        return value;
+
     for(int k=0; k<N; ++k)
-        value += a[k];
+        value += a.at(k);
 
     return value;
 }
@@ -432,8 +507,11 @@ template <typename T> T max(numarray<T> const& v)
     assert_cgp(N>0, "Cannot get max on empty numarray");
 
     T current_max = v[0];
+    if (detail::numarray_simd_dispatch<T>::max(v, current_max))
+        return current_max;
+
     for (int k = 1; k < N; ++k) {
-        T const& element = v[k];
+        T const& element = v.at(k);
         if(element>current_max) 
             current_max = element;
     }
@@ -446,8 +524,11 @@ template <typename T> T min(numarray<T> const& v)
     assert_cgp(N>0, "Cannot get max on empty numarray");
 
     T current_min = v[0];
+    if (detail::numarray_simd_dispatch<T>::min(v, current_min))
+        return current_min;
+
     for (int k = 1; k < N; ++k) {
-        T const& element = v[k];
+        T const& element = v.at(k);
         if(element<current_min) 
             current_min = element;
     }
@@ -463,48 +544,15 @@ numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b)
     assert_cgp(a.size()==b.size(), "Size do not agree");
 
     const int N = a.size();
+    if (detail::numarray_simd_dispatch<T>::add(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] += b[k];
+        a.at(k) += b.at(k);
     return a;
 }
 
 
 
-template <typename T>
-numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b)
-{
-    numarray<T> res = a;
-    res += b;
-    return res;
-}
-
-template <typename T>
-numarray<T>  operator+(numarray<T> const& a, T const& b)
-{
-    numarray<T> res = a;
-    res += b;
-    return res;
-}
-
-template <typename T>
-numarray<T>  operator+(T const& a, numarray<T> const& b)
-{
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a+b[k];
-    return res;
-}
-
-template <typename T> numarray<T>  operator-(numarray<T> const& a)
-{
-    int const N = a.size();
-    numarray<T> b(N);
-    for(int k=0; k<N; ++k)
-        b[k] = -a[k];
-    return b;
-}
-
 
 template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b)
 {
@@ -512,17 +560,13 @@ template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const&
     assert_cgp(a.size()==b.size(), "Size do not agree");
 
     const int N = a.size();
+    if (detail::numarray_simd_dispatch<T>::sub(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] -= b[k];
+        a.at(k) -= b.at(k);
     return a;
 }
 
-template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b)
-{
-    numarray<T> res = a;
-    res -= b;
-    return res;
-}
 
 
 template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b)
@@ -531,16 +575,12 @@ template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const&
     assert_cgp(a.size()==b.size(), "Size do not agree");
 
     const int N = a.size();
+    if (detail::numarray_simd_dispatch<T>::mul(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] *= b[k];
+        a.at(k) *= b.at(k);
     return a;
 }
-template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b)
-{
-    numarray<T> res = a;
-    res *= b;
-    return res;
-}
 
 
 
@@ -548,26 +588,12 @@ template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> c
 template <typename T> numarray<T>& operator*=(numarray<T>& a, float b)
 {
     int const N = a.size();
+    if (detail::numarray_simd_dispatch<T>::mul(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] *= b;
+        a.at(k) *= b;
     return a;
 }
-template <typename T> numarray<T>  operator*(numarray<T> const& a, float b)
-{
-    int const N = a.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a[k]*b;
-    return res;
-}
-template <typename T> numarray<T>  operator*(float a, numarray<T> const& b)
-{
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a*b[k];
-    return res;
-}
 
 template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const& b)
 {
@@ -575,30 +601,22 @@ template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const&
     assert_cgp(a.size()==b.size(), "Size do not agree");
 
     const int N = a.size();
+    if (detail::numarray_simd_dispatch<T>::div(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] /= b[k];
+        a.at(k) /= b.at(k);
     return a;
 }
 template <typename T> numarray<T>& operator/=(numarray<T>& a, float b)
 {
     assert_cgp(a.size()>0, "Size must be >0");
     const int N = a.size();
+    if (detail::numarray_simd_dispatch<T>::div(a, b))
+        return a;
     for(int k=0; k<N; ++k)
-        a[k] /= b;
+        a.at(k) /= b;
     return a;
 }
-template <typename T> numarray<T>  operator/(numarray<T> const& a, numarray<T> const& b)
-{
-    numarray<T> res = a;
-    res /= b;
-    return res;
-}
-template <typename T> numarray<T>  operator/(numarray<T> const& a, float b)
-{
-    numarray<T> res = a;
-    res /= b;
-    return res;
-}
 
 
 
@@ -642,102 +660,41 @@ template <typename T> auto const* ptr(numarray<T> const& v)
     return ptr(v[0]);
 }
 
-template <typename T> numarray<T> sub(numarray<T> const& a, T const& b)
-{
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]-b;
-    }
-
-    return res;
-}
-template <typename T> numarray<T> add(numarray<T> const& a, T const& b)
-{
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]+b;
-    }
-
-    return res;
-}
-template <typename T> numarray<T> mul(numarray<T> const& a, T const& b)
-{
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]*b;
-    }
-
-    return res;
-}
-template <typename T> numarray<T> div(numarray<T> const& a, T const& b)
+template <typename T, typename E> numarray<T>& operator+=(numarray<T>& a, numarray_expression<E> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]/b;
-    }
-
-    return res;
-}
-
-template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b)
-{
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a-b[k];
-    }
-
-    return res;
+    E const& expression = b.derived();
+    assert_cgp(a.size()==expression.size(), "Size do not agree");
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) += expression.at(k);
+    return a;
 }
-template <typename T> numarray<T>  add(T const& a, numarray<T> const& b)
+template <typename T, typename E> numarray<T>& operator-=(numarray<T>& a, numarray_expression<E> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a+b[k];
-    }
-
-    return res;
+    E const& expression = b.derived();
+    assert_cgp(a.size()==expression.size(), "Size do not agree");
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) -= expression.at(k);
+    return a;
 }
-template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b)
+template <typename T, typename E> numarray<T>& operator*=(numarray<T>& a, numarray_expression<E> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a*b[k];
-    }
-
-    return res;
+    E const& expression = b.derived();
+    assert_cgp(a.size()==expression.size(), "Size do not agree");
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) *= expression.at(k);
+    return a;
 }
-template <typename T> numarray<T>  div(T const& a, numarray<T> const& b)
+template <typename T, typename E> numarray<T>& operator/=(numarray<T>& a, numarray_expression<E> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a/b[k];
-    }
-
-    return res;
+    E const& expression = b.derived();
+    assert_cgp(a.size()==expression.size(), "Size do not agree");
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) /= expression.at(k);
+    return a;
 }
 
 
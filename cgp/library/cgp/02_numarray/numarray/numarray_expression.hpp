@@ -0,0 +1,344 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+
+#include <type_traits>
+#include <utility>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename T> struct numarray;
+
+/** Lazy expressions on numarray
+ *
+ * The arithmetic operators between numarrays (+ - * / and add, sub, mul, div) don't compute their result immediately:
+ *  they return a lightweight expression storing its operands, evaluated element by element when it is assigned to a numarray.
+ * An expression such as  a = b*s + c*t - d  is therefore computed in a single loop, without temporary numarray,
+ *  and without any allocation when a already has the right size.
+ *
+ * Expressions convert implicitly to numarray, can be combined with other expressions, reduced with sum/average/min/max, and indexed with [].
+ * Operands that are named numarrays are stored by reference, while temporary numarrays are moved into the expression:
+ *  an expression stored with auto remains valid as long as its named operands are alive (and not resized).
+ *
+ **/
+template <typename E>
+struct numarray_expression
+{
+    E const& derived() const { return static_cast<E const&>(*this); }
+};
+
+/** Fused reductions on an expression (no intermediate numarray) */
+template <typename E> typename E::value_type sum(numarray_expression<E> const& e);
+template <typename E> typename E::value_type average(numarray_expression<E> const& e);
+template <typename E> typename E::value_type max(numarray_expression<E> const& e);
+template <typename E> typename E::value_type min(numarray_expression<E> const& e);
+
+template <typename E> std::string str(numarray_expression<E> const& e, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
+template <typename E> std::ostream& operator<<(std::ostream& s, numarray_expression<E> const& e);
+
+namespace detail
+{
+    // Operands accepted by the operators: numarray<T> and expressions
+    template <typename A, typename Enable = void> struct numarray_operand { static constexpr bool value = false; };
+    template <typename T> struct numarray_operand<numarray<T>, void> { static constexpr bool value = true; using value_type = T; };
+    template <typename E> struct numarray_operand<E, typename std::enable_if<std::is_base_of<numarray_expression<E>, E>::value>::type> { static constexpr bool value = true; using value_type = typename E::value_type; };
+
+    template <typename A> using numarray_operand_decay = numarray_operand<typename std::decay<A>::type>;
+    template <typename A> using numarray_operand_value = typename numarray_operand_decay<A>::value_type;
+    template <typename A, typename B = void> using enable_if_numarray_operand = typename std::enable_if<numarray_operand_decay<A>::value && numarray_operand_decay<B>::value>::type;
+    template <typename A> using enable_if_numarray_operand_1 = typename std::enable_if<numarray_operand_decay<A>::value>::type;
+
+    template <typename A> struct is_numarray { static constexpr bool value = false; };
+    template <typename T> struct is_numarray<numarray<T>> { static constexpr bool value = true; };
+
+    // Named numarrays are stored by reference, temporary numarrays and expressions by value
+    template <typename A> using numarray_operand_storage = typename std::conditional<
+        std::is_lvalue_reference<A>::value && is_numarray<typename std::decay<A>::type>::value,
+        typename std::decay<A>::type const&,
+        typename std::decay<A>::type>::type;
+
+    struct numarray_op_add { template <typename A, typename B> static auto apply(A const& a, B const& b) { return a + b; } };
+    struct numarray_op_sub { template <typename A, typename B> static auto apply(A const& a, B const& b) { return a - b; } };
+    struct numarray_op_mul { template <typename A, typename B> static auto apply(A const& a, B const& b) { return a * b; } };
+    struct numarray_op_div { template <typename A, typename B> static auto apply(A const& a, B const& b) { return a / b; } };
+}
+
+/** Element-wise operation between two numarrays (or expressions) of the same size */
+template <typename OP, typename L, typename R>
+struct numarray_expression_binary : numarray_expression<numarray_expression_binary<OP, L, R>>
+{
+    using value_type = typename detail::numarray_operand_value<L>;
+    L left;
+    R right;
+
+    template <typename A, typename B>
+    numarray_expression_binary(A&& a, B&& b);
+    int size() const { return left.size(); }
+    value_type at(int k) const { return OP::apply(left.at(k), right.at(k)); }
+    value_type operator[](int k) const;
+};
+
+/** Operation between each element of a numarray (or expression) and a scalar value, on its right (scalar_left=false) or on its left (scalar_left=true) */
+template <typename OP, typename A, typename S, bool scalar_left>
+struct numarray_expression_scalar : numarray_expression<numarray_expression_scalar<OP, A, S, scalar_left>>
+{
+    using value_type = typename detail::numarray_operand_value<A>;
+    A array;
+    S scalar;
+
+    template <typename B>
+    numarray_expression_scalar(B&& b, S const& s) :array(std::forward<B>(b)), scalar(s) {}
+    int size() const { return array.size(); }
+    value_type at(int k) const { return scalar_left ? value_type(OP::apply(scalar, array.at(k))) : value_type(OP::apply(array.at(k), scalar)); }
+    value_type operator[](int k) const;
+};
+
+/** Opposite of each element */
+template <typename A>
+struct numarray_expression_negate : numarray_expression<numarray_expression_negate<A>>
+{
+    using value_type = typename detail::numarray_operand_value<A>;
+    A array;
+
+    template <typename B>
+    explicit numarray_expression_negate(B&& b) :array(std::forward<B>(b)) {}
+    int size() const { return array.size(); }
+    value_type at(int k) const { return -array.at(k); }
+    value_type operator[](int k) const;
+};
+
+
+/** Math operators
+ * Element-wise operations between numarrays (or expressions), and with scalar or element values. They return lazy expressions.
+ * Ex. numarray<vec3> p = p0 + dt * v; */
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator-(A&& a);
+
+template <typename A, typename B, typename = detail::enable_if_numarray_operand<A, B>> auto operator+(A&& a, B&& b);
+template <typename A, typename B, typename = detail::enable_if_numarray_operand<A, B>> auto operator-(A&& a, B&& b);
+template <typename A, typename B, typename = detail::enable_if_numarray_operand<A, B>> auto operator*(A&& a, B&& b);
+template <typename A, typename B, typename = detail::enable_if_numarray_operand<A, B>> auto operator/(A&& a, B&& b);
+
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator*(A&& a, float b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator*(float a, A&& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator/(A&& a, float b);
+
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator+(A&& a, detail::numarray_operand_value<A> const& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto operator+(detail::numarray_operand_value<A> const& a, A&& b);
+
+// Allow componentwise operations
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto sub(A&& a, detail::numarray_operand_value<A> const& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto add(A&& a, detail::numarray_operand_value<A> const& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto mul(A&& a, detail::numarray_operand_value<A> const& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto div(A&& a, detail::numarray_operand_value<A> const& b);
+
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto sub(detail::numarray_operand_value<A> const& a, A&& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto add(detail::numarray_operand_value<A> const& a, A&& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto mul(detail::numarray_operand_value<A> const& a, A&& b);
+template <typename A, typename = detail::enable_if_numarray_operand_1<A>> auto div(detail::numarray_operand_value<A> const& a, A&& b);
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename OP, typename L, typename R>
+template <typename A, typename B>
+numarray_expression_binary<OP, L, R>::numarray_expression_binary(A&& a, B&& b)
+    :left(std::forward<A>(a)), right(std::forward<B>(b))
+{
+    assert_cgp(left.size()>0 && right.size()>0, "Size must be >0");
+    assert_cgp(left.size()==right.size(), "Size do not agree");
+}
+
+template <typename OP, typename L, typename R>
+typename numarray_expression_binary<OP, L, R>::value_type numarray_expression_binary<OP, L, R>::operator[](int k) const
+{
+    assert_cgp(k>=0 && k<size(), "Try to access expression["+str(k)+"] for a size="+str(size()));
+    return at(k);
+}
+
+template <typename OP, typename A, typename S, bool scalar_left>
+typename numarray_expression_scalar<OP, A, S, scalar_left>::value_type numarray_expression_scalar<OP, A, S, scalar_left>::operator[](int k) const
+{
+    assert_cgp(k>=0 && k<size(), "Try to access expression["+str(k)+"] for a size="+str(size()));
+    return at(k);
+}
+
+template <typename A>
+typename numarray_expression_negate<A>::value_type numarray_expression_negate<A>::operator[](int k) const
+{
+    assert_cgp(k>=0 && k<size(), "Try to access expression["+str(k)+"] for a size="+str(size()));
+    return at(k);
+}
+
+
+template <typename E> typename E::value_type sum(numarray_expression<E> const& e)
+{
+    E const& a = e.derived();
+    int const N = a.size();
+    assert_cgp(N>0, "Cannot compute sum on empty numarray");
+
+    typename E::value_type value = {}; // assume value start at zero
+    for(int k=0; k<N; ++k)
+        value += a.at(k);
+    return value;
+}
+
+template <typename E> typename E::value_type average(numarray_expression<E> const& e)
+{
+    assert_cgp(e.derived().size()>0, "Cannot compute average on empty numarray");
+    typename E::value_type value = sum(e);
+    value /= float(e.derived().size());
+    return value;
+}
+
+template <typename E> typename E::value_type max(numarray_expression<E> const& e)
+{
+    E const& a = e.derived();
+    int const N = a.size();
+    assert_cgp(N>0, "Cannot get max on empty numarray");
+
+    typename E::value_type current_max = a.at(0);
+    for (int k = 1; k < N; ++k) {
+        typename E::value_type const element = a.at(k);
+        if(element>current_max)
+            current_max = element;
+    }
+    return current_max;
+}
+
+template <typename E> typename E::value_type min(numarray_expression<E> const& e)
+{
+    E const& a = e.derived();
+    int const N = a.size();
+    assert_cgp(N>0, "Cannot get min on empty numarray");
+
+    typename E::value_type current_min = a.at(0);
+    for (int k = 1; k < N; ++k) {
+        typename E::value_type const element = a.at(k);
+        if(element<current_min)
+            current_min = element;
+    }
+    return current_min;
+}
+
+template <typename E> std::string str(numarray_expression<E> const& e, std::string const& separator, std::string const& begin, std::string const& end)
+{
+    return str(numarray<typename E::value_type>(e), separator, begin, end);
+}
+
+template <typename E> std::ostream& operator<<(std::ostream& s, numarray_expression<E> const& e)
+{
+    s << str(e);
+    return s;
+}
+
+
+template <typename A, typename>
+auto operator-(A&& a)
+{
+    return numarray_expression_negate<detail::numarray_operand_storage<A>>(std::forward<A>(a));
+}
+
+template <typename A, typename B, typename>
+auto operator+(A&& a, B&& b)
+{
+    return numarray_expression_binary<detail::numarray_op_add, detail::numarray_operand_storage<A>, detail::numarray_operand_storage<B>>(std::forward<A>(a), std::forward<B>(b));
+}
+template <typename A, typename B, typename>
+auto operator-(A&& a, B&& b)
+{
+    return numarray_expression_binary<detail::numarray_op_sub, detail::numarray_operand_storage<A>, detail::numarray_operand_storage<B>>(std::forward<A>(a), std::forward<B>(b));
+}
+template <typename A, typename B, typename>
+auto operator*(A&& a, B&& b)
+{
+    return numarray_expression_binary<detail::numarray_op_mul, detail::numarray_operand_storage<A>, detail::numarray_operand_storage<B>>(std::forward<A>(a), std::forward<B>(b));
+}
+template <typename A, typename B, typename>
+auto operator/(A&& a, B&& b)
+{
+    return numarray_expression_binary<detail::numarray_op_div, detail::numarray_operand_storage<A>, detail::numarray_operand_storage<B>>(std::forward<A>(a), std::forward<B>(b));
+}
+
+template <typename A, typename>
+auto operator*(A&& a, float b)
+{
+    return numarray_expression_scalar<detail::numarray_op_mul, detail::numarray_operand_storage<A>, float, false>(std::forward<A>(a), b);
+}
+template <typename A, typename>
+auto operator*(float a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_mul, detail::numarray_operand_storage<A>, float, true>(std::forward<A>(b), a);
+}
+template <typename A, typename>
+auto operator/(A&& a, float b)
+{
+    return numarray_expression_scalar<detail::numarray_op_div, detail::numarray_operand_storage<A>, float, false>(std::forward<A>(a), b);
+}
+
+template <typename A, typename>
+auto operator+(A&& a, detail::numarray_operand_value<A> const& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_add, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, false>(std::forward<A>(a), b);
+}
+template <typename A, typename>
+auto operator+(detail::numarray_operand_value<A> const& a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_add, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, true>(std::forward<A>(b), a);
+}
+
+template <typename A, typename>
+auto sub(A&& a, detail::numarray_operand_value<A> const& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_sub, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, false>(std::forward<A>(a), b);
+}
+template <typename A, typename>
+auto add(A&& a, detail::numarray_operand_value<A> const& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_add, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, false>(std::forward<A>(a), b);
+}
+template <typename A, typename>
+auto mul(A&& a, detail::numarray_operand_value<A> const& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_mul, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, false>(std::forward<A>(a), b);
+}
+template <typename A, typename>
+auto div(A&& a, detail::numarray_operand_value<A> const& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_div, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, false>(std::forward<A>(a), b);
+}
+
+template <typename A, typename>
+auto sub(detail::numarray_operand_value<A> const& a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_sub, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, true>(std::forward<A>(b), a);
+}
+template <typename A, typename>
+auto add(detail::numarray_operand_value<A> const& a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_add, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, true>(std::forward<A>(b), a);
+}
+template <typename A, typename>
+auto mul(detail::numarray_operand_value<A> const& a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_mul, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, true>(std::forward<A>(b), a);
+}
+template <typename A, typename>
+auto div(detail::numarray_operand_value<A> const& a, A&& b)
+{
+    return numarray_expression_scalar<detail::numarray_op_div, detail::numarray_operand_storage<A>, detail::numarray_operand_value<A>, true>(std::forward<A>(b), a);
+}
+
+}
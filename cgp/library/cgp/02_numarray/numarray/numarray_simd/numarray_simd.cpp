@@ -0,0 +1,126 @@
+#include "numarray_simd.hpp"
+#include "numarray_simd_kernel.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+
+#include <atomic>
+
+namespace cgp
+{
+	namespace numarray_simd
+	{
+		namespace
+		{
+			// "Pack" of a single float: scalar version of the kernels
+			struct simd_scalar
+			{
+				typedef float f;
+				static int const width = 1;
+
+				static f set(float a) { return a; }
+				static f loadu(float const* p) { return *p; }
+				static void storeu(float* p, f const& a) { *p = a; }
+
+				static f add(f const& a, f const& b) { return a + b; }
+				static f sub(f const& a, f const& b) { return a - b; }
+				static f mul(f const& a, f const& b) { return a * b; }
+				static f div(f const& a, f const& b) { return a / b; }
+				static f max(f const& a, f const& b) { return a > b ? a : b; }
+				static f min(f const& a, f const& b) { return a < b ? a : b; }
+			};
+
+			numarray_simd_instruction_set best_instruction_set()
+			{
+#ifdef CGP_SIMD_X86
+				return simd_support_avx2() ? numarray_simd_instruction_set::avx2 : numarray_simd_instruction_set::sse2;
+#else
+				return numarray_simd_instruction_set::scalar;
+#endif
+			}
+
+			std::atomic<int>& current_instruction_set()
+			{
+				static std::atomic<int> instruction_set(static_cast<int>(best_instruction_set()));
+				return instruction_set;
+			}
+
+			std::atomic<bool> deterministic(false);
+
+			kernels const& current_kernels()
+			{
+				switch (static_cast<numarray_simd_instruction_set>(current_instruction_set().load())) {
+				case numarray_simd_instruction_set::avx2: return kernels_avx2();
+				case numarray_simd_instruction_set::sse2: return kernels_sse2();
+				default: return kernels_scalar();
+				}
+			}
+		}
+
+		kernels const& kernels_scalar()
+		{
+			static kernels const k = make_kernels<simd_scalar>();
+			return k;
+		}
+#ifndef CGP_SIMD_X86
+		kernels const& kernels_sse2() { return kernels_scalar(); }
+		kernels const& kernels_avx2() { return kernels_scalar(); }
+#endif
+
+		void add(float* a, float const* b, size_t n) { current_kernels().add(a, b, n); }
+		void sub(float* a, float const* b, size_t n) { current_kernels().sub(a, b, n); }
+		void mul(float* a, float const* b, size_t n) { current_kernels().mul(a, b, n); }
+		void div(float* a, float const* b, size_t n) { current_kernels().div(a, b, n); }
+		void mul(float* a, float s, size_t n) { current_kernels().mul_scalar(a, s, n); }
+		void div(float* a, float s, size_t n) { current_kernels().div_scalar(a, s, n); }
+		float max(float const* a, size_t n) { return current_kernels().max(a, n); }
+		float min(float const* a, size_t n) { return current_kernels().min(a, n); }
+
+		// Sequential sum in index order (deterministic mode), the number of components is a template parameter to keep the accumulators in registers
+		template <int C>
+		void sum_sequential(float* result, float const* a, size_t n)
+		{
+			float acc[C] = {};
+			for (size_t k = 0; k < n; k += C)
+				for (int c = 0; c < C; ++c)
+					acc[c] += a[k + c];
+			for (int c = 0; c < C; ++c)
+				result[c] = acc[c];
+		}
+
+		void sum(float* result, float const* a, size_t n, int components)
+		{
+			if (deterministic) {
+				switch (components) {
+				case 2: sum_sequential<2>(result, a, n); return;
+				case 3: sum_sequential<3>(result, a, n); return;
+				case 4: sum_sequential<4>(result, a, n); return;
+				default: sum_sequential<1>(result, a, n); return;
+				}
+			}
+			current_kernels().sum(result, a, n, components);
+		}
+	}
+
+	numarray_simd_instruction_set numarray_simd_set_instruction_set(numarray_simd_instruction_set instruction_set)
+	{
+		numarray_simd_instruction_set const best = numarray_simd::best_instruction_set();
+		if (static_cast<int>(instruction_set) > static_cast<int>(best))
+			instruction_set = best;
+		numarray_simd::current_instruction_set() = static_cast<int>(instruction_set);
+		return instruction_set;
+	}
+
+	numarray_simd_instruction_set numarray_simd_get_instruction_set()
+	{
+		return static_cast<numarray_simd_instruction_set>(numarray_simd::current_instruction_set().load());
+	}
+
+	void numarray_simd_set_deterministic(bool deterministic)
+	{
+		numarray_simd::deterministic = deterministic;
+	}
+
+	bool numarray_simd_get_deterministic()
+	{
+		return numarray_simd::deterministic;
+	}
+}
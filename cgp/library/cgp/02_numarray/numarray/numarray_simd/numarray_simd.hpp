@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorized kernels of numarray<float>, numarray<vec2>, numarray<vec3> and numarray<vec4>
+//
+// The element-wise operators (+=, -=, *=, /=) and the reductions (sum, average, and min/max for float) of these numarrays are computed on the underlying array of floats
+//  by SSE2 or AVX2 kernels, selected at run-time from the CPU features (see 01_base/simd). A scalar version is used on other platforms.
+// - The element-wise operations give exactly the same result as the scalar loop.
+// - The sums accumulate the floats in 24 partial sums (the float k is added to the partial sum k%24) combined in a fixed order:
+//   the result is identical with the scalar, SSE2 and AVX2 kernels (but can differ from a sequential sum in the last bits).
+//   In deterministic mode, the sums are computed sequentially in index order and are bit-identical to the scalar loop over the elements.
+//
+// Defining CGP_NUMARRAY_ALIGNED before compilation stores these numarrays with an allocator aligned on 32 bytes (their data is then a std::vector<T, simd_aligned_allocator<T>>).
+
+namespace cgp
+{
+	template <typename T, int N> struct numarray_stack;
+
+	/** Instruction set used by the numarray kernels */
+	enum class numarray_simd_instruction_set { scalar, sse2, avx2 };
+
+	/** Select the instruction set of the kernels (default: the best one supported by the CPU).
+	* An instruction set that isn't supported is replaced by the best supported one. Return the instruction set actually used. */
+	numarray_simd_instruction_set numarray_simd_set_instruction_set(numarray_simd_instruction_set instruction_set);
+	numarray_simd_instruction_set numarray_simd_get_instruction_set();
+
+	/** Enable/disable the deterministic mode (default: disabled) */
+	void numarray_simd_set_deterministic(bool deterministic);
+	bool numarray_simd_get_deterministic();
+
+	/** Number of floats of the elements handled by the kernels (0 for the other types) */
+	template <typename T> struct numarray_simd_components { static int const value = 0; };
+	template <> struct numarray_simd_components<float> { static int const value = 1; };
+	template <> struct numarray_simd_components<numarray_stack<float, 2>> { static int const value = 2; };
+	template <> struct numarray_simd_components<numarray_stack<float, 3>> { static int const value = 3; };
+	template <> struct numarray_simd_components<numarray_stack<float, 4>> { static int const value = 4; };
+
+	namespace numarray_simd
+	{
+		// a[k] (op)= b[k] for k in [0,n[
+		void add(float* a, float const* b, size_t n);
+		void sub(float* a, float const* b, size_t n);
+		void mul(float* a, float const* b, size_t n);
+		void div(float* a, float const* b, size_t n);
+		// a[k] (op)= s for k in [0,n[
+		void mul(float* a, float s, size_t n);
+		void div(float* a, float s, size_t n);
+		// result[c] = sum of the a[k] with k%components==c (components in [1,4], n multiple of components)
+		void sum(float* result, float const* a, size_t n, int components);
+		// Maximal/minimal value of a[0..n-1] (n>0)
+		float max(float const* a, size_t n);
+		float min(float const* a, size_t n);
+
+		// Kernels of each instruction set (internal)
+		struct kernels
+		{
+			void (*add)(float*, float const*, size_t);
+			void (*sub)(float*, float const*, size_t);
+			void (*mul)(float*, float const*, size_t);
+			void (*div)(float*, float const*, size_t);
+			void (*mul_scalar)(float*, float, size_t);
+			void (*div_scalar)(float*, float, size_t);
+			void (*sum)(float*, float const*, size_t, int);
+			float (*max)(float const*, size_t);
+			float (*min)(float const*, size_t);
+		};
+		kernels const& kernels_scalar();
+		kernels const& kernels_sse2();
+		kernels const& kernels_avx2();
+	}
+}
@@ -0,0 +1,76 @@
+#include "numarray_simd.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+
+#ifdef CGP_SIMD_X86
+
+// The functions of this file use AVX instructions without requiring the whole library to be compiled with AVX2 support (-mavx2).
+//  They are only called after checking simd_support_avx2() at run-time.
+// Note: only local functions must be defined after the target pragma (no STL or library template instantiated here),
+//  otherwise AVX2 code could be selected by the linker for functions shared with the rest of the library.
+#include <cstddef>
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+#include "numarray_simd_kernel.hpp"
+
+namespace cgp
+{
+	namespace numarray_simd
+	{
+		namespace
+		{
+			// Pack of 8 floats using AVX
+			struct simd_avx2
+			{
+				typedef __m256 f;
+				static int const width = 8;
+
+				static f set(float a) { return _mm256_set1_ps(a); }
+				static f loadu(float const* p) { return _mm256_loadu_ps(p); }
+				static void storeu(float* p, f const& a) { _mm256_storeu_ps(p, a); }
+
+				static f add(f const& a, f const& b) { return _mm256_add_ps(a, b); }
+				static f sub(f const& a, f const& b) { return _mm256_sub_ps(a, b); }
+				static f mul(f const& a, f const& b) { return _mm256_mul_ps(a, b); }
+				static f div(f const& a, f const& b) { return _mm256_div_ps(a, b); }
+				static f max(f const& a, f const& b) { return _mm256_max_ps(a, b); }
+				static f min(f const& a, f const& b) { return _mm256_min_ps(a, b); }
+			};
+
+			void add_avx2(float* a, float const* b, size_t n) { kernel_add<simd_avx2>(a, b, n); }
+			void sub_avx2(float* a, float const* b, size_t n) { kernel_sub<simd_avx2>(a, b, n); }
+			void mul_avx2(float* a, float const* b, size_t n) { kernel_mul<simd_avx2>(a, b, n); }
+			void div_avx2(float* a, float const* b, size_t n) { kernel_div<simd_avx2>(a, b, n); }
+			void mul_scalar_avx2(float* a, float s, size_t n) { kernel_mul_scalar<simd_avx2>(a, s, n); }
+			void div_scalar_avx2(float* a, float s, size_t n) { kernel_div_scalar<simd_avx2>(a, s, n); }
+			void sum_avx2(float* result, float const* a, size_t n, int components) { kernel_sum<simd_avx2>(result, a, n, components); }
+			float max_avx2(float const* a, size_t n) { return kernel_max<simd_avx2>(a, n); }
+			float min_avx2(float const* a, size_t n) { return kernel_min<simd_avx2>(a, n); }
+		}
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace cgp
+{
+	namespace numarray_simd
+	{
+		kernels const& kernels_avx2()
+		{
+			static kernels const k = { add_avx2, sub_avx2, mul_avx2, div_avx2, mul_scalar_avx2, div_scalar_avx2, sum_avx2, max_avx2, min_avx2 };
+			return k;
+		}
+	}
+}
+
+#endif
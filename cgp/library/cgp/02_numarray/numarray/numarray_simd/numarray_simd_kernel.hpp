@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+
+// Generic implementation of the numarray kernels (internal header included by numarray_simd.cpp, numarray_simd_sse2.cpp and numarray_simd_avx2.cpp)
+// S is a structure describing a pack of S::width floats, providing
+//  - the type f, and the functions set, loadu, storeu, add, sub, mul, div, max, min.
+
+namespace cgp
+{
+	namespace numarray_simd
+	{
+		// Number of partial sums of the reductions (multiple of the width of all the instruction sets, and of the number of components 1,2,3,4)
+		static size_t const sum_lanes = 24;
+
+		template <typename S> void kernel_add(float* a, float const* b, size_t n)
+		{
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::add(S::loadu(a + k), S::loadu(b + k)));
+			for (; k < n; ++k)
+				a[k] += b[k];
+		}
+		template <typename S> void kernel_sub(float* a, float const* b, size_t n)
+		{
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::sub(S::loadu(a + k), S::loadu(b + k)));
+			for (; k < n; ++k)
+				a[k] -= b[k];
+		}
+		template <typename S> void kernel_mul(float* a, float const* b, size_t n)
+		{
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::mul(S::loadu(a + k), S::loadu(b + k)));
+			for (; k < n; ++k)
+				a[k] *= b[k];
+		}
+		template <typename S> void kernel_div(float* a, float const* b, size_t n)
+		{
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::div(S::loadu(a + k), S::loadu(b + k)));
+			for (; k < n; ++k)
+				a[k] /= b[k];
+		}
+		template <typename S> void kernel_mul_scalar(float* a, float s, size_t n)
+		{
+			typename S::f const s_pack = S::set(s);
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::mul(S::loadu(a + k), s_pack));
+			for (; k < n; ++k)
+				a[k] *= s;
+		}
+		template <typename S> void kernel_div_scalar(float* a, float s, size_t n)
+		{
+			typename S::f const s_pack = S::set(s);
+			size_t k = 0;
+			for (; k + S::width <= n; k += S::width)
+				S::storeu(a + k, S::div(S::loadu(a + k), s_pack));
+			for (; k < n; ++k)
+				a[k] /= s;
+		}
+
+		// The partial sum j accumulates the a[k] with k%sum_lanes==j in increasing k. The partial sums of a component are then added in increasing j.
+		template <typename S> void kernel_sum(float* result, float const* a, size_t n, int components)
+		{
+			static_assert(sum_lanes % S::width == 0, "The number of partial sums must be a multiple of the width");
+			int const R = int(sum_lanes / S::width);
+			typename S::f acc[sum_lanes / S::width];
+			for (int r = 0; r < R; ++r)
+				acc[r] = S::set(0.0f);
+
+			size_t k = 0;
+			for (; k + sum_lanes <= n; k += sum_lanes)
+				for (int r = 0; r < R; ++r)
+					acc[r] = S::add(acc[r], S::loadu(a + k + r * S::width));
+
+			float lanes[sum_lanes];
+			for (int r = 0; r < R; ++r)
+				S::storeu(lanes + r * S::width, acc[r]);
+			for (size_t j = 0; k < n; ++k, ++j)
+				lanes[j] += a[k];
+
+			for (int c = 0; c < components; ++c) {
+				float value = 0.0f;
+				for (size_t j = c; j < sum_lanes; j += components)
+					value += lanes[j];
+				result[c] = value;
+			}
+		}
+
+		// Same comparison as the scalar loop (S::max(x,acc) is x>acc ? x : acc): a NaN value is skipped (unless it is the first one)
+		template <typename S> float kernel_max(float const* a, size_t n)
+		{
+			float value = a[0];
+			typename S::f acc = S::set(value);
+			size_t k = 1;
+			for (; k + S::width <= n; k += S::width)
+				acc = S::max(S::loadu(a + k), acc);
+			float lanes[S::width];
+			S::storeu(lanes, acc);
+			for (int j = 0; j < S::width; ++j)
+				if (lanes[j] > value)
+					value = lanes[j];
+			for (; k < n; ++k)
+				if (a[k] > value)
+					value = a[k];
+			return value;
+		}
+		template <typename S> float kernel_min(float const* a, size_t n)
+		{
+			float value = a[0];
+			typename S::f acc = S::set(value);
+			size_t k = 1;
+			for (; k + S::width <= n; k += S::width)
+				acc = S::min(S::loadu(a + k), acc);
+			float lanes[S::width];
+			S::storeu(lanes, acc);
+			for (int j = 0; j < S::width; ++j)
+				if (lanes[j] < value)
+					value = lanes[j];
+			for (; k < n; ++k)
+				if (a[k] < value)
+					value = a[k];
+			return value;
+		}
+
+		template <typename S> kernels make_kernels()
+		{
+			kernels k;
+			k.add = kernel_add<S>;
+			k.sub = kernel_sub<S>;
+			k.mul = kernel_mul<S>;
+			k.div = kernel_div<S>;
+			k.mul_scalar = kernel_mul_scalar<S>;
+			k.div_scalar = kernel_div_scalar<S>;
+			k.sum = kernel_sum<S>;
+			k.max = kernel_max<S>;
+			k.min = kernel_min<S>;
+			return k;
+		}
+	}
+}
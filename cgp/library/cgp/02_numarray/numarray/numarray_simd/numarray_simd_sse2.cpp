@@ -0,0 +1,42 @@
+#include "numarray_simd.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+
+#ifdef CGP_SIMD_X86
+
+#include <emmintrin.h>
+#include "numarray_simd_kernel.hpp"
+
+namespace cgp
+{
+	namespace numarray_simd
+	{
+		namespace
+		{
+			// Pack of 4 floats using SSE2
+			struct simd_sse2
+			{
+				typedef __m128 f;
+				static int const width = 4;
+
+				static f set(float a) { return _mm_set1_ps(a); }
+				static f loadu(float const* p) { return _mm_loadu_ps(p); }
+				static void storeu(float* p, f const& a) { _mm_storeu_ps(p, a); }
+
+				static f add(f const& a, f const& b) { return _mm_add_ps(a, b); }
+				static f sub(f const& a, f const& b) { return _mm_sub_ps(a, b); }
+				static f mul(f const& a, f const& b) { return _mm_mul_ps(a, b); }
+				static f div(f const& a, f const& b) { return _mm_div_ps(a, b); }
+				static f max(f const& a, f const& b) { return _mm_max_ps(a, b); }
+				static f min(f const& a, f const& b) { return _mm_min_ps(a, b); }
+			};
+		}
+
+		kernels const& kernels_sse2()
+		{
+			static kernels const k = make_kernels<simd_sse2>();
+			return k;
+		}
+	}
+}
+
+#endif
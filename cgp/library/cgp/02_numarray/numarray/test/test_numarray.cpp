@@ -114,5 +114,59 @@ namespace cgp_test
 			assert_cgp_no_msg(cgp::is_equal(sum(a),  4.5f+8.2f+6.1f-3.6));
 		}
 
+		// test expressions
+		{
+			cgp::numarray<float> const b = { 1.0f, 2.0f, 3.0f };
+			cgp::numarray<float> const c = { 4.0f, -1.0f, 0.5f };
+			cgp::numarray<float> a = 2.0f * b + c / 2.0f - b * c;
+			assert_cgp_no_msg(is_equal(a, { 2.0f+2.0f-4.0f, 4.0f-0.5f+2.0f, 6.0f+0.25f-1.5f }));
+
+			// Assignment into an array of the same size doesn't reallocate, and the array can be one of the operands
+			float const* p = a.data.data();
+			a = -(a + add(c, 1.0f));
+			assert_cgp_no_msg(a.data.data() == p);
+			assert_cgp_no_msg(is_equal(a, { -5.0f, -5.5f, -6.25f }));
+
+			// Temporary operands are stored in the expression
+			auto e = cgp::numarray<float>{ 1.0f, 1.0f, 1.0f } * b;
+			assert_cgp_no_msg(e.size() == 3 && cgp::is_equal(e[2], 3.0f));
+			assert_cgp_no_msg(cgp::is_equal(sum(e + c), 9.5f));
+			assert_cgp_no_msg(cgp::is_equal(max(e - c), 3.0f));
+
+			cgp::numarray<cgp::vec3> v = { {1,2,3}, {4,5,6} };
+			v += 0.5f * v;
+			assert_cgp_no_msg(is_equal(v, cgp::numarray<cgp::vec3>{ {1.5f,3,4.5f}, {6,7.5f,9} }));
+		}
+
+		// test vectorized kernels: same results for all the instruction sets
+		{
+			using cgp::numarray_simd_instruction_set;
+			numarray_simd_instruction_set const initial = cgp::numarray_simd_get_instruction_set();
+
+			cgp::numarray<cgp::vec3> v(1001), d(1001);
+			for (int k = 0; k < v.size(); ++k) {
+				v[k] = { std::sin(0.1f * k), std::cos(0.3f * k), 0.01f * k - 2.0f };
+				d[k] = v[k] + cgp::vec3{ 3.0f, 3.0f, 13.0f };
+			}
+
+			cgp::numarray_simd_set_instruction_set(numarray_simd_instruction_set::scalar);
+			cgp::vec3 const s_scalar = sum(v);
+			cgp::numarray<cgp::vec3> w_scalar = v;
+			w_scalar /= d;
+			w_scalar *= 0.5f;
+
+			for (numarray_simd_instruction_set set : { numarray_simd_instruction_set::sse2, numarray_simd_instruction_set::avx2 }) {
+				cgp::numarray_simd_set_instruction_set(set);
+				cgp::vec3 const s = sum(v);
+				assert_cgp_no_msg(s.x == s_scalar.x && s.y == s_scalar.y && s.z == s_scalar.z);
+				cgp::numarray<cgp::vec3> w = v;
+				w /= d;
+				w *= 0.5f;
+				for (int k = 0; k < w.size(); ++k)
+					assert_cgp_no_msg(w[k].x == w_scalar[k].x && w[k].y == w_scalar[k].y && w[k].z == w_scalar[k].z);
+			}
+			cgp::numarray_simd_set_instruction_set(initial);
+		}
+
 	}
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "../numarray/numarray.hpp"
+
+#include <type_traits>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Parallel versions of the loops and reductions over a numarray, running on the thread pool of parallel_for/parallel_reduce (see cgp/01_base/parallel/parallel.hpp).
+	* Arrays smaller than 2*grain_size are processed serially (grain_size=0: parallel_default_grain_size()).
+	* The sums are computed on chunks combined in order: with parallel_set_deterministic(true) the result doesn't depend on the number of threads.
+	*
+	* Ex.
+	*   parallel_for(position, [&](vec3& p, int k) { p += dt * velocity[k]; });
+	*   parallel_transform(position, height, [](vec3 const& p) { return p.z; });
+	*   float const total = parallel_sum(height); */
+
+	/** Call f(a[k], k) for all the elements */
+	template <typename T, typename F> void parallel_for(numarray<T>& a, F const& f, size_t grain_size = 0);
+	/** result[k] = f(a[k]) (result is resized to the size of a) */
+	template <typename T, typename U, typename F> void parallel_transform(numarray<T> const& a, numarray<U>& result, F const& f, size_t grain_size = 0);
+
+	template <typename T> T parallel_sum(numarray<T> const& a, size_t grain_size = 0);
+	template <typename T> T parallel_average(numarray<T> const& a, size_t grain_size = 0);
+	template <typename T> T parallel_max(numarray<T> const& a, size_t grain_size = 0);
+	template <typename T> T parallel_min(numarray<T> const& a, size_t grain_size = 0);
+	template <typename T1, typename T2> bool parallel_is_equal(numarray<T1> const& a, numarray<T2> const& b, size_t grain_size = 0);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	namespace detail
+	{
+		// Sum of the elements [k_begin, k_end[ added to value: uses the vectorized kernels for float and vec2/3/4
+		template <typename T>
+		T numarray_sum_range(numarray<T> const& a, size_t k_begin, size_t k_end, T value, std::false_type)
+		{
+			for (size_t k = k_begin; k < k_end; ++k)
+				value += a.at(int(k));
+			return value;
+		}
+		template <typename T>
+		T numarray_sum_range(numarray<T> const& a, size_t k_begin, size_t k_end, T value, std::true_type)
+		{
+			int const components = numarray_simd_components<T>::value;
+			T chunk_sum;
+			numarray_simd::sum(reinterpret_cast<float*>(&chunk_sum), reinterpret_cast<float const*>(a.data.data() + k_begin), (k_end - k_begin) * components, components);
+			return value + chunk_sum;
+		}
+	}
+
+	template <typename T, typename F> void parallel_for(numarray<T>& a, F const& f, size_t grain_size)
+	{
+		parallel_for_range(size_t(a.size()), [&](size_t k_begin, size_t k_end) {
+			for (size_t k = k_begin; k < k_end; ++k)
+				f(a.at(int(k)), int(k));
+		}, grain_size);
+	}
+
+	template <typename T, typename U, typename F> void parallel_transform(numarray<T> const& a, numarray<U>& result, F const& f, size_t grain_size)
+	{
+		result.resize(a.size());
+		parallel_for_range(size_t(a.size()), [&](size_t k_begin, size_t k_end) {
+			for (size_t k = k_begin; k < k_end; ++k)
+				result.at(int(k)) = f(a.at(int(k)));
+		}, grain_size);
+	}
+
+	template <typename T> T parallel_sum(numarray<T> const& a, size_t grain_size)
+	{
+		assert_cgp(a.size() > 0, "Cannot compute sum on empty numarray");
+		typedef std::integral_constant<bool, (numarray_simd_components<T>::value > 0)> vectorized;
+		return parallel_reduce(size_t(a.size()), T{},
+			[&a](size_t k_begin, size_t k_end, T value) { return detail::numarray_sum_range(a, k_begin, k_end, value, vectorized()); },
+			[](T const& x, T const& y) { return x + y; }, grain_size);
+	}
+
+	template <typename T> T parallel_average(numarray<T> const& a, size_t grain_size)
+	{
+		assert_cgp(a.size() > 0, "Cannot compute average on empty numarray");
+		return parallel_sum(a, grain_size) / float(a.size());
+	}
+
+	template <typename T> T parallel_max(numarray<T> const& a, size_t grain_size)
+	{
+		assert_cgp(a.size() > 0, "Cannot get max on empty numarray");
+		return parallel_reduce(size_t(a.size()), a.at(0),
+			[&a](size_t k_begin, size_t k_end, T value) {
+				for (size_t k = k_begin; k < k_end; ++k)
+					if (a.at(int(k)) > value)
+						value = a.at(int(k));
+				return value;
+			},
+			[](T const& x, T const& y) { return y > x ? y : x; }, grain_size);
+	}
+
+	template <typename T> T parallel_min(numarray<T> const& a, size_t grain_size)
+	{
+		assert_cgp(a.size() > 0, "Cannot get min on empty numarray");
+		return parallel_reduce(size_t(a.size()), a.at(0),
+			[&a](size_t k_begin, size_t k_end, T value) {
+				for (size_t k = k_begin; k < k_end; ++k)
+					if (a.at(int(k)) < value)
+						value = a.at(int(k));
+				return value;
+			},
+			[](T const& x, T const& y) { return y < x ? y : x; }, grain_size);
+	}
+
+	template <typename T1, typename T2> bool parallel_is_equal(numarray<T1> const& a, numarray<T2> const& b, size_t grain_size)
+	{
+		if (a.size() != b.size())
+			return false;
+		return parallel_reduce(size_t(a.size()), true,
+			[&a, &b](size_t k_begin, size_t k_end, bool value) {
+				using cgp::is_equal;
+				for (size_t k = k_begin; k < k_end && value; ++k)
+					value = is_equal(a.at(int(k)), b.at(int(k)));
+				return value;
+			},
+			[](bool x, bool y) { return x && y; }, grain_size);
+	}
+}
@@ -0,0 +1,77 @@
+#include "cgp/02_numarray/numarray.hpp"
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	void test_numarray_parallel()
+	{
+		size_t const grain_size = cgp::parallel_default_grain_size();
+		cgp::parallel_set_default_grain_size(64);
+
+		// Loops and reductions match their serial version
+		{
+			int const N = 10001;
+			cgp::numarray<float> a(N);
+			cgp::parallel_for(a, [](float& x, int k) { x = float(k % 7) - 3.0f; });
+			for (int k = 0; k < N; ++k)
+				assert_cgp_no_msg(a[k] == float(k % 7) - 3.0f);
+
+			cgp::numarray<cgp::vec3> b;
+			cgp::parallel_transform(a, b, [](float x) { return cgp::vec3{ x, 2 * x, 1.0f }; });
+			assert_cgp_no_msg(b.size() == N);
+			assert_cgp_no_msg(cgp::is_equal(cgp::parallel_sum(b), cgp::sum(b)));
+			assert_cgp_no_msg(cgp::is_equal(cgp::parallel_sum(a), cgp::sum(a)));
+			assert_cgp_no_msg(cgp::parallel_max(a) == 3.0f && cgp::parallel_min(a) == -3.0f);
+			assert_cgp_no_msg(cgp::parallel_is_equal(a, a));
+
+			cgp::numarray<float> c = a;
+			c[N - 1] += 1.0f;
+			assert_cgp_no_msg(!cgp::parallel_is_equal(a, c));
+
+			size_t count = 0;
+			size_t const reduced = cgp::parallel_reduce(size_t(N), count, [](size_t k0, size_t k1, size_t value) { return value + (k1 - k0); }, [](size_t x, size_t y) { return x + y; });
+			assert_cgp_no_msg(reduced == size_t(N));
+		}
+
+		// Deterministic mode: the result of the reduction doesn't depend on the number of threads
+		{
+			bool const deterministic = cgp::parallel_get_deterministic();
+			cgp::parallel_set_deterministic(true);
+
+			cgp::numarray<float> a(20000);
+			for (int k = 0; k < a.size(); ++k)
+				a[k] = 1.0f / (1.0f + k);
+
+			cgp::parallel_set_number_of_threads(1);
+			float const s1 = cgp::parallel_sum(a);
+			cgp::parallel_set_number_of_threads(4);
+			float const s4 = cgp::parallel_sum(a);
+			assert_cgp_no_msg(s1 == s4);
+
+			cgp::parallel_set_number_of_threads(0);
+			cgp::parallel_set_deterministic(deterministic);
+		}
+
+		// Threads spawned by parallel_for_chunk inside a task of the pool call parallel_for while the pool is busy: they run serially instead of waiting for the pool
+		{
+			cgp::parallel_set_number_of_threads(4);
+			std::vector<int> value(4 * 1000, 0);
+			cgp::parallel_for(4, [&](size_t task) {
+				cgp::parallel_for_chunk(2, 2, [&](size_t k_begin, size_t k_end, int) {
+					for (size_t c = k_begin; c < k_end; ++c)
+						cgp::parallel_for(500, [&](size_t k) { value[1000 * task + 500 * c + k] = 1; }, 1);
+				});
+			}, 1);
+			int sum = 0;
+			for (int v : value)
+				sum += v;
+			assert_cgp_no_msg(sum == 4000);
+			cgp::parallel_set_number_of_threads(0);
+		}
+
+		cgp::parallel_set_default_grain_size(grain_size);
+	}
+}
@@ -0,0 +1,121 @@
+#include "numarray_soa.hpp"
+
+#ifdef CGP_SIMD_X86
+#include <emmintrin.h>
+#endif
+
+namespace cgp
+{
+	namespace numarray_soa_transpose
+	{
+#ifdef CGP_SIMD_X86
+		// Blocks of 4 elements: N loads of 4 interleaved floats are shuffled into N registers holding 4 values of the same component
+		static size_t aos_to_soa_sse2(float* const* component, float const* aos, int N, size_t n)
+		{
+			size_t const n_block = n - n % 4;
+			if (N == 2) {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 const a0 = _mm_loadu_ps(aos + 2 * k);     // x0 y0 x1 y1
+					__m128 const a1 = _mm_loadu_ps(aos + 2 * k + 4); // x2 y2 x3 y3
+					_mm_storeu_ps(component[0] + k, _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+					_mm_storeu_ps(component[1] + k, _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+				}
+			}
+			else if (N == 3) {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 const a0 = _mm_loadu_ps(aos + 3 * k);     // x0 y0 z0 x1
+					__m128 const a1 = _mm_loadu_ps(aos + 3 * k + 4); // y1 z1 x2 y2
+					__m128 const a2 = _mm_loadu_ps(aos + 3 * k + 8); // z2 x3 y3 z3
+					__m128 const t0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+					__m128 const t1 = _mm_shuffle_ps(a1, a2, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+					_mm_storeu_ps(component[0] + k, _mm_shuffle_ps(a0, t1, _MM_SHUFFLE(2, 0, 3, 0)));
+					_mm_storeu_ps(component[1] + k, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 2, 0)));
+					_mm_storeu_ps(component[2] + k, _mm_shuffle_ps(t0, a2, _MM_SHUFFLE(3, 0, 3, 1)));
+				}
+			}
+			else {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 a0 = _mm_loadu_ps(aos + 4 * k);
+					__m128 a1 = _mm_loadu_ps(aos + 4 * k + 4);
+					__m128 a2 = _mm_loadu_ps(aos + 4 * k + 8);
+					__m128 a3 = _mm_loadu_ps(aos + 4 * k + 12);
+					_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+					_mm_storeu_ps(component[0] + k, a0);
+					_mm_storeu_ps(component[1] + k, a1);
+					_mm_storeu_ps(component[2] + k, a2);
+					_mm_storeu_ps(component[3] + k, a3);
+				}
+			}
+			return n_block;
+		}
+
+		static size_t soa_to_aos_sse2(float* aos, float const* const* component, int N, size_t n)
+		{
+			size_t const n_block = n - n % 4;
+			if (N == 2) {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 const x = _mm_loadu_ps(component[0] + k);
+					__m128 const y = _mm_loadu_ps(component[1] + k);
+					_mm_storeu_ps(aos + 2 * k, _mm_unpacklo_ps(x, y));
+					_mm_storeu_ps(aos + 2 * k + 4, _mm_unpackhi_ps(x, y));
+				}
+			}
+			else if (N == 3) {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 const x = _mm_loadu_ps(component[0] + k);
+					__m128 const y = _mm_loadu_ps(component[1] + k);
+					__m128 const z = _mm_loadu_ps(component[2] + k);
+					__m128 const xy_lo = _mm_unpacklo_ps(x, y);                        // x0 y0 x1 y1
+					__m128 const xy_hi = _mm_unpackhi_ps(x, y);                        // x2 y2 x3 y3
+					__m128 const zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));   // z0 z0 x1 x1
+					__m128 const yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));   // y1 y1 z1 z1
+					__m128 const zxy = _mm_shuffle_ps(z, xy_hi, _MM_SHUFFLE(3, 2, 3, 2)); // z2 z3 x3 y3
+					_mm_storeu_ps(aos + 3 * k, _mm_shuffle_ps(xy_lo, zx, _MM_SHUFFLE(2, 0, 1, 0)));     // x0 y0 z0 x1
+					_mm_storeu_ps(aos + 3 * k + 4, _mm_shuffle_ps(yz, xy_hi, _MM_SHUFFLE(1, 0, 2, 0)));  // y1 z1 x2 y2
+					_mm_storeu_ps(aos + 3 * k + 8, _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(1, 3, 2, 0)));   // z2 x3 y3 z3
+				}
+			}
+			else {
+				for (size_t k = 0; k < n_block; k += 4) {
+					__m128 a0 = _mm_loadu_ps(component[0] + k);
+					__m128 a1 = _mm_loadu_ps(component[1] + k);
+					__m128 a2 = _mm_loadu_ps(component[2] + k);
+					__m128 a3 = _mm_loadu_ps(component[3] + k);
+					_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+					_mm_storeu_ps(aos + 4 * k, a0);
+					_mm_storeu_ps(aos + 4 * k + 4, a1);
+					_mm_storeu_ps(aos + 4 * k + 8, a2);
+					_mm_storeu_ps(aos + 4 * k + 12, a3);
+				}
+			}
+			return n_block;
+		}
+#endif
+
+		void aos_to_soa(float* const* component, float const* aos, int N, size_t n)
+		{
+			assert_cgp(N >= 2 && N <= 4, "Transpose to SoA is only defined for 2, 3 or 4 components");
+			size_t k0 = 0;
+#ifdef CGP_SIMD_X86
+			if (numarray_simd_get_instruction_set() != numarray_simd_instruction_set::scalar)
+				k0 = aos_to_soa_sse2(component, aos, N, n);
+#endif
+			for (size_t k = k0; k < n; ++k)
+				for (int c = 0; c < N; ++c)
+					component[c][k] = aos[N * k + c];
+		}
+
+		void soa_to_aos(float* aos, float const* const* component, int N, size_t n)
+		{
+			assert_cgp(N >= 2 && N <= 4, "Transpose to AoS is only defined for 2, 3 or 4 components");
+			size_t k0 = 0;
+#ifdef CGP_SIMD_X86
+			if (numarray_simd_get_instruction_set() != numarray_simd_instruction_set::scalar)
+				k0 = soa_to_aos_sse2(aos, component, N, n);
+#endif
+			for (size_t k = k0; k < n; ++k)
+				for (int c = 0; c < N; ++c)
+					aos[N * k + c] = component[c][k];
+		}
+	}
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "../numarray_stack/numarray_stack.hpp"
+#include "../numarray/numarray.hpp"
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Transpose kernels between interleaved elements (x0 y0 z0 x1 y1 z1 ...) and separated components (x0 x1 ..., y0 y1 ..., z0 z1 ...)
+	* N: number of components (2, 3 or 4), n: number of elements.
+	* Vectorized with SSE2 on x86-64 (unless the numarray kernels are set to scalar with numarray_simd_set_instruction_set). */
+	namespace numarray_soa_transpose
+	{
+		void aos_to_soa(float* const* component, float const* aos, int N, size_t n);
+		void soa_to_aos(float* aos, float const* const* component, int N, size_t n);
+	}
+
+	/** Container of vec2/vec3/vec4 stored as a structure of arrays: one contiguous numarray<float> per component.
+	* Componentwise operations over all the elements (translation, scaling, bounding box) vectorize on each component, while a numarray<vec3> interleaves the components.
+	* The conversion to and from numarray<vec3> (array of structures) uses the transpose kernels, and a numarray_soa can be sent directly to a VBO.
+	*
+	* Ex.
+	*   numarray_soa<vec3> p(mesh.position);   // transpose to SoA
+	*   p += vec3{0,0,dt};                     // run on the components
+	*   p.component[2] *= 0.5f;                // per-component access as numarray<float>
+	*   drawable.vbo_position.update(p);       // streamed back to AoS during the upload
+	*   numarray<vec3> q = p.to_aos();         */
+	template <typename T>
+	struct numarray_soa
+	{
+		static int const N = numarray_simd_components<T>::value;
+		static_assert(N >= 2 && N <= 4, "numarray_soa is defined for vec2, vec3 and vec4");
+
+		/** Components of the elements: component[c][k] is the c-th coordinate of the element k */
+		numarray<float> component[N];
+
+		numarray_soa();
+		explicit numarray_soa(int size);
+		explicit numarray_soa(numarray<T> const& aos);
+		numarray_soa& operator=(numarray<T> const& aos);
+
+		/** Number of elements */
+		int size() const;
+		void resize(int size);
+		void clear();
+
+		/** Read/write an element (gather/scatter over the components) */
+		T operator[](int k) const;
+		void set(int k, T const& value);
+
+		/** Conversion from/to the interleaved (array of structures) layout */
+		void assign(numarray<T> const& aos);
+		numarray<T> to_aos() const;
+		void to_aos(numarray<T>& aos) const;
+		/** Write the elements [index_begin, index_end[ interleaved in aos (aos must have at least index_end-index_begin elements) */
+		void to_aos(T* aos, int index_begin, int index_end) const;
+
+		numarray_soa& operator+=(T const& t);
+		numarray_soa& operator-=(T const& t);
+		numarray_soa& operator*=(float s);
+		/** Scale each component independently */
+		numarray_soa& operator*=(T const& s);
+	};
+
+	template <typename T> std::string type_str(numarray_soa<T> const&);
+	template <typename T> size_t size_in_memory(numarray_soa<T> const& a);
+
+	/** Componentwise sum, min and max of the elements (min/max give the corners of the bounding box) */
+	template <typename T> T sum(numarray_soa<T> const& a);
+	template <typename T> T min(numarray_soa<T> const& a);
+	template <typename T> T max(numarray_soa<T> const& a);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	template <typename T> numarray_soa<T>::numarray_soa()
+	{}
+
+	template <typename T> numarray_soa<T>::numarray_soa(int size)
+	{
+		resize(size);
+	}
+
+	template <typename T> numarray_soa<T>::numarray_soa(numarray<T> const& aos)
+	{
+		assign(aos);
+	}
+
+	template <typename T> numarray_soa<T>& numarray_soa<T>::operator=(numarray<T> const& aos)
+	{
+		assign(aos);
+		return *this;
+	}
+
+	template <typename T> int numarray_soa<T>::size() const
+	{
+		return component[0].size();
+	}
+
+	template <typename T> void numarray_soa<T>::resize(int size)
+	{
+		for (int c = 0; c < N; ++c)
+			component[c].resize(size);
+	}
+
+	template <typename T> void numarray_soa<T>::clear()
+	{
+		for (int c = 0; c < N; ++c)
+			component[c].clear();
+	}
+
+	template <typename T> T numarray_soa<T>::operator[](int k) const
+	{
+		assert_cgp(k >= 0 && k < size(), "Try to access numarray_soa at index " + str(k) + " with numarray_soa of size " + str(size()));
+		T value;
+		for (int c = 0; c < N; ++c)
+			value[c] = component[c].at(k);
+		return value;
+	}
+
+	template <typename T> void numarray_soa<T>::set(int k, T const& value)
+	{
+		assert_cgp(k >= 0 && k < size(), "Try to access numarray_soa at index " + str(k) + " with numarray_soa of size " + str(size()));
+		for (int c = 0; c < N; ++c)
+			component[c].at(k) = value[c];
+	}
+
+	template <typename T> void numarray_soa<T>::assign(numarray<T> const& aos)
+	{
+		resize(aos.size());
+		if (aos.size() == 0)
+			return;
+
+		float* c_ptr[N];
+		for (int c = 0; c < N; ++c)
+			c_ptr[c] = component[c].data.data();
+		numarray_soa_transpose::aos_to_soa(c_ptr, reinterpret_cast<float const*>(aos.data.data()), N, size_t(aos.size()));
+	}
+
+	template <typename T> numarray<T> numarray_soa<T>::to_aos() const
+	{
+		numarray<T> aos;
+		to_aos(aos);
+		return aos;
+	}
+
+	template <typename T> void numarray_soa<T>::to_aos(numarray<T>& aos) const
+	{
+		aos.resize(size());
+		if (size() > 0)
+			to_aos(aos.data.data(), 0, size());
+	}
+
+	template <typename T> void numarray_soa<T>::to_aos(T* aos, int index_begin, int index_end) const
+	{
+		assert_cgp(index_begin >= 0 && index_begin <= index_end && index_end <= size(), "Incorrect range [" + str(index_begin) + "," + str(index_end) + "[ for numarray_soa of size " + str(size()));
+
+		float const* c_ptr[N];
+		for (int c = 0; c < N; ++c)
+			c_ptr[c] = component[c].data.data() + index_begin;
+		numarray_soa_transpose::soa_to_aos(reinterpret_cast<float*>(aos), c_ptr, N, size_t(index_end - index_begin));
+	}
+
+	template <typename T> numarray_soa<T>& numarray_soa<T>::operator+=(T const& t)
+	{
+		int const n = size();
+		for (int c = 0; c < N; ++c) {
+			float* p = component[c].data.data();
+			float const tc = t[c];
+			for (int k = 0; k < n; ++k)
+				p[k] += tc;
+		}
+		return *this;
+	}
+
+	template <typename T> numarray_soa<T>& numarray_soa<T>::operator-=(T const& t)
+	{
+		return *this += -t;
+	}
+
+	template <typename T> numarray_soa<T>& numarray_soa<T>::operator*=(float s)
+	{
+		for (int c = 0; c < N; ++c)
+			component[c] *= s;
+		return *this;
+	}
+
+	template <typename T> numarray_soa<T>& numarray_soa<T>::operator*=(T const& s)
+	{
+		for (int c = 0; c < N; ++c)
+			component[c] *= s[c];
+		return *this;
+	}
+
+	template <typename T> std::string type_str(numarray_soa<T> const&)
+	{
+		return "numarray_soa<" + type_str(T()) + ">";
+	}
+
+	template <typename T> size_t size_in_memory(numarray_soa<T> const& a)
+	{
+		return size_t(a.size()) * sizeof(T);
+	}
+
+	template <typename T> T sum(numarray_soa<T> const& a)
+	{
+		T value;
+		for (int c = 0; c < numarray_soa<T>::N; ++c)
+			value[c] = sum(a.component[c]);
+		return value;
+	}
+
+	template <typename T> T min(numarray_soa<T> const& a)
+	{
+		T value;
+		for (int c = 0; c < numarray_soa<T>::N; ++c)
+			value[c] = min(a.component[c]);
+		return value;
+	}
+
+	template <typename T> T max(numarray_soa<T> const& a)
+	{
+		T value;
+		for (int c = 0; c < numarray_soa<T>::N; ++c)
+			value[c] = max(a.component[c]);
+		return value;
+	}
+}
@@ -0,0 +1,55 @@
+#include "cgp/02_numarray/numarray.hpp"
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+
+	void test_numarray_soa()
+	{
+		{
+			cgp::numarray<cgp::vec3> const a = { {1,2,3}, {4,5,6} };
+			cgp::numarray_soa<cgp::vec3> b(a);
+			assert_cgp_no_msg(b.size() == 2);
+			assert_cgp_no_msg(is_equal(b.component[0], { 1.0f, 4.0f }));
+			assert_cgp_no_msg(is_equal(b.component[2], { 3.0f, 6.0f }));
+			assert_cgp_no_msg(is_equal(b[1], cgp::vec3{ 4,5,6 }));
+
+			b.set(0, { -1,-2,-3 });
+			b += cgp::vec3{ 1,1,1 };
+			b *= cgp::vec3{ 1,2,3 };
+			assert_cgp_no_msg(is_equal(b.to_aos(), cgp::numarray<cgp::vec3>{ {0,-2,-6}, {5,12,21} }));
+			assert_cgp_no_msg(is_equal(min(b), cgp::vec3{ 0,-2,-6 }));
+			assert_cgp_no_msg(is_equal(max(b), cgp::vec3{ 5,12,21 }));
+			assert_cgp_no_msg(is_equal(sum(b), cgp::vec3{ 5,10,15 }));
+		}
+
+		// Transpose of vec2/vec3/vec4 with sizes that are not multiple of the vectorized blocks: exact round trip
+		{
+			for (int N : { 1, 4, 7, 33 }) {
+				cgp::numarray<cgp::vec2> a2(N);
+				cgp::numarray<cgp::vec3> a3(N);
+				cgp::numarray<cgp::vec4> a4(N);
+				for (int k = 0; k < N; ++k) {
+					float const f = float(k);
+					a2[k] = { f, -f };
+					a3[k] = { f, -f, 0.5f * f };
+					a4[k] = { f, -f, 0.5f * f, 2.0f * f };
+				}
+				cgp::numarray_soa<cgp::vec2> const b2(a2);
+				cgp::numarray_soa<cgp::vec3> const b3(a3);
+				cgp::numarray_soa<cgp::vec4> const b4(a4);
+				for (int k = 0; k < N; ++k) {
+					assert_cgp_no_msg(b2.component[1][k] == -float(k));
+					assert_cgp_no_msg(b3.component[2][k] == 0.5f * float(k));
+					assert_cgp_no_msg(b4.component[3][k] == 2.0f * float(k));
+				}
+				assert_cgp_no_msg(is_equal(b2.to_aos(), a2));
+				assert_cgp_no_msg(is_equal(b3.to_aos(), a3));
+				assert_cgp_no_msg(is_equal(b4.to_aos(), a4));
+			}
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "../numarray/numarray.hpp"
+
+#include <type_traits>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Non-owning view on a sequence of elements stored in memory: pointer to the first element, number of elements, and stride (distance between two successive elements, counted in elements).
+	* A view doesn't allocate nor copy the data: it can be built from a numarray, a std::vector, a C array or a pointer, and must not outlive the buffer it refers to.
+	* numarray_view<T const> is the read-only version, accepted by the functions that only read their input (ex. VBO update, normal_per_vertex). A numarray or std::vector passed to these functions converts implicitly.
+	*
+	* Ex.
+	*   vec3 const segment[2] = { a, b };
+	*   vbo.update(segment);                                                 // no temporary numarray
+	*   vbo.update_sub_data(numarray_view<vec3 const>(p, 100), 500);         // write the 100 elements pointed by p at the index 500 of the VBO
+	*   numarray_view<vec3> v = numarray_view<vec3>(position).slice(10, 20); // elements 10 to 19 of position
+	*   numarray_view<float const> x(&position[0].x, position.size(), 3);    // x coordinates of position (strided view) */
+	template <typename T>
+	struct numarray_view
+	{
+		typedef typename std::remove_const<T>::type value_type;
+
+		/** Pointer to the first element, number of elements, distance between two successive elements (1: contiguous) */
+		T* data = nullptr;
+		int count = 0;
+		int stride = 1;
+
+		numarray_view();
+		numarray_view(T* data, int count, int stride = 1);
+		template <size_t M> numarray_view(T(&array)[M]);
+		template <typename Alloc> numarray_view(std::vector<value_type, Alloc>& v);
+		template <typename Alloc> numarray_view(std::vector<value_type, Alloc> const& v);
+		numarray_view(numarray<value_type>& a);
+		numarray_view(numarray<value_type> const& a);
+		/** Conversion from a view on non-const elements to a read-only view */
+		numarray_view(numarray_view<value_type> const& v);
+
+		/** Number of elements */
+		int size() const;
+		/** True if the elements are contiguous in memory (stride 1) */
+		bool is_contiguous() const;
+
+		/** Element access with bound check */
+		T& operator[](int index) const;
+		T& operator()(int index) const;
+		/** Element access without bound check */
+		T& at(int index) const;
+
+		/** View on the elements [index_begin, index_end[ */
+		numarray_view slice(int index_begin, int index_end) const;
+
+		/** Iterators over the elements (following the stride) */
+		struct iterator
+		{
+			T* p;
+			int stride;
+			T& operator*() const { return *p; }
+			iterator& operator++() { p += stride; return *this; }
+			bool operator!=(iterator const& it) const { return p != it.p; }
+			bool operator==(iterator const& it) const { return p == it.p; }
+		};
+		iterator begin() const;
+		iterator end() const;
+	};
+
+	template <typename T> std::string type_str(numarray_view<T> const&);
+	/** Size in memory of the elements seen by the view (not counting the gaps of a strided view) */
+	template <typename T> size_t size_in_memory(numarray_view<T> const& v);
+	/** Pointer to the first element */
+	template <typename T> T* ptr(numarray_view<T> const& v);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	template <typename T> numarray_view<T>::numarray_view()
+	{}
+
+	template <typename T> numarray_view<T>::numarray_view(T* data_arg, int count_arg, int stride_arg)
+		:data(data_arg), count(count_arg), stride(stride_arg)
+	{
+		assert_cgp(count >= 0, "Negative number of elements in numarray_view");
+		assert_cgp(stride >= 1, "The stride of numarray_view must be at least 1");
+	}
+
+	template <typename T> template <size_t M> numarray_view<T>::numarray_view(T(&array)[M])
+		:data(array), count(int(M)), stride(1)
+	{}
+
+	template <typename T> template <typename Alloc> numarray_view<T>::numarray_view(std::vector<value_type, Alloc>& v)
+		:data(v.data()), count(int(v.size())), stride(1)
+	{}
+
+	template <typename T> template <typename Alloc> numarray_view<T>::numarray_view(std::vector<value_type, Alloc> const& v)
+		:data(v.data()), count(int(v.size())), stride(1)
+	{}
+
+	template <typename T> numarray_view<T>::numarray_view(numarray<value_type>& a)
+		:data(a.data.data()), count(a.size()), stride(1)
+	{}
+
+	template <typename T> numarray_view<T>::numarray_view(numarray<value_type> const& a)
+		:data(a.data.data()), count(a.size()), stride(1)
+	{}
+
+	template <typename T> numarray_view<T>::numarray_view(numarray_view<value_type> const& v)
+		:data(v.data), count(v.count), stride(v.stride)
+	{}
+
+	template <typename T> int numarray_view<T>::size() const
+	{
+		return count;
+	}
+
+	template <typename T> bool numarray_view<T>::is_contiguous() const
+	{
+		return stride == 1;
+	}
+
+	template <typename T> T& numarray_view<T>::operator[](int index) const
+	{
+		assert_cgp(index >= 0 && index < count, "Try to access numarray_view at index " + str(index) + " with numarray_view of size " + str(count));
+		return data[size_t(index) * stride];
+	}
+
+	template <typename T> T& numarray_view<T>::operator()(int index) const
+	{
+		return (*this)[index];
+	}
+
+	template <typename T> T& numarray_view<T>::at(int index) const
+	{
+		return data[size_t(index) * stride];
+	}
+
+	template <typename T> numarray_view<T> numarray_view<T>::slice(int index_begin, int index_end) const
+	{
+		assert_cgp(index_begin >= 0 && index_begin <= index_end && index_end <= count, "Incorrect range [" + str(index_begin) + "," + str(index_end) + "[ for numarray_view of size " + str(count));
+		return numarray_view<T>(data + size_t(index_begin) * stride, index_end - index_begin, stride);
+	}
+
+	template <typename T> typename numarray_view<T>::iterator numarray_view<T>::begin() const
+	{
+		return iterator{ data, stride };
+	}
+
+	template <typename T> typename numarray_view<T>::iterator numarray_view<T>::end() const
+	{
+		return iterator{ data + size_t(count) * stride, stride };
+	}
+
+	template <typename T> std::string type_str(numarray_view<T> const&)
+	{
+		return "numarray_view<" + type_str(typename numarray_view<T>::value_type()) + ">";
+	}
+
+	template <typename T> size_t size_in_memory(numarray_view<T> const& v)
+	{
+		return size_t(v.size()) * sizeof(T);
+	}
+
+	template <typename T> T* ptr(numarray_view<T> const& v)
+	{
+		return v.data;
+	}
+}
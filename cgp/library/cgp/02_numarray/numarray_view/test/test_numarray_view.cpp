@@ -0,0 +1,47 @@
+#include "cgp/02_numarray/numarray.hpp"
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	static float sum_view(cgp::numarray_view<float const> v)
+	{
+		float s = 0.0f;
+		for (float x : v)
+			s += x;
+		return s;
+	}
+
+	void test_numarray_view()
+	{
+		// Implicit conversion from numarray, std::vector and C array, without copy
+		{
+			cgp::numarray<float> a = { 1.0f, 2.0f, 3.0f, 4.0f };
+			std::vector<float> b = { 5.0f, 6.0f };
+			float const c[3] = { 1.0f, 1.0f, 1.0f };
+			assert_cgp_no_msg(cgp::is_equal(sum_view(a), 10.0f));
+			assert_cgp_no_msg(cgp::is_equal(sum_view(b), 11.0f));
+			assert_cgp_no_msg(cgp::is_equal(sum_view(c), 3.0f));
+
+			cgp::numarray_view<float> v = a;
+			assert_cgp_no_msg(v.data == a.data.data() && v.size() == 4);
+			v[1] = -2.0f;
+			assert_cgp_no_msg(cgp::is_equal(a[1], -2.0f));
+		}
+
+		// Slice and strided view
+		{
+			cgp::numarray<cgp::vec3> p = { {1,2,3}, {4,5,6}, {7,8,9} };
+			cgp::numarray_view<cgp::vec3 const> s = cgp::numarray_view<cgp::vec3 const>(p).slice(1, 3);
+			assert_cgp_no_msg(s.size() == 2 && cgp::is_equal(s[0], cgp::vec3{ 4,5,6 }));
+
+			cgp::numarray_view<float const> y(&p[0].y, p.size(), 3);
+			assert_cgp_no_msg(!y.is_contiguous());
+			assert_cgp_no_msg(cgp::is_equal(y[2], 8.0f));
+			assert_cgp_no_msg(cgp::is_equal(sum_view(y), 15.0f));
+			assert_cgp_no_msg(cgp::is_equal(sum_view(y.slice(1, 2)), 5.0f));
+		}
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+
+namespace cgp_test
+{
+	void test_numarray_view();
+}
+
@@ -0,0 +1,163 @@
+#include "file_map.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../files.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#define CGP_FILE_MAP_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cgp
+{
+	file_map::file_map()
+	{}
+
+	file_map::file_map(std::string const& filename)
+	{
+		open(filename);
+	}
+
+	file_map::~file_map()
+	{
+		close();
+	}
+
+	file_map::file_map(file_map&& other)
+	{
+		swap(other);
+	}
+
+	file_map& file_map::operator=(file_map&& other)
+	{
+		if (this != &other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	void file_map::swap(file_map& other)
+	{
+		std::swap(data_ptr, other.data_ptr);
+		std::swap(data_size, other.data_size);
+		std::swap(opened, other.opened);
+		std::swap(buffer, other.buffer);
+		std::swap(mapped, other.mapped);
+		std::swap(handle_file, other.handle_file);
+		std::swap(handle_mapping, other.handle_mapping);
+	}
+
+	void file_map::open(std::string const& filename)
+	{
+		close();
+		assert_file_exist(filename);
+
+#if defined(_WIN32)
+		HANDLE const file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file != INVALID_HANDLE_VALUE) {
+			LARGE_INTEGER file_size;
+			if (GetFileSizeEx(file, &file_size) && file_size.QuadPart == 0) {
+				CloseHandle(file);
+				opened = true;
+				return;
+			}
+			HANDLE const mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping != NULL) {
+				void* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (view != NULL) {
+					mapped = view;
+					handle_file = file;
+					handle_mapping = mapping;
+					data_ptr = static_cast<char const*>(view);
+					data_size = size_t(file_size.QuadPart);
+					opened = true;
+					return;
+				}
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+		}
+#elif defined(CGP_FILE_MAP_POSIX)
+		int const fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd >= 0) {
+			struct stat file_stat;
+			if (fstat(fd, &file_stat) == 0) {
+				size_t const file_size = size_t(file_stat.st_size);
+				if (file_size == 0) {
+					::close(fd);
+					opened = true;
+					return;
+				}
+				void* const view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (view != MAP_FAILED) {
+					madvise(view, file_size, MADV_SEQUENTIAL);
+					::close(fd); // the mapping remains valid after closing the descriptor
+					mapped = view;
+					data_ptr = static_cast<char const*>(view);
+					data_size = file_size;
+					opened = true;
+					return;
+				}
+			}
+			::close(fd);
+		}
+#endif
+
+		// Fallback: read the entire file
+		if (file_get_size(filename) > 0)
+			buffer = read_from_file_binary(filename);
+		data_ptr = buffer.data();
+		data_size = buffer.size();
+		opened = true;
+	}
+
+	void file_map::close()
+	{
+		if (mapped != nullptr) {
+#if defined(_WIN32)
+			UnmapViewOfFile(mapped);
+			CloseHandle(static_cast<HANDLE>(handle_mapping));
+			CloseHandle(static_cast<HANDLE>(handle_file));
+#elif defined(CGP_FILE_MAP_POSIX)
+			munmap(mapped, data_size);
+#endif
+		}
+		mapped = nullptr;
+		handle_file = nullptr;
+		handle_mapping = nullptr;
+		buffer.clear();
+		buffer.shrink_to_fit();
+		data_ptr = nullptr;
+		data_size = 0;
+		opened = false;
+	}
+
+	bool file_map::is_open() const
+	{
+		return opened;
+	}
+
+	char const* file_map::data() const
+	{
+		return data_ptr;
+	}
+
+	size_t file_map::size() const
+	{
+		return data_size;
+	}
+}
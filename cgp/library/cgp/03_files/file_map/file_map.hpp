@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cgp
+{
+	/** Read-only access to the content of a file mapped in memory.
+	* The pages of the file are loaded by the system when they are accessed: no copy in a user buffer, and no stream/locale processing.
+	* When memory mapping is not available (Emscripten) or fails, the file is read into an internal buffer instead.
+	* The content is not null-terminated, and remains valid until the file_map is closed or destroyed.
+	*
+	* Ex.
+	*   file_map file("mesh.obj");
+	*   for (size_t k = 0; k < file.size(); ++k)
+	*     ... file.data()[k] ... */
+	struct file_map
+	{
+		file_map();
+		explicit file_map(std::string const& filename);
+		~file_map();
+
+		file_map(file_map const&) = delete;
+		file_map& operator=(file_map const&) = delete;
+		file_map(file_map&& other);
+		file_map& operator=(file_map&& other);
+
+		/** Map the file (stops with an error message if the file cannot be accessed) */
+		void open(std::string const& filename);
+		void close();
+		bool is_open() const;
+
+		/** Pointer to the first byte of the file and number of bytes */
+		char const* data() const;
+		size_t size() const;
+
+	private:
+		char const* data_ptr = nullptr;
+		size_t data_size = 0;
+		bool opened = false;
+		/** Content of the file when it is not mapped */
+		std::vector<char> buffer;
+		/** Platform handles of the mapping (mapped pointer, file descriptor / file and mapping handles) */
+		void* mapped = nullptr;
+		void* handle_file = nullptr;
+		void* handle_mapping = nullptr;
+
+		void swap(file_map& other);
+	};
+}
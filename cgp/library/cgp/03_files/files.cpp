@@ -74,6 +74,16 @@ namespace cgp
         return stat_buf.st_size;
     }
 
+    int64_t file_get_modification_time(std::string const& filename)
+    {
+        assert_file_exist(filename);
+        struct stat stat_buf;
+        int rc = stat(filename.c_str(), &stat_buf);
+        assert_cgp(rc==0, "Cannot stat modification time " + filename);
+
+        return int64_t(stat_buf.st_mtime);
+    }
+
     
     std::vector <char> read_from_file_binary(std::string const& filename)
     {
@@ -2,8 +2,10 @@
 
 
 #include "cgp/02_numarray/numarray.hpp"
+#include "file_map/file_map.hpp"
 
 #include <string>
+#include <cstdint>
 #include <sstream>
 #include <fstream>
 
@@ -22,6 +24,9 @@ namespace cgp
 	/** Return the size in octets of a file*/
 	size_t file_get_size(std::string const& filename);
 
+	/** Return the time of the last modification of a file (in seconds since 1970) */
+	int64_t file_get_modification_time(std::string const& filename);
+
 	/** Read the entire content of a file as binary vector of octets*/
 	std::vector <char> read_from_file_binary(std::string const& filename);
 
@@ -68,12 +68,12 @@ struct grid_2D
     /** Iterators
      * 1D-type iterators on grid_2D are compatible with STL syntax
      * allows "forall" loops (for(auto& e : buffer) {...}) */
-    typename std::vector<T>::iterator begin();
-    typename std::vector<T>::iterator end();
-    typename std::vector<T>::const_iterator begin() const;
-    typename std::vector<T>::const_iterator end() const;
-    typename std::vector<T>::const_iterator cbegin() const;
-    typename std::vector<T>::const_iterator cend() const;
+    typename numarray<T>::container_type::iterator begin();
+    typename numarray<T>::container_type::iterator end();
+    typename numarray<T>::container_type::const_iterator begin() const;
+    typename numarray<T>::container_type::const_iterator end() const;
+    typename numarray<T>::container_type::const_iterator cbegin() const;
+    typename numarray<T>::container_type::const_iterator cend() const;
 
     /** Direct access to the value - doesn't check index bounds*/
     inline T const& at(int index) const { return data.at(index); }
@@ -307,37 +307,37 @@ T& grid_2D<T>::operator()(int k1, int k2)
 
 
 template <typename T>
-typename std::vector<T>::iterator grid_2D<T>::begin()
+typename numarray<T>::container_type::iterator grid_2D<T>::begin()
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::iterator grid_2D<T>::end()
+typename numarray<T>::container_type::iterator grid_2D<T>::end()
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::begin() const
+typename numarray<T>::container_type::const_iterator grid_2D<T>::begin() const
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::end() const
+typename numarray<T>::container_type::const_iterator grid_2D<T>::end() const
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::cbegin() const
+typename numarray<T>::container_type::const_iterator grid_2D<T>::cbegin() const
 {
     return data.cbegin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::cend() const
+typename numarray<T>::container_type::const_iterator grid_2D<T>::cend() const
 {
     return data.cend();
 }
@@ -3,6 +3,7 @@
 #include "cgp/01_base/base.hpp"
 #include "cgp/02_numarray/numarray.hpp"
 #include "../../offset_grid/offset_grid.hpp"
+#include "grid_block_3D.hpp"
 
 
 /* ************************************************** */
@@ -61,12 +62,16 @@ struct grid_3D
     int index_to_offset(int3 const& index) const;
     int3 offset_to_index(int offset) const;
 
-    typename std::vector<T>::iterator begin();
-    typename std::vector<T>::iterator end();
-    typename std::vector<T>::const_iterator begin() const;
-    typename std::vector<T>::const_iterator end() const;
-    typename std::vector<T>::const_iterator cbegin() const;
-    typename std::vector<T>::const_iterator cend() const;
+    /** Blocks of elements covering the grid (by default complete lines along k1), to traverse the grid block per block (ex. blocks of 8x8x8 elements for stencils) */
+    grid_block_range_3D blocks() const;
+    grid_block_range_3D blocks(int3 const& block_size) const;
+
+    typename numarray<T>::container_type::iterator begin();
+    typename numarray<T>::container_type::iterator end();
+    typename numarray<T>::container_type::const_iterator begin() const;
+    typename numarray<T>::container_type::const_iterator end() const;
+    typename numarray<T>::container_type::const_iterator cbegin() const;
+    typename numarray<T>::container_type::const_iterator cend() const;
 
     T const& at_unsafe(int index) const;
     T & at_unsafe(int index);           
@@ -280,37 +285,37 @@ template <typename T> T& grid_3D<T>::operator()(int k1, int k2, int k3)
 
 
 template <typename T>
-typename std::vector<T>::iterator grid_3D<T>::begin()
+typename numarray<T>::container_type::iterator grid_3D<T>::begin()
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::iterator grid_3D<T>::end()
+typename numarray<T>::container_type::iterator grid_3D<T>::end()
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::begin() const
+typename numarray<T>::container_type::const_iterator grid_3D<T>::begin() const
 {
     return data.begin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::end() const
+typename numarray<T>::container_type::const_iterator grid_3D<T>::end() const
 {
     return data.end();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::cbegin() const
+typename numarray<T>::container_type::const_iterator grid_3D<T>::cbegin() const
 {
     return data.cbegin();
 }
 
 template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::cend() const
+typename numarray<T>::container_type::const_iterator grid_3D<T>::cend() const
 {
     return data.cend();
 }
@@ -331,6 +336,17 @@ int3 grid_3D<T>::offset_to_index(int offset) const
     return index_grid_from_offset(offset, dimension.x, dimension.y);
 }
 
+template <typename T>
+grid_block_range_3D grid_3D<T>::blocks() const
+{
+    return grid_block_range_3D(dimension, { dimension.x > 0 ? dimension.x : 1, 1, 1 });
+}
+template <typename T>
+grid_block_range_3D grid_3D<T>::blocks(int3 const& block_size) const
+{
+    return grid_block_range_3D(dimension, block_size);
+}
+
 
 
 
@@ -365,6 +381,7 @@ template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, grid_3D<T> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data += b.data;
+    return a;
 }
 template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, T const& b)
 {
@@ -0,0 +1,39 @@
+#include "grid_block_3D.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	grid_block_range_3D::grid_block_range_3D(int3 const& dimension_arg, int3 const& block_size_arg)
+		:dimension(dimension_arg), block_size(block_size_arg)
+	{
+		assert_cgp(block_size.x > 0 && block_size.y > 0 && block_size.z > 0, "Incorrect block size " + str(block_size));
+		for (int d = 0; d < 3; ++d)
+			number_of_blocks[d] = (dimension[d] + block_size[d] - 1) / block_size[d];
+	}
+
+	int grid_block_range_3D::size() const
+	{
+		return number_of_blocks.x * number_of_blocks.y * number_of_blocks.z;
+	}
+
+	grid_block_3D grid_block_range_3D::operator[](int k) const
+	{
+		int3 const b = { k % number_of_blocks.x, (k / number_of_blocks.x) % number_of_blocks.y, k / (number_of_blocks.x * number_of_blocks.y) };
+		grid_block_3D block;
+		for (int d = 0; d < 3; ++d) {
+			block.index_begin[d] = b[d] * block_size[d];
+			block.index_end[d] = std::min(block.index_begin[d] + block_size[d], dimension[d]);
+		}
+		return block;
+	}
+
+	grid_block_range_3D::iterator grid_block_range_3D::begin() const
+	{
+		return iterator{ this, 0 };
+	}
+	grid_block_range_3D::iterator grid_block_range_3D::end() const
+	{
+		return iterator{ this, size() };
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray_stack/numarray_stack.hpp"
+
+namespace cgp
+{
+	/** Block of elements of a grid_3D, indices in [index_begin, index_end[ */
+	struct grid_block_3D
+	{
+		int3 index_begin;
+		int3 index_end;
+	};
+
+	/** Blocks of a given size covering a grid of a given dimension (the blocks at the boundary can be smaller).
+	* Blocks are ordered with the first direction varying fastest.
+	* Ex.
+	*   for (grid_block_3D const& block : grid.blocks())
+	*     for (int k3 = block.index_begin.z; k3 < block.index_end.z; ++k3)
+	*       for (int k2 = block.index_begin.y; k2 < block.index_end.y; ++k2)
+	*         for (int k1 = block.index_begin.x; k1 < block.index_end.x; ++k1)
+	*           grid(k1,k2,k3) = ... */
+	struct grid_block_range_3D
+	{
+		int3 dimension;
+		int3 block_size;
+		int3 number_of_blocks;
+
+		grid_block_range_3D(int3 const& dimension, int3 const& block_size);
+
+		/** Number of blocks */
+		int size() const;
+		grid_block_3D operator[](int k) const;
+
+		struct iterator
+		{
+			grid_block_range_3D const* range;
+			int k;
+			grid_block_3D operator*() const { return (*range)[k]; }
+			iterator& operator++() { ++k; return *this; }
+			bool operator!=(iterator const& it) const { return k != it.k; }
+			bool operator==(iterator const& it) const { return k == it.k; }
+		};
+		iterator begin() const;
+		iterator end() const;
+	};
+}
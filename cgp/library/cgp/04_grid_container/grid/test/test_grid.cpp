@@ -1,5 +1,6 @@
 #include "cgp/01_base/base.hpp"
 #include "../grid.hpp"
+#include "../../grid_parallel/grid_parallel.hpp"
 
 
 #include <iostream>
@@ -90,6 +91,63 @@ namespace cgp_test {
 			assert_cgp_no_msg(type_str(a) == "grid_3D<int>");
 		}
 
+		// parallel_for gives the index of each element
+		{
+			cgp::grid_3D<cgp::int3> a(17, 9, 5);
+			cgp::parallel_for(a, [](cgp::int3& value, int kx, int ky, int kz) { value = { kx, ky, kz }; }, 1);
+			bool valid = true;
+			for (int kx = 0; kx < 17; ++kx)
+				for (int ky = 0; ky < 9; ++ky)
+					for (int kz = 0; kz < 5; ++kz)
+						valid = valid && is_equal(a(kx, ky, kz), cgp::int3{ kx, ky, kz });
+			assert_cgp_no_msg(valid);
+		}
+
+		// Blocks of elements: complete lines along k1 by default, or boxes clamped at the border of the grid
+		{
+			cgp::grid_3D<int> a(11, 6, 9);
+			bool valid = true;
+			for (int kx = 0; kx < 11; ++kx)
+				for (int ky = 0; ky < 6; ++ky)
+					for (int kz = 0; kz < 9; ++kz)
+						valid = valid && is_equal(a.offset_to_index(a.index_to_offset(kx, ky, kz)), cgp::int3{ kx, ky, kz });
+			assert_cgp_no_msg(valid);
+
+			assert_cgp_no_msg(a.blocks().size() == 6 * 9);
+			assert_cgp_no_msg(is_equal(a.blocks()[0].index_end, cgp::int3{ 11, 1, 1 }));
+
+			int count = 0;
+			for (cgp::grid_block_3D const& block : a.blocks({ 4,4,4 })) {
+				cgp::int3 const s = block.index_end - block.index_begin;
+				for (int kz = block.index_begin.z; kz < block.index_end.z; ++kz)
+					for (int ky = block.index_begin.y; ky < block.index_end.y; ++ky)
+						for (int kx = block.index_begin.x; kx < block.index_end.x; ++kx)
+							a(kx, ky, kz) += 1;
+				count += s.x * s.y * s.z;
+			}
+			assert_cgp_no_msg(count == a.size() && a.blocks({ 4,4,4 }).size() == 3 * 2 * 3);
+			for (int k = 0; k < a.size(); ++k)
+				valid = valid && a.at_unsafe(k) == 1;
+			assert_cgp_no_msg(valid);
+		}
+
+		// Range-for over the elements (the container of a grid<float> is aligned with CGP_NUMARRAY_ALIGNED)
+		{
+			cgp::grid_3D<float> a(3, 4, 5);
+			for (float& value : a)
+				value = 2.0f;
+			float sum = 0.0f;
+			for (float const value : static_cast<cgp::grid_3D<float> const&>(a))
+				sum += value;
+
+			cgp::grid_2D<float> b(3, 4);
+			for (float& value : b)
+				value = 1.0f;
+			for (auto it = b.cbegin(); it != b.cend(); ++it)
+				sum += *it;
+			assert_cgp_no_msg(sum == 2.0f * 60 + 12);
+		}
+
 	}
 
 }
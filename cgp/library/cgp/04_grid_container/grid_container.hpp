@@ -11,5 +11,6 @@
 #include "offset_grid/offset_grid.hpp"
 #include "grid_stack/grid_stack.hpp"
 #include "grid/grid.hpp"
+#include "grid_parallel/grid_parallel.hpp"
 #include "matrix_stack/matrix_stack.hpp"
 
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray.hpp"
+#include "../grid/grid.hpp"
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Parallel loops over the elements of a grid_2D/grid_3D (see cgp/01_base/parallel/parallel.hpp).
+	* The grid is split along its lines (elements with consecutive k1 are contiguous in memory): each chunk covers complete lines, and contains at least grain_size elements.
+	* The reductions and transform work on the underlying numarray (see numarray_parallel.hpp).
+	*
+	* Ex.
+	*   parallel_for(field, [&](float& value, int kx, int ky, int kz) { value = f(vec3{kx,ky,kz}*h); });
+	*   float const total = parallel_sum(field); */
+
+	/** Call f(grid(k1,k2), k1, k2) for all the elements */
+	template <typename T, typename F> void parallel_for(grid_2D<T>& grid, F const& f, size_t grain_size = 0);
+	/** Call f(grid(k1,k2,k3), k1, k2, k3) for all the elements */
+	template <typename T, typename F> void parallel_for(grid_3D<T>& grid, F const& f, size_t grain_size = 0);
+
+	/** result(index) = f(grid(index)) (result is resized to the dimension of grid) */
+	template <typename T, typename U, typename F> void parallel_transform(grid_2D<T> const& grid, grid_2D<U>& result, F const& f, size_t grain_size = 0);
+	template <typename T, typename U, typename F> void parallel_transform(grid_3D<T> const& grid, grid_3D<U>& result, F const& f, size_t grain_size = 0);
+
+	template <typename T> T parallel_sum(grid_2D<T> const& grid, size_t grain_size = 0);
+	template <typename T> T parallel_sum(grid_3D<T> const& grid, size_t grain_size = 0);
+	template <typename T> T parallel_max(grid_2D<T> const& grid, size_t grain_size = 0);
+	template <typename T> T parallel_max(grid_3D<T> const& grid, size_t grain_size = 0);
+	template <typename T> T parallel_min(grid_2D<T> const& grid, size_t grain_size = 0);
+	template <typename T> T parallel_min(grid_3D<T> const& grid, size_t grain_size = 0);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	namespace detail
+	{
+		// Number of lines of N1 elements per chunk holding at least grain_size elements
+		inline size_t grid_line_grain_size(int N1, size_t grain_size)
+		{
+			size_t const grain = grain_size > 0 ? grain_size : parallel_default_grain_size();
+			size_t const line = N1 > 0 ? size_t(N1) : 1;
+			return (grain + line - 1) / line;
+		}
+	}
+
+	template <typename T, typename F> void parallel_for(grid_2D<T>& grid, F const& f, size_t grain_size)
+	{
+		int const N1 = grid.dimension.x;
+		int const N2 = grid.dimension.y;
+		parallel_for_range(size_t(N2), [&](size_t k2_begin, size_t k2_end) {
+			for (int k2 = int(k2_begin); k2 < int(k2_end); ++k2) {
+				T* line = grid.data.data.data() + size_t(k2) * N1;
+				for (int k1 = 0; k1 < N1; ++k1)
+					f(line[k1], k1, k2);
+			}
+		}, detail::grid_line_grain_size(N1, grain_size));
+	}
+
+	template <typename T, typename F> void parallel_for(grid_3D<T>& grid, F const& f, size_t grain_size)
+	{
+		int const N1 = grid.dimension.x;
+		int const N2 = grid.dimension.y;
+		int const N3 = grid.dimension.z;
+		size_t const N_line = size_t(N2) * size_t(N3);
+		parallel_for_range(N_line, [&](size_t line_begin, size_t line_end) {
+			for (size_t l = line_begin; l < line_end; ++l) {
+				int const k2 = int(l % N2);
+				int const k3 = int(l / N2);
+				T* line = grid.data.data.data() + l * N1;
+				for (int k1 = 0; k1 < N1; ++k1)
+					f(line[k1], k1, k2, k3);
+			}
+		}, detail::grid_line_grain_size(N1, grain_size));
+	}
+
+	template <typename T, typename U, typename F> void parallel_transform(grid_2D<T> const& grid, grid_2D<U>& result, F const& f, size_t grain_size)
+	{
+		result.resize(grid.dimension);
+		parallel_transform(grid.data, result.data, f, grain_size);
+	}
+	template <typename T, typename U, typename F> void parallel_transform(grid_3D<T> const& grid, grid_3D<U>& result, F const& f, size_t grain_size)
+	{
+		result.resize(grid.dimension);
+		parallel_transform(grid.data, result.data, f, grain_size);
+	}
+
+	template <typename T> T parallel_sum(grid_2D<T> const& grid, size_t grain_size) { return parallel_sum(grid.data, grain_size); }
+	template <typename T> T parallel_sum(grid_3D<T> const& grid, size_t grain_size) { return parallel_sum(grid.data, grain_size); }
+	template <typename T> T parallel_max(grid_2D<T> const& grid, size_t grain_size) { return parallel_max(grid.data, grain_size); }
+	template <typename T> T parallel_max(grid_3D<T> const& grid, size_t grain_size) { return parallel_max(grid.data, grain_size); }
+	template <typename T> T parallel_min(grid_2D<T> const& grid, size_t grain_size) { return parallel_min(grid.data, grain_size); }
+	template <typename T> T parallel_min(grid_3D<T> const& grid, size_t grain_size) { return parallel_min(grid.data, grain_size); }
+}
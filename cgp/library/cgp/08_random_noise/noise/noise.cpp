@@ -2,6 +2,7 @@
 
 #include "third_party/src/simplexnoise/simplexnoise1234.hpp"
 #include "cgp/01_base/base.hpp"
+#include "noise_simd/noise_simd.hpp"
 
 namespace cgp
 {
@@ -50,4 +51,69 @@ namespace cgp
         return value;
     }
 
+#ifdef CGP_SIMD_X86
+    // Permutation table of the simplex noise converted to int for the vectorized version
+    static int const* noise_permutation_table()
+    {
+        static std::vector<int> const table(perm, perm+512);
+        return table.data();
+    }
+#endif
+
+    // Common entry point of the array versions: p contains the N points stored contiguously with the given dimension (2 or 3)
+    static void noise_perlin_batch(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain)
+    {
+#ifdef CGP_SIMD_X86
+        if(simd_support_avx2())
+            noise_simd::noise_perlin_batch_avx2(value, p, dimension, N, octave, persistency, frequency_gain, noise_permutation_table());
+        else
+            noise_simd::noise_perlin_batch_sse2(value, p, dimension, N, octave, persistency, frequency_gain, noise_permutation_table());
+#else
+        for(size_t k=0; k<N; ++k) {
+            float const* pk = p + k*dimension;
+            value[k] = dimension==2 ?
+                noise_perlin(vec2(pk[0], pk[1]), octave, persistency, frequency_gain) :
+                noise_perlin(vec3(pk[0], pk[1], pk[2]), octave, persistency, frequency_gain);
+        }
+#endif
+    }
+
+    void noise_perlin(numarray<float>& value, numarray<vec2> const& p, int octave, float persistency, float frequency_gain)
+    {
+        static_assert(sizeof(vec2)==2*sizeof(float), "vec2 is expected to store its coordinates contiguously");
+        value.resize(p.size());
+        if(p.size()==0)
+            return;
+        noise_perlin_batch(&value[0], &p[0].x, 2, p.size(), octave, persistency, frequency_gain);
+    }
+
+    void noise_perlin(numarray<float>& value, numarray<vec3> const& p, int octave, float persistency, float frequency_gain)
+    {
+        static_assert(sizeof(vec3)==3*sizeof(float), "vec3 is expected to store its coordinates contiguously");
+        value.resize(p.size());
+        if(p.size()==0)
+            return;
+        noise_perlin_batch(&value[0], &p[0].x, 3, p.size(), octave, persistency, frequency_gain);
+    }
+
+    void noise_perlin(grid_2D<float>& value, vec2 const& p_min, vec2 const& p_max, int octave, float persistency, float frequency_gain)
+    {
+        int const Nx = value.dimension.x;
+        int const Ny = value.dimension.y;
+        if(Nx*Ny==0)
+            return;
+
+        // Sample positions stored in the same order than the grid
+        numarray<vec2> p;
+        p.resize(Nx*Ny);
+        for(int ky=0; ky<Ny; ++ky) {
+            float const v = Ny>1 ? ky/(Ny-1.0f) : 0.0f;
+            for(int kx=0; kx<Nx; ++kx) {
+                float const u = Nx>1 ? kx/(Nx-1.0f) : 0.0f;
+                p[value.index_to_offset(kx,ky)] = { p_min.x + u*(p_max.x-p_min.x), p_min.y + v*(p_max.y-p_min.y) };
+            }
+        }
+        noise_perlin(value.data, p, octave, persistency, frequency_gain);
+    }
+
 }
\ No newline at end of file
@@ -1,10 +1,24 @@
 #pragma once
 
 #include "cgp/05_vec/vec.hpp"
+#include "cgp/02_numarray/numarray.hpp"
+#include "cgp/04_grid_container/grid/grid.hpp"
 
 namespace cgp
 {
 	float noise_perlin(float x,       int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec2 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec3 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+
+	/** Evaluate the noise on a set of points: value[k] = noise_perlin(p[k], octave, persistency, frequency_gain)
+	 * The points are processed by packs of 4 (SSE2) or 8 (AVX2, if supported by the CPU) using vectorized instructions.
+	 * The computation is done in single precision: the result matches the scalar version up to ~1e-5 for coordinates of magnitude ~1.
+	 *  (Larger differences, ~1e-4, can appear in 3D on points lying on the boundary of a simplex, where the 3D simplex noise is discontinuous.)
+	 * The scalar version is used if the vectorized instructions are not available (non x86 platforms, Emscripten). */
+	void noise_perlin(numarray<float>& value, numarray<vec2> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	void noise_perlin(numarray<float>& value, numarray<vec3> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+
+	/** Fill the grid with the noise sampled regularly over the rectangle [p_min,p_max]
+	 * value(kx,ky) = noise_perlin( p_min + (p_max-p_min)*(kx/(Nx-1), ky/(Ny-1)) ) where (Nx,Ny) is the current dimension of the grid */
+	void noise_perlin(grid_2D<float>& value, vec2 const& p_min, vec2 const& p_max, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorized evaluation of noise_perlin over arrays of points (internal functions used by noise.cpp)
+//  - value: output array of N floats
+//  - p: coordinates of the N points stored contiguously ( (x,y) for dimension==2, (x,y,z) for dimension==3 )
+//  - perm: permutation table of the simplex noise stored as int (512 elements)
+// The SSE2 version is available when CGP_SIMD_X86 is defined, the AVX2 version must only be called if simd_support_avx2() is true.
+
+namespace cgp
+{
+	namespace noise_simd
+	{
+		void noise_perlin_batch_sse2(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain, int const* perm);
+		void noise_perlin_batch_avx2(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain, int const* perm);
+	}
+}
@@ -0,0 +1,78 @@
+#include "noise_simd.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+
+#ifdef CGP_SIMD_X86
+
+// The functions of this file use AVX2 instructions without requiring the whole library to be compiled with AVX2 support (-mavx2).
+//  They are only called after checking simd_support_avx2() at run-time.
+// Note: only local functions must be defined after the target pragma (no STL or library template instantiated here),
+//  otherwise AVX2 code could be selected by the linker for functions shared with the rest of the library.
+#include <cstddef>
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+#include "noise_simd_kernel.hpp"
+
+namespace cgp
+{
+	namespace noise_simd
+	{
+		namespace
+		{
+			// Pack of 8 floats/int using AVX2
+			struct simd_avx2
+			{
+				typedef __m256 f;
+				typedef __m256i i;
+				static int const width = 8;
+
+				static f set(float a) { return _mm256_set1_ps(a); }
+				static i seti(int a) { return _mm256_set1_epi32(a); }
+				static f loadu(float const* p) { return _mm256_loadu_ps(p); }
+				static void storeu(float* p, f const& a) { _mm256_storeu_ps(p, a); }
+
+				static f add(f const& a, f const& b) { return _mm256_add_ps(a, b); }
+				static f sub(f const& a, f const& b) { return _mm256_sub_ps(a, b); }
+				static f mul(f const& a, f const& b) { return _mm256_mul_ps(a, b); }
+				static f max(f const& a, f const& b) { return _mm256_max_ps(a, b); }
+				static f floor(f const& a) { return _mm256_floor_ps(a); }
+				static i to_int(f const& a) { return _mm256_cvttps_epi32(a); }
+				static f to_float(i const& a) { return _mm256_cvtepi32_ps(a); }
+
+				static i add_i(i const& a, i const& b) { return _mm256_add_epi32(a, b); }
+				static i sub_i(i const& a, i const& b) { return _mm256_sub_epi32(a, b); }
+				static i and_i(i const& a, i const& b) { return _mm256_and_si256(a, b); }
+				static i or_i(i const& a, i const& b) { return _mm256_or_si256(a, b); }
+				static i andnot_i(i const& a, i const& b) { return _mm256_andnot_si256(a, b); }
+				static i eq_i(i const& a, i const& b) { return _mm256_cmpeq_epi32(a, b); }
+				static i gt_i(i const& a, i const& b) { return _mm256_cmpgt_epi32(a, b); }
+				static i gt(f const& a, f const& b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+				static i ge(f const& a, f const& b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+				template <int n> static i shift_left(i const& a) { return _mm256_slli_epi32(a, n); }
+
+				static f select(i const& mask, f const& a, f const& b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+				static f xor_sign(f const& a, i const& sign) { return _mm256_xor_ps(a, _mm256_castsi256_ps(sign)); }
+
+				static i gather(int const* table, i const& index) { return _mm256_i32gather_epi32(table, index, 4); }
+			};
+		}
+
+		void noise_perlin_batch_avx2(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain, int const* perm)
+		{
+			noise_perlin_batch<simd_avx2>(value, p, dimension, N, octave, persistency, frequency_gain, perm);
+		}
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
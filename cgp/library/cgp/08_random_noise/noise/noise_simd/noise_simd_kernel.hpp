@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+
+// Generic vectorized version of the simplex noise (snoise2/snoise3 from third_party/src/simplexnoise) and of noise_perlin,
+//  evaluating S::width points at once.
+//
+// S is a structure describing a SIMD instruction set (see noise_simd_sse2.cpp and noise_simd_avx2.cpp). It provides
+//  - the types S::f (pack of floats) and S::i (pack of int), and the number of elements S::width
+//  - static functions on these packs: set, seti, loadu, storeu, add, sub, mul, max, floor, to_int, to_float,
+//     add_i, sub_i, and_i, or_i, andnot_i (~a & b), xor_sign, eq_i, gt_i, gt, ge, select (mask ? a : b), shift_left<n>, gather (table[idx])
+//
+// The computation is the same as the scalar version, but is performed in single precision instead of double:
+//  the results match the scalar noise up to ~1e-5 for coordinates of magnitude ~1 (see noise.hpp).
+// This file must only be included from the .cpp files defining S (the functions are instantiated with the target of the instruction set).
+
+namespace cgp
+{
+	namespace noise_simd
+	{
+		template <typename S>
+		typename S::f grad2(typename S::i const& hash, typename S::f const& x, typename S::f const& y)
+		{
+			typedef typename S::i I;
+			I const h = S::and_i(hash, S::seti(7));
+			I const h_lt4 = S::eq_i(S::and_i(h, S::seti(4)), S::seti(0));
+			typename S::f const u = S::xor_sign(S::select(h_lt4, x, y), S::template shift_left<31>(S::and_i(h, S::seti(1))));
+			typename S::f const v = S::xor_sign(S::select(h_lt4, y, x), S::template shift_left<30>(S::and_i(h, S::seti(2))));
+			return S::add(u, S::mul(S::set(2.0f), v));
+		}
+
+		template <typename S>
+		typename S::f grad3(typename S::i const& hash, typename S::f const& x, typename S::f const& y, typename S::f const& z)
+		{
+			typedef typename S::i I;
+			I const h = S::and_i(hash, S::seti(15));
+			I const h_lt8 = S::gt_i(S::seti(8), h);
+			I const h_lt4 = S::gt_i(S::seti(4), h);
+			I const h_12_14 = S::or_i(S::eq_i(h, S::seti(12)), S::eq_i(h, S::seti(14)));
+			typename S::f const u = S::xor_sign(S::select(h_lt8, x, y), S::template shift_left<31>(S::and_i(h, S::seti(1))));
+			typename S::f const v = S::xor_sign(S::select(h_lt4, y, S::select(h_12_14, x, z)), S::template shift_left<30>(S::and_i(h, S::seti(2))));
+			return S::add(u, v);
+		}
+
+		// Contribution t^4 * gradient of one corner of the simplex, where t = max(radius - |d|^2, 0)
+		template <typename S>
+		typename S::f corner2(typename S::i const& hash, typename S::f const& x, typename S::f const& y)
+		{
+			typename S::f t = S::sub(S::sub(S::set(0.5f), S::mul(x, x)), S::mul(y, y));
+			t = S::max(t, S::set(0.0f));
+			t = S::mul(t, t);
+			return S::mul(S::mul(t, t), grad2<S>(hash, x, y));
+		}
+		template <typename S>
+		typename S::f corner3(typename S::i const& hash, typename S::f const& x, typename S::f const& y, typename S::f const& z)
+		{
+			typename S::f t = S::sub(S::sub(S::sub(S::set(0.6f), S::mul(x, x)), S::mul(y, y)), S::mul(z, z));
+			t = S::max(t, S::set(0.0f));
+			t = S::mul(t, t);
+			return S::mul(S::mul(t, t), grad3<S>(hash, x, y, z));
+		}
+
+		// perm: permutation table of the simplex noise stored as int (512 elements)
+		template <typename S>
+		typename S::f snoise2(typename S::f const& x, typename S::f const& y, int const* perm)
+		{
+			typedef typename S::f F;
+			typedef typename S::i I;
+			float const F2 = 0.366025403f;
+			float const G2 = 0.211324865f;
+
+			// Skew the input space to determine which simplex cell we're in
+			F const s = S::mul(S::add(x, y), S::set(F2));
+			F const fi = S::floor(S::add(x, s));
+			F const fj = S::floor(S::add(y, s));
+			F const t = S::mul(S::add(fi, fj), S::set(G2));
+			// x0 = x-(i-t) is computed as (x-i)+t to limit the loss of precision in single precision
+			F const dx = S::sub(x, fi);
+			F const dy = S::sub(y, fj);
+			F const x0 = S::add(dx, t);
+			F const y0 = S::add(dy, t);
+
+			// Offsets of the middle corner: (1,0) if x0>y0, (0,1) otherwise
+			//  The comparison is done on (x-i) and (y-j) which are exact, to select the same simplex as the scalar version
+			I const one = S::seti(1);
+			I const i1 = S::and_i(S::gt(dx, dy), one);
+			I const j1 = S::sub_i(one, i1);
+
+			F const x1 = S::add(S::sub(x0, S::to_float(i1)), S::set(G2));
+			F const y1 = S::add(S::sub(y0, S::to_float(j1)), S::set(G2));
+			F const x2 = S::add(x0, S::set(-1.0f + 2.0f * G2));
+			F const y2 = S::add(y0, S::set(-1.0f + 2.0f * G2));
+
+			// Wrap the integer indices at 256
+			I const ii = S::and_i(S::to_int(fi), S::seti(0xff));
+			I const jj = S::and_i(S::to_int(fj), S::seti(0xff));
+
+			I const gi0 = S::gather(perm, S::add_i(ii, S::gather(perm, jj)));
+			I const gi1 = S::gather(perm, S::add_i(S::add_i(ii, i1), S::gather(perm, S::add_i(jj, j1))));
+			I const gi2 = S::gather(perm, S::add_i(S::add_i(ii, one), S::gather(perm, S::add_i(jj, one))));
+
+			F const n = S::add(S::add(corner2<S>(gi0, x0, y0), corner2<S>(gi1, x1, y1)), corner2<S>(gi2, x2, y2));
+			return S::mul(S::set(40.0f), n);
+		}
+
+		template <typename S>
+		typename S::f snoise3(typename S::f const& x, typename S::f const& y, typename S::f const& z, int const* perm)
+		{
+			typedef typename S::f F;
+			typedef typename S::i I;
+			float const F3 = 0.333333333f;
+			float const G3 = 0.166666667f;
+
+			// Skew the input space to determine which simplex cell we're in
+			F const s = S::mul(S::add(S::add(x, y), z), S::set(F3));
+			F const fi = S::floor(S::add(x, s));
+			F const fj = S::floor(S::add(y, s));
+			F const fk = S::floor(S::add(z, s));
+			F const t = S::mul(S::add(S::add(fi, fj), fk), S::set(G3));
+			F const dx = S::sub(x, fi);
+			F const dy = S::sub(y, fj);
+			F const dz = S::sub(z, fk);
+			F const x0 = S::add(dx, t);
+			F const y0 = S::add(dy, t);
+			F const z0 = S::add(dz, t);
+
+			// Offsets of the second and third corners of the simplex
+			//  Same choice as the scalar version, written as boolean expressions of the 3 comparisons
+			I const one = S::seti(1);
+			I const x_ge_y = S::ge(dx, dy);
+			I const y_ge_z = S::ge(dy, dz);
+			I const x_ge_z = S::ge(dx, dz);
+			I const i1 = S::and_i(S::and_i(x_ge_y, x_ge_z), one);
+			I const j1 = S::and_i(S::andnot_i(x_ge_y, y_ge_z), one);
+			I const k1 = S::andnot_i(S::or_i(y_ge_z, x_ge_z), one);
+			I const i2 = S::and_i(S::or_i(x_ge_y, x_ge_z), one);
+			I const j2 = S::or_i(S::andnot_i(x_ge_y, one), S::and_i(y_ge_z, one));
+			I const k2 = S::andnot_i(S::and_i(y_ge_z, x_ge_z), one);
+
+			F const x1 = S::add(S::sub(x0, S::to_float(i1)), S::set(G3));
+			F const y1 = S::add(S::sub(y0, S::to_float(j1)), S::set(G3));
+			F const z1 = S::add(S::sub(z0, S::to_float(k1)), S::set(G3));
+			F const x2 = S::add(S::sub(x0, S::to_float(i2)), S::set(2.0f * G3));
+			F const y2 = S::add(S::sub(y0, S::to_float(j2)), S::set(2.0f * G3));
+			F const z2 = S::add(S::sub(z0, S::to_float(k2)), S::set(2.0f * G3));
+			F const x3 = S::add(x0, S::set(-1.0f + 3.0f * G3));
+			F const y3 = S::add(y0, S::set(-1.0f + 3.0f * G3));
+			F const z3 = S::add(z0, S::set(-1.0f + 3.0f * G3));
+
+			// Wrap the integer indices at 256
+			I const ii = S::and_i(S::to_int(fi), S::seti(0xff));
+			I const jj = S::and_i(S::to_int(fj), S::seti(0xff));
+			I const kk = S::and_i(S::to_int(fk), S::seti(0xff));
+
+			I const gi0 = S::gather(perm, S::add_i(ii, S::gather(perm, S::add_i(jj, S::gather(perm, kk)))));
+			I const gi1 = S::gather(perm, S::add_i(S::add_i(ii, i1), S::gather(perm, S::add_i(S::add_i(jj, j1), S::gather(perm, S::add_i(kk, k1))))));
+			I const gi2 = S::gather(perm, S::add_i(S::add_i(ii, i2), S::gather(perm, S::add_i(S::add_i(jj, j2), S::gather(perm, S::add_i(kk, k2))))));
+			I const gi3 = S::gather(perm, S::add_i(S::add_i(ii, one), S::gather(perm, S::add_i(S::add_i(jj, one), S::gather(perm, S::add_i(kk, one))))));
+
+			F const n0 = corner3<S>(gi0, x0, y0, z0);
+			F const n1 = corner3<S>(gi1, x1, y1, z1);
+			F const n2 = corner3<S>(gi2, x2, y2, z2);
+			F const n3 = corner3<S>(gi3, x3, y3, z3);
+			return S::mul(S::set(32.0f), S::add(S::add(n0, n1), S::add(n2, n3)));
+		}
+
+		// Evaluate noise_perlin on a pack of points given as separated coordinates (z is ignored for dimension 2)
+		template <typename S>
+		typename S::f noise_perlin(typename S::f const& x, typename S::f const& y, typename S::f const& z, int dimension, int octave, float persistency, float frequency_gain, int const* perm)
+		{
+			typename S::f value = S::set(0.0f);
+			float a = 1.0f; // current magnitude
+			float f = 1.0f; // current frequency
+			for (int k = 0; k < octave; k++)
+			{
+				typename S::f const sf = S::set(f);
+				typename S::f const n = dimension == 2 ?
+					snoise2<S>(S::mul(x, sf), S::mul(y, sf), perm) :
+					snoise3<S>(S::mul(x, sf), S::mul(y, sf), S::mul(z, sf), perm);
+				value = S::add(value, S::mul(S::set(a), S::add(S::set(0.5f), S::mul(S::set(0.5f), n))));
+				f *= frequency_gain;
+				a *= persistency;
+			}
+			return value;
+		}
+
+		// Fill value[k] with the noise evaluated at the k-th point of p, for k in [0,N[
+		//  p stores the coordinates of the points contiguously: (x,y) for dimension 2, (x,y,z) for dimension 3
+		template <typename S>
+		void noise_perlin_batch(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain, int const* perm)
+		{
+			int const W = S::width;
+			float x[S::width], y[S::width], z[S::width], v[S::width];
+			for (size_t k0 = 0; k0 < N; k0 += W)
+			{
+				// The last pack is padded with zeros if N is not a multiple of W
+				int const n = (N - k0 < size_t(W)) ? int(N - k0) : W;
+				for (int k = 0; k < W; ++k) {
+					float const* pk = p + (k0 + k) * dimension;
+					x[k] = k < n ? pk[0] : 0.0f;
+					y[k] = k < n ? pk[1] : 0.0f;
+					z[k] = (k < n && dimension == 3) ? pk[2] : 0.0f;
+				}
+
+				typename S::f const r = noise_perlin<S>(S::loadu(x), S::loadu(y), S::loadu(z), dimension, octave, persistency, frequency_gain, perm);
+				if (n == W)
+					S::storeu(value + k0, r);
+				else {
+					S::storeu(v, r);
+					for (int k = 0; k < n; ++k)
+						value[k0 + k] = v[k];
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include "noise_simd.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+
+#ifdef CGP_SIMD_X86
+
+#include <emmintrin.h>
+#include "noise_simd_kernel.hpp"
+
+namespace cgp
+{
+	namespace noise_simd
+	{
+		namespace
+		{
+			// Pack of 4 floats/int using SSE2
+			struct simd_sse2
+			{
+				typedef __m128 f;
+				typedef __m128i i;
+				static int const width = 4;
+
+				static f set(float a) { return _mm_set1_ps(a); }
+				static i seti(int a) { return _mm_set1_epi32(a); }
+				static f loadu(float const* p) { return _mm_loadu_ps(p); }
+				static void storeu(float* p, f const& a) { _mm_storeu_ps(p, a); }
+
+				static f add(f const& a, f const& b) { return _mm_add_ps(a, b); }
+				static f sub(f const& a, f const& b) { return _mm_sub_ps(a, b); }
+				static f mul(f const& a, f const& b) { return _mm_mul_ps(a, b); }
+				static f max(f const& a, f const& b) { return _mm_max_ps(a, b); }
+				static f floor(f const& a) {
+					// Truncation, then subtract 1 for negative non-integer values (SSE2 has no rounding instruction)
+					f const t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+					return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+				}
+				static i to_int(f const& a) { return _mm_cvttps_epi32(a); }
+				static f to_float(i const& a) { return _mm_cvtepi32_ps(a); }
+
+				static i add_i(i const& a, i const& b) { return _mm_add_epi32(a, b); }
+				static i sub_i(i const& a, i const& b) { return _mm_sub_epi32(a, b); }
+				static i and_i(i const& a, i const& b) { return _mm_and_si128(a, b); }
+				static i or_i(i const& a, i const& b) { return _mm_or_si128(a, b); }
+				static i andnot_i(i const& a, i const& b) { return _mm_andnot_si128(a, b); }
+				static i eq_i(i const& a, i const& b) { return _mm_cmpeq_epi32(a, b); }
+				static i gt_i(i const& a, i const& b) { return _mm_cmpgt_epi32(a, b); }
+				static i gt(f const& a, f const& b) { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+				static i ge(f const& a, f const& b) { return _mm_castps_si128(_mm_cmpge_ps(a, b)); }
+				template <int n> static i shift_left(i const& a) { return _mm_slli_epi32(a, n); }
+
+				static f select(i const& mask, f const& a, f const& b) {
+					f const m = _mm_castsi128_ps(mask);
+					return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+				}
+				static f xor_sign(f const& a, i const& sign) { return _mm_xor_ps(a, _mm_castsi128_ps(sign)); }
+
+				// No gather instruction in SSE2: the lookups are done element by element
+				static i gather(int const* table, i const& index) {
+					alignas(16) int k[4];
+					_mm_store_si128(reinterpret_cast<__m128i*>(k), index);
+					return _mm_set_epi32(table[k[3]], table[k[2]], table[k[1]], table[k[0]]);
+				}
+			};
+		}
+
+		void noise_perlin_batch_sse2(float* value, float const* p, int dimension, size_t N, int octave, float persistency, float frequency_gain, int const* perm)
+		{
+			noise_perlin_batch<simd_sse2>(value, p, dimension, N, octave, persistency, frequency_gain, perm);
+		}
+	}
+}
+
+#endif
@@ -1,4 +1,5 @@
 #pragma once
 
 #include "mesh/mesh.hpp"
+#include "mesh_adjacency/mesh_adjacency.hpp"
 #include "primitive/primitive.hpp"
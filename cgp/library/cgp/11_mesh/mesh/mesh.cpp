@@ -2,8 +2,6 @@
 
 
 
-#include <set>
-
 namespace cgp
 {
 	mesh& mesh::fill_empty_field()
@@ -45,7 +43,7 @@ namespace cgp
 	}
 
 
-	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
+	void normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, numarray<vec3>& normals, bool invert)
 	{
 		size_t const N = position.size();
 		if(normals.size()!=N)
@@ -106,13 +104,106 @@ namespace cgp
 
 			
 	}
-	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert)
+	numarray<vec3> normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, bool invert)
 	{
 		numarray<vec3> normals;
 		normal_per_vertex(position, connectivity, normals, invert);
 		return normals;
 	}
 
+	void mesh_normal_cache::update(numarray_view<uint3 const> connectivity, int number_of_vertex_arg)
+	{
+		if (is_valid && number_of_vertex_arg == number_of_vertex && connectivity.size() == number_of_face)
+			return;
+
+		adjacency_vertex_to_face(vertex_to_face, connectivity, number_of_vertex_arg);
+		number_of_vertex = number_of_vertex_arg;
+		number_of_face = connectivity.size();
+		is_valid = true;
+	}
+
+	void mesh_normal_cache::invalidate()
+	{
+		is_valid = false;
+	}
+
+	void normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, numarray<vec3>& normals, mesh_normal_cache& cache, normal_weighting weighting, bool invert, int number_of_threads)
+	{
+		int const N = position.size();
+		int const N_face = connectivity.size();
+		cache.update(connectivity, N);
+		normals.resize(N);
+		cache.face_normal.resize(N_face);
+		if (weighting == normal_weighting::angle)
+			cache.face_angle.resize(N_face);
+
+		// The threads are not worth their cost for small meshes
+		int const threads = N_face < 20000 ? 1 : number_of_threads;
+
+		// Normal of each face: unit normal (same computation as the scatter version), or cross product (norm = 2*area) for area weighting
+		parallel_for_chunk(N_face, threads, [&](size_t k_begin, size_t k_end, int) {
+			for (int k_face = int(k_begin); k_face < int(k_end); ++k_face) {
+				uint3 const& face = connectivity.at(k_face);
+				vec3 const& p0 = position.at(get<0>(face));
+				vec3 const p10 = position.at(get<1>(face)) - p0;
+				vec3 const p20 = position.at(get<2>(face)) - p0;
+
+				vec3 n = { 0,0,0 };
+				if (weighting == normal_weighting::area)
+					n = cross(p10, p20);
+				else {
+					float const L10 = norm(p10);
+					float const L20 = norm(p20);
+					if (L10 > 1e-6f && L20 > 1e-6f) {
+						n = cross(p10 / L10, p20 / L20);
+						float const Ln = norm(n);
+						n = Ln > 1e-6f ? n / Ln : vec3{ 0,0,0 };
+					}
+				}
+				cache.face_normal.at(k_face) = n;
+
+				if (weighting == normal_weighting::angle) {
+					// Angles of the face at its 3 vertices
+					vec3 const p21 = p20 - p10;
+					float const L10 = norm(p10), L20 = norm(p20), L21 = norm(p21);
+					vec3 angle = { 0,0,0 };
+					if (L10 > 1e-6f && L20 > 1e-6f && L21 > 1e-6f) {
+						angle[0] = std::acos(std::min(std::max(dot(p10, p20) / (L10 * L20), -1.0f), 1.0f));
+						angle[1] = std::acos(std::min(std::max(-dot(p10, p21) / (L10 * L21), -1.0f), 1.0f));
+						angle[2] = std::max(3.14159265f - angle[0] - angle[1], 0.0f);
+					}
+					cache.face_angle.at(k_face) = angle;
+				}
+			}
+		});
+
+		// Each vertex sums the normals of its adjacent faces
+		adjacency_csr const& vertex_to_face = cache.vertex_to_face;
+		parallel_for_chunk(N, threads, [&](size_t k_begin, size_t k_end, int) {
+			for (int k = int(k_begin); k < int(k_end); ++k) {
+				vec3 n = { 0,0,0 };
+				int const end = vertex_to_face.end(k);
+				for (int i = vertex_to_face.begin(k); i < end; ++i) {
+					int const k_face = vertex_to_face.index.at(i);
+					if (weighting == normal_weighting::angle) {
+						// Angle of the face at the current vertex
+						uint3 const& face = connectivity.at(k_face);
+						vec3 const& angle = cache.face_angle.at(k_face);
+						float const a = int(get<0>(face)) == k ? angle.x : (int(get<1>(face)) == k ? angle.y : angle.z);
+						n += a * cache.face_normal.at(k_face);
+					}
+					else
+						n += cache.face_normal.at(k_face);
+				}
+
+				float const L = norm(n);
+				if (L > 1e-6f)
+					n /= L;
+				normals.at(k) = invert ? -n : n;
+			}
+		});
+	}
+
 	bool mesh_check(mesh const& m)
 	{
 		bool ok = true;
@@ -225,6 +316,11 @@ namespace cgp
 		normal_per_vertex(position, connectivity, normal);
 		return *this;
 	}
+	mesh& mesh::normal_update(mesh_normal_cache& cache, normal_weighting weighting, int number_of_threads)
+	{
+		normal_per_vertex(position, connectivity, normal, cache, weighting, false, number_of_threads);
+		return *this;
+	}
 
 	mesh& mesh::translate(vec3 const& t)
 	{
@@ -304,29 +400,15 @@ namespace cgp
 	}
 
 
-	numarray<numarray<int> > connectivity_one_ring(numarray<uint3> const& connectivity)
+	numarray<numarray<int> > connectivity_one_ring(numarray_view<uint3 const> connectivity)
 	{
-		size_t const N = connectivity.size();
-		numarray<std::set<int> > one_ring;
-		one_ring.resize(N);
-		for (size_t k = 0; k < N; ++k)
-		{
-			uint3 const& tri = connectivity[k];
-			one_ring[ get<0>(tri) ].insert( get<1>(tri) );
-			one_ring[ get<0>(tri) ].insert( get<2>(tri) );
-
-			one_ring[ get<1>(tri) ].insert( get<0>(tri) );
-			one_ring[ get<1>(tri) ].insert( get<2>(tri) );
-
-			one_ring[ get<2>(tri) ].insert( get<0>(tri) );
-			one_ring[ get<2>(tri) ].insert( get<1>(tri) );
-		}
+		int const N = number_of_vertex_in_connectivity(connectivity);
+		adjacency_csr const one_ring = adjacency_vertex_to_vertex(connectivity, N);
 
 		numarray<numarray<int> > one_ring_buffer;
 		one_ring_buffer.resize(N);
-		for(int k=0; k<N; ++k)
-			for(int idx : one_ring[k])
-				one_ring_buffer[k].push_back(idx);
+		for (int k = 0; k < N; ++k)
+			one_ring_buffer[k].data.assign(one_ring.index.data.begin() + one_ring.begin(k), one_ring.index.data.begin() + one_ring.end(k));
 		return one_ring_buffer;
 	}
 
@@ -3,11 +3,37 @@
 
 #include "cgp/05_vec/vec.hpp"
 #include "cgp/09_geometric_transformation/geometric_transformation.hpp"
+#include "../mesh_adjacency/mesh_adjacency.hpp"
 
 
 
 namespace cgp
 {
+	/** Weight of the face normals when computing per-vertex normals
+	* uniform: unit normal of each face, area: normal scaled by the area of the face, angle: normal scaled by the angle of the face at the vertex */
+	enum class normal_weighting { uniform, area, angle };
+
+	/** Data reused between successive computations of the per-vertex normals of a mesh (ex. deforming mesh updated at every frame)
+	* The cache is owned by the caller and passed explicitly to normal_per_vertex (or mesh::normal_update). It must be invalidated when the connectivity changes. */
+	struct mesh_normal_cache
+	{
+		/** Faces around each vertex */
+		adjacency_csr vertex_to_face;
+		/** Scratch buffer storing the normal of each face */
+		numarray<vec3> face_normal;
+		/** Scratch buffer storing the angles of each face at its 3 vertices (only used with angle weighting) */
+		numarray<vec3> face_angle;
+
+		/** Build vertex_to_face if the cache was invalidated, or if the number of vertices or faces changed since the last call */
+		void update(numarray_view<uint3 const> connectivity, int number_of_vertex);
+		/** Must be called when the connectivity is modified: vertex_to_face is rebuilt at the next update */
+		void invalidate();
+
+	private:
+		bool is_valid = false;
+		int number_of_vertex = -1;
+		int number_of_face = -1;
+	};
 
 	/** Standard triangular mesh structure storing per-vertex information as well as triangle connectivity
 	* All data are stored contiguously in the CPU memory	 (as numarray) */
@@ -26,7 +52,11 @@ namespace cgp
 		/** Concatenate the content of another mesh to the current one */
 		mesh& push_back(mesh const& to_add);
 		mesh& flip_connectivity();
+		/** Recompute the per-vertex normals from the position and connectivity */
 		mesh& normal_update();
+		/** Recompute the per-vertex normals with the parallel version of normal_per_vertex, reusing the vertex to face adjacency stored in the cache
+		* (ex. deforming mesh updated at every frame; call cache.invalidate() when the connectivity changes) */
+		mesh& normal_update(mesh_normal_cache& cache, normal_weighting weighting = normal_weighting::uniform, int number_of_threads = 0);
 
 		/** Apply a translation to position. Shorthand for(vec3& p: position) { p += t; } */
 		mesh& translate(vec3 const& t);
@@ -58,15 +88,21 @@ namespace cgp
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity 
 	* Version where the normal is passed as in/out argument (usefull in case of real-time update of the normals) 
 	*   allows to save time and avoid unecessary allocation if the normal vector has already the correct size.	*/
-	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals_to_fill, bool invert=false);
+	void normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, numarray<vec3>& normals_to_fill, bool invert=false);
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity */
-	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert=false);
+	numarray<vec3> normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, bool invert=false);
+	/** Compute the per-vertex normals in parallel: each vertex gathers the normals of its adjacent faces (given by the adjacency in the cache) instead of having the faces scattering their normal to the vertices.
+	* The adjacency is built at the first call and reused by the next ones until cache.invalidate() is called (or the number of vertices or faces changes). With uniform weighting, the result is the same as the previous versions.
+	* number_of_threads: 0 for the number of hardware threads, 1 for no threads (small meshes are always computed without threads). */
+	void normal_per_vertex(numarray_view<vec3 const> position, numarray_view<uint3 const> connectivity, numarray<vec3>& normals_to_fill, mesh_normal_cache& cache, normal_weighting weighting=normal_weighting::uniform, bool invert=false, int number_of_threads=0);
 
 	/** Check if the mesh looks coherent (correct indexing and size of buffer, no degenerate triangle, etc) */
 	bool mesh_check(mesh const& m);
 
 
-	numarray<numarray<int> > connectivity_one_ring(numarray<uint3> const& connectivity);
+	/** Neighbors of each vertex (sorted by increasing index), the size of the result is the number of vertices indexed by the connectivity
+	* Note: adjacency_vertex_to_vertex provides the same information stored contiguously (without one allocation per vertex) */
+	numarray<numarray<int> > connectivity_one_ring(numarray_view<uint3 const> connectivity);
 
 	std::string str(mesh const& m);
 	std::string type_str(mesh const&);
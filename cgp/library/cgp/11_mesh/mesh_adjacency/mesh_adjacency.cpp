@@ -0,0 +1,185 @@
+#include "cgp/01_base/base.hpp"
+#include "mesh_adjacency.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace cgp
+{
+	void adjacency_vertex_to_face(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity, int number_of_vertex)
+	{
+		int const N_face = connectivity.size();
+		adjacency.offset.resize(number_of_vertex + 1);
+		adjacency.offset.fill(0);
+
+		// Count the faces around each vertex (stored in offset[k+1])
+		for (int k_face = 0; k_face < N_face; ++k_face) {
+			uint3 const& face = connectivity.at(k_face);
+			for (int k = 0; k < 3; ++k) {
+				assert_cgp(int(face[k]) < number_of_vertex, "Face " + str(k_face) + " has an index larger than the number of vertices (" + str(number_of_vertex) + ")");
+				adjacency.offset.at(face[k] + 1)++;
+			}
+		}
+
+		// Prefix sum
+		for (int k = 0; k < number_of_vertex; ++k)
+			adjacency.offset.at(k + 1) += adjacency.offset.at(k);
+
+		// Fill the lists, using offset[k] as the current insertion position of vertex k (shifted back afterwards)
+		adjacency.index.resize(3 * N_face);
+		for (int k_face = 0; k_face < N_face; ++k_face) {
+			uint3 const& face = connectivity.at(k_face);
+			for (int k = 0; k < 3; ++k)
+				adjacency.index.at(adjacency.offset.at(face[k])++) = k_face;
+		}
+		for (int k = number_of_vertex; k > 0; --k)
+			adjacency.offset.at(k) = adjacency.offset.at(k - 1);
+		adjacency.offset.at(0) = 0;
+	}
+
+	adjacency_csr adjacency_vertex_to_face(numarray_view<uint3 const> connectivity, int number_of_vertex)
+	{
+		adjacency_csr adjacency;
+		adjacency_vertex_to_face(adjacency, connectivity, number_of_vertex);
+		return adjacency;
+	}
+
+	// Sort and remove duplicates in each adjacency list, then compact the lists (in place)
+	static void adjacency_sort_unique(adjacency_csr& adjacency)
+	{
+		int const N = adjacency.size();
+		int counter = 0;
+		for (int k = 0; k < N; ++k) {
+			int const begin = adjacency.offset.at(k);
+			int const end = adjacency.offset.at(k + 1);
+			int* const first = adjacency.index.data.data() + begin;
+			std::sort(first, first + (end - begin));
+			int const n = int(std::unique(first, first + (end - begin)) - first);
+
+			// counter <= begin: the list can be moved to its compacted position
+			if (counter < begin)
+				std::copy(first, first + n, adjacency.index.data.data() + counter);
+			adjacency.offset.at(k) = counter;
+			counter += n;
+		}
+		adjacency.offset.at(N) = counter;
+		adjacency.index.resize(counter);
+	}
+
+	void adjacency_vertex_to_vertex(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity, int number_of_vertex)
+	{
+		int const N_face = connectivity.size();
+
+		// Each corner of a face adds its two neighbors in the face (with duplicates for edges shared by several faces)
+		adjacency.offset.resize(number_of_vertex + 1);
+		adjacency.offset.fill(0);
+		for (int k_face = 0; k_face < N_face; ++k_face) {
+			uint3 const& face = connectivity.at(k_face);
+			for (int k = 0; k < 3; ++k) {
+				assert_cgp(int(face[k]) < number_of_vertex, "Face " + str(k_face) + " has an index larger than the number of vertices (" + str(number_of_vertex) + ")");
+				adjacency.offset.at(face[k] + 1) += 2;
+			}
+		}
+		for (int k = 0; k < number_of_vertex; ++k)
+			adjacency.offset.at(k + 1) += adjacency.offset.at(k);
+
+		adjacency.index.resize(6 * N_face);
+		for (int k_face = 0; k_face < N_face; ++k_face) {
+			uint3 const& face = connectivity.at(k_face);
+			for (int k = 0; k < 3; ++k) {
+				int& position = adjacency.offset.at(face[k]);
+				adjacency.index.at(position++) = face[(k + 1) % 3];
+				adjacency.index.at(position++) = face[(k + 2) % 3];
+			}
+		}
+		for (int k = number_of_vertex; k > 0; --k)
+			adjacency.offset.at(k) = adjacency.offset.at(k - 1);
+		adjacency.offset.at(0) = 0;
+
+		adjacency_sort_unique(adjacency);
+	}
+
+	adjacency_csr adjacency_vertex_to_vertex(numarray_view<uint3 const> connectivity, int number_of_vertex)
+	{
+		adjacency_csr adjacency;
+		adjacency_vertex_to_vertex(adjacency, connectivity, number_of_vertex);
+		return adjacency;
+	}
+
+	void adjacency_face_to_face(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity)
+	{
+		int const N_face = connectivity.size();
+
+		// All the edges of the faces as (key, face), where the key encodes the edge (min index, max index)
+		//  After sorting, the faces sharing an edge are contiguous.
+		std::vector<std::pair<uint64_t, int> > edges(3 * size_t(N_face));
+		for (int k_face = 0; k_face < N_face; ++k_face) {
+			uint3 const& face = connectivity.at(k_face);
+			for (int k = 0; k < 3; ++k) {
+				uint64_t const a = face[k];
+				uint64_t const b = face[(k + 1) % 3];
+				edges[3 * size_t(k_face) + k] = { a < b ? (a << 32) | b : (b << 32) | a, k_face };
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		// Two passes over the groups of faces sharing the same edge: count the adjacent faces, then fill the lists
+		adjacency.offset.resize(N_face + 1);
+		adjacency.offset.fill(0);
+		for (int pass = 0; pass < 2; ++pass) {
+			size_t group_begin = 0;
+			while (group_begin < edges.size()) {
+				size_t group_end = group_begin + 1;
+				while (group_end < edges.size() && edges[group_end].first == edges[group_begin].first)
+					++group_end;
+
+				for (size_t i = group_begin; i < group_end; ++i) {
+					for (size_t j = group_begin; j < group_end; ++j) {
+						if (i == j || edges[i].second == edges[j].second)
+							continue;
+						if (pass == 0)
+							adjacency.offset.at(edges[i].second + 1)++;
+						else
+							adjacency.index.at(adjacency.offset.at(edges[i].second)++) = edges[j].second;
+					}
+				}
+				group_begin = group_end;
+			}
+
+			if (pass == 0) {
+				for (int k = 0; k < N_face; ++k)
+					adjacency.offset.at(k + 1) += adjacency.offset.at(k);
+				adjacency.index.resize(adjacency.offset.at(N_face));
+			}
+		}
+		for (int k = N_face; k > 0; --k)
+			adjacency.offset.at(k) = adjacency.offset.at(k - 1);
+		adjacency.offset.at(0) = 0;
+
+		// Faces sharing two edges (degenerate configurations) appear twice
+		adjacency_sort_unique(adjacency);
+	}
+
+	adjacency_csr adjacency_face_to_face(numarray_view<uint3 const> connectivity)
+	{
+		adjacency_csr adjacency;
+		adjacency_face_to_face(adjacency, connectivity);
+		return adjacency;
+	}
+
+	void mesh_adjacency::initialize(numarray_view<uint3 const> connectivity, int number_of_vertex)
+	{
+		adjacency_vertex_to_vertex(vertex_to_vertex, connectivity, number_of_vertex);
+		adjacency_vertex_to_face(vertex_to_face, connectivity, number_of_vertex);
+		adjacency_face_to_face(face_to_face, connectivity);
+	}
+
+	int number_of_vertex_in_connectivity(numarray_view<uint3 const> connectivity)
+	{
+		int N = 0;
+		for (uint3 const& face : connectivity)
+			for (unsigned int idx : face)
+				N = std::max(N, int(idx) + 1);
+		return N;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cgp/02_numarray/numarray.hpp"
+#include "cgp/05_vec/vec.hpp"
+
+namespace cgp
+{
+	/** Compact adjacency list stored in CSR format (Compressed Sparse Row)
+	* The elements adjacent to the element k are index[offset[k]], ..., index[offset[k+1]-1].
+	* All the lists are stored contiguously in a single buffer: no allocation per element. */
+	struct adjacency_csr
+	{
+		/** Start of the adjacency list of each element in index (size = number of elements + 1) */
+		numarray<int> offset;
+		/** Concatenated adjacency lists */
+		numarray<int> index;
+
+		/** Number of elements (ex. number of vertices for a vertex to face adjacency) */
+		int size() const { return offset.size() > 0 ? offset.size() - 1 : 0; }
+		/** Range [begin,end[ of the adjacency list of the element k in index */
+		int begin(int k) const { return offset.at(k); }
+		int end(int k) const { return offset.at(k + 1); }
+		/** Number of elements adjacent to k */
+		int number_of_adjacent(int k) const { return offset.at(k + 1) - offset.at(k); }
+	};
+
+	/** Faces adjacent to each vertex, listed in increasing face index (a face indexing the same vertex several times appears several times)
+	* Built in O(number_of_vertex + number_of_face) by counting sort. Vertices that are not indexed by any face have an empty list. */
+	void adjacency_vertex_to_face(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity, int number_of_vertex);
+	adjacency_csr adjacency_vertex_to_face(numarray_view<uint3 const> connectivity, int number_of_vertex);
+
+	/** Vertices sharing an edge with each vertex (one-ring), sorted by increasing index without duplicates
+	* Built in O(E log d) where E is the number of edges and d the maximal valence (sort and unique of the neighbors of each vertex). */
+	void adjacency_vertex_to_vertex(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity, int number_of_vertex);
+	adjacency_csr adjacency_vertex_to_vertex(numarray_view<uint3 const> connectivity, int number_of_vertex);
+
+	/** Faces sharing an edge with each face, sorted by increasing index without duplicates (all the faces around a non-manifold edge are adjacent)
+	* Built in O(E log E) by sorting the edges of all the faces. */
+	void adjacency_face_to_face(adjacency_csr& adjacency, numarray_view<uint3 const> connectivity);
+	adjacency_csr adjacency_face_to_face(numarray_view<uint3 const> connectivity);
+
+	/** Vertex-vertex, vertex-face, and face-face adjacencies of a triangle mesh
+	* Ex. for a smoothing step: for(int k=0; k<N; ++k) for(int i=adjacency.vertex_to_vertex.begin(k); i<adjacency.vertex_to_vertex.end(k); ++i) { int neighbor = adjacency.vertex_to_vertex.index[i]; ... } */
+	struct mesh_adjacency
+	{
+		adjacency_csr vertex_to_vertex;
+		adjacency_csr vertex_to_face;
+		adjacency_csr face_to_face;
+
+		/** Build the three adjacencies. The buffers are reused if the structure is initialized again. */
+		void initialize(numarray_view<uint3 const> connectivity, int number_of_vertex);
+	};
+
+	/** Number of vertices indexed by the connectivity (largest index + 1) */
+	int number_of_vertex_in_connectivity(numarray_view<uint3 const> connectivity);
+}
@@ -0,0 +1,57 @@
+#include "cgp/01_base/base.hpp"
+#include "../mesh_adjacency.hpp"
+#include "../../mesh/mesh.hpp"
+
+
+namespace cgp_test {
+
+	static bool is_adjacent_list(cgp::adjacency_csr const& adjacency, int k, cgp::numarray<int> const& expected)
+	{
+		if (adjacency.number_of_adjacent(k) != expected.size())
+			return false;
+		for (int i = 0; i < expected.size(); ++i)
+			if (adjacency.index[adjacency.begin(k) + i] != expected[i])
+				return false;
+		return true;
+	}
+
+	void test_mesh_adjacency()
+	{
+		using cgp::numarray;
+		using cgp::uint3;
+
+		{
+			// Quad made of two triangles (0,1,2) and (0,2,3), vertex 4 is not indexed
+			numarray<uint3> connectivity = { uint3{0,1,2}, uint3{0,2,3} };
+
+			cgp::mesh_adjacency adjacency;
+			adjacency.initialize(connectivity, 5);
+
+			assert_cgp_no_msg(adjacency.vertex_to_vertex.size() == 5);
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_vertex, 0, { 1,2,3 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_vertex, 1, { 0,2 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_vertex, 2, { 0,1,3 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_vertex, 3, { 0,2 }));
+			assert_cgp_no_msg(adjacency.vertex_to_vertex.number_of_adjacent(4) == 0);
+
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_face, 0, { 0,1 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_face, 1, { 0 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.vertex_to_face, 3, { 1 }));
+			assert_cgp_no_msg(adjacency.vertex_to_face.number_of_adjacent(4) == 0);
+
+			assert_cgp_no_msg(adjacency.face_to_face.size() == 2);
+			assert_cgp_no_msg(is_adjacent_list(adjacency.face_to_face, 0, { 1 }));
+			assert_cgp_no_msg(is_adjacent_list(adjacency.face_to_face, 1, { 0 }));
+		}
+
+		{
+			// Single triangle indexing more vertices than there are triangles
+			numarray<uint3> connectivity = { uint3{3,5,4} };
+			numarray<numarray<int> > one_ring = cgp::connectivity_one_ring(connectivity);
+			assert_cgp_no_msg(one_ring.size() == 6);
+			assert_cgp_no_msg(one_ring[0].size() == 0);
+			assert_cgp_no_msg(one_ring[5].size() == 2);
+			assert_cgp_no_msg(one_ring[5][0] == 3 && one_ring[5][1] == 4);
+		}
+	}
+}
@@ -0,0 +1,456 @@
+#include "cgp/01_base/base.hpp"
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cgp
+{
+	namespace
+	{
+		// Axis aligned box stored as float arrays to be indexed by axis
+		struct bvh_box
+		{
+			float p_min[3];
+			float p_max[3];
+
+			void reset() {
+				for (int a = 0; a < 3; ++a) {
+					p_min[a] = std::numeric_limits<float>::max();
+					p_max[a] = -std::numeric_limits<float>::max();
+				}
+			}
+			void grow(float const* p) {
+				for (int a = 0; a < 3; ++a) {
+					p_min[a] = std::min(p_min[a], p[a]);
+					p_max[a] = std::max(p_max[a], p[a]);
+				}
+			}
+			void grow(bvh_box const& b) {
+				for (int a = 0; a < 3; ++a) {
+					p_min[a] = std::min(p_min[a], b.p_min[a]);
+					p_max[a] = std::max(p_max[a], b.p_max[a]);
+				}
+			}
+			// Half of the surface area (only used for comparisons)
+			float area() const {
+				float const dx = p_max[0] - p_min[0], dy = p_max[1] - p_min[1], dz = p_max[2] - p_min[2];
+				return (dx < 0) ? 0.0f : dx * dy + dy * dz + dz * dx;
+			}
+		};
+
+		int const bvh_bins_max = 32;
+		// Nodes deeper than this limit are split at the median to bound the depth of the tree (and the traversal stack)
+		int const bvh_depth_sah_max = 40;
+		int const bvh_stack_size = 128;
+		// Below these sizes, a node is processed by a single thread
+		int const bvh_parallel_subtree_min = 4096;
+		int const bvh_parallel_binning_min = 65536;
+
+		struct bvh_bins
+		{
+			bvh_box box[3][bvh_bins_max];
+			int count[3][bvh_bins_max];
+		};
+
+		// Top-down construction of the hierarchy
+		// A node covering n triangles is the root of a subtree of at most 2n-1 nodes. The descendants of each node are placed in a reserved
+		//  range of indices such that the subtrees can be built concurrently and independently of the threads. The nodes are compacted afterwards.
+		struct bvh_builder
+		{
+			bvh_box const* triangle_box;
+			vec3 const* centroid;
+			int* index;
+			bvh_node* node;
+			int leaf_size;
+			int bins;
+
+			// Bounding box of the triangles and of their centroids in [begin,end[
+			void bounds(int begin, int end, bvh_box& box, bvh_box& box_centroid, int threads) const
+			{
+				int const N = end - begin;
+				int const T = (threads > 1 && N >= bvh_parallel_binning_min) ? parallel_number_of_threads(N, threads) : 1;
+				std::vector<bvh_box> box_thread(2 * T);
+				parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int thread) {
+					bvh_box b, c; b.reset(); c.reset();
+					for (size_t k = k_begin; k < k_end; ++k) {
+						int const t = index[begin + k];
+						b.grow(triangle_box[t]);
+						c.grow(&centroid[t].x);
+					}
+					box_thread[2 * thread] = b;
+					box_thread[2 * thread + 1] = c;
+				});
+				box.reset(); box_centroid.reset();
+				for (int k = 0; k < T; ++k) {
+					box.grow(box_thread[2 * k]);
+					box_centroid.grow(box_thread[2 * k + 1]);
+				}
+			}
+
+			// Accumulate the triangles of [begin,end[ in the bins along the 3 axes
+			void binning(int begin, int end, bvh_box const& box_centroid, float const* scale, bvh_bins& result, int threads) const
+			{
+				int const N = end - begin;
+				int const T = (threads > 1 && N >= bvh_parallel_binning_min) ? parallel_number_of_threads(N, threads) : 1;
+				std::vector<bvh_bins> bins_thread(T);
+				parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int thread) {
+					bvh_bins& b = bins_thread[thread];
+					for (int a = 0; a < 3; ++a) {
+						for (int i = 0; i < bins; ++i) {
+							b.box[a][i].reset();
+							b.count[a][i] = 0;
+						}
+					}
+					for (size_t k = k_begin; k < k_end; ++k) {
+						int const t = index[begin + k];
+						for (int a = 0; a < 3; ++a) {
+							int const i = bin(centroid[t].at(a), box_centroid.p_min[a], scale[a]);
+							b.box[a][i].grow(triangle_box[t]);
+							b.count[a][i]++;
+						}
+					}
+				});
+				result = bins_thread[0];
+				for (int k = 1; k < T; ++k) {
+					for (int a = 0; a < 3; ++a) {
+						for (int i = 0; i < bins; ++i) {
+							result.box[a][i].grow(bins_thread[k].box[a][i]);
+							result.count[a][i] += bins_thread[k].count[a][i];
+						}
+					}
+				}
+			}
+
+			int bin(float c, float c_min, float scale) const {
+				int const i = int((c - c_min) * scale);
+				return std::min(std::max(i, 0), bins - 1);
+			}
+
+			// Build the subtree rooted at node k_node over the triangles [begin,end[, its descendants are stored from the index k_free
+			void build(int k_node, int begin, int end, int k_free, int depth, int threads)
+			{
+				int const N = end - begin;
+				bvh_box box, box_centroid;
+				bounds(begin, end, box, box_centroid, threads);
+
+				bvh_node& current = node[k_node];
+				current.p_min = { box.p_min[0], box.p_min[1], box.p_min[2] };
+				current.p_max = { box.p_max[0], box.p_max[1], box.p_max[2] };
+
+				float extent[3];
+				for (int a = 0; a < 3; ++a)
+					extent[a] = box_centroid.p_max[a] - box_centroid.p_min[a];
+				int const axis_largest = int(std::max_element(extent, extent + 3) - extent);
+
+				if (N <= leaf_size || extent[axis_largest] <= 0) {
+					// Leaf (also used when all the centroids are identical: no split can separate them)
+					current.first = begin;
+					current.count = N;
+					return;
+				}
+
+				int middle = begin;
+				if (depth < bvh_depth_sah_max)
+				{
+					float scale[3];
+					for (int a = 0; a < 3; ++a)
+						scale[a] = extent[a] > 0 ? bins * (1 - 1e-5f) / extent[a] : 0.0f;
+
+					bvh_bins b;
+					binning(begin, end, box_centroid, scale, b, threads);
+
+					// Sweep the bins from the right to store the cost of the right part, and from the left to evaluate the splits
+					float best_cost = std::numeric_limits<float>::max();
+					int best_axis = -1;
+					int best_split = 0;
+					for (int a = 0; a < 3; ++a) {
+						if (extent[a] <= 0)
+							continue;
+						float cost_right[bvh_bins_max];
+						bvh_box acc; acc.reset();
+						int count = 0;
+						for (int i = bins - 1; i > 0; --i) {
+							acc.grow(b.box[a][i]);
+							count += b.count[a][i];
+							cost_right[i] = count * acc.area();
+						}
+						acc.reset();
+						count = 0;
+						for (int i = 0; i < bins - 1; ++i) {
+							acc.grow(b.box[a][i]);
+							count += b.count[a][i];
+							float const cost = count * acc.area() + cost_right[i + 1];
+							if (count > 0 && count < N && cost < best_cost) {
+								best_cost = cost;
+								best_axis = a;
+								best_split = i + 1;
+							}
+						}
+					}
+
+					if (best_axis >= 0) {
+						float const c_min = box_centroid.p_min[best_axis];
+						float const s = scale[best_axis];
+						int const a = best_axis;
+						middle = int(std::partition(index + begin, index + end, [&](int t) { return bin(centroid[t].at(a), c_min, s) < best_split; }) - index);
+					}
+				}
+
+				if (middle <= begin || middle >= end) {
+					// Median split along the largest axis
+					middle = begin + N / 2;
+					int const a = axis_largest;
+					std::nth_element(index + begin, index + middle, index + end, [&](int t0, int t1) { return centroid[t0].at(a) < centroid[t1].at(a); });
+				}
+
+				int const N_left = middle - begin;
+				int const k_left = k_free;
+				int const k_right = k_free + 1;
+				int const k_free_left = k_free + 2;
+				int const k_free_right = k_free + 2 + 2 * (N_left - 1);
+				current.first = k_left;
+				current.count = 0;
+
+				if (threads > 1 && N >= bvh_parallel_subtree_min) {
+					int const threads_left = threads / 2;
+					int const threads_right = threads - threads_left;
+					parallel_for_chunk(2, 2, [&](size_t k, size_t, int) {
+						if (k == 0)
+							build(k_left, begin, middle, k_free_left, depth + 1, threads_left);
+						else
+							build(k_right, middle, end, k_free_right, depth + 1, threads_right);
+					});
+				}
+				else {
+					build(k_left, begin, middle, k_free_left, depth + 1, 1);
+					build(k_right, middle, end, k_free_right, depth + 1, 1);
+				}
+			}
+		};
+
+		// Slab test: return true if the ray enters the box before t_max, and store the entry parameter in t_enter
+		inline bool bvh_ray_box(bvh_node const& n, vec3 const& p, vec3 const& d_inv, float t_max, float& t_enter)
+		{
+			float const tx0 = (n.p_min.x - p.x) * d_inv.x, tx1 = (n.p_max.x - p.x) * d_inv.x;
+			float const ty0 = (n.p_min.y - p.y) * d_inv.y, ty1 = (n.p_max.y - p.y) * d_inv.y;
+			float const tz0 = (n.p_min.z - p.z) * d_inv.z, tz1 = (n.p_max.z - p.z) * d_inv.z;
+			float const t0 = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+			float const t1 = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), t_max));
+			t_enter = t0;
+			return t0 <= t1;
+		}
+
+		// Moller-Trumbore ray/triangle intersection with the triangle (a, a+e1, a+e2). Two-sided.
+		inline bool bvh_ray_triangle(vec3 const& p, vec3 const& d, vec3 const& a, vec3 const& e1, vec3 const& e2, float t_max, float& t, float& u, float& v)
+		{
+			vec3 const q = cross(d, e2);
+			float const det = dot(e1, q);
+			if (det == 0.0f)
+				return false;
+			float const det_inv = 1.0f / det;
+			vec3 const s = p - a;
+			u = dot(s, q) * det_inv;
+			if (u < 0.0f || u > 1.0f)
+				return false;
+			vec3 const r = cross(s, e1);
+			v = dot(d, r) * det_inv;
+			if (v < 0.0f || u + v > 1.0f)
+				return false;
+			t = dot(e2, r) * det_inv;
+			return t > 0.0f && t < t_max;
+		}
+
+		inline vec3 bvh_inverse_direction(vec3 const& d)
+		{
+			// Avoid infinite values (and NaN in the slab test) for axis aligned rays
+			float const eps = 1e-20f;
+			return { 1.0f / (std::abs(d.x) > eps ? d.x : std::copysign(eps, d.x)),
+				1.0f / (std::abs(d.y) > eps ? d.y : std::copysign(eps, d.y)),
+				1.0f / (std::abs(d.z) > eps ? d.z : std::copysign(eps, d.z)) };
+		}
+	}
+
+	void bvh_mesh::initialize(mesh const& m)
+	{
+		initialize(m.position, m.connectivity);
+	}
+
+	void bvh_mesh::initialize(numarray<vec3> const& position, numarray<uint3> const& connectivity)
+	{
+		assert_cgp(leaf_size >= 1, "leaf_size must be at least 1 (leaf_size=" + str(leaf_size) + ")");
+		assert_cgp(bins >= 2 && bins <= bvh_bins_max, "The number of bins must be in [2," + str(bvh_bins_max) + "] (bins=" + str(bins) + ")");
+
+		int const N = connectivity.size();
+		nodes.resize(0);
+		triangle_index.resize(N);
+		triangle_vertex.resize(3 * N);
+		if (N == 0)
+			return;
+
+		// Bounding box and centroid of each triangle
+		numarray<bvh_box> triangle_box;
+		numarray<vec3> centroid;
+		triangle_box.resize(N);
+		centroid.resize(N);
+		assert_cgp(number_of_vertex_in_connectivity(connectivity) <= position.size(), "The connectivity has an index larger than the number of vertices (" + str(position.size()) + ")");
+		parallel_for_chunk(N, number_of_threads, [&](size_t k_begin, size_t k_end, int) {
+			for (size_t k = k_begin; k < k_end; ++k) {
+				uint3 const& f = connectivity.at(int(k));
+				vec3 const& a = position.at(f.x);
+				vec3 const& b = position.at(f.y);
+				vec3 const& c = position.at(f.z);
+				bvh_box& box = triangle_box.at(int(k));
+				box.reset();
+				box.grow(&a.x); box.grow(&b.x); box.grow(&c.x);
+				centroid.at(int(k)) = (a + b + c) / 3.0f;
+				triangle_index.at(int(k)) = int(k);
+			}
+		});
+
+		// Build in a sparse array of 2N-1 nodes
+		numarray<bvh_node> node_sparse;
+		node_sparse.resize(2 * N - 1);
+		bvh_builder builder;
+		builder.triangle_box = triangle_box.data.data();
+		builder.centroid = centroid.data.data();
+		builder.index = triangle_index.data.data();
+		builder.node = node_sparse.data.data();
+		builder.leaf_size = leaf_size;
+		builder.bins = bins;
+		builder.build(0, 0, N, 1, 0, parallel_number_of_threads(N, number_of_threads));
+
+		// Compact the nodes in depth-first order (the two children of a node remain contiguous)
+		std::vector<int> stack; // pairs (index in node_sparse, index in nodes)
+		nodes.push_back(node_sparse.at(0));
+		stack.push_back(0); stack.push_back(0);
+		while (!stack.empty()) {
+			int const k_new = stack.back(); stack.pop_back();
+			int const k_sparse = stack.back(); stack.pop_back();
+			bvh_node const& n = node_sparse.at(k_sparse);
+			if (n.count > 0)
+				continue;
+			int const k_child = nodes.size();
+			nodes.push_back(node_sparse.at(n.first));
+			nodes.push_back(node_sparse.at(n.first + 1));
+			nodes.at(k_new).first = k_child;
+			stack.push_back(n.first + 1); stack.push_back(k_child + 1);
+			stack.push_back(n.first); stack.push_back(k_child);
+		}
+
+		// Copy the triangles in the order of the leaves
+		parallel_for_chunk(N, number_of_threads, [&](size_t k_begin, size_t k_end, int) {
+			for (size_t k = k_begin; k < k_end; ++k) {
+				uint3 const& f = connectivity.at(triangle_index.at(int(k)));
+				vec3 const& a = position.at(f.x);
+				triangle_vertex.at(3 * int(k)) = a;
+				triangle_vertex.at(3 * int(k) + 1) = position.at(f.y) - a;
+				triangle_vertex.at(3 * int(k) + 2) = position.at(f.z) - a;
+			}
+		});
+	}
+
+	bvh_intersection bvh_mesh::closest_hit(vec3 const& p_ray, vec3 const& d_ray, float t_max) const
+	{
+		bvh_intersection hit;
+		if (nodes.size() == 0)
+			return hit;
+
+		vec3 const d_inv = bvh_inverse_direction(d_ray);
+		int k_hit = -1;
+		float u_hit = 0, v_hit = 0;
+
+		int stack_node[bvh_stack_size];
+		float stack_t[bvh_stack_size];
+		int stack_size = 0;
+
+		float t_enter;
+		if (!bvh_ray_box(nodes.at(0), p_ray, d_inv, t_max, t_enter))
+			return hit;
+		stack_node[stack_size] = 0;
+		stack_t[stack_size++] = t_enter;
+
+		while (stack_size > 0)
+		{
+			--stack_size;
+			if (stack_t[stack_size] >= t_max) // The node was pushed before a closer hit was found
+				continue;
+			bvh_node const* n = &nodes.at(stack_node[stack_size]);
+
+			while (n->count == 0)
+			{
+				float t_left, t_right;
+				bool const hit_left = bvh_ray_box(nodes.at(n->first), p_ray, d_inv, t_max, t_left);
+				bool const hit_right = bvh_ray_box(nodes.at(n->first + 1), p_ray, d_inv, t_max, t_right);
+				if (hit_left && hit_right) {
+					// Visit the closest child first
+					int const k_near = t_left <= t_right ? n->first : n->first + 1;
+					stack_node[stack_size] = t_left <= t_right ? n->first + 1 : n->first;
+					stack_t[stack_size++] = std::max(t_left, t_right);
+					n = &nodes.at(k_near);
+				}
+				else if (hit_left)
+					n = &nodes.at(n->first);
+				else if (hit_right)
+					n = &nodes.at(n->first + 1);
+				else
+					break;
+			}
+
+			if (n->count > 0) {
+				for (int k = n->first; k < n->first + n->count; ++k) {
+					float t, u, v;
+					if (bvh_ray_triangle(p_ray, d_ray, triangle_vertex.at(3 * k), triangle_vertex.at(3 * k + 1), triangle_vertex.at(3 * k + 2), t_max, t, u, v)) {
+						t_max = t;
+						k_hit = k;
+						u_hit = u;
+						v_hit = v;
+					}
+				}
+			}
+		}
+
+		if (k_hit >= 0) {
+			hit.valid = true;
+			hit.triangle = triangle_index.at(k_hit);
+			hit.t = t_max;
+			hit.barycentric = { u_hit, v_hit };
+			hit.position = p_ray + t_max * d_ray;
+			hit.normal = normalize(cross(triangle_vertex.at(3 * k_hit + 1), triangle_vertex.at(3 * k_hit + 2)));
+		}
+		return hit;
+	}
+
+	bool bvh_mesh::any_hit(vec3 const& p_ray, vec3 const& d_ray, float t_max) const
+	{
+		if (nodes.size() == 0)
+			return false;
+
+		vec3 const d_inv = bvh_inverse_direction(d_ray);
+		int stack_node[bvh_stack_size];
+		int stack_size = 0;
+		stack_node[stack_size++] = 0;
+
+		while (stack_size > 0)
+		{
+			bvh_node const& n = nodes.at(stack_node[--stack_size]);
+			float t_enter;
+			if (!bvh_ray_box(n, p_ray, d_inv, t_max, t_enter))
+				continue;
+
+			if (n.count > 0) {
+				for (int k = n.first; k < n.first + n.count; ++k) {
+					float t, u, v;
+					if (bvh_ray_triangle(p_ray, d_ray, triangle_vertex.at(3 * k), triangle_vertex.at(3 * k + 1), triangle_vertex.at(3 * k + 2), t_max, t, u, v))
+						return true;
+				}
+			}
+			else {
+				stack_node[stack_size++] = n.first + 1;
+				stack_node[stack_size++] = n.first;
+			}
+		}
+		return false;
+	}
+}
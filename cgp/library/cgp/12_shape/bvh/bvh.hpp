@@ -0,0 +1,77 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <limits>
+
+namespace cgp
+{
+	/** Node of a bounding volume hierarchy (32 bytes)
+	* - Leaf (count>0): contains the triangles [first, first+count[ of bvh_mesh::triangle_index
+	* - Internal node (count=0): its two children are stored at the indices first and first+1 of bvh_mesh::nodes */
+	struct bvh_node
+	{
+		vec3 p_min;
+		int first = 0;
+		vec3 p_max;
+		int count = 0;
+	};
+
+	/** Result of a ray query on a bvh_mesh */
+	struct bvh_intersection
+	{
+		/** true if the ray hits a triangle */
+		bool valid = false;
+		/** Index of the hit triangle in the connectivity of the mesh */
+		int triangle = -1;
+		/** Parameter of the hit along the ray: position = p_ray + t*d_ray */
+		float t = 0.0f;
+		/** Barycentric coordinates (u,v) of the hit in the triangle (a,b,c): position = (1-u-v) a + u b + v c */
+		vec2 barycentric = { 0,0 };
+		/** Hit position */
+		vec3 position = { 0,0,0 };
+		/** Unit normal of the hit triangle (oriented by its winding, ie. normalize(cross(b-a,c-a))) */
+		vec3 normal = { 0,0,1 };
+	};
+
+	/** Bounding volume hierarchy over the triangles of a mesh, used to accelerate ray queries (picking, visibility, etc)
+	* The hierarchy is built top-down with a binned SAH (Surface Area Heuristic): at each node, the centroids of the triangles are binned along the 3 axes,
+	*  and the split minimizing area(left)*count(left) + area(right)*count(right) is selected.
+	* Large nodes are binned in parallel, and the two subtrees of a node are built in parallel as long as threads are available. The resulting hierarchy doesn't depend on the number of threads.
+	* The triangle vertices are copied in the order of the leaves: the hierarchy must be rebuilt (initialize) after modifying the positions of the mesh.
+	*
+	* Ex.
+	*   bvh_mesh bvh;
+	*   bvh.initialize(shape);
+	*   bvh_intersection hit = bvh.closest_hit(p_ray, d_ray);
+	*   if(hit.valid) { ... hit.triangle, hit.position ... } */
+	struct bvh_mesh
+	{
+		/** Maximal number of triangles in a leaf */
+		int leaf_size = 4;
+		/** Number of bins used to evaluate the SAH along each axis (between 2 and 32) */
+		int bins = 16;
+		/** Number of threads used by the build. 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+
+		/** Nodes of the hierarchy, the root is nodes[0]. Empty if the mesh has no triangle */
+		numarray<bvh_node> nodes;
+		/** Index of the triangles (in the connectivity) in the order of the leaves */
+		numarray<int> triangle_index;
+
+		/** Build the hierarchy over the triangles of the mesh */
+		void initialize(mesh const& m);
+		void initialize(numarray<vec3> const& position, numarray<uint3> const& connectivity);
+
+		/** Closest intersection between the ray p_ray + t d_ray, with 0 < t < t_max, and the triangles (triangles are two-sided) */
+		bvh_intersection closest_hit(vec3 const& p_ray, vec3 const& d_ray, float t_max = std::numeric_limits<float>::max()) const;
+		/** Return true as soon as an intersection with 0 < t < t_max is found (ex. shadow/visibility rays). Cheaper than closest_hit. */
+		bool any_hit(vec3 const& p_ray, vec3 const& d_ray, float t_max = std::numeric_limits<float>::max()) const;
+
+		/** Number of triangles in the hierarchy */
+		int size() const { return triangle_index.size(); }
+
+	private:
+		numarray<vec3> triangle_vertex; // (a, b-a, c-a) for each triangle in the order of triangle_index
+	};
+}
@@ -0,0 +1,173 @@
+#include "cgp/01_base/base.hpp"
+#include "cgp/08_random_noise/noise/noise.hpp"
+#include "heightfield_terrain.hpp"
+
+namespace cgp
+{
+	void heightfield_terrain::initialize(int2 const& samples_arg, vec2 const& p_min_arg, vec2 const& p_max_arg, vec2 const& uv_scale)
+	{
+		assert_cgp(samples_arg.x > 1 && samples_arg.y > 1, "The terrain must have at least 2 samples in each direction");
+		samples = samples_arg;
+		p_min = p_min_arg;
+		p_max = p_max_arg;
+
+		int const Nu = samples.x;
+		int const Nv = samples.y;
+		int const N = Nu * Nv;
+
+		shape.position.resize(N);
+		shape.normal.resize(N);
+		shape.color.resize(N);
+		shape.uv.resize(N);
+		for (int ku = 0; ku < Nu; ++ku) {
+			for (int kv = 0; kv < Nv; ++kv) {
+				vec2 const uv = { ku / (Nu - 1.0f), kv / (Nv - 1.0f) };
+				int const idx = index(ku, kv);
+				shape.position.at(idx) = { p_min.x + uv.x * (p_max.x - p_min.x), p_min.y + uv.y * (p_max.y - p_min.y), 0.0f };
+				shape.normal.at(idx) = { 0,0,1 };
+				shape.color.at(idx) = { 1,1,1 };
+				shape.uv.at(idx) = uv_scale * uv;
+			}
+		}
+
+		// Two triangles per grid cell
+		shape.connectivity.resize(2 * (Nu - 1) * (Nv - 1));
+		for (int ku = 0; ku < Nu - 1; ++ku) {
+			for (int kv = 0; kv < Nv - 1; ++kv) {
+				unsigned int const idx = static_cast<unsigned int>(index(ku, kv));
+				unsigned int const N_v = static_cast<unsigned int>(Nv);
+				int const k_tri = 2 * (kv + (Nv - 1) * ku);
+				shape.connectivity.at(k_tri) = uint3{ idx, idx + 1 + N_v, idx + 1 };
+				shape.connectivity.at(k_tri + 1) = uint3{ idx, idx + N_v, idx + 1 + N_v };
+			}
+		}
+	}
+
+	void heightfield_terrain::update(height_function const& height, color_function const& color)
+	{
+		update_height(height);
+		update_normal();
+		if (color)
+			update_color(color);
+	}
+
+	void heightfield_terrain::update_height(height_function const& height)
+	{
+		int const Nu = samples.x;
+		int const Nv = samples.y;
+		assert_cgp(shape.position.size() == Nu * Nv, "heightfield_terrain must be initialized before being updated");
+
+		parallel_for_chunk(Nu, number_of_threads, [&](size_t ku_begin, size_t ku_end, int) {
+			for (int ku = int(ku_begin); ku < int(ku_end); ++ku) {
+				for (int kv = 0; kv < Nv; ++kv) {
+					vec3& p = shape.position.at(index(ku, kv));
+					vec2 const uv = { ku / (Nu - 1.0f), kv / (Nv - 1.0f) };
+					p.z = height({ p.x, p.y }, uv);
+				}
+			}
+		});
+	}
+
+	void heightfield_terrain::update_height_noise_perlin(float terrain_height, int octave, float persistency, float frequency_gain)
+	{
+		int const Nu = samples.x;
+		int const Nv = samples.y;
+		assert_cgp(shape.position.size() == Nu * Nv, "heightfield_terrain must be initialized before being updated");
+
+		parallel_for_chunk(Nu, number_of_threads, [&](size_t ku_begin, size_t ku_end, int) {
+			// Buffers of one row, reused for all the rows of the chunk
+			numarray<vec2> uv_row;
+			numarray<float> noise_row;
+			uv_row.resize(Nv);
+			for (int ku = int(ku_begin); ku < int(ku_end); ++ku) {
+				for (int kv = 0; kv < Nv; ++kv)
+					uv_row.at(kv) = { ku / (Nu - 1.0f), kv / (Nv - 1.0f) };
+				noise_perlin(noise_row, uv_row, octave, persistency, frequency_gain);
+				for (int kv = 0; kv < Nv; ++kv)
+					shape.position.at(index(ku, kv)).z = terrain_height * noise_row.at(kv);
+			}
+		});
+	}
+
+	// Unit normal of the triangle (p0,p1,p2), or 0 if the triangle is degenerate (same computation as normal_per_vertex)
+	static vec3 triangle_unit_normal(vec3 const& p0, vec3 const& p1, vec3 const& p2)
+	{
+		vec3 const p10 = p1 - p0;
+		vec3 const p20 = p2 - p0;
+		float const L10 = norm(p10);
+		float const L20 = norm(p20);
+		if (L10 > 1e-6f && L20 > 1e-6f) {
+			vec3 const n = cross(p10 / L10, p20 / L20);
+			float const Ln = norm(n);
+			if (Ln > 1e-6f)
+				return n / Ln;
+		}
+		return { 0,0,0 };
+	}
+
+	void heightfield_terrain::update_normal()
+	{
+		int const Nu = samples.x;
+		int const Nv = samples.y;
+		assert_cgp(shape.position.size() == Nu * Nv, "heightfield_terrain must be initialized before being updated");
+		numarray<vec3> const& position = shape.position;
+		triangle_normal.resize(shape.connectivity.size());
+
+		// First pass: unit normal of each triangle
+		parallel_for_chunk(Nu - 1, number_of_threads, [&](size_t ku_begin, size_t ku_end, int) {
+			for (int ku = int(ku_begin); ku < int(ku_end); ++ku) {
+				for (int kv = 0; kv < Nv - 1; ++kv) {
+					int const k_tri = 2 * (kv + (Nv - 1) * ku);
+					uint3 const& f0 = shape.connectivity.at(k_tri);
+					uint3 const& f1 = shape.connectivity.at(k_tri + 1);
+					triangle_normal.at(k_tri) = triangle_unit_normal(position.at(get<0>(f0)), position.at(get<1>(f0)), position.at(get<2>(f0)));
+					triangle_normal.at(k_tri + 1) = triangle_unit_normal(position.at(get<0>(f1)), position.at(get<1>(f1)), position.at(get<2>(f1)));
+				}
+			}
+		});
+
+		// Second pass: each vertex gathers the normals of the (up to 6) triangles around it
+		//  the vertices are computed independently without write conflicts.
+		//  The triangles of the cell (ku,kv) are (00,11,01) and (00,10,11), where ij refers to the vertex (ku+i,kv+j).
+		parallel_for_chunk(Nu, number_of_threads, [&](size_t ku_begin, size_t ku_end, int) {
+			for (int ku = int(ku_begin); ku < int(ku_end); ++ku) {
+				for (int kv = 0; kv < Nv; ++kv) {
+					vec3 n = { 0,0,0 };
+					if (ku < Nu - 1 && kv < Nv - 1) { // cell (ku,kv): current vertex is 00
+						int const k_tri = 2 * (kv + (Nv - 1) * ku);
+						n += triangle_normal.at(k_tri) + triangle_normal.at(k_tri + 1);
+					}
+					if (ku < Nu - 1 && kv > 0) { // cell (ku,kv-1): current vertex is 01
+						n += triangle_normal.at(2 * (kv - 1 + (Nv - 1) * ku));
+					}
+					if (ku > 0 && kv < Nv - 1) { // cell (ku-1,kv): current vertex is 10
+						n += triangle_normal.at(2 * (kv + (Nv - 1) * (ku - 1)) + 1);
+					}
+					if (ku > 0 && kv > 0) { // cell (ku-1,kv-1): current vertex is 11
+						int const k_tri = 2 * (kv - 1 + (Nv - 1) * (ku - 1));
+						n += triangle_normal.at(k_tri) + triangle_normal.at(k_tri + 1);
+					}
+
+					float const L = norm(n);
+					shape.normal.at(index(ku, kv)) = L > 1e-6f ? n / L : n;
+				}
+			}
+		});
+	}
+
+	void heightfield_terrain::update_color(color_function const& color)
+	{
+		int const Nu = samples.x;
+		int const Nv = samples.y;
+		assert_cgp(shape.position.size() == Nu * Nv, "heightfield_terrain must be initialized before being updated");
+
+		parallel_for_chunk(Nu, number_of_threads, [&](size_t ku_begin, size_t ku_end, int) {
+			for (int ku = int(ku_begin); ku < int(ku_end); ++ku) {
+				for (int kv = 0; kv < Nv; ++kv) {
+					int const idx = index(ku, kv);
+					shape.color.at(idx) = color(shape.position.at(idx), shape.normal.at(idx));
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <functional>
+
+namespace cgp {
+
+	/** Terrain mesh defined as a heightfield z = h(x,y) sampled on a regular grid of (Nu,Nv) vertices over the rectangle [p_min,p_max].
+	* The terrain is computed in successive stages: height -> normal -> color. Each stage is computed in parallel over the rows of the grid
+	*  and overwrites the corresponding buffer of the mesh in place: the buffers are only allocated at initialization and are reused between updates.
+	*
+	* The vertex (ku,kv) is stored at index kv + Nv*ku and is placed at the local parametric coordinates (u,v) = (ku/(Nu-1), kv/(Nv-1)) \in [0,1]^2, 
+	*  ie. at the position (x,y) = p_min + (u,v)*(p_max-p_min).
+	* The triangles are oriented such that the normals point toward +z. */
+	struct heightfield_terrain
+	{
+		/** Number of samples (Nu,Nv) along the x and y directions */
+		int2 samples;
+		/** Extent of the terrain in the (x,y) plane */
+		vec2 p_min;
+		vec2 p_max;
+		/** Number of threads used by the update stages (the functions given to update must then be thread-safe). 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+
+		/** Mesh of the terrain. The uv and the connectivity are set at initialization, position/normal/color are updated in place. */
+		mesh shape;
+
+		/** Allocate the mesh of the terrain (flat terrain at z=0, white color). The texture coordinates are set to uv_scale*(u,v). */
+		void initialize(int2 const& samples, vec2 const& p_min, vec2 const& p_max, vec2 const& uv_scale = { 1.0f,1.0f });
+
+		/** Function returning the height z given the position p=(x,y) of the vertex and its local parametric coordinates (u,v) \in [0,1]^2 */
+		using height_function = std::function<float(vec2 const& p, vec2 const& uv)>;
+		/** Function returning the color of a vertex given its position and normal */
+		using color_function = std::function<vec3(vec3 const& position, vec3 const& normal)>;
+
+		/** Run all the stages: height, normal, and color (if a color function is given) */
+		void update(height_function const& height, color_function const& color = nullptr);
+
+		/** Set the z coordinate of the vertices to height(p,uv) */
+		void update_height(height_function const& height);
+		/** Set the z coordinate of the vertices to terrain_height * noise_perlin((u,v), octave, persistency, frequency_gain) 
+		*   The noise is evaluated row by row using the vectorized array version of noise_perlin. */
+		void update_height_noise_perlin(float terrain_height, int octave = 5, float persistency = 0.3f, float frequency_gain = 2.0f);
+		/** Compute the normals from the current positions (same result as normal_per_vertex, without concurrent accumulation on the vertices) */
+		void update_normal();
+		/** Set the color of the vertices to color(position, normal) */
+		void update_color(color_function const& color);
+
+		/** Index of the vertex (ku,kv) in the buffers of the mesh */
+		int index(int ku, int kv) const { return kv + samples.y * ku; }
+
+	private:
+		numarray<vec3> triangle_normal; // Scratch buffer storing the unit normal of each triangle
+	};
+
+}
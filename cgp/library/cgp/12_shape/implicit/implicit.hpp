@@ -1,3 +1,5 @@
 #pragma once
 
-#include "marching_cube/marching_cube.hpp"
\ No newline at end of file
+#include "marching_cube/marching_cube.hpp"
+#include "minmax_hierarchy/minmax_hierarchy.hpp"
+#include "implicit_surface_bricks/implicit_surface_bricks.hpp"
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "implicit_surface_bricks.hpp"
+
+#include "cgp/01_base/parallel/parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace cgp {
+
+	// Position and normal used for the unused vertices of a brick
+	static vec3 const degenerate_position = { 0,0,0 };
+	static vec3 const degenerate_normal = { 0,0,1 };
+
+
+	void implicit_surface_bricks::initialize(spatial_domain_grid_3D const& domain_arg, int brick_size_arg)
+	{
+		domain = domain_arg;
+		brick_size = brick_size_arg;
+
+		field.resize(domain.samples);
+		field.fill(0.0f);
+		gradient.resize(domain.samples);
+		gradient.fill({ 0,0,0 });
+		hierarchy.initialize(field, brick_size);
+
+		int3 const N = hierarchy.brick_dimension();
+		bricks.clear();
+		bricks.resize(N.x * N.y * N.z);
+
+		position.clear();
+		normal.clear();
+		modified_range.clear();
+		buffer_resized = true;
+		is_iso_valid = false;
+		number_of_wasted_vertex = 0;
+		updated_bricks = 0;
+	}
+
+	implicit_surface_bricks::brick_structure& implicit_surface_bricks::brick_at(int3 const& brick)
+	{
+		int3 const N = hierarchy.brick_dimension();
+		return bricks[brick.x + N.x * (brick.y + N.y * brick.z)];
+	}
+
+	void implicit_surface_bricks::set_dirty(vec3 const& p_min, vec3 const& p_max)
+	{
+		// Convert the spatial region to the range of samples it contains
+		vec3 const u_min = (p_min - domain.corner_min()) / domain.voxel_length();
+		vec3 const u_max = (p_max - domain.corner_min()) / domain.voxel_length();
+		int3 const N = hierarchy.brick_dimension();
+
+		int3 b_min, b_max;
+		for (int d = 0; d < 3; ++d) {
+			int const s_min = std::max(int(std::floor(u_min[d])), 0);
+			int const s_max = std::min(int(std::ceil(u_max[d])), domain.samples[d] - 1);
+			if (s_min > s_max)
+				return;
+			// A sample k belongs to the voxels k-1 and k, and therefore potentially to two bricks
+			b_min[d] = std::max(s_min - 1, 0) / brick_size;
+			b_max[d] = std::min(s_max / brick_size, N[d] - 1);
+		}
+
+		for (int bz = b_min.z; bz <= b_max.z; ++bz)
+			for (int by = b_min.y; by <= b_max.y; ++by)
+				for (int bx = b_min.x; bx <= b_max.x; ++bx)
+					brick_at({ bx,by,bz }).dirty = true;
+	}
+
+	void implicit_surface_bricks::set_dirty_all()
+	{
+		for (brick_structure& b : bricks)
+			b.dirty = true;
+	}
+
+	int implicit_surface_bricks::number_of_updated_bricks() const
+	{
+		return updated_bricks;
+	}
+
+	void implicit_surface_bricks::export_triangle_soup(std::vector<vec3>& position_soup, std::vector<vec3>& normal_soup) const
+	{
+		position_soup.clear();
+		normal_soup.clear();
+		for (brick_structure const& brick : bricks) {
+			position_soup.insert(position_soup.end(), position.begin() + brick.offset, position.begin() + brick.offset + brick.number_of_vertex);
+			normal_soup.insert(normal_soup.end(), normal.begin() + brick.offset, normal.begin() + brick.offset + brick.number_of_vertex);
+		}
+	}
+
+	void implicit_surface_bricks::owned_samples(int3 const& brick, int3& sample_begin, int3& sample_end) const
+	{
+		// Each sample is owned by a single brick: [brick*brick_size, (brick+1)*brick_size[, the last brick also owns the last sample
+		int3 const N = hierarchy.brick_dimension();
+		for (int d = 0; d < 3; ++d) {
+			sample_begin[d] = brick[d] * brick_size;
+			sample_end[d] = (brick[d] == N[d] - 1) ? domain.samples[d] : (brick[d] + 1) * brick_size;
+		}
+	}
+
+	void implicit_surface_bricks::update(std::function<float(vec3 const&)> const& field_function, float iso)
+	{
+		assert_cgp(bricks.size() > 0, "implicit_surface_bricks must be initialized before the update");
+		int3 const N = hierarchy.brick_dimension();
+
+		modified_range.clear();
+		buffer_resized = false;
+		updated_bricks = 0;
+
+		// List the dirty bricks, and mark for re-meshing their neighbors as they share samples and gradient values
+		std::vector<int3> bricks_dirty;
+		std::vector<char> to_remesh(bricks.size(), 0);
+		for (int bz = 0; bz < N.z; ++bz) {
+			for (int by = 0; by < N.y; ++by) {
+				for (int bx = 0; bx < N.x; ++bx) {
+					if (brick_at({ bx,by,bz }).dirty == false)
+						continue;
+					bricks_dirty.push_back({ bx,by,bz });
+					for (int kz = std::max(bz - 1, 0); kz <= std::min(bz + 1, N.z - 1); ++kz)
+						for (int ky = std::max(by - 1, 0); ky <= std::min(by + 1, N.y - 1); ++ky)
+							for (int kx = std::max(bx - 1, 0); kx <= std::min(bx + 1, N.x - 1); ++kx)
+								to_remesh[kx + N.x * (ky + N.y * kz)] = 1;
+				}
+			}
+		}
+
+		// Re-evaluate the field, and update the min/max values of the bricks
+		evaluate_field(bricks_dirty, field_function);
+		for (int3 const& b : bricks_dirty) {
+			int3 sample_begin, sample_end;
+			owned_samples(b, sample_begin, sample_end);
+			hierarchy.update(field, sample_begin, sample_end - int3{ 1,1,1 });
+			brick_at(b).dirty = false;
+		}
+
+		// A change of iso-value requires to re-mesh all the bricks that contain, or used to contain, the surface
+		bool const iso_changed = !is_iso_valid || iso != iso_previous;
+		iso_previous = iso;
+		is_iso_valid = true;
+
+		for (int bz = 0; bz < N.z; ++bz) {
+			for (int by = 0; by < N.y; ++by) {
+				for (int bx = 0; bx < N.x; ++bx) {
+					int const idx = bx + N.x * (by + N.y * bz);
+					if (to_remesh[idx])
+						evaluate_gradient({ bx,by,bz });
+				}
+			}
+		}
+
+		for (int bz = 0; bz < N.z; ++bz) {
+			for (int by = 0; by < N.y; ++by) {
+				for (int bx = 0; bx < N.x; ++bx) {
+					int const idx = bx + N.x * (by + N.y * bz);
+					if (iso_changed && to_remesh[idx] == 0) {
+						vec2 const& minmax = hierarchy.level[0].at_unsafe(bx, by, bz);
+						bool const contains_iso = minmax.x < iso && minmax.y >= iso;
+						to_remesh[idx] = contains_iso || bricks[idx].number_of_vertex > 0;
+					}
+					if (to_remesh[idx]) {
+						remesh({ bx,by,bz }, iso);
+						updated_bricks++;
+					}
+				}
+			}
+		}
+
+		// Reorganize the buffers when too much space is lost in unused ranges
+		if (number_of_wasted_vertex > 1024 && number_of_wasted_vertex > position.size() / 2)
+			compact();
+
+		// Merge the modified ranges
+		std::sort(modified_range.begin(), modified_range.end(), [](int2 const& a, int2 const& b) { return a.x < b.x; });
+		std::vector<int2> merged;
+		for (int2 const& r : modified_range) {
+			if (r.y <= r.x)
+				continue;
+			if (merged.size() > 0 && r.x <= merged.back().y)
+				merged.back().y = std::max(merged.back().y, r.y);
+			else
+				merged.push_back(r);
+		}
+		modified_range = merged;
+	}
+
+	void implicit_surface_bricks::evaluate_field(std::vector<int3> const& bricks_to_evaluate, std::function<float(vec3 const&)> const& field_function)
+	{
+		// The bricks own disjoint sets of samples and can be evaluated in parallel
+		parallel_for_chunk(bricks_to_evaluate.size(), number_of_threads, [&](size_t k_begin, size_t k_end, int) {
+			for (size_t k = k_begin; k < k_end; ++k) {
+				int3 sample_begin, sample_end;
+				owned_samples(bricks_to_evaluate[k], sample_begin, sample_end);
+				for (int kz = sample_begin.z; kz < sample_end.z; ++kz)
+					for (int ky = sample_begin.y; ky < sample_end.y; ++ky)
+						for (int kx = sample_begin.x; kx < sample_end.x; ++kx)
+							field.at_unsafe(kx, ky, kz) = field_function(domain.position({ kx,ky,kz }));
+			}
+		});
+	}
+
+	void implicit_surface_bricks::evaluate_gradient(int3 const& brick)
+	{
+		int const Nx = field.dimension.x;
+		int const Ny = field.dimension.y;
+		int const Nz = field.dimension.z;
+
+		// Finite differences: g(k) = f(k+1)-f(k) for k<N-1, and g(N-1) = f(N-1)-f(N-2)
+		int3 sample_begin, sample_end;
+		owned_samples(brick, sample_begin, sample_end);
+		for (int kz = sample_begin.z; kz < sample_end.z; ++kz) {
+			for (int ky = sample_begin.y; ky < sample_end.y; ++ky) {
+				for (int kx = sample_begin.x; kx < sample_end.x; ++kx) {
+					vec3& g = gradient.at_unsafe(kx, ky, kz);
+					float const f = field.at_unsafe(kx, ky, kz);
+					g.x = kx != Nx - 1 ? field.at_unsafe(kx + 1, ky, kz) - f : f - field.at_unsafe(kx - 1, ky, kz);
+					g.y = ky != Ny - 1 ? field.at_unsafe(kx, ky + 1, kz) - f : f - field.at_unsafe(kx, ky - 1, kz);
+					g.z = kz != Nz - 1 ? field.at_unsafe(kx, ky, kz + 1) - f : f - field.at_unsafe(kx, ky, kz - 1);
+				}
+			}
+		}
+	}
+
+	void implicit_surface_bricks::remesh(int3 const& brick_index, float iso)
+	{
+		brick_structure& brick = brick_at(brick_index);
+
+		// Extract the triangles of the brick
+		int3 voxel_begin, voxel_end;
+		hierarchy.brick_voxels(brick_index, voxel_begin, voxel_end);
+		int const N = int(marching_cube_block(position_brick, field.data.data, domain, iso, voxel_begin, voxel_end, 0, &relative_brick));
+
+		// Find the place to store the new vertices
+		int const N_previous = brick.number_of_vertex;
+		if (N > brick.capacity) {
+			// The previous range is lost, and a new range is allocated at the end of the buffer with some margin
+			fill_degenerate(brick.offset, brick.offset + N_previous);
+			modified_range.push_back({ brick.offset, brick.offset + N_previous });
+			number_of_wasted_vertex += brick.capacity;
+
+			brick.offset = position.size();
+			brick.capacity = N + 3 * (N / 6);
+			position.resize(brick.offset + brick.capacity);
+			normal.resize(brick.offset + brick.capacity);
+			fill_degenerate(brick.offset + N, brick.offset + brick.capacity);
+			buffer_resized = true;
+		}
+		else if (N < N_previous) {
+			fill_degenerate(brick.offset + N, brick.offset + N_previous);
+		}
+
+		// Write the new vertices and their normals (interpolated from the gradient)
+		float const sign = invert_normal ? 1.0f : -1.0f;
+		for (int k = 0; k < N; ++k) {
+			marching_cube_relative_coordinates const& r = relative_brick[k];
+			vec3 const& n0 = gradient.at_unsafe(r.k0);
+			vec3 const& n1 = gradient.at_unsafe(r.k1);
+
+			position.at(brick.offset + k) = position_brick[k];
+			normal.at(brick.offset + k) = sign * normalize((1 - r.alpha) * n0 + r.alpha * n1, { 1,0,0 });
+		}
+
+		modified_range.push_back({ brick.offset, brick.offset + std::max(N, N_previous) });
+		brick.number_of_vertex = N;
+	}
+
+	void implicit_surface_bricks::fill_degenerate(int begin, int end)
+	{
+		for (int k = begin; k < end; ++k) {
+			position.at(k) = degenerate_position;
+			normal.at(k) = degenerate_normal;
+		}
+	}
+
+	void implicit_surface_bricks::compact()
+	{
+		// Copy all the valid vertices contiguously, brick after brick, with some margin for each one
+		numarray<vec3> position_compact;
+		numarray<vec3> normal_compact;
+		int offset = 0;
+		for (brick_structure& brick : bricks) {
+			int const N = brick.number_of_vertex;
+			int const capacity = N + 3 * (N / 6);
+
+			position_compact.resize(offset + capacity);
+			normal_compact.resize(offset + capacity);
+			for (int k = 0; k < N; ++k) {
+				position_compact.at(offset + k) = position.at(brick.offset + k);
+				normal_compact.at(offset + k) = normal.at(brick.offset + k);
+			}
+			for (int k = N; k < capacity; ++k) {
+				position_compact.at(offset + k) = degenerate_position;
+				normal_compact.at(offset + k) = degenerate_normal;
+			}
+
+			brick.offset = offset;
+			brick.capacity = capacity;
+			offset += capacity;
+		}
+
+		position = position_compact;
+		normal = normal_compact;
+		number_of_wasted_vertex = 0;
+		buffer_resized = true;
+		modified_range.clear();
+		modified_range.push_back({ 0, int(position.size()) });
+	}
+
+}
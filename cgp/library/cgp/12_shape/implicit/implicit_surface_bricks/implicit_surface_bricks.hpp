@@ -0,0 +1,92 @@
+#pragma once
+
+#include "cgp/04_grid_container/grid/grid.hpp"
+#include "cgp/12_shape/spatial_domain/spatial_domain.hpp"
+#include "../marching_cube/marching_cube.hpp"
+#include "../minmax_hierarchy/minmax_hierarchy.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace cgp {
+
+	/** Implicit surface partitioned in bricks of voxels that can be updated incrementally.
+	* Only the bricks overlapping a region marked as dirty (set_dirty) are re-evaluated and re-meshed at the next call to update().
+	* 
+	* The triangles are stored as a soup in position/normal, where each brick owns a contiguous range of vertices (with some reserved capacity).
+	* Unused vertices of a range are degenerate triangles (3 vertices at the same position) that are not rasterized.
+	* After an update, only the ranges listed in modified_range have been changed (and can be sent to the GPU with partial VBO updates),
+	*  unless buffer_resized is true in which case the buffers have been reallocated and must be fully sent again. 
+	* The number of vertices to draw is position.size(). */
+	struct implicit_surface_bricks
+	{
+		/** Domain of the discrete field */
+		spatial_domain_grid_3D domain;
+		/** Number of voxels along each side of a brick */
+		int brick_size = 8;
+		/** Number of threads used to evaluate the field function (the function must then be thread-safe). 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 1;
+		/** The normals are set to -gradient by default (outward normals for fields with larger values inside the shape). Set to true for signed distance functions. */
+		bool invert_normal = false;
+
+		/** Discrete field and its gradient (finite differences) */
+		grid_3D<float> field;
+		grid_3D<vec3> gradient;
+		/** Min/max values of the field per brick (kept up-to-date with the field) */
+		minmax_hierarchy_grid_3D hierarchy;
+
+		/** Triangle soup of the surface */
+		numarray<vec3> position;
+		numarray<vec3> normal;
+
+		/** Ranges [begin, end[ of vertices of position/normal modified by the last update */
+		std::vector<int2> modified_range;
+		/** True if position/normal have been reallocated (size changed) by the last update */
+		bool buffer_resized = false;
+
+
+		/** Set the domain and the brick size. The full field is marked as dirty. */
+		void initialize(spatial_domain_grid_3D const& domain, int brick_size = 8);
+
+		/** Mark the region of space between p_min and p_max as dirty: the field has to be re-evaluated there at the next update */
+		void set_dirty(vec3 const& p_min, vec3 const& p_max);
+		/** Mark the full domain as dirty */
+		void set_dirty_all();
+
+		/** Re-evaluate the field in the dirty bricks, and re-extract the triangles in the bricks affected by the changes (or in all non-empty bricks if the iso-value changed) */
+		void update(std::function<float(vec3 const&)> const& field_function, float iso);
+
+		/** Number of bricks that were re-meshed by the last update */
+		int number_of_updated_bricks() const;
+
+		/** Copy the valid triangles (without the unused vertices) in a contiguous triangle soup */
+		void export_triangle_soup(std::vector<vec3>& position_soup, std::vector<vec3>& normal_soup) const;
+
+	private:
+		struct brick_structure {
+			int offset = 0;           // Index of the first vertex of the brick in position/normal
+			int capacity = 0;         // Number of vertices reserved for the brick
+			int number_of_vertex = 0; // Number of valid vertices of the brick
+			bool dirty = true;        // The field must be re-evaluated in the brick
+		};
+		std::vector<brick_structure> bricks; // bricks ordered as the finest level of the hierarchy
+		brick_structure& brick_at(int3 const& brick);
+
+		float iso_previous = 0.0f;
+		bool is_iso_valid = false;
+		int number_of_wasted_vertex = 0;
+		int updated_bricks = 0;
+
+		// Scratch buffers
+		std::vector<vec3> position_brick;
+		std::vector<marching_cube_relative_coordinates> relative_brick;
+
+		void owned_samples(int3 const& brick, int3& sample_begin, int3& sample_end) const;
+		void evaluate_field(std::vector<int3> const& bricks_to_evaluate, std::function<float(vec3 const&)> const& field_function);
+		void evaluate_gradient(int3 const& brick);
+		void remesh(int3 const& brick, float iso);
+		void fill_degenerate(int begin, int end);
+		void compact();
+	};
+
+}
@@ -2,16 +2,11 @@
 
 #include "cgp/09_geometric_transformation/interpolation/interpolation.hpp"
 #include "helper/marching_cubes_lut.hpp"
-#include <unordered_map>
+#include <algorithm>
 
 namespace cgp
 {
 
-	// Helper structure to hash a pair of index (a,b) as a unique number
-	struct hash_edge {
-		size_t operator()(std::pair<int, int> const& key) const;
-	};
-
 	// Helper structure to store voxels information
 	struct cube_parameters {
 		std::array<size_t, 8> index;
@@ -19,62 +14,75 @@ namespace cgp
 		std::array<vec3, 8>   position;
 	};
 
+	// Slot of the grid edge (k0,k1) in marching_cube_mesh_buffer::edge_vertex
+	//  Every edge is aligned with one axis and starts at the grid vertex min(k0,k1): its slot is 3*min(k0,k1)+axis.
+	static size_t edge_slot(marching_cube_relative_coordinates const& edge, size_t Nx)
+	{
+		size_t const k0 = std::min(edge.k0, edge.k1);
+		size_t const k1 = std::max(edge.k0, edge.k1);
+		size_t const axis = (k1 - k0 == 1) ? 0 : (k1 - k0 == Nx ? 1 : 2);
+		return 3 * k0 + axis;
+	}
+
 
 	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso)
+	{
+		mesh m;
+		marching_cube_mesh_buffer buffer;
+		marching_cube(m, field, domain, iso, buffer);
+		return m;
+	}
+
+	void marching_cube(mesh& m, grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso, marching_cube_mesh_buffer& buffer)
 	{
 		assert_cgp_no_msg(is_equal(field.dimension, domain.samples));
 
 		// Compute the marching cube
-		std::vector<vec3> position;
-		std::vector<marching_cube_relative_coordinates> relative;
-		int const N = marching_cube(position, field.data.data, domain, iso, &relative);
+		std::vector<vec3> const& position = buffer.position;
+		std::vector<marching_cube_relative_coordinates> const& relative = buffer.relative;
+		size_t const N = marching_cube(buffer.position, field.data.data, domain, iso, &buffer.relative);
 
+		// Each vertex lies on a grid edge that has its own slot storing the index of the welded vertex
+		size_t const Nx = domain.samples.x;
+		size_t const Ny = domain.samples.y;
+		size_t const Nz = domain.samples.z;
+		std::vector<int>& edge_vertex = buffer.edge_vertex;
+		if (edge_vertex.size() < 3 * Nx * Ny * Nz)
+			edge_vertex.resize(3 * Nx * Ny * Nz, -1);
 
 		// Compute the mesh with non-duplicated vertices
-		mesh m;
-		int const N_triangle = N / 3;
-
-		// Storage avoiding to duplicate vertices at the same position if they are on the same voxel edge
-		std::unordered_map<std::pair<int, int>, int, hash_edge> unique_edge;
+		size_t const N_triangle = N / 3;
+		m.position.resize(0);
+		m.connectivity.resize(N_triangle);
 
-		for (int k_tri = 0; k_tri < N_triangle; ++k_tri) {
+		for (size_t k_tri = 0; k_tri < N_triangle; ++k_tri) {
+			uint3& triangle_index = m.connectivity[k_tri];
+			for (size_t k = 0; k < 3; ++k) {
 
-			uint3 triangle_index;
-			for (int k = 0; k < 3; ++k) {
+				size_t const idx = 3 * k_tri + k;
 
-				int const idx = 3 * k_tri + k;
-
-				// The indices of the edge of the current vertex
-				std::pair<int, int> const edge = { relative[3 * k_tri+k].k0, relative[3 * k_tri+k].k1 };
-
-				// Check if this edge has already been encountered
-				auto const it = unique_edge.find(edge);
+				// The slot of the edge of the current vertex
+				int& slot = edge_vertex[edge_slot(relative[idx], Nx)];
 
 				// if it is a new edge, add this vertex as a new one in the mesh
-				if (it == unique_edge.end()) {
-					int const idx_new_vertex = m.position.size(); // create a new vertex index
-					triangle_index[k] = idx_new_vertex; // set the current index to the triangle connectivity
-					m.position.push_back(position[idx]); // add this vertex in the mesh
-					unique_edge[edge] = idx_new_vertex; // add the edge in the unique structure for further check
-				}
-				// if the edge has already been encountered - only reuse the index in the connectivity but do not add the vertex again
-				else {
-					int const idx_existing_vertex = it->second;   // the index that has already be defined
-					triangle_index[k] = idx_existing_vertex;      // set this existing index in the triangle connectivity
+				if (slot == -1) {
+					slot = m.position.size();
+					m.position.push_back(position[idx]);
 				}
+				// otherwise only reuse the index of the existing vertex in the connectivity
+				triangle_index[k] = slot;
 			}
-			m.connectivity.push_back(triangle_index); // add the new triangle
-			
-			
 		}
 
-		m.fill_empty_field();
-		return m;
-	}
+		// Reset the slots that have been used, so that the buffer can be reused at the next call
+		for (size_t k = 0; k < N; ++k)
+			edge_vertex[edge_slot(relative[k], Nx)] = -1;
 
-
-	size_t hash_edge::operator()(std::pair<int, int> const& key) const {
-		return std::hash<int>{}(key.first) ^ std::hash<int>{}(key.second);
+		// The per-vertex attributes are recomputed for the new vertices
+		m.normal.resize(0);
+		m.color.resize(0);
+		m.uv.resize(0);
+		m.fill_empty_field();
 	}
 
 
@@ -102,7 +110,7 @@ namespace cgp
 
 
 
-	size_t marching_cube(std::vector<vec3>& position, std::vector<float> const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative)
+	size_t marching_cube_block(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, int3 const& voxel_begin, int3 const& voxel_end, size_t counter_position, std::vector<marching_cube_relative_coordinates>* relative)
 	{
 		// Table of correspondance between the 256 type of cube and the edges on which new vertices are created
 		static std::array<std::array<int, 16>, 256> const triTable = marching_cube_lut_triTable();
@@ -121,8 +129,6 @@ namespace cgp
 		float const dy = 1 / (Ny - 1.0f);
 		float const dz = 1 / (Nz - 1.0f);
 
-		size_t counter_position = 0;
-
 		// Marching-Cube
 		// *************************** //
 		cube_parameters cube;
@@ -133,11 +139,11 @@ namespace cgp
 
 		bool exist_cube_value_positive;
 		bool exist_cube_value_negative;
-		for (size_t kz = 0; kz < Nz - 1; ++kz) {
+		for (size_t kz = voxel_begin.z; kz < size_t(voxel_end.z); ++kz) {
 			float const uz = kz * dz;
-			for (size_t ky = 0; ky < Ny - 1; ++ky) {
+			for (size_t ky = voxel_begin.y; ky < size_t(voxel_end.y); ++ky) {
 				float const uy = ky * dy;
-				for (size_t kx = 0; kx < Nx - 1; ++kx) {
+				for (size_t kx = voxel_begin.x; kx < size_t(voxel_end.x); ++kx) {
 					float const ux = kx * dx;
 
 					size_t const index_corner = kx + Nx * (ky + Ny * kz);
@@ -260,4 +266,76 @@ namespace cgp
 		return counter_position;
 
 	}
-}
\ No newline at end of file
+
+
+	size_t marching_cube(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative)
+	{
+		int3 const voxel_end = domain.samples - int3{ 1,1,1 };
+		return marching_cube_block(position, field, domain, iso, { 0,0,0 }, voxel_end, 0, relative);
+	}
+
+
+	size_t marching_cube(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, minmax_hierarchy_grid_3D const& hierarchy, std::vector<marching_cube_relative_coordinates>* relative)
+	{
+		assert_cgp(is_equal(hierarchy.field_dimension, domain.samples), "The min/max hierarchy doesn't correspond to the domain");
+
+		std::vector<int3> bricks;
+		hierarchy.active_bricks(iso, bricks);
+
+		size_t counter_position = 0;
+		for (int3 const& brick : bricks) {
+			int3 voxel_begin, voxel_end;
+			hierarchy.brick_voxels(brick, voxel_begin, voxel_end);
+			counter_position = marching_cube_block(position, field, domain, iso, voxel_begin, voxel_end, counter_position, relative);
+		}
+
+		return counter_position;
+	}
+
+
+	size_t marching_cube_parallel(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative, int number_of_threads)
+	{
+		size_t const Nz = domain.samples.z;
+		if (Nz < 2)
+			return 0;
+		size_t const N_slab = Nz - 1;
+
+		int const T = parallel_number_of_threads(N_slab, number_of_threads);
+		if (T <= 1)
+			return marching_cube(position, field, domain, iso, relative);
+
+		// Each thread generates the triangles of its own z-slab in a local buffer
+		std::vector<std::vector<vec3>> position_thread(T);
+		std::vector<std::vector<marching_cube_relative_coordinates>> relative_thread(relative != nullptr ? T : 0);
+		std::vector<size_t> counter_thread(T + 1, 0);
+
+		parallel_for_chunk(N_slab, T, [&](size_t kz_begin, size_t kz_end, int k_thread) {
+			std::vector<marching_cube_relative_coordinates>* relative_local = relative != nullptr ? &relative_thread[k_thread] : nullptr;
+			int3 const voxel_begin = { 0, 0, int(kz_begin) };
+			int3 const voxel_end = { domain.samples.x - 1, domain.samples.y - 1, int(kz_end) };
+			counter_thread[k_thread + 1] = marching_cube_block(position_thread[k_thread], field, domain, iso, voxel_begin, voxel_end, 0, relative_local);
+		});
+
+		// Prefix sum giving the offset of each slab in the final buffer
+		for (int k = 0; k < T; ++k)
+			counter_thread[k + 1] += counter_thread[k];
+		size_t const counter_position = counter_thread[T];
+
+		if (position.size() < counter_position)
+			position.resize(counter_position);
+		if (relative != nullptr && relative->size() < counter_position)
+			relative->resize(counter_position);
+
+		// Merge the local buffers - the slabs are ordered along z, so the result is the same as the serial marching cube
+		parallel_for_chunk(size_t(T), T, [&](size_t k_begin, size_t k_end, int) {
+			for (size_t k = k_begin; k < k_end; ++k) {
+				size_t const N_local = counter_thread[k + 1] - counter_thread[k];
+				std::copy(position_thread[k].begin(), position_thread[k].begin() + N_local, position.begin() + counter_thread[k]);
+				if (relative != nullptr)
+					std::copy(relative_thread[k].begin(), relative_thread[k].begin() + N_local, relative->begin() + counter_thread[k]);
+			}
+		});
+
+		return counter_position;
+	}
+}
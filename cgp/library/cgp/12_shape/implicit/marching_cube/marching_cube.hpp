@@ -3,6 +3,7 @@
 #include "cgp/04_grid_container/grid/grid.hpp"
 #include "cgp/11_mesh/mesh.hpp"
 #include "cgp/12_shape/spatial_domain/spatial_domain.hpp"
+#include "../minmax_hierarchy/minmax_hierarchy.hpp"
 
 namespace cgp {
 
@@ -17,9 +18,35 @@ namespace cgp {
 		float alpha;
 	};
 
+	/** Scratch buffers used to build a mesh from the marching cube. 
+	* Keep the same instance between successive calls (ex. animated field) to avoid re-allocations. */
+	struct marching_cube_mesh_buffer {
+		std::vector<vec3> position;                               // Triangle soup generated by the fast marching cube
+		std::vector<marching_cube_relative_coordinates> relative; // Edge of the grid on which each vertex lies
+		std::vector<int> edge_vertex;                             // Index of the mesh vertex associated to each grid edge (3 axis-aligned edges per grid vertex), -1 if none
+	};
+
+	/** Marching cube generating a mesh without duplicated vertices, re-using the mesh and the buffer allocated memory.
+	* The vertices are welded in linear time: each grid edge has its own vertex slot in the buffer. */
+	void marching_cube(mesh& m, grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso, marching_cube_mesh_buffer& buffer);
+
 	/** A fast marching cube that generate triangles in minimizing the number of resize of not needed. The vertices of the triangles are duplicated.
 	* - Return the actual number of valid vertices (that may be smaller than the size of the position)
 	* - If the parameter relative is not null, it is filled with the indices of the indice grid corresponding to the edge on which the vertex lie. 
 	* - Note: the parameters are set using row std::vector to handle possibly large mesh with indices using size_t instead of int */
-	size_t marching_cube(std::vector<vec3>& position, std::vector<float> const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative=nullptr);
+	size_t marching_cube(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative=nullptr);
+
+	/** Fast marching cube restricted to the voxels [voxel_begin, voxel_end[ of the domain.
+	* The new vertices are written from the index counter_position in position (and relative). Return the new number of valid vertices. */
+	size_t marching_cube_block(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, int3 const& voxel_begin, int3 const& voxel_end, size_t counter_position, std::vector<marching_cube_relative_coordinates>* relative=nullptr);
+
+	/** Fast marching cube skipping the empty regions of the field: only the bricks of the hierarchy whose range of values contains the iso-value are visited.
+	* - The generated triangles are the same as the full marching cube, but ordered brick by brick.
+	* - The hierarchy must have been initialized with the same field. It does not need to be rebuilt when the iso-value changes. */
+	size_t marching_cube(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, minmax_hierarchy_grid_3D const& hierarchy, std::vector<marching_cube_relative_coordinates>* relative=nullptr);
+
+	/** Multi-threaded version of the fast marching cube. The domain is split in slabs along z that are processed in parallel in per-thread buffers, then merged in the output.
+	* - The output (position, relative, returned number of vertices) is the same as the serial marching_cube.
+	* - number_of_threads<=0 uses the default number of hardware threads. */
+	size_t marching_cube_parallel(std::vector<vec3>& position, numarray<float>::container_type const& field, spatial_domain_grid_3D const& domain, float iso, std::vector<marching_cube_relative_coordinates>* relative=nullptr, int number_of_threads=0);
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "minmax_hierarchy.hpp"
+
+#include <algorithm>
+
+namespace cgp {
+
+	// Number of elements of the level above (ceil(N/2), at least 1)
+	static int3 parent_dimension(int3 const& N)
+	{
+		return { std::max((N.x + 1) / 2, 1), std::max((N.y + 1) / 2, 1), std::max((N.z + 1) / 2, 1) };
+	}
+
+	static bool contains_iso(vec2 const& minmax, float iso)
+	{
+		// Same convention as the marching cube: a voxel is crossed if it has at least a value < iso and a value >= iso
+		return minmax.x < iso && minmax.y >= iso;
+	}
+
+
+	void minmax_hierarchy_grid_3D::initialize(grid_3D<float> const& field, int brick_size_arg)
+	{
+		assert_cgp(brick_size_arg > 0, "Brick size must be strictly positive");
+		assert_cgp(field.dimension.x > 1 && field.dimension.y > 1 && field.dimension.z > 1, "Field must have at least 2 samples in each direction");
+
+		brick_size = brick_size_arg;
+		field_dimension = field.dimension;
+
+		// Allocate the levels
+		level.clear();
+		int3 N = brick_dimension();
+		level.push_back(grid_3D<vec2>(N));
+		while (N.x > 1 || N.y > 1 || N.z > 1) {
+			N = parent_dimension(N);
+			level.push_back(grid_3D<vec2>(N));
+		}
+
+		update(field, { 0,0,0 }, field.dimension - int3{ 1,1,1 });
+	}
+
+	void minmax_hierarchy_grid_3D::update(grid_3D<float> const& field, int3 const& sample_min, int3 const& sample_max)
+	{
+		assert_cgp(is_equal(field.dimension, field_dimension), "The hierarchy was built for a field with a different dimension");
+		assert_cgp_no_msg(level.size() > 0);
+
+		// A sample k belongs to the voxels k-1 and k, and therefore potentially to two bricks
+		int3 const N = brick_dimension();
+		int3 b_min, b_max;
+		for (int d = 0; d < 3; ++d) {
+			b_min[d] = std::max(sample_min[d] - 1, 0) / brick_size;
+			b_max[d] = std::min(sample_max[d] / brick_size, N[d] - 1);
+		}
+
+		for (int bz = b_min.z; bz <= b_max.z; ++bz)
+			for (int by = b_min.y; by <= b_max.y; ++by)
+				for (int bx = b_min.x; bx <= b_max.x; ++bx)
+					update_brick(field, { bx,by,bz });
+
+		// Propagate the modification to the coarser levels
+		for (int k_level = 1; k_level < int(level.size()); ++k_level) {
+			b_min = b_min / 2;
+			b_max = b_max / 2;
+			for (int bz = b_min.z; bz <= b_max.z; ++bz)
+				for (int by = b_min.y; by <= b_max.y; ++by)
+					for (int bx = b_min.x; bx <= b_max.x; ++bx)
+						update_node(k_level, { bx,by,bz });
+		}
+	}
+
+	int3 minmax_hierarchy_grid_3D::brick_dimension() const
+	{
+		int3 const N_voxel = field_dimension - int3{ 1,1,1 };
+		return { (N_voxel.x + brick_size - 1) / brick_size, (N_voxel.y + brick_size - 1) / brick_size, (N_voxel.z + brick_size - 1) / brick_size };
+	}
+
+	void minmax_hierarchy_grid_3D::brick_voxels(int3 const& brick, int3& voxel_begin, int3& voxel_end) const
+	{
+		for (int d = 0; d < 3; ++d) {
+			voxel_begin[d] = brick[d] * brick_size;
+			voxel_end[d] = std::min((brick[d] + 1) * brick_size, field_dimension[d] - 1);
+		}
+	}
+
+	void minmax_hierarchy_grid_3D::update_brick(grid_3D<float> const& field, int3 const& brick)
+	{
+		int3 voxel_begin, voxel_end;
+		brick_voxels(brick, voxel_begin, voxel_end);
+
+		// The samples of the brick include the upper corners of its last voxels
+		float v_min = field.at_unsafe(voxel_begin.x, voxel_begin.y, voxel_begin.z);
+		float v_max = v_min;
+		for (int kz = voxel_begin.z; kz <= voxel_end.z; ++kz) {
+			for (int ky = voxel_begin.y; ky <= voxel_end.y; ++ky) {
+				for (int kx = voxel_begin.x; kx <= voxel_end.x; ++kx) {
+					float const v = field.at_unsafe(kx, ky, kz);
+					v_min = std::min(v_min, v);
+					v_max = std::max(v_max, v);
+				}
+			}
+		}
+		level[0].at_unsafe(brick.x, brick.y, brick.z) = { v_min, v_max };
+	}
+
+	void minmax_hierarchy_grid_3D::update_node(int k_level, int3 const& node)
+	{
+		grid_3D<vec2> const& children = level[k_level - 1];
+		int3 const child_end = { std::min(2 * node.x + 2, children.dimension.x), std::min(2 * node.y + 2, children.dimension.y), std::min(2 * node.z + 2, children.dimension.z) };
+
+		vec2 minmax = children.at_unsafe(2 * node.x, 2 * node.y, 2 * node.z);
+		for (int kz = 2 * node.z; kz < child_end.z; ++kz) {
+			for (int ky = 2 * node.y; ky < child_end.y; ++ky) {
+				for (int kx = 2 * node.x; kx < child_end.x; ++kx) {
+					vec2 const& c = children.at_unsafe(kx, ky, kz);
+					minmax.x = std::min(minmax.x, c.x);
+					minmax.y = std::max(minmax.y, c.y);
+				}
+			}
+		}
+		level[k_level].at_unsafe(node.x, node.y, node.z) = minmax;
+	}
+
+	void minmax_hierarchy_grid_3D::active_bricks(float iso, std::vector<int3>& bricks) const
+	{
+		bricks.clear();
+		if (level.size() == 0)
+			return;
+		active_bricks_recursive(iso, int(level.size()) - 1, { 0,0,0 }, bricks);
+	}
+
+	void minmax_hierarchy_grid_3D::active_bricks_recursive(float iso, int k_level, int3 const& node, std::vector<int3>& bricks) const
+	{
+		if (contains_iso(level[k_level].at_unsafe(node.x, node.y, node.z), iso) == false)
+			return;
+
+		if (k_level == 0) {
+			bricks.push_back(node);
+			return;
+		}
+
+		int3 const& N = level[k_level - 1].dimension;
+		for (int kz = 2 * node.z; kz < std::min(2 * node.z + 2, N.z); ++kz)
+			for (int ky = 2 * node.y; ky < std::min(2 * node.y + 2, N.y); ++ky)
+				for (int kx = 2 * node.x; kx < std::min(2 * node.x + 2, N.x); ++kx)
+					active_bricks_recursive(iso, k_level - 1, { kx,ky,kz }, bricks);
+	}
+
+}
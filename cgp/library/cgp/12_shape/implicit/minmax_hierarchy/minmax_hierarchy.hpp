@@ -0,0 +1,46 @@
+#pragma once
+
+#include "cgp/04_grid_container/grid/grid.hpp"
+#include "cgp/05_vec/vec.hpp"
+
+#include <vector>
+
+namespace cgp {
+
+	/** Hierarchy of min/max values over a 3D scalar field used to skip empty regions during the marching cube.
+	* - The finest level stores the (min,max) values of the samples of each brick of brick_size^3 voxels.
+	* - Each coarser level stores the (min,max) values of 2x2x2 nodes of the previous level, until a single root node.
+	* The hierarchy does not depend on the iso-value: it can be reused for any iso-value without being rebuilt.
+	* When the field is modified locally, only the bricks covering the modified samples (and their parents) need to be updated. */
+	struct minmax_hierarchy_grid_3D
+	{
+		/** Number of voxels along each side of a brick at the finest level */
+		int brick_size = 8;
+		/** Dimension of the field (number of samples) used to build the hierarchy */
+		int3 field_dimension;
+		/** level[0] is the finest level (one node per brick), the last level is the root. Each node stores (min,max). */
+		std::vector<grid_3D<vec2>> level;
+
+		/** Build the full hierarchy from the field */
+		void initialize(grid_3D<float> const& field, int brick_size = 8);
+
+		/** Update the hierarchy after a modification of the field samples in the region [sample_min, sample_max] (bounds included) */
+		void update(grid_3D<float> const& field, int3 const& sample_min, int3 const& sample_max);
+
+		/** Number of bricks along each direction at the finest level */
+		int3 brick_dimension() const;
+
+		/** Voxel range [voxel_begin, voxel_end[ covered by a brick */
+		void brick_voxels(int3 const& brick, int3& voxel_begin, int3& voxel_end) const;
+
+		/** Fill the list of bricks whose range of values contains the iso-value (the only bricks that may contain part of the iso-surface)
+		* The traversal starts at the root and skips all the sub-trees that do not contain the iso-value. */
+		void active_bricks(float iso, std::vector<int3>& bricks) const;
+
+	private:
+		void update_brick(grid_3D<float> const& field, int3 const& brick);
+		void update_node(int k_level, int3 const& node);
+		void active_bricks_recursive(float iso, int k_level, int3 const& node, std::vector<int3>& bricks) const;
+	};
+
+}
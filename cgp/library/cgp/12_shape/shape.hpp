@@ -2,6 +2,9 @@
 
 #include "curve/curve.hpp"
 #include "bounding_box/bounding_box.hpp"
+#include "bvh/bvh.hpp"
+#include "heightfield_terrain/heightfield_terrain.hpp"
 #include "implicit/implicit.hpp"
 #include "intersection/intersection.hpp"
 #include "spatial_domain/spatial_domain.hpp"
+#include "spatial_hash_grid/spatial_hash_grid.hpp"
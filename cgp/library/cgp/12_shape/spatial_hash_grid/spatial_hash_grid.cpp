@@ -0,0 +1,154 @@
+#include "spatial_hash_grid.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace cgp
+{
+	void spatial_hash_grid::initialize(numarray<vec3> const& position, float radius_arg)
+	{
+		assert_cgp(radius_arg > 0, "The radius of the spatial_hash_grid must be strictly positive (radius=" + str(radius_arg) + ")");
+		radius = radius_arg;
+		update(position);
+	}
+
+	void spatial_hash_grid::update(numarray<vec3> const& position)
+	{
+		assert_cgp(radius > 0, "The spatial_hash_grid must be initialized with a strictly positive radius before being updated");
+
+		int const N = position.size();
+
+		// Bounding box of the points
+		int const T_box = parallel_number_of_threads(N, number_of_threads);
+		std::vector<vec3> box_thread(2 * T_box, N > 0 ? position.at(0) : vec3(0, 0, 0));
+		parallel_for_chunk(N, T_box, [&](size_t k_begin, size_t k_end, int thread) {
+			vec3& b_min = box_thread[2 * thread];
+			vec3& b_max = box_thread[2 * thread + 1];
+			for (size_t k = k_begin; k < k_end; ++k) {
+				vec3 const& q = position.at(int(k));
+				b_min = { std::min(b_min.x, q.x), std::min(b_min.y, q.y), std::min(b_min.z, q.z) };
+				b_max = { std::max(b_max.x, q.x), std::max(b_max.y, q.y), std::max(b_max.z, q.z) };
+			}
+		});
+		vec3 b_min = box_thread[0], b_max = box_thread[1];
+		for (int t = 1; t < T_box; ++t) {
+			b_min = { std::min(b_min.x, box_thread[2 * t].x), std::min(b_min.y, box_thread[2 * t].y), std::min(b_min.z, box_thread[2 * t].z) };
+			b_max = { std::max(b_max.x, box_thread[2 * t + 1].x), std::max(b_max.y, box_thread[2 * t + 1].y), std::max(b_max.z, box_thread[2 * t + 1].z) };
+		}
+		p_min = b_min;
+
+		// Cells indexed linearly if their number is at most a few times the number of points, hash table otherwise
+		int3 const c_max = cell(b_max);
+		double const N_cell = (c_max.x + 1.0) * (c_max.y + 1.0) * (c_max.z + 1.0);
+		int N_bucket = 1;
+		if (N_cell <= 8.0 * N + 64) {
+			dimension = { c_max.x + 1, c_max.y + 1, c_max.z + 1 };
+			N_bucket = dimension.x * dimension.y * dimension.z;
+		}
+		else {
+			dimension = { 0,0,0 };
+			while (N_bucket < N)
+				N_bucket *= 2;
+		}
+		offset.resize(N_bucket + 1);
+		point_bucket.resize(N);
+		index.resize(N);
+		position_sorted.resize(N);
+		if (N == 0) {
+			offset.fill(0);
+			return;
+		}
+
+		// Counting sort over contiguous chunks of points, one per thread:
+		//  - each thread computes the buckets of its points and counts them in its own histogram (row t of bucket_cursor)
+		//  - prefix sum over the (bucket, thread) pairs: the points of a bucket are stored chunk after chunk
+		//  - each thread scatters its points at the positions given by its histogram
+		//  The order of the points within a bucket is the order of their indices, whatever the number of threads.
+		//  The number of threads is limited so that the histograms stay comparable in size to the points.
+		int const T = std::max(1, std::min(parallel_number_of_threads(N, number_of_threads), int((16.0 * N) / N_bucket)));
+		bucket_cursor.resize(T * N_bucket);
+		parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int thread) {
+			int* count = bucket_cursor.data.data() + size_t(thread) * N_bucket;
+			std::fill(count, count + N_bucket, 0);
+			for (size_t k = k_begin; k < k_end; ++k) {
+				int const b = bucket(cell(position.at(int(k))));
+				point_bucket.at(int(k)) = b;
+				count[b]++;
+			}
+		});
+
+		// Prefix sum: the buckets are split in T ranges summed in parallel, then shifted by the total of the previous ranges
+		std::vector<int> count_range(T, 0);
+		parallel_for_chunk(N_bucket, T, [&](size_t b_begin, size_t b_end, int range) {
+			int sum = 0;
+			for (size_t b = b_begin; b < b_end; ++b)
+				for (int t = 0; t < T; ++t)
+					sum += bucket_cursor.at(int(t * N_bucket + b));
+			count_range[range] = sum;
+		});
+		std::vector<int> start_range(T, 0);
+		for (int t = 1; t < T; ++t)
+			start_range[t] = start_range[t - 1] + count_range[t - 1];
+
+		parallel_for_chunk(N_bucket, T, [&](size_t b_begin, size_t b_end, int range) {
+			int sum = start_range[range];
+			for (size_t b = b_begin; b < b_end; ++b) {
+				offset.at(int(b)) = sum;
+				for (int t = 0; t < T; ++t) {
+					int& c = bucket_cursor.at(int(t * N_bucket + b));
+					int const count = c;
+					c = sum;
+					sum += count;
+				}
+			}
+		});
+		offset.at(N_bucket) = N;
+
+		parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int thread) {
+			int* cursor = bucket_cursor.data.data() + size_t(thread) * N_bucket;
+			for (size_t k = k_begin; k < k_end; ++k) {
+				int const i = cursor[point_bucket.at(int(k))]++;
+				index.at(i) = int(k);
+				position_sorted.at(i) = position.at(int(k));
+			}
+		});
+	}
+
+	void spatial_hash_grid::neighbors(vec3 const& p, numarray<int>& result) const
+	{
+		result.resize(0);
+		for_each_neighbor(p, [&](int j) { result.push_back(j); });
+	}
+
+	void spatial_hash_grid::neighbors(adjacency_csr& result) const
+	{
+		int const N = index.size();
+		result.offset.resize(N + 1);
+
+		// Two passes over the points in the sorted order (better locality): count the neighbors, then fill the lists
+		parallel_for_chunk(N, number_of_threads, [&](size_t i_begin, size_t i_end, int) {
+			for (size_t i = i_begin; i < i_end; ++i) {
+				int const k = index.at(int(i));
+				int count = 0;
+				for_each_neighbor(position_sorted.at(int(i)), [&](int j) { count += (j != k); });
+				result.offset.at(k + 1) = count;
+			}
+		});
+
+		result.offset.at(0) = 0;
+		for (int k = 0; k < N; ++k)
+			result.offset.at(k + 1) += result.offset.at(k);
+		result.index.resize(result.offset.at(N));
+
+		parallel_for_chunk(N, number_of_threads, [&](size_t i_begin, size_t i_end, int) {
+			for (size_t i = i_begin; i < i_end; ++i) {
+				int const k = index.at(int(i));
+				int counter = result.offset.at(k);
+				for_each_neighbor(position_sorted.at(int(i)), [&](int j) {
+					if (j != k)
+						result.index.at(counter++) = j;
+				});
+			}
+		});
+	}
+}
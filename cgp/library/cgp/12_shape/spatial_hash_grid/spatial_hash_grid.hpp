@@ -0,0 +1,144 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cgp
+{
+	/** Uniform grid over a set of points (ex. particles) to find the neighbors of a point within a given radius
+	* The cells of the grid have the size of the radius. Each cell is associated to a bucket:
+	*  - When the number of cells covering the bounding box of the points is comparable to the number of points, the buckets are the cells indexed linearly (x first).
+	*    The points of neighboring cells are then close in memory (the 3 cells along x are contiguous).
+	*  - Otherwise (sparse points), the cells are mapped to a hash table of buckets.
+	* The points are sorted by bucket with a counting sort in O(N): the indices and a copy of the positions of the points of a bucket are contiguous in memory.
+	* The neighbors of a position are found by visiting the 27 cells around it and testing the distance to the points they contain.
+	* The build is parallel (the points are split in one chunk per thread, each thread counting and scattering its chunk), and gives the same result for any number of threads.
+	* The grid must be rebuilt (update) when the points move.
+	*
+	* Ex.
+	*   spatial_hash_grid grid;
+	*   grid.initialize(particle_position, radius);
+	*   grid.for_each_neighbor(p, [&](int j) { ... particle_position[j] is at a distance <= radius from p ... });
+	*   ...
+	*   grid.update(particle_position); // after the particles moved */
+	struct spatial_hash_grid
+	{
+		/** Radius of the neighborhood, and size of the cells */
+		float radius = 0.0f;
+		/** Number of threads used by the build and by neighbors(adjacency_csr&). 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+
+		/** Start of each bucket in index (size = number of buckets + 1) */
+		numarray<int> offset;
+		/** Indices of the points sorted by bucket */
+		numarray<int> index;
+		/** Positions of the points sorted by bucket: position_sorted[i] = position[index[i]] */
+		numarray<vec3> position_sorted;
+		/** Corner of the cell (0,0,0) (minimal corner of the bounding box of the points) */
+		vec3 p_min = { 0,0,0 };
+		/** Number of cells along each direction when the cells are indexed linearly, (0,0,0) when a hash table is used */
+		int3 dimension = { 0,0,0 };
+
+		/** Set the radius and build the grid */
+		void initialize(numarray<vec3> const& position, float radius);
+		/** Rebuild the grid from the new positions (the number of points may change) */
+		void update(numarray<vec3> const& position);
+
+		/** Call f(j) for each point j at a distance <= radius from p (in no particular order) */
+		template <typename F> void for_each_neighbor(vec3 const& p, F const& f) const;
+		/** Indices of the points at a distance <= radius from p */
+		void neighbors(vec3 const& p, numarray<int>& result) const;
+		/** Neighbors of all the points within radius (a point is not its own neighbor), computed in parallel
+		*  Each list is ordered as the points are visited by for_each_neighbor. */
+		void neighbors(adjacency_csr& result) const;
+
+		/** Integer coordinates of the cell containing p */
+		int3 cell(vec3 const& p) const;
+		/** Bucket associated to a cell (-1 for a cell outside the grid when the cells are indexed linearly) */
+		int bucket(int3 const& cell) const;
+		/** Number of points in the grid */
+		int size() const { return index.size(); }
+
+	private:
+		numarray<int> point_bucket;  // Bucket of each point
+		numarray<int> bucket_cursor; // Number of points, then insertion position, of each (thread, bucket) pair during the build
+	};
+}
+
+
+// Template implementation
+
+namespace cgp
+{
+	inline int3 spatial_hash_grid::cell(vec3 const& p) const
+	{
+		float const s = 1.0f / radius;
+		return { int(std::floor((p.x - p_min.x) * s)), int(std::floor((p.y - p_min.y) * s)), int(std::floor((p.z - p_min.z) * s)) };
+	}
+
+	inline int spatial_hash_grid::bucket(int3 const& c) const
+	{
+		if (dimension.x > 0) {
+			if (c.x < 0 || c.y < 0 || c.z < 0 || c.x >= dimension.x || c.y >= dimension.y || c.z >= dimension.z)
+				return -1;
+			return c.x + dimension.x * (c.y + dimension.y * c.z);
+		}
+
+		// The number of buckets of the hash table is a power of 2
+		unsigned int const h = (unsigned int)(c.x) * 73856093u ^ (unsigned int)(c.y) * 19349663u ^ (unsigned int)(c.z) * 83492791u;
+		return int(h & (unsigned int)(offset.size() - 2));
+	}
+
+	template <typename F>
+	void spatial_hash_grid::for_each_neighbor(vec3 const& p, F const& f) const
+	{
+		if (index.size() == 0)
+			return;
+		float const r2 = radius * radius;
+		int3 const c = cell(p);
+
+		auto visit = [&](int i_begin, int i_end) {
+			for (int i = i_begin; i < i_end; ++i) {
+				vec3 const d = position_sorted.at(i) - p;
+				if (d.x * d.x + d.y * d.y + d.z * d.z <= r2)
+					f(index.at(i));
+			}
+		};
+
+		if (dimension.x > 0) {
+			// Linear indexing: the cells (x-1,y,z), (x,y,z), (x+1,y,z) are contiguous buckets
+			int const x0 = std::max(c.x - 1, 0);
+			int const x1 = std::min(c.x + 1, dimension.x - 1);
+			if (x0 > x1)
+				return;
+			for (int z = std::max(c.z - 1, 0); z <= std::min(c.z + 1, dimension.z - 1); ++z) {
+				for (int y = std::max(c.y - 1, 0); y <= std::min(c.y + 1, dimension.y - 1); ++y) {
+					int const b = x0 + dimension.x * (y + dimension.y * z);
+					visit(offset.at(b), offset.at(b + x1 - x0 + 1));
+				}
+			}
+			return;
+		}
+
+		// Hash table: several cells can be mapped to the same bucket, each bucket is visited once
+		int visited[27];
+		int N_visited = 0;
+		for (int dx = -1; dx <= 1; ++dx) {
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dz = -1; dz <= 1; ++dz) {
+					int const b = bucket({ c.x + dx, c.y + dy, c.z + dz });
+					bool already_visited = false;
+					for (int k = 0; k < N_visited && !already_visited; ++k)
+						already_visited = (visited[k] == b);
+					if (already_visited)
+						continue;
+					visited[N_visited++] = b;
+					visit(offset.at(b), offset.at(b + 1));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#include "cgp/01_base/base.hpp"
+#include "../spatial_hash_grid.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+
+namespace cgp_test {
+
+	static float random_uniform(float a, float b)
+	{
+		return a + (b - a) * float(std::rand()) / float(RAND_MAX);
+	}
+
+	// Compare the neighbors found by the grid to a brute force search over all the points
+	static bool is_neighborhood_exact(cgp::spatial_hash_grid const& grid, cgp::numarray<cgp::vec3> const& position, cgp::numarray<cgp::vec3> const& queries)
+	{
+		float const r2 = grid.radius * grid.radius;
+		for (cgp::vec3 const& p : queries) {
+			cgp::numarray<int> found;
+			grid.neighbors(p, found);
+			std::vector<int> result(found.begin(), found.end());
+			std::sort(result.begin(), result.end());
+
+			std::vector<int> expected;
+			for (int k = 0; k < position.size(); ++k) {
+				cgp::vec3 const d = position[k] - p;
+				if (d.x * d.x + d.y * d.y + d.z * d.z <= r2)
+					expected.push_back(k);
+			}
+			if (result != expected)
+				return false;
+		}
+		return true;
+	}
+
+	void test_spatial_hash_grid()
+	{
+		// Dense points (cells indexed linearly) and sparse clusters (hash table)
+		for (int config = 0; config < 2; ++config) {
+			cgp::numarray<cgp::vec3> position;
+			for (int k = 0; k < 3000; ++k) {
+				cgp::vec3 p = { random_uniform(-1, 1), random_uniform(-1, 1), random_uniform(-1, 1) };
+				if (config == 1)
+					p = 0.05f * p + cgp::vec3{ 100.0f * (k % 3), -50.0f * (k % 5), 0.0f };
+				position.push_back(p);
+			}
+			float const radius = config == 0 ? 0.15f : 0.02f;
+
+			cgp::numarray<cgp::vec3> queries = position;
+			for (int k = 0; k < 200; ++k)
+				queries.push_back(position[k] + cgp::vec3{ random_uniform(-0.1f, 0.1f), random_uniform(-0.1f, 0.1f), random_uniform(-0.1f, 0.1f) });
+
+			cgp::spatial_hash_grid grid_sequential;
+			grid_sequential.number_of_threads = 1;
+			grid_sequential.initialize(position, radius);
+			assert_cgp_no_msg((grid_sequential.dimension.x > 0) == (config == 0));
+			assert_cgp_no_msg(is_neighborhood_exact(grid_sequential, position, queries));
+
+			// Same sorted points with several threads
+			cgp::spatial_hash_grid grid_parallel;
+			grid_parallel.number_of_threads = 4;
+			grid_parallel.initialize(position, radius);
+			assert_cgp_no_msg(is_equal(grid_parallel.index, grid_sequential.index));
+			assert_cgp_no_msg(is_equal(grid_parallel.offset, grid_sequential.offset));
+			assert_cgp_no_msg(is_neighborhood_exact(grid_parallel, position, queries));
+
+			// Update after the points moved
+			for (cgp::vec3& p : position)
+				p += cgp::vec3{ 0.3f, 0.0f, -0.2f } + 0.05f * cgp::vec3{ random_uniform(-1, 1), random_uniform(-1, 1), random_uniform(-1, 1) };
+			grid_parallel.update(position);
+			assert_cgp_no_msg(is_neighborhood_exact(grid_parallel, position, position));
+		}
+
+		// Empty set of points
+		cgp::spatial_hash_grid grid;
+		grid.initialize(cgp::numarray<cgp::vec3>(), 1.0f);
+		cgp::numarray<int> found;
+		grid.neighbors({ 0,0,0 }, found);
+		assert_cgp_no_msg(grid.size() == 0 && found.size() == 0);
+	}
+}
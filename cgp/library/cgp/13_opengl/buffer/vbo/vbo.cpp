@@ -6,95 +6,210 @@ namespace cgp
 {
 	static void warning_initialize_non_empty();
 
+	// Write the elements of data at the index index_offset of the bound VBO. Contiguous data is sent directly, strided data is packed by chunks in a staging buffer.
 	template <int N>
-	static GLuint opengl_buffer_data_initialize_generic(numarray<numarray_stack<float,N> > const& data, GLuint buffer_type, GLenum draw_type)
+	static void opengl_buffer_sub_data_generic(numarray_view<numarray_stack<float, N> const> data, int index_offset)
 	{
-		GLuint vbo_index;
-		glGenBuffers(1, &vbo_index);                                                       opengl_check;
-		glBindBuffer(buffer_type, vbo_index);                                              opengl_check;
-		glBufferData(buffer_type, GLsizeiptr(size_in_memory(data)), ptr(data), draw_type); opengl_check;
-		glBindBuffer(buffer_type, 0);                                                      opengl_check;
+		if (data.size() == 0)
+			return;
+		if (data.is_contiguous()) {
+			glBufferSubData(GL_ARRAY_BUFFER, N * sizeof(float) * index_offset, size_in_memory(data), ptr(data));  opengl_check;
+			return;
+		}
 
-		return vbo_index;
+		int const chunk_size = 4096;
+		numarray<numarray_stack<float, N> > staging;
+		staging.resize(std::min(chunk_size, data.size()));
+		for (int b = 0; b < data.size(); b += chunk_size) {
+			int const e = std::min(b + chunk_size, data.size());
+			for (int k = b; k < e; ++k)
+				staging.at(k - b) = data.at(k);
+			glBufferSubData(GL_ARRAY_BUFFER, N * sizeof(float) * (index_offset + b), N * sizeof(float) * (e - b), ptr(staging));  opengl_check;
+		}
 	}
 
-	void opengl_vbo_structure::initialize_data_on_gpu(numarray<vec3> const& data, GLuint div)
+	template <int N>
+	static void opengl_vbo_initialize_generic(opengl_vbo_structure& vbo, numarray_view<numarray_stack<float, N> const> data, GLuint div)
 	{
-		if(id!=0){
+		if (vbo.id != 0) {
 			warning_initialize_non_empty();
 		}
 
-		divisor = div;
-		id = opengl_buffer_data_initialize_generic(data, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
-		size = data.size();
-		type = GL_ARRAY_BUFFER;
+		vbo.divisor = div;
+		glGenBuffers(1, &vbo.id);                                                       opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo.id);                                          opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size_in_memory(data)), data.is_contiguous() ? ptr(data) : nullptr, GL_DYNAMIC_DRAW); opengl_check;
+		if (!data.is_contiguous())
+			opengl_buffer_sub_data_generic(data, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);                                               opengl_check;
+		vbo.size = data.size();
+		vbo.type = GL_ARRAY_BUFFER;
+
+		vbo.details.size_byte = size_in_memory(data);
+		vbo.details.size_element = N;
+		vbo.details.type_element = GL_FLOAT;
+	}
 
-		details.size_byte = size_in_memory(data);
-		details.size_element = 3;
-		details.type_element = GL_FLOAT;
+	template <int N>
+	static void opengl_vbo_update_generic(GLuint id, numarray_view<numarray_stack<float, N> const> data, int size_elements_update)
+	{
+		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		opengl_buffer_sub_data_generic(data.slice(0, size_elements_update == -1 ? data.size() : size_elements_update), 0);
 	}
-	void opengl_vbo_structure::initialize_data_on_gpu(numarray<vec2> const& data, GLuint div)
+
+	template <int N>
+	static void opengl_vbo_update_range_generic(GLuint id, numarray_view<numarray_stack<float, N> const> data, int index_begin, int index_end)
 	{
-		if(id!=0){
-			warning_initialize_non_empty();
-		}
+		assert_cgp(index_begin >= 0 && index_begin <= index_end && index_end <= data.size(), "Incorrect range to update the VBO");
+		if (index_end == index_begin)
+			return;
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		opengl_buffer_sub_data_generic(data.slice(index_begin, index_end), index_begin);
+	}
 
-		divisor = div;
-		id = opengl_buffer_data_initialize_generic(data, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
-		size = data.size();
-		type = GL_ARRAY_BUFFER;
+	template <int N>
+	static void opengl_vbo_update_sub_data_generic(opengl_vbo_structure const& vbo, numarray_view<numarray_stack<float, N> const> data, int index_offset)
+	{
+		assert_cgp(index_offset >= 0 && index_offset + data.size() <= vbo.size, "Cannot write " + str(data.size()) + " elements at the index " + str(index_offset) + " of a VBO of size " + str(vbo.size));
+		if (data.size() == 0)
+			return;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo.id); opengl_check;
+		opengl_buffer_sub_data_generic(data, index_offset);
+	}
 
-		details.size_byte = size_in_memory(data);
-		details.size_element = 2;
-		details.type_element = GL_FLOAT;
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_view<vec2 const> data, GLuint div)
+	{
+		opengl_vbo_initialize_generic(*this, data, div);
 	}
-	void opengl_vbo_structure::initialize_data_on_gpu(numarray<vec4> const& data, GLuint div)
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_view<vec3 const> data, GLuint div)
 	{
-		if(id!=0){
+		opengl_vbo_initialize_generic(*this, data, div);
+	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_view<vec4 const> data, GLuint div)
+	{
+		opengl_vbo_initialize_generic(*this, data, div);
+	}
+	void opengl_vbo_structure::update(numarray_view<vec2 const> data, int size_elements_update)
+	{
+		opengl_vbo_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update(numarray_view<vec3 const> data, int size_elements_update)
+	{
+		opengl_vbo_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update(numarray_view<vec4 const> data, int size_elements_update)
+	{
+		opengl_vbo_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update_range(numarray_view<vec2 const> data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_range_generic(id, data, index_begin, index_end);
+	}
+	void opengl_vbo_structure::update_range(numarray_view<vec3 const> data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_range_generic(id, data, index_begin, index_end);
+	}
+	void opengl_vbo_structure::update_range(numarray_view<vec4 const> data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_range_generic(id, data, index_begin, index_end);
+	}
+	void opengl_vbo_structure::update_sub_data(numarray_view<vec2 const> data, int index_offset)
+	{
+		opengl_vbo_update_sub_data_generic(*this, data, index_offset);
+	}
+	void opengl_vbo_structure::update_sub_data(numarray_view<vec3 const> data, int index_offset)
+	{
+		opengl_vbo_update_sub_data_generic(*this, data, index_offset);
+	}
+	void opengl_vbo_structure::update_sub_data(numarray_view<vec4 const> data, int index_offset)
+	{
+		opengl_vbo_update_sub_data_generic(*this, data, index_offset);
+	}
+
+	// Send the elements [index_begin, index_end[ of a SoA container to the bound VBO: each chunk is interleaved in a staging buffer that stays in cache, then sent with glBufferSubData
+	template <int N>
+	static void opengl_buffer_stream_soa_generic(numarray_soa<numarray_stack<float, N> > const& data, int index_begin, int index_end)
+	{
+		int const chunk_size = 4096;
+		numarray<numarray_stack<float, N> > staging;
+		staging.resize(std::min(chunk_size, index_end - index_begin));
+		for (int b = index_begin; b < index_end; b += chunk_size) {
+			int const e = std::min(b + chunk_size, index_end);
+			data.to_aos(staging.data.data(), b, e);
+			glBufferSubData(GL_ARRAY_BUFFER, N * sizeof(float) * b, N * sizeof(float) * (e - b), ptr(staging));  opengl_check;
+		}
+	}
+
+	template <int N>
+	static void opengl_vbo_initialize_soa_generic(opengl_vbo_structure& vbo, numarray_soa<numarray_stack<float, N> > const& data, GLuint div)
+	{
+		if (vbo.id != 0) {
 			warning_initialize_non_empty();
 		}
 
-		divisor = div;
-		id = opengl_buffer_data_initialize_generic(data, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
-		size = data.size();
-		type = GL_ARRAY_BUFFER;
+		vbo.divisor = div;
+		glGenBuffers(1, &vbo.id);                                                                opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo.id);                                                   opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size_in_memory(data)), nullptr, GL_DYNAMIC_DRAW); opengl_check;
+		opengl_buffer_stream_soa_generic(data, 0, data.size());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);                                                        opengl_check;
+		vbo.size = data.size();
+		vbo.type = GL_ARRAY_BUFFER;
+
+		vbo.details.size_byte = size_in_memory(data);
+		vbo.details.size_element = N;
+		vbo.details.type_element = GL_FLOAT;
+	}
 
-		details.size_byte = size_in_memory(data);
-		details.size_element = 4;
-		details.type_element = GL_FLOAT;
+	template <int N>
+	static void opengl_vbo_update_soa_generic(GLuint id, numarray_soa<numarray_stack<float, N> > const& data, int index_begin, int index_end)
+	{
+		assert_cgp(index_begin >= 0 && index_begin <= index_end && index_end <= data.size(), "Incorrect range to update the VBO");
+		if (index_end == index_begin)
+			return;
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		opengl_buffer_stream_soa_generic(data, index_begin, index_end);
+	}
+
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_soa<vec2> const& data, GLuint div)
+	{
+		opengl_vbo_initialize_soa_generic(*this, data, div);
+	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_soa<vec3> const& data, GLuint div)
+	{
+		opengl_vbo_initialize_soa_generic(*this, data, div);
+	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray_soa<vec4> const& data, GLuint div)
+	{
+		opengl_vbo_initialize_soa_generic(*this, data, div);
 	}
-	void opengl_vbo_structure::update(numarray<vec2> const& data, int size_elements_update)
+	void opengl_vbo_structure::update(numarray_soa<vec2> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
-		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
-		if (size_elements_update == -1) {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
-		}
-		else {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 2 * sizeof(float) * size_elements_update, ptr(data));  opengl_check;
-		}
+		opengl_vbo_update_soa_generic(id, data, 0, size_elements_update == -1 ? data.size() : size_elements_update);
 	}
-	void opengl_vbo_structure::update(numarray<vec3> const& data, int size_elements_update)
+	void opengl_vbo_structure::update(numarray_soa<vec3> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
-		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
-		if (size_elements_update == -1) {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
-		}
-		else {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 3 * sizeof(float) * size_elements_update, ptr(data));  opengl_check;
-		}
+		opengl_vbo_update_soa_generic(id, data, 0, size_elements_update == -1 ? data.size() : size_elements_update);
 	}
-	void opengl_vbo_structure::update(numarray<vec4> const& data, int size_elements_update)
+	void opengl_vbo_structure::update(numarray_soa<vec4> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
-		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
-		if (size_elements_update == -1) {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
-		}
-		else {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 4 * sizeof(float) * size_elements_update, ptr(data));  opengl_check;
-		}
+		opengl_vbo_update_soa_generic(id, data, 0, size_elements_update == -1 ? data.size() : size_elements_update);
+	}
+	void opengl_vbo_structure::update_range(numarray_soa<vec2> const& data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_soa_generic(id, data, index_begin, index_end);
+	}
+	void opengl_vbo_structure::update_range(numarray_soa<vec3> const& data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_soa_generic(id, data, index_begin, index_end);
+	}
+	void opengl_vbo_structure::update_range(numarray_soa<vec4> const& data, int index_begin, int index_end)
+	{
+		opengl_vbo_update_soa_generic(id, data, index_begin, index_end);
 	}
 
 
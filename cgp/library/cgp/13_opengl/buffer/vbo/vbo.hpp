@@ -11,17 +11,40 @@ namespace cgp
 {
 	struct opengl_vbo_structure : opengl_gpu_buffer
 	{
-		void initialize_data_on_gpu(numarray<vec3> const& data, GLuint divisor = 0);
-		void initialize_data_on_gpu(numarray<vec2> const& data, GLuint divisor = 0);
-		void initialize_data_on_gpu(numarray<vec4> const& data, GLuint divisor = 0);
+		/** The data is given as a view on contiguous (or strided) elements: a numarray, std::vector, or C array converts implicitly without copy */
+		void initialize_data_on_gpu(numarray_view<vec3 const> data, GLuint divisor = 0);
+		void initialize_data_on_gpu(numarray_view<vec2 const> data, GLuint divisor = 0);
+		void initialize_data_on_gpu(numarray_view<vec4 const> data, GLuint divisor = 0);
 
 		/** Re-write data on the VBO. (without re-allocation) in calling glBufferSubData
 		* - size_elements_update: 
 		*   number of elements to sent from data
 		*    -1: send all data (similar to data.size()) 	*/
-		void update(numarray<vec2> const& data, int size_elements_update = -1);
-		void update(numarray<vec3> const& data, int size_elements_update = -1);
-		void update(numarray<vec4> const& data, int size_elements_update = -1);
+		void update(numarray_view<vec2 const> data, int size_elements_update = -1);
+		void update(numarray_view<vec3 const> data, int size_elements_update = -1);
+		void update(numarray_view<vec4 const> data, int size_elements_update = -1);
+
+		/** Re-write only the elements [index_begin, index_end[ of the VBO from the same elements of data (without re-allocation) */
+		void update_range(numarray_view<vec2 const> data, int index_begin, int index_end);
+		void update_range(numarray_view<vec3 const> data, int index_begin, int index_end);
+		void update_range(numarray_view<vec4 const> data, int index_begin, int index_end);
+
+		/** Re-write the elements [index_offset, index_offset+data.size()[ of the VBO with all the elements of data (without re-allocation)
+		*  Ex. vbo.update_sub_data(numarray_view<vec3 const>(buffer, 64), 128); // 64 elements from any buffer written at the index 128 */
+		void update_sub_data(numarray_view<vec2 const> data, int index_offset);
+		void update_sub_data(numarray_view<vec3 const> data, int index_offset);
+		void update_sub_data(numarray_view<vec4 const> data, int index_offset);
+
+		/** Structure of arrays data: the elements are interleaved by chunks in a small staging buffer while they are sent to the GPU (no full-size AoS copy) */
+		void initialize_data_on_gpu(numarray_soa<vec2> const& data, GLuint divisor = 0);
+		void initialize_data_on_gpu(numarray_soa<vec3> const& data, GLuint divisor = 0);
+		void initialize_data_on_gpu(numarray_soa<vec4> const& data, GLuint divisor = 0);
+		void update(numarray_soa<vec2> const& data, int size_elements_update = -1);
+		void update(numarray_soa<vec3> const& data, int size_elements_update = -1);
+		void update(numarray_soa<vec4> const& data, int size_elements_update = -1);
+		void update_range(numarray_soa<vec2> const& data, int index_begin, int index_end);
+		void update_range(numarray_soa<vec3> const& data, int index_begin, int index_end);
+		void update_range(numarray_soa<vec4> const& data, int index_begin, int index_end);
 
 		GLuint divisor;
 	};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "timer_basic/timer_basic.hpp"
+#include "timer_benchmark/timer_benchmark.hpp"
 #include "timer_event_periodic/timer_event_periodic.hpp"
+#include "timer_fixed_step/timer_fixed_step.hpp"
+#include "timer_fixed_step_thread/timer_fixed_step_thread.hpp"
 #include "timer_fps/timer_fps.hpp"
 #include "timer_interval/timer_interval.hpp"
\ No newline at end of file
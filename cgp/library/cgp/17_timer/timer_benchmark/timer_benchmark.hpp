@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+
+namespace cgp
+{
+	/** Time in milliseconds of the fastest of several runs of a function (used by the benchmarks to reduce the noise of the measures)
+	* Ex.
+	*   double const t = time_best_ms([&]() { m = mesh_load_file_obj(filename); }, 3); */
+	template <typename F>
+	double time_best_ms(F const& f, int runs = 5)
+	{
+		double best = 0;
+		for (int k = 0; k < runs; ++k) {
+			auto const t0 = std::chrono::high_resolution_clock::now();
+			f();
+			auto const t1 = std::chrono::high_resolution_clock::now();
+			double const t = std::chrono::duration<double, std::milli>(t1 - t0).count();
+			if (k == 0 || t < best)
+				best = t;
+		}
+		return best;
+	}
+}
@@ -0,0 +1,48 @@
+#include "timer_fixed_step.hpp"
+
+#include <cmath>
+
+namespace cgp
+{
+
+    timer_fixed_step::timer_fixed_step(float step_arg, int substep_max_arg)
+        :timer_basic(), step(step_arg), substep_max(substep_max_arg), steps(0), alpha(0.0f), steps_dropped(0), accumulator(0.0f)
+    {
+    }
+
+    float timer_fixed_step::update()
+    {
+        float const dt = timer_basic::update();
+        accumulate(dt);
+        return dt;
+    }
+
+    int timer_fixed_step::accumulate(float dt)
+    {
+        steps = 0;
+        if (step <= 0) {
+            alpha = 0.0f;
+            return 0;
+        }
+
+        accumulator += dt > 0 ? dt : 0.0f;
+        int const N = static_cast<int>(std::floor(accumulator / step));
+        steps = N < substep_max ? N : (substep_max > 0 ? substep_max : 0);
+        accumulator -= steps * step;
+
+        // Drop the time that can't be simulated within the budget
+        if (accumulator >= step) {
+            int const dropped = static_cast<int>(std::floor(accumulator / step));
+            steps_dropped += dropped;
+            accumulator -= dropped * step;
+        }
+        if (accumulator < 0)
+            accumulator = 0;
+
+        alpha = accumulator / step;
+        if (alpha >= 1.0f)
+            alpha = 0.0f;
+        return steps;
+    }
+
+}
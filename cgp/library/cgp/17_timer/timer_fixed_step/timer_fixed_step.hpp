@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../timer_basic/timer_basic.hpp"
+
+namespace cgp
+{
+	/** Timer running a simulation with a fixed time step, independently of the display frame rate
+	* At each update, the elapsed (scaled) time is accumulated and converted into a number of fixed steps to run.
+	* The number of steps per update is limited to substep_max: when the simulation can't keep up with the real time, the remaining time is dropped (the simulation slows down instead of running always more steps per frame).
+	* alpha is the fraction of step left in the accumulator: the displayed state can be interpolated as (1-alpha) previous_state + alpha current_state.
+	*
+	* Ex.
+	*   timer.update();
+	*   for (int k = 0; k < timer.steps; ++k)
+	*       simulation_step(timer.step);
+	*/
+	class timer_fixed_step
+		: public timer_basic
+	{
+	public:
+
+		timer_fixed_step(float step=0.01f, int substep_max=10);
+		/** Accumulate the elapsed time and compute steps and alpha. Return the elapsed time. */
+		float update();
+		/** Accumulate a given elapsed time dt, compute alpha and return the number of steps to run (also stored in steps) */
+		int accumulate(float dt);
+
+		/** Duration of a simulation step */
+		float step;
+		/** Maximal number of steps per update */
+		int substep_max;
+
+		/** Number of steps to run after the last update */
+		int steps;
+		/** Fraction of step remaining after these steps, in [0,1[ */
+		float alpha;
+		/** Total number of steps dropped due to substep_max */
+		int steps_dropped;
+
+	protected:
+		float accumulator;
+	};
+
+}
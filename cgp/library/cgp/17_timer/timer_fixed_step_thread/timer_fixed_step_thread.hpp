@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../timer_fixed_step/timer_fixed_step.hpp"
+
+namespace cgp
+{
+	/** Run a fixed-step simulation on a worker thread, double-buffered against the display
+	* The worker owns the simulated state and advances it in real time (times scale) by steps of fixed duration, with at most substep_max steps per wake-up.
+	* After each batch of steps, the state and the state before the last step are copied into a display buffer: read() copies them for the display without blocking the simulation during the draw.
+	* Changes to the state requested by the display thread (ex. user interaction) are queued with modify() and applied by the worker between two steps.
+	* STATE is any copyable type (ex. a struct of numarray<vec3>).
+	* Without thread support (Emscripten without pthread), no thread is started and read() runs the pending steps on the calling thread.
+	*
+	* Ex.
+	*   timer_fixed_step_thread<particles_state> simulation;
+	*   simulation.start(initial_state, [](particles_state& s, float dt) { ... });
+	*   ...
+	*   simulation.read(previous, current, alpha); // display (1-alpha) previous + alpha current
+	*/
+	template <typename STATE>
+	class timer_fixed_step_thread
+	{
+	public:
+		timer_fixed_step_thread(float step = 0.01f, int substep_max = 10);
+		~timer_fixed_step_thread();
+
+		/** Start the simulation from the initial state (stop a previous one) */
+		void start(STATE const& initial_state, std::function<void(STATE&, float)> const& simulation_step);
+		/** Stop and join the worker thread. The last state remains available with read(). */
+		void stop();
+		bool running() const { return is_running; }
+
+		/** Copy the last published state. Return true if it changed since the previous read. */
+		bool read(STATE& current);
+		/** Copy the last two published states and the interpolation factor between them (time elapsed since the publication, in step units, clamped to 1) */
+		bool read(STATE& previous, STATE& current, float& alpha);
+		/** Queue a modification of the state, applied on the worker thread before the next step */
+		void modify(std::function<void(STATE&)> const& f);
+
+		/** Duration of a step and maximal number of steps per wake-up: set before start() */
+		float step;
+		int substep_max;
+		/** Time scale (can be changed while running, 0 pauses the simulation) */
+		std::atomic<float> scale;
+		/** Number of steps computed and dropped since start() */
+		std::atomic<int> steps_total;
+		std::atomic<int> steps_dropped;
+
+	private:
+		using clock = std::chrono::steady_clock;
+		void run();
+		void advance();
+
+		std::function<void(STATE&, float)> simulation_step;
+		STATE state;            // Owned by the worker
+		STATE state_previous;   // Owned by the worker
+		STATE front;            // Published, protected by mutex
+		STATE front_previous;   // Published, protected by mutex
+		clock::time_point front_time;
+		bool front_changed = false;
+		std::vector<std::function<void(STATE&)>> pending;
+
+		timer_fixed_step scheduler;
+		clock::time_point time_previous;
+		std::mutex mutex;
+		std::thread worker;
+		std::atomic<bool> is_running;
+		std::atomic<bool> quit;
+	};
+}
+
+
+// Template implementation
+
+namespace cgp
+{
+	template <typename STATE>
+	timer_fixed_step_thread<STATE>::timer_fixed_step_thread(float step_arg, int substep_max_arg)
+		: step(step_arg), substep_max(substep_max_arg), scale(1.0f), steps_total(0), steps_dropped(0), is_running(false), quit(false)
+	{}
+
+	template <typename STATE>
+	timer_fixed_step_thread<STATE>::~timer_fixed_step_thread()
+	{
+		stop();
+	}
+
+	template <typename STATE>
+	void timer_fixed_step_thread<STATE>::start(STATE const& initial_state, std::function<void(STATE&, float)> const& simulation_step_arg)
+	{
+		stop();
+		simulation_step = simulation_step_arg;
+		state = initial_state;
+		state_previous = initial_state;
+		front = initial_state;
+		front_previous = initial_state;
+		front_changed = true;
+		pending.clear();
+		steps_total = 0;
+		steps_dropped = 0;
+
+		scheduler = timer_fixed_step(step, substep_max);
+		time_previous = clock::now();
+		front_time = time_previous;
+		quit = false;
+		is_running = true;
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+		worker = std::thread([this]() { run(); });
+#endif
+	}
+
+	template <typename STATE>
+	void timer_fixed_step_thread<STATE>::stop()
+	{
+		quit = true;
+		if (worker.joinable())
+			worker.join();
+		is_running = false;
+	}
+
+	template <typename STATE>
+	void timer_fixed_step_thread<STATE>::advance()
+	{
+		clock::time_point const now = clock::now();
+		float const dt = scale * std::chrono::duration<float>(now - time_previous).count();
+		time_previous = now;
+
+		int const N = scheduler.accumulate(dt);
+		steps_dropped = scheduler.steps_dropped;
+
+		std::vector<std::function<void(STATE&)>> modifications;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			modifications.swap(pending);
+		}
+		for (auto const& f : modifications)
+			f(state);
+		if (N == 0 && modifications.empty())
+			return;
+
+		for (int k = 0; k < N; ++k) {
+			if (k == N - 1)
+				state_previous = state;
+			simulation_step(state, step);
+		}
+		steps_total += N;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (N > 0)
+			std::swap(front_previous, state_previous);
+		front = state;
+		front_time = clock::now();
+		front_changed = true;
+	}
+
+	template <typename STATE>
+	void timer_fixed_step_thread<STATE>::run()
+	{
+		while (!quit) {
+			advance();
+
+			// Sleep until the next step is due (at most one step of real time, to react to changes of scale and to stop())
+			float const s = scale;
+			float wait = step;
+			if (s > 0)
+				wait = (1.0f - scheduler.alpha) * step / s;
+			if (wait > step)
+				wait = step;
+			if (wait > 0)
+				std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+		}
+	}
+
+	template <typename STATE>
+	bool timer_fixed_step_thread<STATE>::read(STATE& current)
+	{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+		if (is_running)
+			advance();
+#endif
+		std::lock_guard<std::mutex> lock(mutex);
+		bool const changed = front_changed;
+		current = front;
+		front_changed = false;
+		return changed;
+	}
+
+	template <typename STATE>
+	bool timer_fixed_step_thread<STATE>::read(STATE& previous, STATE& current, float& alpha)
+	{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+		if (is_running)
+			advance();
+#endif
+		std::lock_guard<std::mutex> lock(mutex);
+		bool const changed = front_changed;
+		previous = front_previous;
+		current = front;
+		front_changed = false;
+
+		alpha = 1.0f;
+		if (step > 0) {
+			alpha = scale * std::chrono::duration<float>(clock::now() - front_time).count() / step;
+			alpha = alpha < 0 ? 0.0f : (alpha > 1 ? 1.0f : alpha);
+		}
+		return changed;
+	}
+
+	template <typename STATE>
+	void timer_fixed_step_thread<STATE>::modify(std::function<void(STATE&)> const& f)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.push_back(f);
+	}
+}
@@ -2,4 +2,5 @@
 
 #include "picking_structure/picking_structure.hpp"
 #include "picking_spheres/picking_spheres.hpp"
+#include "picking_mesh/picking_mesh.hpp"
 #include "picking_plane/picking_plane.hpp"
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "picking_mesh.hpp"
+
+namespace cgp
+{
+	picking_structure picking_mesh(vec2 const& screen_click, mesh const& m, bvh_mesh const& bvh, camera_generic_base const& camera, camera_projection_perspective const& projection)
+	{
+		picking_structure picking;
+
+		picking.ray_direction = camera_ray_direction(camera.matrix_frame(), projection.matrix_inverse(), screen_click);
+		picking.ray_origin = camera.position();
+		picking.screen_clicked = screen_click;
+
+		bvh_intersection const intersection = bvh.closest_hit(picking.ray_origin, picking.ray_direction);
+
+		if (intersection.valid == true) {
+			picking.active = true;
+			picking.index = intersection.triangle;
+			picking.position = intersection.position;
+			picking.normal = intersection.normal;
+
+			if (m.normal.size() == m.position.size()) {
+				uint3 const& f = m.connectivity[intersection.triangle];
+				float const u = intersection.barycentric.x;
+				float const v = intersection.barycentric.y;
+				vec3 const n = (1 - u - v) * m.normal[f.x] + u * m.normal[f.y] + v * m.normal[f.z];
+				if (norm(n) > 1e-6f)
+					picking.normal = normalize(n);
+			}
+		}
+
+		return picking;
+	}
+}
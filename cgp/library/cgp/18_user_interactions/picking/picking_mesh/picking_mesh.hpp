@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../picking_structure/picking_structure.hpp"
+#include "cgp/11_mesh/mesh.hpp"
+#include "cgp/12_shape/bvh/bvh.hpp"
+#include "cgp/10_camera_model/camera_model.hpp"
+
+namespace cgp
+{
+	/** Picking of the closest triangle of a mesh, using a bvh_mesh built on the same mesh (bvh.initialize(m))
+	* picking.index is the index of the picked triangle in m.connectivity. 
+	* picking.normal is interpolated from the vertex normals of the mesh if they are available, otherwise it is the normal of the triangle. */
+	picking_structure picking_mesh(vec2 const& screen_click, mesh const& m, bvh_mesh const& bvh, camera_generic_base const& camera, camera_projection_perspective const& projection);
+}
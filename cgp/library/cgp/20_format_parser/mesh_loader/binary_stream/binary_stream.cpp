@@ -0,0 +1,166 @@
+#include "binary_stream.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cgp
+{
+namespace loader
+{
+	binary_file_reader::binary_file_reader(std::string const& filename, size_t buffer_size)
+		: stream(filename, std::ios::binary), buffer(std::max(buffer_size, size_t(64)))
+	{
+		if (stream.is_open()) {
+			stream.seekg(0, std::ios::end);
+			std::streamoff const size = stream.tellg();
+			stream.seekg(0, std::ios::beg);
+			file_size = size > 0 ? uint64_t(size) : 0;
+		}
+	}
+
+	bool binary_file_reader::is_open() const
+	{
+		return stream.is_open();
+	}
+
+	bool binary_file_reader::fill(size_t N)
+	{
+		if (end - begin >= N)
+			return true;
+
+		// Move the remaining bytes at the beginning of the buffer, and complete it from the file
+		size_t const remaining = end - begin;
+		if (begin > 0 && remaining > 0)
+			std::memmove(buffer.data(), buffer.data() + begin, remaining);
+		begin = 0;
+		end = remaining;
+		if (N > buffer.size())
+			buffer.resize(N);
+
+		while (end < N && stream) {
+			stream.read(buffer.data() + end, std::streamsize(buffer.size() - end));
+			end += size_t(stream.gcount());
+		}
+		return end >= N;
+	}
+
+	char const* binary_file_reader::read(size_t N)
+	{
+		// Sizes read in the file itself may be arbitrary large: check them before growing the buffer
+		if (N > remaining() || !fill(N))
+			return nullptr;
+		char const* p = buffer.data() + begin;
+		begin += N;
+		consumed += N;
+		return p;
+	}
+
+	bool binary_file_reader::skip(size_t N)
+	{
+		while (N > 0) {
+			size_t const n = std::min(N, buffer.size());
+			if (read(n) == nullptr)
+				return false;
+			N -= n;
+		}
+		return true;
+	}
+
+	bool binary_file_reader::read_line(std::string& line)
+	{
+		line.clear();
+		while (true) {
+			if (begin == end && !fill(1))
+				return line.size() > 0;
+			char const* const first = buffer.data() + begin;
+			char const* const last = buffer.data() + end;
+			char const* const eol = std::find(first, last, '\n');
+			line.append(first, eol);
+			size_t const n = size_t(eol - first) + (eol != last ? 1 : 0);
+			begin += n;
+			consumed += n;
+			if (eol != last) {
+				if (line.size() > 0 && line.back() == '\r')
+					line.pop_back();
+				return true;
+			}
+		}
+	}
+
+	uint64_t binary_file_reader::position() const
+	{
+		return consumed;
+	}
+
+	uint64_t binary_file_reader::remaining() const
+	{
+		return consumed < file_size ? file_size - consumed : 0;
+	}
+
+
+	binary_file_writer::binary_file_writer(std::string const& filename_arg, size_t buffer_size)
+		: filename(filename_arg), stream(filename_arg, std::ios::binary), buffer(std::max(buffer_size, size_t(64)))
+	{}
+
+	binary_file_writer::~binary_file_writer()
+	{
+		if (stream.is_open()) {
+			flush();
+			stream.close();
+		}
+	}
+
+	bool binary_file_writer::is_open() const
+	{
+		return stream.is_open();
+	}
+
+	void binary_file_writer::flush()
+	{
+		if (end > 0)
+			stream.write(buffer.data(), std::streamsize(end));
+		end = 0;
+	}
+
+	char* binary_file_writer::write(size_t N)
+	{
+		if (end + N > buffer.size()) {
+			flush();
+			if (N > buffer.size())
+				buffer.resize(N);
+		}
+		char* p = buffer.data() + end;
+		end += N;
+		return p;
+	}
+
+	void binary_file_writer::write(void const* data, size_t N)
+	{
+		std::memcpy(write(N), data, N);
+	}
+
+	void binary_file_writer::close()
+	{
+		assert_cgp(stream.is_open(), "Cannot write file " + filename);
+		flush();
+		stream.close();
+		assert_cgp(!stream.fail(), "Error while writing file " + filename);
+	}
+
+	bool host_is_little_endian()
+	{
+		uint32_t const value = 1;
+		char first_byte;
+		std::memcpy(&first_byte, &value, 1);
+		return first_byte == 1;
+	}
+
+	void swap_bytes(char* data, size_t element_size, size_t N)
+	{
+		for (size_t k = 0; k < N; ++k, data += element_size)
+			std::reverse(data, data + element_size);
+	}
+}
+}
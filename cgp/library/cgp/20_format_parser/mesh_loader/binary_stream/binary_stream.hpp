@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+namespace loader
+{
+	/** Sequential reader of a binary file through a fixed size buffer (the memory used doesn't depend on the size of the file)
+	* Ex.
+	*   binary_file_reader reader("mesh.stl");
+	*   char const* record = reader.read(50); // pointer to the next 50 bytes of the file, valid until the next call to read/skip */
+	struct binary_file_reader
+	{
+		explicit binary_file_reader(std::string const& filename, size_t buffer_size = 1024 * 1024);
+
+		bool is_open() const;
+		/** Pointer to the next N contiguous bytes of the file (the buffer grows if N is larger than its size). Returns nullptr if the end of the file is reached first (the buffer never grows beyond the size of the file). */
+		char const* read(size_t N);
+		/** Skip the next N bytes. Returns false if the end of the file is reached first. */
+		bool skip(size_t N);
+		/** Read the next line (without the end of line character). Returns false at the end of the file. */
+		bool read_line(std::string& line);
+		/** Number of bytes already read */
+		uint64_t position() const;
+		/** Number of bytes left to read */
+		uint64_t remaining() const;
+
+	private:
+		std::ifstream stream;
+		std::vector<char> buffer;
+		size_t begin = 0;
+		size_t end = 0;
+		uint64_t consumed = 0;
+		uint64_t file_size = 0;
+
+		// Make sure that at least N bytes are available after begin
+		bool fill(size_t N);
+	};
+
+	/** Sequential writer of a binary file through a fixed size buffer flushed to the file when it is full */
+	struct binary_file_writer
+	{
+		explicit binary_file_writer(std::string const& filename, size_t buffer_size = 1024 * 1024);
+		~binary_file_writer();
+
+		bool is_open() const;
+		/** Pointer to N bytes to be filled, written after the previous ones (valid until the next call to write) */
+		char* write(size_t N);
+		void write(void const* data, size_t N);
+		/** Flush the buffer and close the file (stops with an error message if the file could not be written) */
+		void close();
+
+	private:
+		std::string filename;
+		std::ofstream stream;
+		std::vector<char> buffer;
+		size_t end = 0;
+
+		void flush();
+	};
+
+	bool host_is_little_endian();
+	/** Reverse the order of the bytes of each element of an array (N elements of element_size bytes) */
+	void swap_bytes(char* data, size_t element_size, size_t N = 1);
+}
+}
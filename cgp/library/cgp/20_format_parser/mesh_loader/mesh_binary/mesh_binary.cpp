@@ -0,0 +1,437 @@
+#include "mesh_binary.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace cgp
+{
+namespace mesh_binary
+{
+	static char const magic_value[8] = { 'C','G','P','M','E','S','H','\0' };
+	static uint32_t const endianness_value = 0x01020304;
+	static size_t const element_size[number_of_block] = { sizeof(vec3), sizeof(vec3), sizeof(vec3), sizeof(vec2), sizeof(uint3) };
+
+	static size_t aligned_size(size_t size)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	static inline uint64_t rotate_left(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+	static inline uint64_t mix(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	// Incremental hash: 4 independent lanes of 8-byte words (the multiplications of the lanes overlap), combined at the end
+	struct hasher
+	{
+		uint64_t lane[4] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull };
+		char tail[32];
+		size_t tail_size = 0;
+		uint64_t total_size = 0;
+
+		void add_block(char const* p)
+		{
+			for (int k = 0; k < 4; ++k) {
+				uint64_t w;
+				std::memcpy(&w, p + 8 * k, 8);
+				lane[k] = rotate_left(lane[k] ^ (w * 0x87C37B91114253D5ull), 31) * 0x4CF5AD432745937Full;
+			}
+		}
+
+		void add(char const* data, size_t size)
+		{
+			total_size += size;
+			if (tail_size > 0) {
+				size_t const n = std::min(size, 32 - tail_size);
+				std::memcpy(tail + tail_size, data, n);
+				tail_size += n;
+				data += n;
+				size -= n;
+				if (tail_size < 32)
+					return;
+				add_block(tail);
+				tail_size = 0;
+			}
+			for (; size >= 32; data += 32, size -= 32)
+				add_block(data);
+			std::memcpy(tail, data, size);
+			tail_size = size;
+		}
+
+		uint64_t value() const
+		{
+			uint64_t h = total_size;
+			for (int k = 0; k < 4; ++k)
+				h = mix(h ^ lane[k]);
+			for (size_t k = 0; k < tail_size; ++k)
+				h = mix(h ^ (uint64_t(uint8_t(tail[k])) << (8 * (k % 8))) ^ k);
+			return h;
+		}
+	};
+
+	uint64_t hash(char const* data, size_t size)
+	{
+		hasher h;
+		h.add(data, size);
+		return h.value();
+	}
+
+	source_information source_information_of_file(std::string const& filename)
+	{
+		source_information info;
+		info.size = file_get_size(filename);
+		info.modification_time = file_get_modification_time(filename);
+		file_map const file(filename);
+		info.hash = hash(file.data(), file.size());
+		return info;
+	}
+
+	static char const* block_data(mesh const& m, int block)
+	{
+		switch (block) {
+		case block_position: return reinterpret_cast<char const*>(m.position.data.data());
+		case block_normal: return reinterpret_cast<char const*>(m.normal.data.data());
+		case block_color: return reinterpret_cast<char const*>(m.color.data.data());
+		case block_uv: return reinterpret_cast<char const*>(m.uv.data.data());
+		default: return reinterpret_cast<char const*>(m.connectivity.data.data());
+		}
+	}
+	static size_t block_count(mesh const& m, int block)
+	{
+		switch (block) {
+		case block_position: return m.position.data.size();
+		case block_normal: return m.normal.data.size();
+		case block_color: return m.color.data.size();
+		case block_uv: return m.uv.data.size();
+		default: return m.connectivity.data.size();
+		}
+	}
+
+	// Write the file, return an error message (empty on success)
+	static std::string write_file(std::string const& filename, std::vector<mesh> const& meshes, std::vector<std::string> const& names, source_information const& source)
+	{
+		if (names.size() != 0 && names.size() != meshes.size())
+			return "The number of names (" + str(names.size()) + ") differs from the number of meshes (" + str(meshes.size()) + ")";
+
+		size_t const N_mesh = meshes.size();
+		std::vector<entry> entries(N_mesh);
+
+		// Layout: header, entries, names, blocks
+		size_t offset = sizeof(header) + N_mesh * sizeof(entry);
+		for (size_t k = 0; k < N_mesh; ++k) {
+			entries[k].name_offset = offset;
+			entries[k].name_size = names.size() > 0 ? names[k].size() : 0;
+			offset += size_t(entries[k].name_size);
+		}
+		for (size_t k = 0; k < N_mesh; ++k) {
+			for (int b = 0; b < number_of_block; ++b) {
+				offset = aligned_size(offset);
+				entries[k].block_offset[b] = offset;
+				entries[k].block_count[b] = block_count(meshes[k], b);
+				offset += size_t(entries[k].block_count[b]) * element_size[b];
+			}
+		}
+		size_t const file_size = aligned_size(offset);
+
+		// Write in a temporary file renamed at the end: an interrupted write never leaves an incomplete file with the final name
+		std::string const temporary_filename = filename + ".tmp";
+		std::ofstream stream(temporary_filename, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+			return "Cannot open the file " + temporary_filename + " for writing";
+
+		header h;
+		std::memset(&h, 0, sizeof(header));
+		stream.write(reinterpret_cast<char const*>(&h), sizeof(header));
+
+		hasher checksum;
+		size_t position = sizeof(header);
+		auto write = [&](char const* data, size_t size) {
+			stream.write(data, std::streamsize(size));
+			checksum.add(data, size);
+			position += size;
+		};
+		char const padding[alignment] = {};
+		auto pad_to = [&](size_t target) {
+			write(padding, target - position);
+		};
+
+		write(reinterpret_cast<char const*>(entries.data()), N_mesh * sizeof(entry));
+		for (size_t k = 0; k < names.size(); ++k)
+			write(names[k].data(), names[k].size());
+		for (size_t k = 0; k < N_mesh; ++k) {
+			for (int b = 0; b < number_of_block; ++b) {
+				pad_to(size_t(entries[k].block_offset[b]));
+				write(block_data(meshes[k], b), size_t(entries[k].block_count[b]) * element_size[b]);
+			}
+		}
+		pad_to(file_size);
+
+		std::memcpy(h.magic, magic_value, sizeof(magic_value));
+		h.version = version;
+		h.endianness = endianness_value;
+		h.number_of_mesh = uint32_t(N_mesh);
+		h.loader = source.loader;
+		h.loader_revision = source.loader_revision;
+		h.file_size = file_size;
+		h.checksum = checksum.value();
+		h.source_size = source.size;
+		h.source_modification_time = source.modification_time;
+		h.source_hash = source.hash;
+		stream.seekp(0);
+		stream.write(reinterpret_cast<char const*>(&h), sizeof(header));
+		stream.close();
+		if (!stream) {
+			std::remove(temporary_filename.c_str());
+			return "Error while writing the file " + temporary_filename;
+		}
+
+		std::remove(filename.c_str());
+		if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+			std::remove(temporary_filename.c_str());
+			return "Cannot rename " + temporary_filename + " to " + filename;
+		}
+		return "";
+	}
+}
+
+	mesh mesh_binary_view::to_mesh() const
+	{
+		mesh m;
+		m.position.data.assign(position.data, position.data + position.size());
+		m.normal.data.assign(normal.data, normal.data + normal.size());
+		m.color.data.assign(color.data, color.data + color.size());
+		m.uv.data.assign(uv.data, uv.data + uv.size());
+		m.connectivity.data.assign(connectivity.data, connectivity.data + connectivity.size());
+		return m;
+	}
+
+
+	mesh_binary_file::mesh_binary_file()
+	{}
+
+	mesh_binary_file::mesh_binary_file(std::string const& filename, bool check_checksum)
+	{
+		open(filename, check_checksum);
+	}
+
+	void mesh_binary_file::open(std::string const& filename, bool check_checksum)
+	{
+		file.open(filename);
+		std::string const error = validate(check_checksum);
+		if (!error.empty()) {
+			close();
+			error_cgp("Invalid mesh binary file " + filename + ": " + error);
+		}
+	}
+
+	bool mesh_binary_file::try_open(std::string const& filename, bool check_checksum)
+	{
+		close();
+		if (!check_file_exist(filename))
+			return false;
+		file.open(filename);
+		if (!validate(check_checksum).empty()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void mesh_binary_file::close()
+	{
+		file.close();
+		entry.clear();
+	}
+
+	bool mesh_binary_file::is_open() const
+	{
+		return file.is_open();
+	}
+
+	// Check the content of the file and read the entries, return an error message (empty if the file is valid)
+	std::string mesh_binary_file::validate(bool check_checksum)
+	{
+		using namespace mesh_binary;
+		entry.clear();
+
+		size_t const size = file.size();
+		if (size < sizeof(mesh_binary::header))
+			return "file too small";
+		mesh_binary::header const& h = header();
+		if (std::memcmp(h.magic, magic_value, sizeof(magic_value)) != 0)
+			return "not a mesh binary file";
+		if (h.endianness != endianness_value)
+			return "file written with a different byte order";
+		if (h.version != version)
+			return "version " + str(h.version) + " (expected " + str(version) + ")";
+		if (h.file_size != size)
+			return "truncated file (" + str(size) + " bytes, expected " + str(h.file_size) + ")";
+		if (h.number_of_mesh > (size - sizeof(mesh_binary::header)) / sizeof(mesh_binary::entry))
+			return "incorrect number of meshes";
+		if (check_checksum && hash(file.data() + sizeof(mesh_binary::header), size - sizeof(mesh_binary::header)) != h.checksum)
+			return "incorrect checksum";
+
+		entry.resize(h.number_of_mesh);
+		std::memcpy(entry.data(), file.data() + sizeof(mesh_binary::header), entry.size() * sizeof(mesh_binary::entry));
+		for (mesh_binary::entry const& e : entry) {
+			if (e.name_offset > size || e.name_size > size - e.name_offset)
+				return "incorrect name";
+			for (int b = 0; b < number_of_block; ++b) {
+				if (e.block_offset[b] % alignment != 0 || e.block_offset[b] > size || e.block_count[b] > (size - e.block_offset[b]) / element_size[b] || e.block_count[b] > uint64_t(std::numeric_limits<int>::max()))
+					return "incorrect block";
+			}
+		}
+		return "";
+	}
+
+	mesh_binary::header const& mesh_binary_file::header() const
+	{
+		return *reinterpret_cast<mesh_binary::header const*>(file.data());
+	}
+
+	int mesh_binary_file::size() const
+	{
+		return int(entry.size());
+	}
+
+	mesh_binary_view mesh_binary_file::view(int index) const
+	{
+		using namespace mesh_binary;
+		assert_cgp(index >= 0 && index < size(), "Incorrect mesh index " + str(index) + " in a mesh binary file of " + str(size()) + " meshes");
+		mesh_binary::entry const& e = entry[index];
+		char const* data = file.data();
+
+		mesh_binary_view v;
+		v.position = numarray_view<vec3 const>(reinterpret_cast<vec3 const*>(data + e.block_offset[block_position]), int(e.block_count[block_position]));
+		v.normal = numarray_view<vec3 const>(reinterpret_cast<vec3 const*>(data + e.block_offset[block_normal]), int(e.block_count[block_normal]));
+		v.color = numarray_view<vec3 const>(reinterpret_cast<vec3 const*>(data + e.block_offset[block_color]), int(e.block_count[block_color]));
+		v.uv = numarray_view<vec2 const>(reinterpret_cast<vec2 const*>(data + e.block_offset[block_uv]), int(e.block_count[block_uv]));
+		v.connectivity = numarray_view<uint3 const>(reinterpret_cast<uint3 const*>(data + e.block_offset[block_connectivity]), int(e.block_count[block_connectivity]));
+		v.name = std::string(data + e.name_offset, size_t(e.name_size));
+		return v;
+	}
+
+
+	void mesh_save_file_binary(std::string const& filename, std::vector<mesh> const& meshes, std::vector<std::string> const& names, mesh_binary::source_information const& source)
+	{
+		std::string const error = mesh_binary::write_file(filename, meshes, names, source);
+		if (!error.empty())
+			error_cgp(error);
+	}
+
+	void mesh_save_file_binary(std::string const& filename, mesh const& m)
+	{
+		mesh_save_file_binary(filename, std::vector<mesh>{ m });
+	}
+
+	mesh mesh_load_file_binary(std::string const& filename)
+	{
+		mesh_binary_file const file(filename);
+		assert_cgp(file.size() > 0, "The mesh binary file " + filename + " doesn't contain any mesh");
+		return file.view(0).to_mesh();
+	}
+
+	std::vector<mesh> mesh_load_file_binary_all(std::string const& filename, std::vector<std::string>* names)
+	{
+		mesh_binary_file const file(filename);
+		std::vector<mesh> meshes(file.size());
+		if (names != nullptr)
+			names->resize(file.size());
+		for (int k = 0; k < file.size(); ++k) {
+			mesh_binary_view const v = file.view(k);
+			meshes[k] = v.to_mesh();
+			if (names != nullptr)
+				(*names)[k] = v.name;
+		}
+		return meshes;
+	}
+
+
+namespace mesh_cache
+{
+	bool enabled = true;
+
+	std::string cache_filename(std::string const& source_filename)
+	{
+		return source_filename + ".cgpmesh";
+	}
+
+	// The modification times are stored in seconds: a source modified in the same second as (or just after) the writing of its cache can keep the same time
+	static int64_t const modification_time_margin = 2;
+
+	bool load(std::string const& source_filename, loader_type loader, std::vector<mesh>& meshes, std::vector<std::string>& names)
+	{
+		if (!enabled)
+			return false;
+
+		std::string const filename = cache_filename(source_filename);
+		mesh_binary_file file;
+		if (!file.try_open(filename))
+			return false;
+
+		// The cache must have been written by the same revision of the same loader
+		mesh_binary::header const& h = file.header();
+		if (h.loader != loader || h.loader_revision != loader_revision)
+			return false;
+
+		// The cache is valid if the source has the same size, and the same modification time or the same content.
+		//  The content is also compared when the modification time is too close to the writing of the cache to be trusted.
+		if (h.source_size != file_get_size(source_filename))
+			return false;
+		int64_t const modification_time = file_get_modification_time(source_filename);
+		int64_t const cache_time = file_get_modification_time(filename);
+		bool const same_time = h.source_modification_time == modification_time;
+		bool const check_content = !same_time || std::abs(modification_time - cache_time) <= modification_time_margin;
+		if (check_content) {
+			file_map const source(source_filename);
+			if (h.source_hash != mesh_binary::hash(source.data(), source.size()))
+				return false;
+		}
+
+		meshes.resize(file.size());
+		names.resize(file.size());
+		for (int k = 0; k < file.size(); ++k) {
+			mesh_binary_view const v = file.view(k);
+			meshes[k] = v.to_mesh();
+			names[k] = v.name;
+		}
+		file.close();
+
+		// Same content with a new modification time (ex. file copied or checked out again), or with a time close to the cache: rewrite the time in the header.
+		//  The cache is then more recent than the source, and the source is not hashed again at the next load.
+		if (check_content) {
+			std::fstream stream(filename, std::ios::binary | std::ios::in | std::ios::out);
+			if (stream.is_open()) {
+				stream.seekp(offsetof(mesh_binary::header, source_modification_time));
+				stream.write(reinterpret_cast<char const*>(&modification_time), sizeof(int64_t));
+			}
+		}
+		return true;
+	}
+
+	void save(std::string const& source_filename, loader_type loader, std::vector<mesh> const& meshes, std::vector<std::string> const& names)
+	{
+		if (!enabled)
+			return;
+		mesh_binary::source_information source = mesh_binary::source_information_of_file(source_filename);
+		source.loader = loader;
+		source.loader_revision = loader_revision;
+		mesh_binary::write_file(cache_filename(source_filename), meshes, names, source);
+	}
+}
+}
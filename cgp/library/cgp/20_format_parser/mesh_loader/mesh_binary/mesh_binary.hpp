@@ -0,0 +1,144 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	/** Binary mesh file (extension .cgpmesh): the arrays of one or several meshes stored as they are in memory, to be loaded without any parsing.
+	*
+	* Layout of the file (little endian):
+	*   - header (mesh_binary::header, 64 bytes): magic "CGPMESH", version, number of meshes, checksum, and the description of the source file the meshes were loaded from (and of the loader used)
+	*   - one entry per mesh (mesh_binary::entry): offset and number of elements of the position, normal, color, uv and connectivity blocks, and an optional name (ex. texture file)
+	*   - the names, then the blocks. Each block starts on a multiple of 64 bytes.
+	* The checksum covers all the bytes after the header.
+	*
+	* Ex.
+	*   mesh_save_file_binary("bunny.cgpmesh", m);
+	*   mesh m2 = mesh_load_file_binary("bunny.cgpmesh");
+	*
+	*   mesh_binary_file file("bunny.cgpmesh"); // memory mapped, the arrays are accessed in place
+	*   numarray_view<vec3 const> p = file.view(0).position; */
+
+	namespace mesh_binary
+	{
+		static uint32_t const version = 1;
+		/** Alignment of the blocks in the file (in bytes) */
+		static size_t const alignment = 64;
+		/** Blocks of a mesh */
+		enum block_type { block_position = 0, block_normal, block_color, block_uv, block_connectivity, number_of_block };
+
+		struct header
+		{
+			char magic[8];              // "CGPMESH\0"
+			uint32_t version;
+			uint32_t endianness;        // 0x01020304 written in the byte order of the writer
+			uint32_t number_of_mesh;
+			uint16_t loader;            // loader that built the meshes from the source file, and its revision (0 if unknown, see mesh_cache)
+			uint16_t loader_revision;
+			uint64_t file_size;
+			uint64_t checksum;          // of the bytes [sizeof(header), file_size[
+			// Source file the meshes were built from (0 if unknown)
+			uint64_t source_size;
+			int64_t source_modification_time;
+			uint64_t source_hash;
+		};
+		static_assert(sizeof(header) == 64, "Unexpected size of the header of mesh_binary");
+
+		struct entry
+		{
+			uint64_t block_offset[number_of_block];  // position in the file of the first byte of the block
+			uint64_t block_count[number_of_block];   // number of elements
+			uint64_t name_offset;
+			uint64_t name_size;
+		};
+
+		/** Description of the source file stored in the header (used by the cache to check that the binary file is up to date) */
+		struct source_information
+		{
+			uint64_t size = 0;
+			int64_t modification_time = 0;
+			uint64_t hash = 0;
+			uint16_t loader = 0;
+			uint16_t loader_revision = 0;
+		};
+		/** Size, modification time and hash of a file (the loader is left to 0) */
+		source_information source_information_of_file(std::string const& filename);
+
+		/** 64-bit hash of a buffer (used for the checksum and the hash of the source files) */
+		uint64_t hash(char const* data, size_t size);
+	}
+
+	/** Arrays of a mesh stored in a mesh_binary_file (read only views on the memory mapped file) */
+	struct mesh_binary_view
+	{
+		numarray_view<vec3 const> position;
+		numarray_view<vec3 const> normal;
+		numarray_view<vec3 const> color;
+		numarray_view<vec2 const> uv;
+		numarray_view<uint3 const> connectivity;
+		std::string name;
+
+		/** Copy of the arrays in a mesh */
+		mesh to_mesh() const;
+	};
+
+	/** Memory mapped binary mesh file */
+	struct mesh_binary_file
+	{
+		mesh_binary_file();
+		/** Open and validate the file (stops with an error message if the file is not a valid mesh binary file) */
+		explicit mesh_binary_file(std::string const& filename, bool check_checksum = true);
+
+		void open(std::string const& filename, bool check_checksum = true);
+		/** Open the file and return false (without error) if it is not a valid mesh binary file */
+		bool try_open(std::string const& filename, bool check_checksum = true);
+		void close();
+		bool is_open() const;
+
+		mesh_binary::header const& header() const;
+		/** Number of meshes */
+		int size() const;
+		mesh_binary_view view(int index) const;
+
+	private:
+		file_map file;
+		std::vector<mesh_binary::entry> entry;
+		std::string validate(bool check_checksum);
+	};
+
+	/** Write meshes in a binary file. The optional names are stored with the meshes (names is either empty, or has one element per mesh). */
+	void mesh_save_file_binary(std::string const& filename, std::vector<mesh> const& meshes, std::vector<std::string> const& names = {}, mesh_binary::source_information const& source = {});
+	void mesh_save_file_binary(std::string const& filename, mesh const& m);
+
+	/** Load the first mesh of a binary file */
+	mesh mesh_load_file_binary(std::string const& filename);
+	/** Load all the meshes of a binary file (and their names if names is not null) */
+	std::vector<mesh> mesh_load_file_binary_all(std::string const& filename, std::vector<std::string>* names = nullptr);
+
+
+	/** Cache of loaded meshes stored in binary files next to their source (filename + ".cgpmesh")
+	* The binary file is written on the first load, and reused by the same loader as long as the source file has the same size and modification time, or the same content (hash).
+	* The content is also hashed when the modification time of the source is within a few seconds of the writing of the cache (a source modified just after its cache was written can keep the same time).
+	* The cached meshes are stored after fill_empty_field: the normals are not computed again.
+	* The cache is silently skipped if the binary file cannot be written. */
+	namespace mesh_cache
+	{
+		/** Set to false to always load the source files */
+		extern bool enabled;
+
+		/** Loaders using the cache: the meshes of a cache are only returned to the loader that built them */
+		enum loader_type : uint16_t { loader_unknown = 0, loader_obj = 1, loader_obj_advanced = 2 };
+		/** Revision of the loaders, stored in the caches. To be incremented when a loader builds different meshes from the same file: the caches written before are then ignored. */
+		static uint16_t const loader_revision = 1;
+
+		std::string cache_filename(std::string const& source_filename);
+		/** Valid cached meshes of a source file built by the loader (returns false if there is no valid cache) */
+		bool load(std::string const& source_filename, loader_type loader, std::vector<mesh>& meshes, std::vector<std::string>& names);
+		void save(std::string const& source_filename, loader_type loader, std::vector<mesh> const& meshes, std::vector<std::string> const& names = {});
+	}
+}
@@ -0,0 +1,107 @@
+#include "cgp/01_base/base.hpp"
+#include "../mesh_binary.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace cgp_test {
+
+	static std::string read_file(std::string const& filename)
+	{
+		std::ifstream stream(filename, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	static void write_file(std::string const& filename, std::string const& content)
+	{
+		std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+		stream.write(content.data(), std::streamsize(content.size()));
+	}
+
+	static bool is_same_mesh(cgp::mesh const& a, cgp::mesh const& b)
+	{
+		using namespace cgp;
+		return is_equal(a.position, b.position) && is_equal(a.normal, b.normal) && is_equal(a.color, b.color) && is_equal(a.uv, b.uv) && is_equal(a.connectivity, b.connectivity);
+	}
+
+	void test_mesh_binary()
+	{
+		using namespace cgp;
+		std::string const filename = "test_mesh_binary.cgpmesh";
+		std::string const source_filename = "test_mesh_binary.txt";
+
+		mesh m1;
+		m1.position = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+		m1.normal = { {0,0,1}, {0,0,1}, {0,0,1}, {1,0,0} };
+		m1.uv = { {0,0}, {1,0}, {0,1}, {0.5f,0.5f} };
+		m1.connectivity = { {0,1,2}, {0,2,3}, {1,2,3} };
+		mesh m2;
+		m2.position = { {2,0,0}, {3,0,0}, {2,1,0} };
+		m2.color = { {1,0,0}, {0,1,0}, {0,0,1} };
+		m2.connectivity = { {0,1,2} };
+
+		// Round trip of several meshes with their names
+		{
+			mesh_save_file_binary(filename, { m1, m2 }, { "first.png", "" });
+			std::vector<std::string> names;
+			std::vector<mesh> const meshes = mesh_load_file_binary_all(filename, &names);
+			assert_cgp_no_msg(meshes.size() == 2 && names.size() == 2);
+			assert_cgp_no_msg(is_same_mesh(meshes[0], m1) && is_same_mesh(meshes[1], m2));
+			assert_cgp_no_msg(names[0] == "first.png" && names[1] == "");
+			assert_cgp_no_msg(is_same_mesh(mesh_load_file_binary(filename), m1));
+
+			mesh_binary_file file(filename);
+			assert_cgp_no_msg(file.size() == 2);
+			assert_cgp_no_msg(file.view(1).position.size() == 3 && file.view(1).name == "");
+		}
+
+		// A modified byte is detected by the checksum, a truncated file by its size
+		{
+			std::string const content = read_file(filename);
+			mesh_binary_file file;
+			assert_cgp_no_msg(file.try_open(filename));
+			size_t const position_offset = size_t(reinterpret_cast<char const*>(file.view(0).position.data) - reinterpret_cast<char const*>(&file.header()));
+			file.close();
+
+			std::string modified = content;
+			modified[position_offset + 5] ^= 0x10; // one bit of the second coordinate of the first position
+			write_file(filename, modified);
+			assert_cgp_no_msg(!file.try_open(filename));
+			assert_cgp_no_msg(file.try_open(filename, false));
+			file.close();
+
+			write_file(filename, content.substr(0, content.size() - mesh_binary::alignment));
+			assert_cgp_no_msg(!file.try_open(filename, false));
+			write_file(filename, content.substr(0, sizeof(mesh_binary::header) / 2));
+			assert_cgp_no_msg(!file.try_open(filename, false));
+		}
+		std::remove(filename.c_str());
+
+		// Cache: only used by the loader that wrote it, and invalidated by a change of the source of the same size written just after the cache
+		{
+			std::string const cache = mesh_cache::cache_filename(source_filename);
+			bool const enabled = mesh_cache::enabled;
+			mesh_cache::enabled = true;
+			std::vector<mesh> meshes;
+			std::vector<std::string> names;
+
+			write_file(source_filename, "first version");
+			mesh_cache::save(source_filename, mesh_cache::loader_obj, { m1 });
+			assert_cgp_no_msg(mesh_cache::load(source_filename, mesh_cache::loader_obj, meshes, names));
+			assert_cgp_no_msg(meshes.size() == 1 && is_same_mesh(meshes[0], m1));
+			assert_cgp_no_msg(!mesh_cache::load(source_filename, mesh_cache::loader_obj_advanced, meshes, names));
+
+			write_file(source_filename, "other version");
+			assert_cgp_no_msg(!mesh_cache::load(source_filename, mesh_cache::loader_obj, meshes, names));
+
+			mesh_cache::enabled = false;
+			assert_cgp_no_msg(!mesh_cache::load(source_filename, mesh_cache::loader_obj, meshes, names));
+			mesh_cache::enabled = enabled;
+			std::remove(cache.c_str());
+		}
+		std::remove(source_filename.c_str());
+	}
+}
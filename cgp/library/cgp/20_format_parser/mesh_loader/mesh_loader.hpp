@@ -1,4 +1,8 @@
 #pragma once
 
 #include "obj/obj.hpp"
-#include "obj_advanced/obj_advanced.hpp"
\ No newline at end of file
+#include "obj_advanced/obj_advanced.hpp"
+#include "vertex_index_map/vertex_index_map.hpp"
+#include "mesh_binary/mesh_binary.hpp"
+#include "ply/ply.hpp"
+#include "stl/stl.hpp"
@@ -9,8 +9,8 @@
 
 #include "cgp/01_base/base.hpp"
 #include "cgp/03_files/files.hpp"
-
-#include <map>
+#include "../vertex_index_map/vertex_index_map.hpp"
+#include "../mesh_binary/mesh_binary.hpp"
 
 #include <fstream>
 #include <sstream>
@@ -18,82 +18,15 @@
 namespace cgp
 {
 
-    void mesh_save_file_obj(std::string const& filename, mesh const& m)
-    {
-        std::ofstream stream(filename, std::ofstream::out);
-        assert_cgp(stream.is_open(), "Cannot open file " + str(filename));
-
-        for (int k = 0; k < m.position.size(); ++k)
-            stream << "v " << m.position[k].x << " " << m.position[k].y <<" " << m.position[k].z << std::endl;
-        for (int k = 0; k < m.uv.size(); ++k)
-            stream << "vt " << m.uv[k].x <<" " << m.uv[k].y << std::endl;
-        for (int k = 0; k < m.normal.size(); ++k)
-            stream << "vn " << m.normal[k].x << " " << m.normal[k].y <<" " << m.normal[k].z << std::endl;
-
-        for (int k = 0; k < m.connectivity.size(); ++k) {
-            std::string const u0 = str(m.connectivity[k][0]+1);
-            std::string const u1 = str(m.connectivity[k][1]+1);
-            std::string const u2 = str(m.connectivity[k][2]+1);
-            std::string const f0 = u0 + "/" + u0 + "/" + u0;
-            std::string const f1 = u1 + "/" + u1 + "/" + u1;
-            std::string const f2 = u2 + "/" + u2 + "/" + u2;
-
-            stream << "f " << f0 << " " << f1 << " " << f2 << std::endl;
-        }
-
-        stream.close();
-    }
-
-    void save_file_obj(std::string const& filename, std::vector<vec3> const& position, std::vector<vec3> const& normal)
-    {
-        std::ofstream stream(filename, std::ofstream::out);
-        assert_cgp(stream.is_open(), "Cannot open file " + str(filename));
-
-        for (int k = 0; k < position.size(); ++k)
-            stream << "v " << position[k].x << " " << position[k].y <<" " << position[k].z << std::endl;
-        for (int k = 0; k < normal.size(); ++k)
-            stream << "vn " << normal[k].x << " " << normal[k].y <<" " << normal[k].z << std::endl;
-
-        for (int k = 0; k < position.size()/3; k++) {
-            std::string const u0 = str(3*k+1);
-            std::string const u1 = str(3*k+2);
-            std::string const u2 = str(3*k+3);
-            std::string const f0 = u0 + "//" + u0;
-            std::string const f1 = u1 + "//" + u1;
-            std::string const f2 = u2 + "//" + u2;
-
-            stream << "f " << f0 << " " << f1 << " " << f2 << std::endl;
-        }
-
-        stream.close();
-    }
+static numarray<numarray_stack<int3,3>> triangulate_faces(loader::obj_content const& content, loader::obj_type const type);
 
 
-// Comparator of triplet of integer for std::map
-struct comparator_int3 {
-    long int N; // number of vertices
-
-    comparator_int3(int N_arg=0) :N(N_arg) {}
-
-    // compute a<b
-    bool operator()(int3 const& a, int3 const& b) const
-    {
-        long int const offset_a = long(a[0]) + N*(long(a[1]) + N*long(a[2]));
-        long int const offset_b = long(b[0]) + N*(long(b[1]) + N*long(b[2]));
-        return offset_a < offset_b;
-    }
-};
-
-
-static numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces);
-
-
-static std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
+static mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
                                     numarray<vec2> const& texture_uv,
                                     numarray<vec3> const& normals,
                                     numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type);
+                                    loader::obj_type const type,
+                                    loader::vertex_index_map& vertex_map);
 
 
 mesh mesh_load_file_obj(const std::string& filename)
@@ -103,14 +36,29 @@ mesh mesh_load_file_obj(const std::string& filename)
      m.fill_empty_field();
      return m;
 }
+mesh mesh_load_file_obj_cached(const std::string& filename)
+{
+    assert_file_exist(filename);
+
+    std::vector<mesh> meshes;
+    std::vector<std::string> names;
+    if(mesh_cache::load(filename, mesh_cache::loader_obj, meshes, names) && meshes.size()==1)
+        return meshes[0];
+
+    mesh const m = mesh_load_file_obj(filename);
+    mesh_cache::save(filename, mesh_cache::loader_obj, {m});
+    return m;
+}
+
 mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& vertex_correspondance)
 {
     assert_file_exist(filename);
 
-    // Load parameters
-    numarray<vec3> positions = loader::obj_read_positions(filename);
-    numarray<vec2> texture_uv = loader::obj_read_texture_uv(filename);
-    numarray<vec3> normals = loader::obj_read_normals(filename);
+    // Load parameters and faces in a single pass
+    loader::obj_content const content = loader::obj_parse(filename);
+    numarray<vec3> const& positions = content.position;
+    numarray<vec2> const& texture_uv = content.uv;
+    numarray<vec3> const& normals = content.normal;
 
     assert_cgp(positions.size()>0, str("File ")+filename+" has 0 vertices");
 
@@ -123,21 +71,19 @@ mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& v
     else if( normals.size()>0 )
         type = loader::obj_type::vertex_normal;
 
-    // Load connectivity and triangulate
-    numarray<numarray_stack<int3,3>> faces = triangulate_faces( loader::obj_read_faces(filename, type) );
+    // Triangulate
+    numarray<numarray_stack<int3,3>> faces = triangulate_faces(content, type);
 
     // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
-    mesh m;
-    std::map<int3, int, comparator_int3> connectivity_map;
-    std::tie(m,connectivity_map) = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type);
+    loader::vertex_index_map vertex_map;
+    mesh m = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type, vertex_map);
 
-    // Retrieve correspondance between initial vertices in files and new ones
+    // Retrieve correspondance between initial vertices in files and new ones (the new vertices of a position are listed in increasing order)
+    vertex_correspondance.clear();
     vertex_correspondance.resize(positions.size());
-    for(auto const& it : connectivity_map)
+    for(int vertex_out=0; vertex_out<vertex_map.size(); ++vertex_out)
     {
-        int const vertex_in = it.first[0];
-        int const vertex_out = it.second;
-
+        int const vertex_in = vertex_map.key(vertex_out)[0];
         vertex_correspondance[vertex_in].push_back(vertex_out);
     }
 
@@ -145,38 +91,51 @@ mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& v
 }
 
 
-numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces)
+// Triangulation of the faces of the parsed file. The indices of uv and normals are set to -1 if they are not used by the type (as done by obj_read_faces)
+numarray<numarray_stack<int3,3>> triangulate_faces(loader::obj_content const& content, loader::obj_type const type)
 {
+    bool const use_uv = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture;
+    bool const use_normal = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal;
+    auto vertex = [&](int k) {
+        int3 v = content.face_vertex.at(k);
+        if(!use_uv) v[1] = -1;
+        if(!use_normal) v[2] = -1;
+        return v;
+    };
+
+    int const N_face = content.face_begin.size()-1;
     numarray<numarray_stack<int3,3>> faces_triangulation;
-    size_t const N_face = faces.size();
-    for(size_t k_face=0; k_face<N_face; ++k_face)
+    faces_triangulation.data.reserve(std::max(content.face_vertex.size()-2*N_face, 0));
+    for(int k_face=0; k_face<N_face; ++k_face)
     {
-        numarray<int3> const& current_polygon = faces[k_face];
-        int const N_polygon = int(current_polygon.size());
-
-        for(int k=0; k<N_polygon-2; ++k) {
-            // triangulation
-            int3 const& f0 = current_polygon[0];
-            int3 const& f1 = current_polygon[k+1];
-            int3 const& f2 = current_polygon[k+2];
-
-            faces_triangulation.push_back({f0,f1,f2});
-        }
+        int const begin = content.face_begin.at(k_face);
+        int const N_polygon = content.face_begin.at(k_face+1)-begin;
+        for(int k=0; k<N_polygon-2; ++k)
+            faces_triangulation.push_back({vertex(begin), vertex(begin+k+1), vertex(begin+k+2)});
     }
     return faces_triangulation;
 }
 
-std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
+// Create one vertex per distinct (position, uv, normal) triplet of the faces
+//  vertex_map associates each triplet to the index of its vertex in the mesh
+mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
                                     numarray<vec2> const& texture_uv,
                                     numarray<vec3> const& normals,
                                     numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type)
+                                    loader::obj_type const type,
+                                    loader::vertex_index_map& vertex_map)
 {
-    mesh m;
-    comparator_int3 comparator(int(positions.size()));
-    std::map<int3, int, comparator_int3> connectivity_map(comparator); // stores map between original face index and final offset
+    bool const use_uv = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture;
+    bool const use_normal = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal;
 
+    // Most meshes have between one and two vertices per position
+    vertex_map.reserve(positions.size() + positions.size()/2);
+
+    mesh m;
+    m.position.data.reserve(positions.size());
+    if(use_uv) m.uv.data.reserve(positions.size());
+    if(use_normal) m.normal.data.reserve(positions.size());
+    m.connectivity.data.reserve(faces.size());
 
     size_t const N_triangle = faces.size();
     for(size_t k_triangle=0; k_triangle<N_triangle; ++k_triangle)
@@ -186,37 +145,30 @@ std::pair<mesh, std::map<int3, int, comparator_int3>>
         for(int k=0; k<3; ++k)
         {
             int3 const& index = tri[k];
-            auto const it = connectivity_map.find( index );
-            if( it==connectivity_map.end() ) {
-
-                size_t const offset = m.position.size();
-                connectivity_map[index] = int(offset);
-                new_triangle_index[k] = int(offset);
+            bool is_new = false;
+            new_triangle_index[k] = vertex_map.insert(index, is_new);
+            if( is_new ) {
 
                 int const idx_position = index[0];
+                assert_cgp_no_msg( idx_position>=0 && idx_position<int(positions.size()));
+                m.position.push_back( positions.at(idx_position) );
 
-                assert_cgp_no_msg( idx_position<int(positions.size()));
-                m.position.push_back( positions[idx_position] );
-
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture) {
+                if(use_uv) {
                     int const idx_uv = index[1];
-                    assert_cgp_no_msg( idx_uv<int(texture_uv.size()) );
-                    m.uv.push_back( texture_uv[ idx_uv ] );
+                    assert_cgp_no_msg( idx_uv>=0 && idx_uv<int(texture_uv.size()) );
+                    m.uv.push_back( texture_uv.at(idx_uv) );
                 }
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal) {
+                if(use_normal) {
                     int const idx_normal = index[2];
-                    assert_cgp_no_msg( idx_normal<int(normals.size()) );
-                    m.normal.push_back( normals[idx_normal] );
+                    assert_cgp_no_msg( idx_normal>=0 && idx_normal<int(normals.size()) );
+                    m.normal.push_back( normals.at(idx_normal) );
                 }
-
             }
-            else
-                new_triangle_index[k] = it->second;
         }
         m.connectivity.push_back(new_triangle_index);
     }
 
-    return {m, connectivity_map};
+    return m;
 }
 
 
@@ -2,18 +2,34 @@
 
 #include "cgp/11_mesh/mesh.hpp"
 
+#include <future>
+
 namespace cgp
 {
     /** Save a mesh in .obj file
-    * Note that OBJ format doesn't stores per-vertex color */
+    * Note that OBJ format doesn't stores per-vertex color
+    *  - The uv and normals are written if they are defined for every vertex
+    *  - The floats are written with the shortest representation read back as the same value (independently of the locale)
+    *  - The text is formatted in large reusable buffers written by chunks of 1MB. Large meshes are formatted on number_of_threads threads (0: parallel_number_of_threads(), 1: no threads) */
+    void mesh_save_file_obj(std::string const& filename, mesh const& m, int number_of_threads = 0);
     void save_file_obj(std::string const& filename, mesh const& m);
 
 
     /** Minimalist export of triangle soup */
-    void save_file_obj(std::string const& filename, std::vector<vec3> const& position, std::vector<vec3> const& normal);
+    void save_file_obj(std::string const& filename, std::vector<vec3> const& position, std::vector<vec3> const& normal, int number_of_threads = 0);
+
+    /** Export in a background thread: the data is moved (or copied) to the thread, and the function returns immediately.
+    * The future is ready once the file is written (keep it until then: the destructor of the future waits for the end of the export).
+    * Call get() on the ready future to retrieve the exceptions raised during the export. Don't start a new export of the same file before the previous one is finished.
+    * Note: the errors of the export go through error_cgp, which aborts the program unless CGP_ERROR_EXCEPTION is defined - only then are they rethrown by get().
+    * Ex.
+    *   std::future<void> export_obj = save_file_obj_async("mesh.obj", std::move(position), std::move(normal)); */
+    std::future<void> mesh_save_file_obj_async(std::string const& filename, mesh m, int number_of_threads = 0);
+    std::future<void> save_file_obj_async(std::string const& filename, std::vector<vec3> position, std::vector<vec3> normal, int number_of_threads = 0);
 
     /** Load a mesh stored as .obj in the filename.
     * Notes: 
+    *  - The file is memory mapped and parsed in a single pass (see loader::obj_parse), large files are parsed on several threads
     *  - Normals and UV are read, and vertices are duplicated if needed
     *  - .mtl files are not read with this loader (cannot read shading and color)
     *  - Only one mesh is loaded - this parser cannot be used when multiple textures are associated to different objects
@@ -25,6 +41,9 @@ namespace cgp
     * Outputs the correspondance between the vertex index in the file, and the loaded one */
     mesh mesh_load_file_obj(std::string const& filename, numarray<numarray<int>>& vertex_correspondance);
 
+    /** Same as mesh_load_file_obj(filename) using the binary cache (see mesh_cache): the first load writes filename.cgpmesh next to the file, the next ones map it directly as long as the .obj is unchanged */
+    mesh mesh_load_file_obj_cached(std::string const& filename);
+
 
 
 namespace loader{
@@ -55,6 +74,26 @@ namespace loader{
     */
 
     numarray<numarray<int3>> obj_read_faces(const std::string& filename, obj_type const type);
+
+
+    /** Content of an OBJ file: positions, texture coordinates, normals and polygons
+     * The vertices of the face k are face_vertex[face_begin[k]] ... face_vertex[face_begin[k+1]-1] (face_begin has one more element than the number of faces)
+     * Each vertex of a face is given by its (position, uv, normal) indices starting at 0, the indices are set to -1 if they are not defined.
+     * Relative (negative) indices of the file are converted to absolute ones. */
+    struct obj_content {
+        numarray<vec3> position;
+        numarray<vec2> uv;
+        numarray<vec3> normal;
+        numarray<int3> face_vertex;
+        numarray<int> face_begin;
+    };
+
+    /** Read the content of an obj file in a single pass over the memory mapped file (no iostream, the numbers are parsed independently of the locale)
+     * Files of several MB are split in chunks of complete lines parsed in parallel on number_of_threads threads started by parallel_for_chunk (0: parallel_number_of_threads(), 1: sequential parsing)
+     * Only the v, vt, vn and f lines are read. */
+    obj_content obj_parse(std::string const& filename, int number_of_threads = 0);
+    /** Parse the content of an obj file stored in memory (text doesn't need to be null-terminated) */
+    obj_content obj_parse(char const* text, size_t size, int number_of_threads = 0);
 }
 
 
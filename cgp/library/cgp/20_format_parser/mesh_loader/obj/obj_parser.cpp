@@ -0,0 +1,372 @@
+#include "obj.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace cgp
+{
+namespace loader
+{
+
+// Relative indices are stored with this bias while a chunk is parsed: the number of elements defined before the chunk is only known after all the chunks are parsed
+static int const relative_index_bias = 1 << 30;
+
+static double const power_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+static float const power_of_ten_float[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+// Bound of the relative error of the double computed from a mantissa of at most 19 digits (2^-50, with a margin)
+static double const relative_error_bound = 1.0 / (1ull << 50);
+
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static inline bool is_same_word(char const* begin, char const* end, char const* word)
+{
+    for (; begin < end && *word != '\0'; ++begin, ++word)
+        if ((*begin | 0x20) != *word)
+            return false;
+    return begin == end && *word == '\0';
+}
+
+// Conversion of the numbers that cannot be converted exactly by the fast path (mantissa close to the middle of two floats, large exponent, inf/nan)
+//  The stream uses the "C" locale: the result doesn't depend on LC_NUMERIC (strtof would expect a comma as decimal separator in some locales)
+static float parse_float_fallback(char const* begin, char const* end)
+{
+    char const* word = begin;
+    bool const negative = word < end && *word == '-';
+    if (word < end && (*word == '-' || *word == '+'))
+        ++word;
+    if (is_same_word(word, end, "inf") || is_same_word(word, end, "infinity"))
+        return negative ? -HUGE_VALF : HUGE_VALF;
+    if (is_same_word(word, end, "nan"))
+        return std::numeric_limits<float>::quiet_NaN();
+
+    thread_local std::istringstream stream;
+    stream.imbue(std::locale::classic());
+    stream.clear();
+    stream.str(std::string(begin, end));
+    float value = 0.0f;
+    stream >> value;
+    if (stream.fail() && std::fabs(value) == std::numeric_limits<float>::max())
+        return value > 0 ? HUGE_VALF : -HUGE_VALF; // overflow
+    return value;
+}
+
+// Parse a float starting at p, return the position after the number (p if there is no number)
+// The result is the correctly rounded float, as given by strtof in the "C" locale.
+static char const* parse_float(char const* p, char const* end, float& value)
+{
+    char const* const begin = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool has_digit = false;
+    bool truncated = false;
+    while (p < end && is_digit(*p)) {
+        if (significant_digits < 19) {
+            mantissa = 10 * mantissa + uint64_t(*p - '0');
+            significant_digits += (mantissa > 0);
+        }
+        else {
+            truncated = truncated || *p != '0';
+            ++exponent;
+        }
+        has_digit = true;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && is_digit(*p)) {
+            if (significant_digits < 19) {
+                mantissa = 10 * mantissa + uint64_t(*p - '0');
+                significant_digits += (mantissa > 0);
+                --exponent;
+            }
+            else
+                truncated = truncated || *p != '0';
+            has_digit = true;
+            ++p;
+        }
+    }
+
+    if (!has_digit) {
+        // inf, nan
+        char const* q = p;
+        while (q < end && ((*q >= 'a' && *q <= 'z') || (*q >= 'A' && *q <= 'Z')))
+            ++q;
+        if (q == p)
+            return begin;
+        value = parse_float_fallback(begin, q);
+        return q;
+    }
+
+    if (p + 1 < end && (*p == 'e' || *p == 'E') && (is_digit(p[1]) || ((p[1] == '-' || p[1] == '+') && p + 2 < end && is_digit(p[2])))) {
+        ++p;
+        bool const negative_exponent = (*p == '-');
+        if (*p == '-' || *p == '+')
+            ++p;
+        int e = 0;
+        while (p < end && is_digit(*p)) {
+            if (e < 100000)
+                e = 10 * e + (*p - '0');
+            ++p;
+        }
+        exponent += negative_exponent ? -e : e;
+    }
+
+    if (mantissa == 0 && !truncated) {
+        value = negative ? -0.0f : 0.0f;
+        return p;
+    }
+
+    if (!truncated && mantissa <= (uint64_t(1) << 24) && exponent >= -10 && exponent <= 10) {
+        // Exact mantissa and power of ten in float: a single correctly rounded operation
+        float const m = float(mantissa);
+        float const v = exponent < 0 ? m / power_of_ten_float[-exponent] : m * power_of_ten_float[exponent];
+        value = negative ? -v : v;
+        return p;
+    }
+    if (!truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        // Correctly rounded double, then rounded to float. The double rounding differs from a direct rounding only if the double falls exactly between two floats.
+        double const m = double(mantissa);
+        double const d = exponent < 0 ? m / power_of_ten[-exponent] : m * power_of_ten[exponent];
+        float const f = float(d);
+        if (double(f) != d) {
+            float const neighbor = std::nextafter(f, double(f) < d ? HUGE_VALF : -HUGE_VALF);
+            if (double(f) + double(neighbor) == 2.0 * d) {
+                value = parse_float_fallback(begin, p);
+                return p;
+            }
+        }
+        value = negative ? -f : f;
+        return p;
+    }
+
+    if (mantissa > 0 && exponent >= -22 && exponent <= 22) {
+        // Long (or truncated) mantissa: the double d has a relative error below 2^-52 (conversion of the mantissa, product, ignored digits after the 19th).
+        // Its rounding to float is the correct one, unless d is closer than this error to the middle of two floats.
+        double const m = double(mantissa);
+        double const d = exponent < 0 ? m / power_of_ten[-exponent] : m * power_of_ten[exponent];
+        if (d < double(std::numeric_limits<float>::max())) {
+            float const f = float(d);
+            float const neighbor = std::nextafter(f, double(f) < d ? HUGE_VALF : -HUGE_VALF);
+            double const middle = 0.5 * (double(f) + double(neighbor));
+            if (std::fabs(d - middle) > d * relative_error_bound) {
+                value = negative ? -f : f;
+                return p;
+            }
+        }
+    }
+
+    value = parse_float_fallback(begin, p);
+    return p;
+}
+
+// Parse an integer starting at p, return the position after the number (p if there is no number)
+static char const* parse_int(char const* p, char const* end, int& value)
+{
+    char const* const begin = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p == end || !is_digit(*p))
+        return begin;
+    int v = 0;
+    while (p < end && is_digit(*p)) {
+        v = 10 * v + (*p - '0');
+        ++p;
+    }
+    value = negative ? -v : v;
+    return p;
+}
+
+// Index of the file (starting at 1, or negative for relative indices) to index starting at 0
+static int convert_index(int index, int number_of_elements)
+{
+    if (index > 0)
+        return index - 1;
+    if (index < 0)
+        return number_of_elements + index - relative_index_bias;
+    return -1;
+}
+
+static char const* skip_blank(char const* p, char const* end)
+{
+    while (p < end && is_blank(*p))
+        ++p;
+    return p;
+}
+
+static char const* skip_line(char const* p, char const* end)
+{
+    while (p < end && *p != '\n')
+        ++p;
+    return p < end ? p + 1 : end;
+}
+
+// Parse up to N floats of the current line
+template <int N>
+static char const* parse_floats(char const* p, char const* end, float* values)
+{
+    for (int k = 0; k < N; ++k) {
+        p = skip_blank(p, end);
+        char const* const next = parse_float(p, end, values[k]);
+        if (next == p)
+            break;
+        p = next;
+    }
+    return p;
+}
+
+// Parse the lines of [begin,end[, begin is the start of a line
+static void parse_chunk(char const* p, char const* end, obj_content& content)
+{
+    content.face_begin.push_back(0);
+    while (p < end)
+    {
+        p = skip_blank(p, end);
+        char const c0 = p < end ? p[0] : '\n';
+        char const c1 = p + 1 < end ? p[1] : '\n';
+        char const c2 = p + 2 < end ? p[2] : '\n';
+
+        if (c0 == 'v') {
+            if (is_blank(c1)) {
+                vec3 position = { 0,0,0 };
+                p = parse_floats<3>(p + 2, end, &position.x);
+                content.position.push_back(position);
+            }
+            else if (c1 == 't' && is_blank(c2)) {
+                vec2 uv = { 0,0 };
+                p = parse_floats<2>(p + 3, end, &uv.x);
+                content.uv.push_back(uv);
+            }
+            else if (c1 == 'n' && is_blank(c2)) {
+                vec3 normal = { 0,0,0 };
+                p = parse_floats<3>(p + 3, end, &normal.x);
+                content.normal.push_back(normal);
+            }
+        }
+        else if (c0 == 'f' && is_blank(c1)) {
+            p += 2;
+            while (true) {
+                p = skip_blank(p, end);
+                if (p == end || *p == '\n' || *p == '#')
+                    break;
+
+                int index[3] = { 0,0,0 };
+                char const* q = parse_int(p, end, index[0]);
+                if (q != p && q < end && *q == '/') {
+                    ++q;
+                    q = parse_int(q, end, index[1]);
+                    if (q < end && *q == '/') {
+                        ++q;
+                        q = parse_int(q, end, index[2]);
+                    }
+                }
+                if (q == p) { // not a vertex index: ignore the word
+                    while (q < end && !is_blank(*q) && *q != '\n')
+                        ++q;
+                    p = q;
+                    continue;
+                }
+                p = q;
+
+                content.face_vertex.push_back({ convert_index(index[0], content.position.size()), convert_index(index[1], content.uv.size()), convert_index(index[2], content.normal.size()) });
+            }
+            content.face_begin.push_back(content.face_vertex.size());
+        }
+        p = skip_line(p, end);
+    }
+}
+
+// Resolve the relative indices of the faces of a chunk given the number of elements defined in the previous chunks
+static void resolve_relative_index(numarray<int3>& face_vertex, int index_begin, int3 const& offset)
+{
+    for (int k = index_begin; k < face_vertex.size(); ++k) {
+        int3& v = face_vertex.at(k);
+        for (int c = 0; c < 3; ++c)
+            if (v[c] < -relative_index_bias / 2)
+                v[c] += relative_index_bias + offset[c];
+    }
+}
+
+obj_content obj_parse(char const* text, size_t size, int number_of_threads)
+{
+    // Chunks of at least 4MB of complete lines
+    size_t const minimal_chunk_size = size_t(4) << 20;
+    int const T = parallel_number_of_threads(size / minimal_chunk_size, number_of_threads);
+    int const N_chunk = T;
+
+    std::vector<char const*> chunk_begin(N_chunk + 1);
+    chunk_begin[0] = text;
+    chunk_begin[N_chunk] = text + size;
+    for (int k = 1; k < N_chunk; ++k) {
+        char const* p = text + (size * k) / N_chunk;
+        if (p < chunk_begin[k - 1])
+            p = chunk_begin[k - 1];
+        while (p < text + size && p[-1] != '\n')
+            ++p;
+        chunk_begin[k] = p;
+    }
+
+    if (N_chunk == 1) {
+        obj_content content;
+        parse_chunk(text, text + size, content);
+        resolve_relative_index(content.face_vertex, 0, { 0,0,0 });
+        return content;
+    }
+
+    // One thread per chunk started by parallel_for_chunk (not the pool of parallel_run): there are only a few large chunks per file,
+    //  and an explicit number_of_threads is honored whatever the size of the pool
+    std::vector<obj_content> chunk(N_chunk);
+    parallel_for_chunk(size_t(N_chunk), T, [&](size_t k_begin, size_t k_end, int) {
+        for (size_t k = k_begin; k < k_end; ++k)
+            parse_chunk(chunk_begin[k], chunk_begin[k + 1], chunk[k]);
+    });
+
+    // Concatenate the chunks
+    obj_content content = std::move(chunk[0]);
+    resolve_relative_index(content.face_vertex, 0, { 0,0,0 });
+    for (int k = 1; k < N_chunk; ++k) {
+        obj_content const& c = chunk[k];
+        int3 const offset = { content.position.size(), content.uv.size(), content.normal.size() };
+        int const face_offset = content.face_vertex.size();
+        int const index_begin = content.face_vertex.size();
+
+        content.position.data.insert(content.position.data.end(), c.position.data.begin(), c.position.data.end());
+        content.uv.data.insert(content.uv.data.end(), c.uv.data.begin(), c.uv.data.end());
+        content.normal.data.insert(content.normal.data.end(), c.normal.data.begin(), c.normal.data.end());
+        content.face_vertex.data.insert(content.face_vertex.data.end(), c.face_vertex.data.begin(), c.face_vertex.data.end());
+        for (int f = 1; f < c.face_begin.size(); ++f)
+            content.face_begin.push_back(c.face_begin.at(f) + face_offset);
+
+        resolve_relative_index(content.face_vertex, index_begin, offset);
+        chunk[k] = obj_content();
+    }
+    return content;
+}
+
+obj_content obj_parse(std::string const& filename, int number_of_threads)
+{
+    file_map const file(filename);
+    return obj_parse(file.data(), file.size(), number_of_threads);
+}
+
+}
+}
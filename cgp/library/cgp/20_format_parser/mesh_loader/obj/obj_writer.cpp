@@ -0,0 +1,348 @@
+#include "obj.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace cgp
+{
+namespace loader
+{
+
+// Powers of ten from 1e-64 to 1e64
+static double const power_of_ten_table[] = {
+    1e-64, 1e-63, 1e-62, 1e-61, 1e-60, 1e-59, 1e-58, 1e-57, 1e-56, 1e-55, 1e-54, 1e-53,
+    1e-52, 1e-51, 1e-50, 1e-49, 1e-48, 1e-47, 1e-46, 1e-45, 1e-44, 1e-43, 1e-42, 1e-41,
+    1e-40, 1e-39, 1e-38, 1e-37, 1e-36, 1e-35, 1e-34, 1e-33, 1e-32, 1e-31, 1e-30, 1e-29,
+    1e-28, 1e-27, 1e-26, 1e-25, 1e-24, 1e-23, 1e-22, 1e-21, 1e-20, 1e-19, 1e-18, 1e-17,
+    1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-11, 1e-10, 1e-9, 1e-8, 1e-7, 1e-6, 1e-5,
+    1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31,
+    1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39, 1e40, 1e41, 1e42, 1e43,
+    1e44, 1e45, 1e46, 1e47, 1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55,
+    1e56, 1e57, 1e58, 1e59, 1e60, 1e61, 1e62, 1e63, 1e64
+};
+static inline double power_of_ten(int e)
+{
+    return power_of_ten_table[e + 64];
+}
+static uint32_t const power_of_ten_int[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static char* format_uint(uint32_t value, char* p)
+{
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0)
+        *p++ = digits[--n];
+    return p;
+}
+
+// Write the shortest decimal representation of x that is read back as the same float (at most 9 significant digits, as std::to_chars)
+//  The candidates are x rounded to 1, 2, ... digits. They are compared to the rounding interval of x in double precision with a margin larger than the rounding errors,
+//  and exactly when they are close to a bound. The 9 digits mantissa always reads back as x. The output doesn't depend on the locale.
+static char* format_float(float x, char* p)
+{
+    if (std::isnan(x)) {
+        std::memcpy(p, "nan", 3);
+        return p + 3;
+    }
+    if (std::signbit(x))
+        *p++ = '-';
+    float const a = std::fabs(x);
+    if (std::isinf(a)) {
+        std::memcpy(p, "inf", 3);
+        return p + 3;
+    }
+    if (a == 0.0f) {
+        *p++ = '0';
+        return p;
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &a, 4);
+    double const d = a;
+
+    // Decimal exponent of the leading digit
+    int exponent2;
+    std::frexp(d, &exponent2);
+    int e10 = int(std::floor((exponent2 - 1) * 0.30102999566398120));
+    if (d >= power_of_ten(e10 + 1))
+        ++e10;
+    else if (d < power_of_ten(e10))
+        --e10;
+
+    // Interval of the reals rounded to a (the bounds are rounded to the float with an even mantissa)
+    float below, above;
+    uint32_t const bits_below = bits - 1, bits_above = bits + 1;
+    std::memcpy(&below, &bits_below, 4);
+    std::memcpy(&above, &bits_above, 4);
+    double const low = 0.5 * (d + double(below));
+    double const high = std::isinf(above) ? d + 0.5 * (d - double(below)) : 0.5 * (d + double(above));
+    bool const even = (bits & 1) == 0;
+
+    // 9 digits mantissa, and bounds of the interval, in units of 10^(e10-8)
+    double const scale = power_of_ten(8 - e10);
+    double const scaled = d * scale;
+    uint32_t const mantissa_9 = uint32_t(std::floor(scaled + 0.5));
+    double const low_scaled = low * scale;
+    double const high_scaled = high * scale;
+    double const margin = 1e-6; // larger than the rounding errors of the scaled values (< 1e10)
+
+    // Mantissa of x rounded to n digits, and test if it reads back as x
+    auto rounded_mantissa = [&](int n) { return uint32_t(std::floor(scaled * power_of_ten(n - 9) + 0.5)); };
+    auto is_inside = [&](int n, uint32_t m) {
+        double const candidate = double(m) * power_of_ten_int[9 - n];
+        if (candidate > low_scaled + margin && candidate < high_scaled - margin)
+            return true;
+        if (std::fabs(candidate - low_scaled) <= margin || std::fabs(candidate - high_scaled) <= margin) {
+            // Only an integer candidate can be exactly on a bound: compare exactly when it is representable
+            int const e = e10 - n + 1;
+            if (e >= 0 && e <= 22 && double(m) * power_of_ten(e) < 9007199254740992.0) {
+                double const value = double(m) * power_of_ten(e);
+                return (value > low && value < high) || (even && (value == low || value == high));
+            }
+        }
+        return false;
+    };
+
+    // If x rounded to n digits reads back as x, it is also the case with more digits: binary search of the smallest number of digits
+    int digits_min = 1, digits = 9;
+    while (digits_min < digits) {
+        int const n = (digits_min + digits) / 2;
+        if (is_inside(n, rounded_mantissa(n)))
+            digits = n;
+        else
+            digits_min = n + 1;
+    }
+    uint32_t mantissa = digits == 9 ? mantissa_9 : rounded_mantissa(digits);
+
+    // Rounding up can add a digit (ex. 9.99 -> 10.0)
+    if (mantissa >= power_of_ten_int[digits]) {
+        mantissa /= 10;
+        ++e10;
+    }
+    while (digits > 1 && mantissa % 10 == 0) {
+        mantissa /= 10;
+        --digits;
+    }
+
+    char digit[9];
+    for (int k = digits - 1; k >= 0; --k) {
+        digit[k] = char('0' + mantissa % 10);
+        mantissa /= 10;
+    }
+
+    if (e10 >= 0 && e10 < 9) {
+        // ddd, ddd000, dd.ddd
+        for (int k = 0; k <= e10 || k < digits; ++k) {
+            if (k == e10 + 1)
+                *p++ = '.';
+            *p++ = k < digits ? digit[k] : '0';
+        }
+    }
+    else if (e10 < 0 && e10 >= -5) {
+        // 0.000ddd
+        *p++ = '0';
+        *p++ = '.';
+        for (int k = 0; k < -e10 - 1; ++k)
+            *p++ = '0';
+        for (int k = 0; k < digits; ++k)
+            *p++ = digit[k];
+    }
+    else {
+        // d.ddde-xx
+        *p++ = digit[0];
+        if (digits > 1) {
+            *p++ = '.';
+            for (int k = 1; k < digits; ++k)
+                *p++ = digit[k];
+        }
+        *p++ = 'e';
+        *p++ = e10 < 0 ? '-' : '+';
+        int const e = e10 < 0 ? -e10 : e10;
+        if (e < 10)
+            *p++ = '0';
+        p = format_uint(uint32_t(e), p);
+    }
+    return p;
+}
+
+// Maximal number of characters of a formatted float, and of an index
+static size_t const float_max_size = 16;
+static size_t const index_max_size = 10;
+
+// Output file written by large chunks. The lines are formatted in reusable buffers, in parallel for large sections.
+class obj_file_writer
+{
+public:
+    obj_file_writer(std::string const& filename, int number_of_threads)
+        :stream(filename, std::ios::out | std::ios::binary), number_of_threads(number_of_threads)
+    {
+        assert_cgp(stream.is_open(), "Cannot open file " + str(filename));
+    }
+
+    // Write the lines format(k, p) for k in [0,N[. format writes at most line_max_size characters starting at p and returns the end of the line.
+    template <typename F>
+    void write_lines(size_t N, size_t line_max_size, F const& format)
+    {
+        int const T = parallel_number_of_threads(N / minimal_lines_per_thread, number_of_threads);
+        size_t const lines_per_chunk = std::max<size_t>(1, chunk_size / line_max_size);
+        size_t const lines_per_batch = lines_per_chunk * size_t(T);
+        if (buffer.size() < size_t(T))
+            buffer.resize(T);
+        std::vector<size_t> buffer_size(T, 0);
+
+        for (size_t batch_begin = 0; batch_begin < N; batch_begin += lines_per_batch) {
+            size_t const batch_end = std::min(N, batch_begin + lines_per_batch);
+            parallel_for_chunk(batch_end - batch_begin, T, [&](size_t k_begin, size_t k_end, int thread) {
+                std::vector<char>& b = buffer[thread];
+                if (b.size() < (k_end - k_begin) * line_max_size)
+                    b.resize((k_end - k_begin) * line_max_size);
+                char* p = b.data();
+                for (size_t k = batch_begin + k_begin; k < batch_begin + k_end; ++k)
+                    p = format(k, p);
+                buffer_size[thread] = size_t(p - b.data());
+            });
+            // The chunks are ordered by thread index
+            int const T_batch = parallel_number_of_threads(batch_end - batch_begin, T);
+            for (int t = 0; t < T_batch; ++t)
+                stream.write(buffer[t].data(), std::streamsize(buffer_size[t]));
+        }
+    }
+
+    void close()
+    {
+        stream.close();
+        assert_cgp(!stream.fail(), "Error while writing the obj file");
+    }
+
+private:
+    // Size of the text formatted before being written in the file
+    static size_t const chunk_size = size_t(1) << 20;
+    // Sections smaller than this number of lines per thread are formatted on a single thread
+    static size_t const minimal_lines_per_thread = 64 * 1024;
+
+    std::ofstream stream;
+    int number_of_threads;
+    std::vector<std::vector<char>> buffer;
+};
+
+static char* format_vec3_line(char const* prefix, size_t prefix_size, vec3 const& v, char* p)
+{
+    std::memcpy(p, prefix, prefix_size);
+    p += prefix_size;
+    p = format_float(v.x, p);
+    *p++ = ' ';
+    p = format_float(v.y, p);
+    *p++ = ' ';
+    p = format_float(v.z, p);
+    *p++ = '\n';
+    return p;
+}
+
+// Face vertex "p", "p/t", "p//n" or "p/t/n" with the same index for the three attributes
+static char* format_face_vertex(uint32_t index, bool has_uv, bool has_normal, char* p)
+{
+    p = format_uint(index, p);
+    if (has_uv || has_normal) {
+        *p++ = '/';
+        if (has_uv)
+            p = format_uint(index, p);
+        if (has_normal) {
+            *p++ = '/';
+            p = format_uint(index, p);
+        }
+    }
+    return p;
+}
+
+static char* format_face_line(uint3 const& f, bool has_uv, bool has_normal, char* p)
+{
+    *p++ = 'f';
+    for (int k = 0; k < 3; ++k) {
+        *p++ = ' ';
+        p = format_face_vertex(f[k] + 1, has_uv, has_normal, p);
+    }
+    *p++ = '\n';
+    return p;
+}
+
+static size_t const vec3_line_max_size = 3 + 3 * (float_max_size + 1);
+static size_t const face_line_max_size = 2 + 3 * (3 * (index_max_size + 1) + 1);
+
+}
+
+    void mesh_save_file_obj(std::string const& filename, mesh const& m, int number_of_threads)
+    {
+        using namespace loader;
+        obj_file_writer writer(filename, number_of_threads);
+
+        // The uv and normals are written if they are defined for every vertex, the faces then refer to them with the index of the vertex
+        bool const has_uv = m.uv.size() > 0 && m.uv.size() == m.position.size();
+        bool const has_normal = m.normal.size() > 0 && m.normal.size() == m.position.size();
+
+        writer.write_lines(m.position.size(), vec3_line_max_size, [&](size_t k, char* p) { return format_vec3_line("v ", 2, m.position.at(int(k)), p); });
+        if (has_uv) {
+            writer.write_lines(m.uv.size(), 4 + 2 * (float_max_size + 1), [&](size_t k, char* p) {
+                vec2 const& uv = m.uv.at(int(k));
+                std::memcpy(p, "vt ", 3);
+                p = format_float(uv.x, p + 3);
+                *p++ = ' ';
+                p = format_float(uv.y, p);
+                *p++ = '\n';
+                return p;
+            });
+        }
+        if (has_normal)
+            writer.write_lines(m.normal.size(), vec3_line_max_size, [&](size_t k, char* p) { return format_vec3_line("vn ", 3, m.normal.at(int(k)), p); });
+        writer.write_lines(m.connectivity.size(), face_line_max_size, [&](size_t k, char* p) { return format_face_line(m.connectivity.at(int(k)), has_uv, has_normal, p); });
+
+        writer.close();
+    }
+
+    void save_file_obj(std::string const& filename, mesh const& m)
+    {
+        mesh_save_file_obj(filename, m);
+    }
+
+    void save_file_obj(std::string const& filename, std::vector<vec3> const& position, std::vector<vec3> const& normal, int number_of_threads)
+    {
+        using namespace loader;
+        obj_file_writer writer(filename, number_of_threads);
+
+        bool const has_normal = normal.size() > 0;
+        writer.write_lines(position.size(), vec3_line_max_size, [&](size_t k, char* p) { return format_vec3_line("v ", 2, position[k], p); });
+        writer.write_lines(normal.size(), vec3_line_max_size, [&](size_t k, char* p) { return format_vec3_line("vn ", 3, normal[k], p); });
+        writer.write_lines(position.size() / 3, face_line_max_size, [&](size_t k, char* p) {
+            uint32_t const i = uint32_t(3 * k);
+            return format_face_line(uint3{ i, i + 1, i + 2 }, false, has_normal, p);
+        });
+
+        writer.close();
+    }
+
+    std::future<void> mesh_save_file_obj_async(std::string const& filename, mesh m, int number_of_threads)
+    {
+        auto const m_ptr = std::make_shared<mesh>(std::move(m));
+        return std::async(std::launch::async, [filename, m_ptr, number_of_threads]() {
+            mesh_save_file_obj(filename, *m_ptr, number_of_threads);
+        });
+    }
+
+    std::future<void> save_file_obj_async(std::string const& filename, std::vector<vec3> position, std::vector<vec3> normal, int number_of_threads)
+    {
+        auto const data = std::make_shared<std::pair<std::vector<vec3>, std::vector<vec3>>>(std::move(position), std::move(normal));
+        return std::async(std::launch::async, [filename, data, number_of_threads]() {
+            save_file_obj(filename, data->first, data->second, number_of_threads);
+        });
+    }
+}
@@ -0,0 +1,69 @@
+#include "cgp/01_base/base.hpp"
+#include "../obj.hpp"
+
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace cgp_test {
+
+	static bool is_same_float(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	// Parse the positions "v x y z" of the text and compare them bitwise to the expected values
+	static bool is_parsed_as(std::string const& text, std::vector<float> const& expected)
+	{
+		cgp::loader::obj_content const content = cgp::loader::obj_parse(text.data(), text.size(), 1);
+		if (3 * content.position.size() != expected.size())
+			return false;
+		for (int k = 0; k < content.position.size(); ++k)
+			for (int c = 0; c < 3; ++c)
+				if (!is_same_float(content.position[k][c], expected[3 * k + c]))
+					return false;
+		return true;
+	}
+
+	void test_obj_parser()
+	{
+		// Numbers written with 17 significant digits (or more): converted by the slow paths of the parser.
+		// The expected values are given by strtof in the "C" locale.
+		std::vector<std::string> numbers = {
+			"0.1", "-2.5", "1e-30", "-0", "3.4028235e38", "1e39", "-inf", "1e-40", "1e-50",
+			"0.10000000000000000555", "1.0000000596046447753906250000000001", "123456789012345678901234567890", "7.0064923216240853546186479164495807e-46"
+		};
+		for (int k = 0; k < 3000; ++k) {
+			double const x = (std::rand() / double(RAND_MAX) - 0.5) * std::pow(10.0, std::rand() % 20 - 10);
+			char buffer[64];
+			std::snprintf(buffer, sizeof(buffer), "%.17g", x);
+			numbers.push_back(buffer);
+		}
+		while (numbers.size() % 3 != 0)
+			numbers.push_back("0");
+
+		// One vertex per line
+		std::string obj;
+		std::vector<float> expected;
+		for (size_t k = 0; k < numbers.size(); ++k) {
+			expected.push_back(std::strtof(numbers[k].c_str(), nullptr));
+			obj += (k % 3 == 0 ? "v " : " ") + numbers[k] + (k % 3 == 2 ? "\n" : "");
+		}
+		assert_cgp_no_msg(is_parsed_as(obj, expected));
+
+		// Same result with a locale using a comma as decimal separator (if one is installed)
+		std::string const previous_locale = std::setlocale(LC_NUMERIC, nullptr);
+		for (char const* name : { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "French", "German" }) {
+			if (std::setlocale(LC_NUMERIC, name) != nullptr) {
+				assert_cgp_no_msg(is_parsed_as(obj, expected));
+				break;
+			}
+		}
+		std::setlocale(LC_NUMERIC, previous_locale.c_str());
+	}
+}
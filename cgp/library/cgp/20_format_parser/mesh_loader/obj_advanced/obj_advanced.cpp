@@ -1,4 +1,7 @@
 #include "obj_advanced.hpp"
+#include "../mesh_binary/mesh_binary.hpp"
+
+#include <map>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "third_party/src/tinyobj/tiny_obj_loader.hpp"
@@ -23,10 +26,9 @@ namespace cgp
 		}
 	}
 
-	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename)
+	// Read the meshes of the file (one mesh per shape and per material) and the name of their diffuse texture (empty if there is none)
+	static void load_obj_advanced_meshes(std::string const& directory, std::string const& filename, std::vector<mesh>& meshes, std::vector<std::string>& texture_names)
 	{
-		std::vector<mesh_obj_advanced_loader::shape_element_node> data;
-
 		std::string inputfile = directory + filename; // project::path + "assets/StMaria/StMaria.obj";
 		tinyobj::ObjReaderConfig reader_config;
 		tinyobj::ObjReader reader;
@@ -46,19 +48,9 @@ namespace cgp
 		auto& shapes = reader.GetShapes();
 		auto& materials = reader.GetMaterials();
 
-		int N_material = materials.size();
-		std::vector<opengl_texture_image_structure> texture_array;
-		texture_array.resize(N_material);
-
-		for (int k = 0; k < N_material; ++k) {
-			std::string texture_filename = materials[k].diffuse_texname;
-			if (texture_filename != "") {
-				texture_array[k].load_and_initialize_texture_2d_on_gpu(directory + texture_filename, GL_REPEAT, GL_REPEAT);
-			}
-			else {
-				texture_array[k] = mesh_drawable::default_texture;
-			}
-		}
+		auto texture_name = [&](int idx_material) {
+			return (idx_material >= 0 && idx_material < int(materials.size())) ? materials[idx_material].diffuse_texname : std::string();
+		};
 
 
 		// Loop over shapes
@@ -80,11 +72,8 @@ namespace cgp
 				{
 					if (idx_material_previous != -1)
 					{
-						mesh_obj_advanced_loader::shape_element_node node;
-						node.mesh_element = mesh_current;
-						node.texture_element = texture_array[idx_material_previous];
-
-						data.push_back(node);
+						meshes.push_back(mesh_current);
+						texture_names.push_back(texture_name(idx_material_previous));
 						mesh_current = mesh();
 						connectivity_counter = 0;
 
@@ -129,15 +118,53 @@ namespace cgp
 				connectivity_counter += 3;
 
 				if (f == shapes[shape_idx].mesh.num_face_vertices.size() - 1) {
-					mesh_obj_advanced_loader::shape_element_node node;
-					node.mesh_element = mesh_current;
-					node.texture_element = texture_array[idx_material];
-					data.push_back(node);
+					meshes.push_back(mesh_current);
+					texture_names.push_back(texture_name(idx_material));
 				}
 			}
 		}
+	}
 
-
+	// Associate the textures to the meshes (each texture file is loaded once)
+	static std::vector<mesh_obj_advanced_loader::shape_element_node> build_shape_element_nodes(std::string const& directory, std::vector<mesh> const& meshes, std::vector<std::string> const& texture_names)
+	{
+		std::map<std::string, opengl_texture_image_structure> texture_map;
+		std::vector<mesh_obj_advanced_loader::shape_element_node> data(meshes.size());
+		for (size_t k = 0; k < meshes.size(); ++k)
+		{
+			std::string const& texture_filename = texture_names[k];
+			if (texture_map.find(texture_filename) == texture_map.end()) {
+				if (texture_filename != "")
+					texture_map[texture_filename].load_and_initialize_texture_2d_on_gpu(directory + texture_filename, GL_REPEAT, GL_REPEAT);
+				else
+					texture_map[texture_filename] = mesh_drawable::default_texture;
+			}
+			data[k].mesh_element = meshes[k];
+			data[k].texture_element = texture_map[texture_filename];
+		}
 		return data;
 	}
+
+	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename)
+	{
+		std::vector<mesh> meshes;
+		std::vector<std::string> texture_names;
+		load_obj_advanced_meshes(directory, filename, meshes, texture_names);
+		return build_shape_element_nodes(directory, meshes, texture_names);
+	}
+
+	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced_cached(std::string const& directory, std::string const& filename)
+	{
+		std::vector<mesh> meshes;
+		std::vector<std::string> texture_names;
+		if (!mesh_cache::load(directory + filename, mesh_cache::loader_obj_advanced, meshes, texture_names))
+		{
+			load_obj_advanced_meshes(directory, filename, meshes, texture_names);
+			for (mesh& m : meshes)
+				if (m.position.size() > 0 && m.connectivity.size() > 0)
+					m.fill_empty_field();
+			mesh_cache::save(directory + filename, mesh_cache::loader_obj_advanced, meshes, texture_names);
+		}
+		return build_shape_element_nodes(directory, meshes, texture_names);
+	}
 }
\ No newline at end of file
@@ -17,5 +17,8 @@ namespace cgp
 
 	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename);
 
+	/** Same as mesh_load_file_obj_advanced using the binary cache (see mesh_cache): the meshes (after fill_empty_field) and the names of their textures are stored in filename.cgpmesh */
+	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced_cached(std::string const& directory, std::string const& filename);
+
 
 }
\ No newline at end of file
@@ -0,0 +1,413 @@
+#include "ply.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "../binary_stream/binary_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace cgp
+{
+namespace loader
+{
+	enum class ply_type { int8, uint8, int16, uint16, int32, uint32, float32, float64, undefined };
+
+	static ply_type ply_type_from_name(std::string const& name)
+	{
+		if (name == "char" || name == "int8") return ply_type::int8;
+		if (name == "uchar" || name == "uint8") return ply_type::uint8;
+		if (name == "short" || name == "int16") return ply_type::int16;
+		if (name == "ushort" || name == "uint16") return ply_type::uint16;
+		if (name == "int" || name == "int32") return ply_type::int32;
+		if (name == "uint" || name == "uint32") return ply_type::uint32;
+		if (name == "float" || name == "float32") return ply_type::float32;
+		if (name == "double" || name == "float64") return ply_type::float64;
+		return ply_type::undefined;
+	}
+
+	static size_t ply_type_size(ply_type type)
+	{
+		switch (type) {
+		case ply_type::int8: case ply_type::uint8: return 1;
+		case ply_type::int16: case ply_type::uint16: return 2;
+		case ply_type::int32: case ply_type::uint32: case ply_type::float32: return 4;
+		case ply_type::float64: return 8;
+		default: return 0;
+		}
+	}
+
+	// Maximal value of an integer type (used to normalize the colors)
+	static double ply_type_maximal_value(ply_type type)
+	{
+		switch (type) {
+		case ply_type::int8: return 127.0;
+		case ply_type::uint8: return 255.0;
+		case ply_type::int16: return 32767.0;
+		case ply_type::uint16: return 65535.0;
+		case ply_type::int32: return 2147483647.0;
+		case ply_type::uint32: return 4294967295.0;
+		default: return 1.0;
+		}
+	}
+
+	template <typename T>
+	static inline T load_value(char const* p, bool swap)
+	{
+		T value;
+		if (swap) {
+			char bytes[sizeof(T)];
+			std::reverse_copy(p, p + sizeof(T), bytes);
+			std::memcpy(&value, bytes, sizeof(T));
+		}
+		else
+			std::memcpy(&value, p, sizeof(T));
+		return value;
+	}
+
+	static inline double load_scalar(char const* p, ply_type type, bool swap)
+	{
+		switch (type) {
+		case ply_type::int8: return double(load_value<int8_t>(p, swap));
+		case ply_type::uint8: return double(load_value<uint8_t>(p, swap));
+		case ply_type::int16: return double(load_value<int16_t>(p, swap));
+		case ply_type::uint16: return double(load_value<uint16_t>(p, swap));
+		case ply_type::int32: return double(load_value<int32_t>(p, swap));
+		case ply_type::uint32: return double(load_value<uint32_t>(p, swap));
+		case ply_type::float32: return double(load_value<float>(p, swap));
+		default: return load_value<double>(p, swap);
+		}
+	}
+
+	struct ply_property
+	{
+		std::string name;
+		ply_type type = ply_type::undefined;
+		ply_type count_type = ply_type::undefined; // type of the number of elements for a list property, undefined for a scalar
+		size_t offset = 0;                          // position in the element (only for elements without list properties)
+	};
+
+	struct ply_element
+	{
+		std::string name;
+		size_t count = 0;
+		std::vector<ply_property> property;
+		bool has_list = false;
+		size_t stride = 0; // size in bytes of an element without list properties
+	};
+
+	struct ply_header
+	{
+		bool big_endian = false;
+		std::vector<ply_element> element;
+	};
+
+	static ply_header read_ply_header(binary_file_reader& reader, std::string const& filename)
+	{
+		ply_header header;
+		std::string line;
+		if (!reader.read_line(line) || line != "ply")
+			error_cgp("File " + filename + " is not a PLY file");
+
+		bool has_format = false;
+		while (true) {
+			if (!reader.read_line(line))
+				error_cgp("Unexpected end of file in the header of the PLY file " + filename);
+
+			std::istringstream stream(line);
+			std::string keyword;
+			stream >> keyword;
+
+			if (keyword == "end_header")
+				break;
+			else if (keyword == "format") {
+				std::string format;
+				stream >> format;
+				if (format == "binary_little_endian")
+					header.big_endian = false;
+				else if (format == "binary_big_endian")
+					header.big_endian = true;
+				else
+					error_cgp("Unsupported format \"" + format + "\" in PLY file " + filename + " (only binary_little_endian and binary_big_endian are handled)");
+				has_format = true;
+			}
+			else if (keyword == "element") {
+				ply_element element;
+				stream >> element.name >> element.count;
+				if (stream.fail())
+					error_cgp("Invalid line \"" + line + "\" in the header of the PLY file " + filename);
+				header.element.push_back(element);
+			}
+			else if (keyword == "property") {
+				if (header.element.size() == 0)
+					error_cgp("Property defined before any element in the PLY file " + filename);
+				ply_element& element = header.element.back();
+
+				ply_property property;
+				std::string type_name;
+				stream >> type_name;
+				if (type_name == "list") {
+					std::string count_type_name;
+					stream >> count_type_name >> type_name;
+					property.count_type = ply_type_from_name(count_type_name);
+					if (property.count_type == ply_type::undefined || property.count_type == ply_type::float32 || property.count_type == ply_type::float64)
+						error_cgp("Invalid list property \"" + line + "\" in the PLY file " + filename);
+					element.has_list = true;
+				}
+				property.type = ply_type_from_name(type_name);
+				stream >> property.name;
+				if (property.type == ply_type::undefined || stream.fail())
+					error_cgp("Invalid property \"" + line + "\" in the PLY file " + filename);
+
+				property.offset = element.stride;
+				element.stride += ply_type_size(property.type);
+				element.property.push_back(property);
+			}
+			// comment, obj_info and unknown keywords are ignored
+		}
+
+		if (!has_format)
+			error_cgp("Missing format in the header of the PLY file " + filename);
+		return header;
+	}
+
+	static char const* read_or_stop(binary_file_reader& reader, size_t N, std::string const& filename)
+	{
+		char const* p = reader.read(N);
+		if (p == nullptr)
+			error_cgp("Unexpected end of the PLY file " + filename);
+		return p;
+	}
+
+	// Read one element containing list properties. The list named list_name is returned in list_data/list_size (if it exists).
+	static void read_ply_element_with_list(binary_file_reader& reader, ply_element const& element, bool swap, std::string const& filename, int list_index, char const*& list_data, size_t& list_size)
+	{
+		list_data = nullptr;
+		list_size = 0;
+		for (int k = 0; k < int(element.property.size()); ++k) {
+			ply_property const& property = element.property[k];
+			size_t const element_size = ply_type_size(property.type);
+			if (property.count_type == ply_type::undefined) {
+				read_or_stop(reader, element_size, filename);
+				continue;
+			}
+
+			double const count = load_scalar(read_or_stop(reader, ply_type_size(property.count_type), filename), property.count_type, swap);
+			// The count comes from the file: a corrupted value must not lead to a huge allocation
+			if (count < 0 || count * double(element_size) > double(reader.remaining()))
+				error_cgp("Incorrect size of list " + str(count) + " in the PLY file " + filename + " (larger than the rest of the file)");
+			size_t const N = size_t(count);
+			char const* data = read_or_stop(reader, N * element_size, filename);
+			if (k == list_index) {
+				list_data = data;
+				list_size = N;
+			}
+		}
+	}
+
+	static void read_ply_vertices(binary_file_reader& reader, ply_element const& element, bool swap, std::string const& filename, mesh& m)
+	{
+		if (element.has_list)
+			error_cgp("List properties in the vertices of the PLY file " + filename + " are not handled");
+
+		// Target of each read property: 0-2 position, 3-5 normal, 6-8 color, 9-10 uv
+		struct vertex_field
+		{
+			size_t offset;
+			ply_type type;
+			int target;
+			double scale;
+		};
+		static char const* const names[][4] = {
+			{"x"}, {"y"}, {"z"},
+			{"nx"}, {"ny"}, {"nz"},
+			{"red", "r", "diffuse_red"}, {"green", "g", "diffuse_green"}, {"blue", "b", "diffuse_blue"},
+			{"u", "s", "texture_u", "texture_s"}, {"v", "t", "texture_v", "texture_t"}
+		};
+		int const number_of_target = 11;
+
+		std::vector<vertex_field> field;
+		bool found[number_of_target] = {};
+		for (ply_property const& property : element.property) {
+			for (int target = 0; target < number_of_target; ++target) {
+				bool match = false;
+				for (int k = 0; k < 4 && names[target][k] != nullptr; ++k)
+					match = match || property.name == names[target][k];
+				if (match && !found[target]) {
+					found[target] = true;
+					bool const is_color = target >= 6 && target <= 8;
+					field.push_back({ property.offset, property.type, target, is_color ? 1.0 / ply_type_maximal_value(property.type) : 1.0 });
+				}
+			}
+		}
+		if (!(found[0] && found[1] && found[2]))
+			error_cgp("The vertices of the PLY file " + filename + " don't have the x, y, z properties");
+
+		size_t const N = element.count;
+		if (double(N) * double(element.stride) > double(reader.remaining()))
+			error_cgp("The PLY file " + filename + " is truncated: " + str(N) + " vertices are expected");
+		bool const has_normal = found[3] && found[4] && found[5];
+		bool const has_color = found[6] && found[7] && found[8];
+		bool const has_uv = found[9] && found[10];
+		m.position.resize(int(N));
+		if (has_normal) m.normal.resize(int(N));
+		if (has_color) m.color.resize(int(N));
+		if (has_uv) m.uv.resize(int(N));
+
+		for (size_t k = 0; k < N; ++k) {
+			char const* record = read_or_stop(reader, element.stride, filename);
+			float value[number_of_target] = {};
+			for (vertex_field const& f : field)
+				value[f.target] = float(load_scalar(record + f.offset, f.type, swap) * f.scale);
+
+			m.position[k] = { value[0], value[1], value[2] };
+			if (has_normal) m.normal[k] = { value[3], value[4], value[5] };
+			if (has_color) m.color[k] = { value[6], value[7], value[8] };
+			if (has_uv) m.uv[k] = { value[9], value[10] };
+		}
+	}
+
+	static void read_ply_faces(binary_file_reader& reader, ply_element const& element, bool swap, std::string const& filename, size_t number_of_vertex, mesh& m)
+	{
+		int list_index = -1;
+		for (int k = 0; k < int(element.property.size()); ++k)
+			if (element.property[k].count_type != ply_type::undefined && (element.property[k].name == "vertex_indices" || element.property[k].name == "vertex_index"))
+				list_index = k;
+		if (list_index == -1)
+			error_cgp("The faces of the PLY file " + filename + " don't have the vertex_indices property");
+
+		ply_type const index_type = element.property[list_index].type;
+		size_t const index_size = ply_type_size(index_type);
+		if (double(element.count) * double(ply_type_size(element.property[list_index].count_type)) > double(reader.remaining()))
+			error_cgp("The PLY file " + filename + " is truncated: " + str(element.count) + " faces are expected");
+		m.connectivity.data.reserve(m.connectivity.size() + element.count);
+
+		for (size_t k_face = 0; k_face < element.count; ++k_face) {
+			char const* data;
+			size_t N;
+			read_ply_element_with_list(reader, element, swap, filename, list_index, data, N);
+
+			// Triangulation as a fan around the first vertex
+			unsigned int index[3];
+			for (size_t k = 0; k < N; ++k) {
+				double const value = load_scalar(data + k * index_size, index_type, swap);
+				if (value < 0 || value >= double(number_of_vertex))
+					error_cgp("Incorrect vertex index " + str(value) + " in face " + str(k_face) + " of the PLY file " + filename + " (number of vertices: " + str(number_of_vertex) + ")");
+				unsigned int const i = static_cast<unsigned int>(value);
+				if (k < 2)
+					index[k] = i;
+				else {
+					index[2] = i;
+					m.connectivity.push_back({ index[0], index[1], index[2] });
+					index[1] = i;
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	static inline void store_value(char*& p, T value, bool swap)
+	{
+		std::memcpy(p, &value, sizeof(T));
+		if (swap)
+			swap_bytes(p, sizeof(T));
+		p += sizeof(T);
+	}
+}
+
+	mesh mesh_load_file_ply(std::string const& filename)
+	{
+		using namespace loader;
+		assert_file_exist(filename);
+
+		binary_file_reader reader(filename);
+		ply_header const header = read_ply_header(reader, filename);
+		bool const swap = header.big_endian == host_is_little_endian();
+
+		size_t number_of_vertex = 0;
+		for (ply_element const& element : header.element)
+			if (element.name == "vertex")
+				number_of_vertex = element.count;
+
+		mesh m;
+		bool has_vertex = false;
+		for (ply_element const& element : header.element) {
+			if (element.name == "vertex" && !has_vertex) {
+				read_ply_vertices(reader, element, swap, filename, m);
+				has_vertex = true;
+			}
+			else if (element.name == "face")
+				read_ply_faces(reader, element, swap, filename, number_of_vertex, m);
+			else if (!element.has_list) {
+				if (!reader.skip(element.count * element.stride))
+					error_cgp("Unexpected end of the PLY file " + filename);
+			}
+			else {
+				char const* data;
+				size_t N;
+				for (size_t k = 0; k < element.count; ++k)
+					read_ply_element_with_list(reader, element, swap, filename, -1, data, N);
+			}
+		}
+
+		assert_cgp(m.position.size() > 0, "File " + filename + " has 0 vertices");
+		if (m.connectivity.size() > 0)
+			m.fill_empty_field();
+		return m;
+	}
+
+	void mesh_save_file_ply(std::string const& filename, mesh const& m)
+	{
+		using namespace loader;
+		size_t const N = m.position.size();
+		bool const has_normal = m.normal.size() == N;
+		bool const has_color = m.color.size() == N;
+		bool const has_uv = m.uv.size() == N;
+		bool const swap = !host_is_little_endian();
+
+		std::string header = "ply\nformat binary_little_endian 1.0\ncomment cgp\n";
+		header += "element vertex " + str(N) + "\n";
+		header += "property float x\nproperty float y\nproperty float z\n";
+		if (has_normal)
+			header += "property float nx\nproperty float ny\nproperty float nz\n";
+		if (has_color)
+			header += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+		if (has_uv)
+			header += "property float u\nproperty float v\n";
+		header += "element face " + str(m.connectivity.size()) + "\n";
+		header += "property list uchar int vertex_indices\nend_header\n";
+
+		binary_file_writer writer(filename);
+		assert_cgp(writer.is_open(), "Cannot write file " + filename);
+		writer.write(header.data(), header.size());
+
+		size_t const vertex_size = 12 + (has_normal ? 12 : 0) + (has_color ? 3 : 0) + (has_uv ? 8 : 0);
+		for (size_t k = 0; k < N; ++k) {
+			char* p = writer.write(vertex_size);
+			vec3 const& position = m.position[k];
+			store_value(p, position.x, swap); store_value(p, position.y, swap); store_value(p, position.z, swap);
+			if (has_normal) {
+				vec3 const& n = m.normal[k];
+				store_value(p, n.x, swap); store_value(p, n.y, swap); store_value(p, n.z, swap);
+			}
+			if (has_color) {
+				vec3 const& c = m.color[k];
+				for (int i = 0; i < 3; ++i)
+					*p++ = char(uint8_t(std::min(std::max(c[i], 0.0f), 1.0f) * 255.0f + 0.5f));
+			}
+			if (has_uv) {
+				vec2 const& uv = m.uv[k];
+				store_value(p, uv.x, swap); store_value(p, uv.y, swap);
+			}
+		}
+
+		for (uint3 const& f : m.connectivity) {
+			char* p = writer.write(13);
+			*p++ = 3;
+			for (int i = 0; i < 3; ++i)
+				store_value(p, int32_t(f[i]), swap);
+		}
+		writer.close();
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <string>
+
+namespace cgp
+{
+	/** Load a mesh stored in a binary PLY file (format binary_little_endian or binary_big_endian)
+	* Notes:
+	*  - The file is streamed through a fixed size buffer: the elements are decoded directly in the arrays of the mesh
+	*  - The vertex properties x,y,z (position), nx,ny,nz (normal), red,green,blue (color, integer values are divided by their maximal value), and u,v / s,t / texture_u,texture_v (uv) are read, the others are skipped
+	*  - The faces are read from the list property vertex_indices (or vertex_index), polygons are triangulated as fans
+	*  - Other elements (edges, materials, etc.) are skipped
+	*  - ASCII PLY files are not handled
+	*  - fill_empty_field is called if the file has faces (a point cloud is returned as it is)
+	*/
+	mesh mesh_load_file_ply(std::string const& filename);
+
+	/** Save a mesh in a binary little endian PLY file
+	* The normals, colors (as unsigned char) and uv are written if they are defined for every vertex. */
+	void mesh_save_file_ply(std::string const& filename, mesh const& m);
+}
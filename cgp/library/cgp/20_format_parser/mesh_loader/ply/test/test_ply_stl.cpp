@@ -0,0 +1,161 @@
+#include "cgp/01_base/base.hpp"
+#include "../ply.hpp"
+#include "../../stl/stl.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+
+namespace cgp_test {
+
+	// Append the bytes of a value in a given byte order (independent of the byte order of the host)
+	static void append_bytes(std::string& s, uint64_t bits, int size, bool big_endian)
+	{
+		for (int k = 0; k < size; ++k) {
+			int const shift = 8 * (big_endian ? size - 1 - k : k);
+			s.push_back(char((bits >> shift) & 0xff));
+		}
+	}
+	static void append_float(std::string& s, float value, bool big_endian)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, 4);
+		append_bytes(s, bits, 4, big_endian);
+	}
+	static void append_double(std::string& s, double value, bool big_endian)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, 8);
+		append_bytes(s, bits, 8, big_endian);
+	}
+
+	static void write_file(std::string const& filename, std::string const& content)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		stream.write(content.data(), std::streamsize(content.size()));
+	}
+
+	static bool is_same_position(cgp::mesh const& a, cgp::mesh const& b)
+	{
+		if (a.position.size() != b.position.size())
+			return false;
+		for (int k = 0; k < a.position.size(); ++k)
+			if (!cgp::is_equal(a.position[k], b.position[k]))
+				return false;
+		return true;
+	}
+
+	void test_ply_stl()
+	{
+		using namespace cgp;
+		std::string const filename_ply = "test_ply_stl.ply";
+		std::string const filename_stl = "test_ply_stl.stl";
+
+		// Round trip of a binary PLY file with every attribute (colors are 0 or 1 to be exact once stored as uchar)
+		{
+			mesh m;
+			m.position = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0.5f} };
+			m.normal = { {0,0,1}, {0,0,1}, {0,1,0}, {1,0,0} };
+			m.color = { {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1} };
+			m.uv = { {0,0}, {1,0}, {1,1}, {0.25f,0.75f} };
+			m.connectivity = { {0,1,2}, {0,2,3} };
+			mesh_save_file_ply(filename_ply, m);
+
+			mesh const loaded = mesh_load_file_ply(filename_ply);
+			assert_cgp_no_msg(is_same_position(loaded, m));
+			assert_cgp_no_msg(loaded.connectivity.size() == 2);
+			for (int k = 0; k < 2; ++k)
+				assert_cgp_no_msg(is_equal(loaded.connectivity[k], m.connectivity[k]));
+			for (int k = 0; k < 4; ++k) {
+				assert_cgp_no_msg(is_equal(loaded.normal[k], m.normal[k]));
+				assert_cgp_no_msg(is_equal(loaded.color[k], m.color[k]));
+				assert_cgp_no_msg(is_equal(loaded.uv[k], m.uv[k]));
+			}
+		}
+
+		// Big endian PLY with an extra vertex property, an extra element with a list placed before the faces, and a quad
+		{
+			std::string ply = "ply\nformat binary_big_endian 1.0\ncomment written by test_ply_stl\n";
+			ply += "element vertex 4\nproperty float x\nproperty double confidence\nproperty float y\nproperty float z\n";
+			ply += "element edge 2\nproperty list uchar int vertex_pair\nproperty uchar flag\n";
+			ply += "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+			float const position[4][3] = { {0,0,0}, {2,0,0}, {2,3,0}, {0,3,-1.5f} };
+			for (int k = 0; k < 4; ++k) {
+				append_float(ply, position[k][0], true);
+				append_double(ply, 0.5 * k, true);
+				append_float(ply, position[k][1], true);
+				append_float(ply, position[k][2], true);
+			}
+			for (int k = 0; k < 2; ++k) {
+				ply.push_back(char(2));
+				append_bytes(ply, uint32_t(k), 4, true);
+				append_bytes(ply, uint32_t(k + 1), 4, true);
+				ply.push_back(char(7));
+			}
+			ply.push_back(char(4));
+			for (uint32_t i : { 0u, 1u, 2u, 3u })
+				append_bytes(ply, i, 4, true);
+			write_file(filename_ply, ply);
+
+			mesh const loaded = mesh_load_file_ply(filename_ply);
+			assert_cgp_no_msg(loaded.position.size() == 4);
+			for (int k = 0; k < 4; ++k)
+				assert_cgp_no_msg(is_equal(loaded.position[k], vec3{ position[k][0], position[k][1], position[k][2] }));
+			// The quad is triangulated as a fan around its first vertex
+			assert_cgp_no_msg(loaded.connectivity.size() == 2);
+			assert_cgp_no_msg(is_equal(loaded.connectivity[0], uint3{ 0,1,2 }));
+			assert_cgp_no_msg(is_equal(loaded.connectivity[1], uint3{ 0,2,3 }));
+		}
+
+		// Round trip of a binary STL file, as a triangle soup and with welded vertices
+		{
+			mesh m;
+			m.position = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0} };
+			m.connectivity = { {0,1,2}, {0,2,3} };
+			mesh_save_file_stl(filename_stl, m);
+
+			mesh const soup = mesh_load_file_stl(filename_stl, false);
+			assert_cgp_no_msg(soup.position.size() == 6);
+			assert_cgp_no_msg(soup.connectivity.size() == 2);
+			for (int k = 0; k < 6; ++k) {
+				assert_cgp_no_msg(is_equal(soup.position[k], m.position[m.connectivity[k / 3][k % 3]]));
+				assert_cgp_no_msg(is_equal(soup.normal[k], vec3{ 0,0,1 }));
+			}
+
+			mesh const welded = mesh_load_file_stl(filename_stl, true);
+			assert_cgp_no_msg(is_same_position(welded, m));
+			assert_cgp_no_msg(welded.connectivity.size() == 2);
+			for (int k = 0; k < 2; ++k)
+				assert_cgp_no_msg(is_equal(welded.connectivity[k], m.connectivity[k]));
+		}
+
+		// Welding of the positions with -0 and +0 coordinates
+		{
+			std::string stl(80, ' ');
+			append_bytes(stl, 2, 4, false);
+			float const triangle[2][9] = {
+				{ 0.0f,0.0f,0.0f,  1,0,0,  1,1,0 },
+				{ -0.0f,0.0f,-0.0f,  1,1,0,  0,1,0 }
+			};
+			for (int k = 0; k < 2; ++k) {
+				for (int i = 0; i < 3; ++i)
+					append_float(stl, 0.0f, false);
+				for (int i = 0; i < 9; ++i)
+					append_float(stl, triangle[k][i], false);
+				append_bytes(stl, 0, 2, false);
+			}
+			write_file(filename_stl, stl);
+
+			mesh const welded = mesh_load_file_stl(filename_stl, true);
+			assert_cgp_no_msg(welded.position.size() == 4);
+			assert_cgp_no_msg(welded.connectivity.size() == 2);
+			assert_cgp_no_msg(is_equal(welded.connectivity[1], uint3{ 0,2,3 }));
+		}
+
+		std::remove(filename_ply.c_str());
+		std::remove(filename_stl.c_str());
+	}
+}
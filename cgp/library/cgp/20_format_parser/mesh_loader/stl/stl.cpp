@@ -0,0 +1,144 @@
+#include "stl.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "../binary_stream/binary_stream.hpp"
+#include "../vertex_index_map/vertex_index_map.hpp"
+
+#include <cstring>
+
+namespace cgp
+{
+namespace loader
+{
+	// Binary STL: 80 bytes header, number of triangles (uint32), then 50 bytes per triangle: normal, 3 positions (12 floats) and a 16-bit attribute
+	static size_t const stl_header_size = 84;
+	static size_t const stl_triangle_size = 50;
+
+	static inline void load_floats(char const* p, float* value, int N, bool swap)
+	{
+		std::memcpy(value, p, N * sizeof(float));
+		if (swap)
+			swap_bytes(reinterpret_cast<char*>(value), sizeof(float), N);
+	}
+
+	// Key of a position in the welding table: bit patterns of the coordinates (-0 and +0 are merged)
+	static inline int3 position_key(vec3 const& p)
+	{
+		int3 key;
+		for (int k = 0; k < 3; ++k) {
+			float const value = p[k] == 0.0f ? 0.0f : p[k];
+			std::memcpy(&key[k], &value, sizeof(float));
+		}
+		return key;
+	}
+}
+
+	mesh mesh_load_file_stl(std::string const& filename, bool weld_vertices)
+	{
+		using namespace loader;
+		assert_file_exist(filename);
+
+		size_t const file_size = file_get_size(filename);
+		binary_file_reader reader(filename);
+		char const* header = reader.read(stl_header_size);
+		if (header == nullptr)
+			error_cgp("File " + filename + " is too small to be a binary STL file");
+
+		bool const swap = !host_is_little_endian();
+		uint32_t number_of_triangle;
+		std::memcpy(&number_of_triangle, header + 80, 4);
+		if (swap)
+			swap_bytes(reinterpret_cast<char*>(&number_of_triangle), 4);
+
+		if (stl_header_size + size_t(number_of_triangle) * stl_triangle_size > file_size) {
+			if (std::strncmp(header, "solid", 5) == 0)
+				error_cgp("File " + filename + " seems to be an ASCII STL file (only binary STL files are handled)");
+			error_cgp("File " + filename + " is truncated: " + str(number_of_triangle) + " triangles are expected");
+		}
+
+		size_t const N = number_of_triangle;
+		mesh m;
+		if (!weld_vertices) {
+			m.position.resize(int(3 * N));
+			m.normal.resize(int(3 * N));
+			m.connectivity.resize(int(N));
+		}
+		else
+			m.connectivity.data.reserve(N);
+
+		vertex_index_map welding;
+		if (weld_vertices)
+			welding.reserve(N / 2 + 3); // closed triangle meshes have about twice less vertices than triangles
+
+		for (size_t k_triangle = 0; k_triangle < N; ++k_triangle) {
+			char const* record = reader.read(stl_triangle_size);
+			if (record == nullptr)
+				error_cgp("Unexpected end of the STL file " + filename);
+			float value[12];
+			load_floats(record, value, 12, swap);
+			vec3 const p[3] = { {value[3], value[4], value[5]}, {value[6], value[7], value[8]}, {value[9], value[10], value[11]} };
+
+			if (!weld_vertices) {
+				vec3 n = { value[0], value[1], value[2] };
+				if (norm(n) < 1e-10f)
+					n = normalize(cross(p[1] - p[0], p[2] - p[0]), vec3{ 0,0,1 });
+				for (int i = 0; i < 3; ++i) {
+					m.position[3 * k_triangle + i] = p[i];
+					m.normal[3 * k_triangle + i] = n;
+				}
+				unsigned int const i0 = static_cast<unsigned int>(3 * k_triangle);
+				m.connectivity[k_triangle] = { i0, i0 + 1, i0 + 2 };
+				continue;
+			}
+
+			unsigned int index[3];
+			for (int i = 0; i < 3; ++i) {
+				bool is_new;
+				index[i] = static_cast<unsigned int>(welding.insert(position_key(p[i]), is_new));
+				if (is_new)
+					m.position.push_back(p[i]);
+			}
+			if (index[0] != index[1] && index[1] != index[2] && index[2] != index[0])
+				m.connectivity.push_back({ index[0], index[1], index[2] });
+		}
+
+		assert_cgp(m.position.size() > 0, "File " + filename + " has 0 vertices");
+		if (m.connectivity.size() > 0)
+			m.fill_empty_field();
+		return m;
+	}
+
+	void mesh_save_file_stl(std::string const& filename, mesh const& m)
+	{
+		using namespace loader;
+		bool const swap = !host_is_little_endian();
+
+		binary_file_writer writer(filename);
+		assert_cgp(writer.is_open(), "Cannot write file " + filename);
+
+		char header[stl_header_size] = {};
+		std::strncpy(header, "binary STL written by cgp", 80);
+		uint32_t const number_of_triangle = uint32_t(m.connectivity.size());
+		std::memcpy(header + 80, &number_of_triangle, 4);
+		if (swap)
+			swap_bytes(header + 80, 4);
+		writer.write(header, stl_header_size);
+
+		for (uint3 const& f : m.connectivity) {
+			vec3 const& p0 = m.position[f[0]];
+			vec3 const& p1 = m.position[f[1]];
+			vec3 const& p2 = m.position[f[2]];
+			vec3 const n = normalize(cross(p1 - p0, p2 - p0), vec3{ 0,0,1 });
+
+			float const value[12] = { n.x, n.y, n.z, p0.x, p0.y, p0.z, p1.x, p1.y, p1.z, p2.x, p2.y, p2.z };
+			char* p = writer.write(stl_triangle_size);
+			std::memcpy(p, value, sizeof(value));
+			if (swap)
+				swap_bytes(p, sizeof(float), 12);
+			p[48] = 0;
+			p[49] = 0;
+		}
+		writer.close();
+	}
+}
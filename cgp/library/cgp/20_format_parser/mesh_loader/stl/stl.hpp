@@ -0,0 +1,21 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <string>
+
+namespace cgp
+{
+	/** Load a mesh stored in a binary STL file
+	* Notes:
+	*  - The file is streamed through a fixed size buffer: the triangles are decoded directly in the arrays of the mesh
+	*  - weld_vertices=true: the corners of the triangles with the same position (same float values) are merged in a single vertex with a hash table,
+	*      triangles becoming degenerated are removed, and the normals are computed per vertex by fill_empty_field.
+	*  - weld_vertices=false: each triangle has its own 3 vertices with the normal of the facet stored in the file (triangle soup)
+	*  - ASCII STL files are not handled
+	*/
+	mesh mesh_load_file_stl(std::string const& filename, bool weld_vertices = true);
+
+	/** Save the triangles of a mesh in a binary STL file (the normal of each facet is computed from its positions, the other attributes are not stored) */
+	void mesh_save_file_stl(std::string const& filename, mesh const& m);
+}
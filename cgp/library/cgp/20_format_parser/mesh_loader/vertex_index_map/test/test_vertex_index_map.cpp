@@ -0,0 +1,66 @@
+#include "cgp/01_base/base.hpp"
+#include "../vertex_index_map.hpp"
+
+#include <map>
+#include <tuple>
+
+
+namespace cgp_test {
+
+	void test_vertex_index_map()
+	{
+		using namespace cgp;
+		using cgp::loader::vertex_index_map;
+
+		// Insertion and search of a few keys, indices numbered in insertion order
+		{
+			vertex_index_map map;
+			bool is_new = false;
+			assert_cgp_no_msg(map.insert({ 4,1,2 }, is_new) == 0 && is_new);
+			assert_cgp_no_msg(map.insert({ 2,1,4 }, is_new) == 1 && is_new);
+			assert_cgp_no_msg(map.insert({ 4,1,2 }, is_new) == 0 && !is_new);
+			assert_cgp_no_msg(map.size() == 2);
+			assert_cgp_no_msg(map.find({ 2,1,4 }) == 1);
+			assert_cgp_no_msg(map.find({ 1,2,4 }) == -1);
+			assert_cgp_no_msg(is_equal(map.key(1), int3{ 2,1,4 }));
+
+			map.clear();
+			assert_cgp_no_msg(map.size() == 0);
+			assert_cgp_no_msg(map.find({ 4,1,2 }) == -1);
+			assert_cgp_no_msg(map.insert({ 2,1,4 }) == 0);
+		}
+
+		// Negative keys (-1 is used for the missing uv/normal indices) are distinct from their positive counterparts
+		{
+			vertex_index_map map;
+			assert_cgp_no_msg(map.insert({ 0,-1,-1 }) == 0);
+			assert_cgp_no_msg(map.insert({ 0,1,-1 }) == 1);
+			assert_cgp_no_msg(map.insert({ 0,-1,1 }) == 2);
+			assert_cgp_no_msg(map.insert({ -2147483647 - 1,0,2147483647 }) == 3);
+			assert_cgp_no_msg(map.find({ 0,-1,-1 }) == 0);
+			assert_cgp_no_msg(map.find({ 0,1,1 }) == -1);
+			assert_cgp_no_msg(map.find({ -2147483647 - 1,0,2147483647 }) == 3);
+		}
+
+		// Many keys inserted from the minimal table (several rehash), compared to a std::map
+		for (size_t preallocated : { size_t(0), size_t(5000) }) {
+			vertex_index_map map(preallocated);
+			std::map<std::tuple<int, int, int>, int> reference;
+			for (int k = 0; k < 30000; ++k) {
+				int const i = k % 20000; // the last keys are inserted a second time
+				int3 const key = { (i * 7919) % 3001 - 1500, (i * 31) % 17 - 8, i % 5 - 2 };
+				auto const it = reference.insert({ std::make_tuple(key.x, key.y, key.z), int(reference.size()) });
+				bool is_new;
+				assert_cgp_no_msg(map.insert(key, is_new) == it.first->second);
+				assert_cgp_no_msg(is_new == it.second);
+			}
+			assert_cgp_no_msg(map.size() == int(reference.size()));
+			for (auto const& it : reference) {
+				int3 const key = { std::get<0>(it.first), std::get<1>(it.first), std::get<2>(it.first) };
+				assert_cgp_no_msg(map.find(key) == it.second);
+				assert_cgp_no_msg(is_equal(map.key(it.second), key));
+			}
+			assert_cgp_no_msg(map.find({ 5000,0,0 }) == -1);
+		}
+	}
+}
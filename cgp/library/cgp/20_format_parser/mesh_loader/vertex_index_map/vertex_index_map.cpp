@@ -0,0 +1,131 @@
+#include "vertex_index_map.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+namespace loader
+{
+
+// The table is kept at most half full
+static size_t const minimal_number_of_slots = 16;
+
+static size_t number_of_slots_for(size_t N)
+{
+    size_t n = minimal_number_of_slots;
+    while (n < 2 * N)
+        n *= 2;
+    return n;
+}
+
+static inline bool is_same_key(int3 const& a, int3 const& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+vertex_index_map::vertex_index_map()
+{
+    rehash(minimal_number_of_slots);
+}
+
+vertex_index_map::vertex_index_map(size_t N)
+{
+    rehash(number_of_slots_for(N));
+    key_storage.reserve(N);
+}
+
+size_t vertex_index_map::slot_position(int3 const& key) const
+{
+    // Each index is spread over the 64 bits by a multiplication with a large odd constant, the high bits are then folded down
+    uint64_t h = uint64_t(uint32_t(key.x)) * 0x9E3779B97F4A7C15ull;
+    h ^= uint64_t(uint32_t(key.y)) * 0xC2B2AE3D27D4EB4Full;
+    h ^= uint64_t(uint32_t(key.z)) * 0x165667B19E3779F9ull;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return size_t(h) & mask;
+}
+
+void vertex_index_map::rehash(size_t number_of_slots)
+{
+    slot.assign(number_of_slots, -1);
+    mask = number_of_slots - 1;
+    for (int k = 0; k < int(key_storage.size()); ++k) {
+        size_t p = slot_position(key_storage[k]);
+        while (slot[p] != -1)
+            p = (p + 1) & mask;
+        slot[p] = k;
+    }
+}
+
+int vertex_index_map::insert(int3 const& key, bool& is_new)
+{
+    size_t p = slot_position(key);
+    while (slot[p] != -1) {
+        if (is_same_key(key_storage[slot[p]], key)) {
+            is_new = false;
+            return slot[p];
+        }
+        p = (p + 1) & mask;
+    }
+
+    is_new = true;
+    int const index = int(key_storage.size());
+    key_storage.push_back(key);
+    slot[p] = index;
+    if (2 * key_storage.size() > slot.size())
+        rehash(2 * slot.size());
+    return index;
+}
+
+int vertex_index_map::insert(int3 const& key)
+{
+    bool is_new;
+    return insert(key, is_new);
+}
+
+int vertex_index_map::find(int3 const& key) const
+{
+    size_t p = slot_position(key);
+    while (slot[p] != -1) {
+        if (is_same_key(key_storage[slot[p]], key))
+            return slot[p];
+        p = (p + 1) & mask;
+    }
+    return -1;
+}
+
+int vertex_index_map::size() const
+{
+    return int(key_storage.size());
+}
+
+int3 const& vertex_index_map::key(int index) const
+{
+    assert_cgp(index >= 0 && index < int(key_storage.size()), "Incorrect index " + str(index) + " in vertex_index_map of size " + str(key_storage.size()));
+    return key_storage[index];
+}
+
+std::vector<int3> const& vertex_index_map::keys() const
+{
+    return key_storage;
+}
+
+void vertex_index_map::reserve(size_t N)
+{
+    key_storage.reserve(N);
+    size_t const number_of_slots = number_of_slots_for(N);
+    if (number_of_slots > slot.size())
+        rehash(number_of_slots);
+}
+
+void vertex_index_map::clear()
+{
+    key_storage.clear();
+    slot.assign(slot.size(), -1);
+}
+
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "cgp/05_vec/vec.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace cgp
+{
+namespace loader
+{
+    /** Map from a triplet of integers (ex. position/uv/normal indices of an OBJ face vertex) to a unique index numbered in insertion order (0, 1, 2, ...)
+     * Open addressing hash table with linear probing: no allocation per element, and a constant expected time per query whatever the values of the indices (negative indices are valid keys).
+     *
+     * Ex.
+     *   vertex_index_map map;
+     *   bool is_new;
+     *   int const index = map.insert({p,t,n}, is_new); // index of the triplet, is_new is true if it was not in the map
+     *   map.key(index) // returns {p,t,n} */
+    struct vertex_index_map
+    {
+        vertex_index_map();
+        /** Preallocate the table for N keys */
+        explicit vertex_index_map(size_t N);
+
+        /** Index associated to the key. A new key is associated to the index size() (is_new is set to true). */
+        int insert(int3 const& key, bool& is_new);
+        int insert(int3 const& key);
+        /** Index associated to the key, or -1 if the key is not in the map */
+        int find(int3 const& key) const;
+
+        /** Number of keys */
+        int size() const;
+        /** Keys in insertion order: key(index) is the key associated to index */
+        int3 const& key(int index) const;
+        std::vector<int3> const& keys() const;
+
+        void reserve(size_t N);
+        void clear();
+
+    private:
+        std::vector<int3> key_storage;
+        /** Slots of the hash table: index in key_storage, or -1 for an empty slot */
+        std::vector<int> slot;
+        size_t mask = 0;
+
+        size_t slot_position(int3 const& key) const;
+        void rehash(size_t number_of_slots);
+    };
+}
+}
@@ -0,0 +1,222 @@
+#include "cloth_implicit.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cgp
+{
+	void cloth_implicit::initialize(mesh const& m, float total_mass)
+	{
+		shape = m;
+		normal_cache.invalidate();
+		numarray<uint3> const& connectivity = shape.connectivity;
+		int const N = shape.position.size();
+		int const N_face = connectivity.size();
+
+		velocity.resize(N);
+		velocity.fill({ 0,0,0 });
+		fixed.resize(N);
+		fixed.fill(0);
+		dv.resize(N);
+		dv.fill({ 0,0,0 });
+
+		// Mass proportional to the area of the adjacent triangles
+		mass.resize(N);
+		mass.fill(0.0f);
+		float area_total = 0.0f;
+		for (int k = 0; k < N_face; ++k) {
+			uint3 const& f = connectivity.at(k);
+			vec3 const& a = shape.position.at(f.x);
+			float const area = 0.5f * norm(cross(shape.position.at(f.y) - a, shape.position.at(f.z) - a));
+			mass.at(f.x) += area / 3.0f;
+			mass.at(f.y) += area / 3.0f;
+			mass.at(f.z) += area / 3.0f;
+			area_total += area;
+		}
+		for (int k = 0; k < N; ++k)
+			mass.at(k) = area_total > 0 ? total_mass * mass.at(k) / area_total : total_mass / N;
+
+		// Structural springs along the edges
+		spring_i.resize(0);
+		spring_j.resize(0);
+		adjacency_csr const vertex_to_vertex = adjacency_vertex_to_vertex(connectivity, N);
+		for (int i = 0; i < N; ++i) {
+			for (int a = vertex_to_vertex.begin(i); a < vertex_to_vertex.end(i); ++a) {
+				int const j = vertex_to_vertex.index.at(a);
+				if (j > i) {
+					spring_i.push_back(i);
+					spring_j.push_back(j);
+				}
+			}
+		}
+		number_of_structural_spring = spring_i.size();
+
+		// Bending springs between the opposite vertices of two triangles sharing an edge
+		adjacency_csr const face_to_face = adjacency_face_to_face(connectivity);
+		for (int f = 0; f < N_face; ++f) {
+			uint3 const& face_f = connectivity.at(f);
+			for (int a = face_to_face.begin(f); a < face_to_face.end(f); ++a) {
+				int const g = face_to_face.index.at(a);
+				if (g <= f)
+					continue;
+				uint3 const& face_g = connectivity.at(g);
+				int opposite_f = -1, opposite_g = -1;
+				for (int k = 0; k < 3; ++k) {
+					if (face_f[k] != face_g.x && face_f[k] != face_g.y && face_f[k] != face_g.z)
+						opposite_f = face_f[k];
+					if (face_g[k] != face_f.x && face_g[k] != face_f.y && face_g[k] != face_f.z)
+						opposite_g = face_g[k];
+				}
+				if (opposite_f >= 0 && opposite_g >= 0 && opposite_f != opposite_g) {
+					spring_i.push_back(opposite_f);
+					spring_j.push_back(opposite_g);
+				}
+			}
+		}
+
+		int const N_spring = spring_i.size();
+		spring_L0.resize(N_spring);
+		for (int k = 0; k < N_spring; ++k)
+			spring_L0.at(k) = norm(shape.position.at(spring_j.at(k)) - shape.position.at(spring_i.at(k)));
+		spring_force.resize(N_spring);
+		spring_stiffness.resize(N_spring);
+
+		// Springs attached to each vertex (counting sort)
+		vertex_to_spring.offset.resize(N + 1);
+		vertex_to_spring.offset.fill(0);
+		for (int k = 0; k < N_spring; ++k) {
+			vertex_to_spring.offset.at(spring_i.at(k) + 1)++;
+			vertex_to_spring.offset.at(spring_j.at(k) + 1)++;
+		}
+		for (int k = 0; k < N; ++k)
+			vertex_to_spring.offset.at(k + 1) += vertex_to_spring.offset.at(k);
+		numarray<int> counter = vertex_to_spring.offset;
+		vertex_to_spring.index.resize(2 * N_spring);
+		for (int k = 0; k < N_spring; ++k) {
+			vertex_to_spring.index.at(counter.at(spring_i.at(k))++) = k + 1;
+			vertex_to_spring.index.at(counter.at(spring_j.at(k))++) = -(k + 1);
+		}
+
+		// Pattern of the system: a block for each pair of vertices linked by a spring
+		adjacency_csr pattern;
+		pattern.offset = vertex_to_spring.offset;
+		pattern.index.resize(2 * N_spring);
+		for (int a = 0; a < 2 * N_spring; ++a) {
+			int const s = vertex_to_spring.index.at(a);
+			pattern.index.at(a) = s > 0 ? spring_j.at(s - 1) : spring_i.at(-s - 1);
+		}
+		A.initialize(pattern);
+
+		vertex_to_spring_block.resize(2 * N_spring);
+		for (int i = 0; i < N; ++i)
+			for (int a = pattern.begin(i); a < pattern.end(i); ++a)
+				vertex_to_spring_block.at(a) = A.find(i, pattern.index.at(a));
+	}
+
+	void cloth_implicit::set_fixed(int k, bool is_fixed)
+	{
+		fixed.at(k) = is_fixed ? 1 : 0;
+		velocity.at(k) = { 0,0,0 };
+	}
+
+	void cloth_implicit::step(float dt)
+	{
+		int const N = shape.position.size();
+		int const N_spring = spring_i.size();
+		int const T = solver.number_of_threads;
+		numarray<vec3>& position = shape.position;
+
+		// Force and stiffness matrix of each spring
+		parallel_for_chunk(N_spring, T, [&](size_t k_begin, size_t k_end, int) {
+			for (int k = int(k_begin); k < int(k_end); ++k) {
+				float const Ks = k < number_of_structural_spring ? K : K_bending;
+				vec3 const d = position.at(spring_j.at(k)) - position.at(spring_i.at(k));
+				float const L = norm(d);
+				mat3& S = spring_stiffness.at(k);
+				if (L <= 0) {
+					spring_force.at(k) = { 0,0,0 };
+					S = mat3(0.0f);
+					continue;
+				}
+				vec3 const u = d / L;
+				float const L0 = spring_L0.at(k);
+				spring_force.at(k) = Ks * (L - L0) * u;
+
+				// Ks [ u u^t + max(0, 1-L0/L) (I - u u^t) ]
+				float const t = std::max(0.0f, 1.0f - L0 / L);
+				float const uu[3] = { u.x, u.y, u.z };
+				for (int a = 0; a < 3; ++a)
+					for (int b = 0; b < 3; ++b)
+						S.at(a, b) = Ks * ((1 - t) * uu[a] * uu[b] + (a == b ? t : 0.0f));
+			}
+		});
+
+		// Assembly of A = (1 + dt damping) M + dt^2 K and rhs = dt (f - dt K v), row by row
+		rhs.resize(N);
+		float const dt2 = dt * dt;
+		parallel_for_chunk(N, T, [&](size_t i_begin, size_t i_end, int) {
+			for (int i = int(i_begin); i < int(i_end); ++i) {
+				for (int b = A.row_offset.at(i); b < A.row_offset.at(i + 1); ++b) {
+					float* A_ib = &A.value.at(b).at(0, 0);
+					for (int c = 0; c < 9; ++c)
+						A_ib[c] = 0.0f;
+				}
+				mat3& A_ii = A.value.at(A.diagonal.at(i));
+
+				if (fixed.at(i)) {
+					A_ii = mat3(1.0f);
+					rhs.at(i) = { 0,0,0 };
+					continue;
+				}
+
+				vec3 const& v_i = velocity.at(i);
+				float const m = mass.at(i);
+				vec3 f = m * gravity - damping * m * v_i;
+				vec3 Kv = { 0,0,0 };
+				float D[9] = { 0,0,0, 0,0,0, 0,0,0 };
+				for (int a = vertex_to_spring.begin(i); a < vertex_to_spring.end(i); ++a) {
+					int const s = vertex_to_spring.index.at(a);
+					int const k = (s > 0 ? s : -s) - 1;
+					int const j = s > 0 ? spring_j.at(k) : spring_i.at(k);
+					float const* S = &spring_stiffness.at(k).at(0, 0);
+					if (s > 0)
+						f += spring_force.at(k);
+					else
+						f -= spring_force.at(k);
+					vec3 const dv_ij = v_i - velocity.at(j);
+					Kv.x += S[0] * dv_ij.x + S[1] * dv_ij.y + S[2] * dv_ij.z;
+					Kv.y += S[3] * dv_ij.x + S[4] * dv_ij.y + S[5] * dv_ij.z;
+					Kv.z += S[6] * dv_ij.x + S[7] * dv_ij.y + S[8] * dv_ij.z;
+					for (int c = 0; c < 9; ++c)
+						D[c] += S[c];
+					if (!fixed.at(j)) {
+						float* A_ij = &A.value.at(vertex_to_spring_block.at(a)).at(0, 0);
+						for (int c = 0; c < 9; ++c)
+							A_ij[c] -= dt2 * S[c];
+					}
+				}
+				float* A_diag = &A_ii.at(0, 0);
+				for (int c = 0; c < 9; ++c)
+					A_diag[c] = dt2 * D[c];
+				float const m_damped = m * (1 + dt * damping);
+				A_diag[0] += m_damped;
+				A_diag[4] += m_damped;
+				A_diag[8] += m_damped;
+				rhs.at(i) = dt * (f - dt * Kv);
+			}
+		});
+
+		conjugate_gradient(A, rhs, dv, solver);
+
+		parallel_for_chunk(N, T, [&](size_t i_begin, size_t i_end, int) {
+			for (int i = int(i_begin); i < int(i_end); ++i) {
+				if (!fixed.at(i))
+					velocity.at(i) += dv.at(i);
+				position.at(i) += dt * velocity.at(i);
+			}
+		});
+
+		if (update_normal)
+			shape.normal_update(normal_cache, normal_weighting::uniform, solver.number_of_threads);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+#include "../matrix_sparse_block3/matrix_sparse_block3.hpp"
+
+namespace cgp
+{
+	/** Mass-spring cloth integrated with an implicit (backward) Euler scheme
+	* The springs are built from the connectivity of a triangle mesh (ex. mesh_primitive_grid):
+	*  - structural springs along the edges of the triangles (stiffness K),
+	*  - bending springs between the two opposite vertices of each pair of triangles sharing an edge (stiffness K_bending).
+	* The rest lengths are the lengths in the initial mesh, the mass of each vertex is proportional to the area of its adjacent triangles.
+	*
+	* Each step solves (M - dt df/dv - dt^2 df/dx) dv = dt (f + dt df/dx v), then v += dv and x += dt v.
+	* The system is stored as a sparse matrix of 3x3 blocks whose pattern is built once at initialization, and is solved with a block-Jacobi preconditioned conjugate gradient warm-started with the previous dv.
+	* The compressed springs are linearized without their transverse term to keep the system positive definite: large time steps remain stable for stiff springs.
+	* The assembly and the solve are computed in parallel, without concurrent writes.
+	*
+	* Ex.
+	*   cloth_implicit cloth;
+	*   cloth.initialize(mesh_primitive_grid(...), 1.0f);
+	*   cloth.set_fixed(0);
+	*   ...
+	*   cloth.step(1/60.0f);
+	*   cloth_drawable.vbo_position.update(cloth.shape.position); */
+	struct cloth_implicit
+	{
+		/** Stiffness of the structural and bending springs */
+		float K = 1000.0f;
+		float K_bending = 10.0f;
+		/** Damping proportional to the mass: f = -damping m v */
+		float damping = 0.5f;
+		vec3 gravity = { 0,0,-9.81f };
+		/** Update shape.normal after each step */
+		bool update_normal = true;
+		/** Parameters of the conjugate gradient. Its number_of_threads is also used for the assembly. */
+		conjugate_gradient_parameters solver;
+
+		/** Mesh of the cloth: its positions (and normals) are updated by the steps */
+		mesh shape;
+		numarray<vec3> velocity;
+		numarray<float> mass;
+		/** 1 for a fixed vertex (its position can still be set directly), 0 otherwise */
+		numarray<int> fixed;
+
+		/** Springs between the vertices spring_i[k] and spring_j[k] with rest length spring_L0[k]. The first number_of_structural_spring springs are structural, the following ones are bending springs */
+		numarray<int> spring_i;
+		numarray<int> spring_j;
+		numarray<float> spring_L0;
+		int number_of_structural_spring = 0;
+
+		/** Build the springs and the pattern of the system from the mesh, with zero velocity */
+		void initialize(mesh const& m, float total_mass = 1.0f);
+		/** Fix (or release) a vertex */
+		void set_fixed(int k, bool is_fixed = true);
+		/** Advance the cloth by a time step dt */
+		void step(float dt);
+
+	private:
+		matrix_sparse_block3 A;
+		numarray<vec3> rhs;
+		numarray<vec3> dv;
+		// Springs attached to each vertex (spring k stored as k+1 for its first vertex, and -(k+1) for its second one),
+		//  and index in A.value of the block (vertex, other vertex of the spring)
+		adjacency_csr vertex_to_spring;
+		numarray<int> vertex_to_spring_block;
+		// Force on the first vertex and stiffness matrix of each spring
+		numarray<vec3> spring_force;
+		numarray<mat3> spring_stiffness;
+		// Vertex to face adjacency reused by the update of the normals at each step
+		mesh_normal_cache normal_cache;
+	};
+}
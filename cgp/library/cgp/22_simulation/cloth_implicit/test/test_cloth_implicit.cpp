@@ -0,0 +1,51 @@
+#include "cgp/01_base/base.hpp"
+#include "cgp/11_mesh/primitive/primitive.hpp"
+#include "../cloth_implicit.hpp"
+
+#include <cmath>
+
+
+namespace cgp_test {
+
+	void test_cloth_implicit()
+	{
+		using namespace cgp;
+
+		// Horizontal cloth of 1m x 1m hanging from two corners, integrated with a time step far above the explicit stability bound
+		cloth_implicit cloth;
+		cloth.K = 5000.0f;
+		cloth.initialize(mesh_primitive_grid({ 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, 12, 12), 1.0f);
+		int const N = cloth.shape.position.size();
+		assert_cgp_no_msg(N == 144);
+		assert_cgp_no_msg(cloth.number_of_structural_spring > 0 && cloth.spring_i.size() > cloth.number_of_structural_spring);
+
+		int corner[2] = { -1, -1 };
+		for (int k = 0; k < N; ++k) {
+			if (norm(cloth.shape.position[k] - vec3{ 0,0,0 }) < 1e-6f) corner[0] = k;
+			if (norm(cloth.shape.position[k] - vec3{ 0,1,0 }) < 1e-6f) corner[1] = k;
+		}
+		assert_cgp_no_msg(corner[0] >= 0 && corner[1] >= 0);
+		cloth.set_fixed(corner[0]);
+		cloth.set_fixed(corner[1]);
+
+		for (int step = 0; step < 200; ++step) {
+			cloth.step(1 / 60.0f);
+			assert_cgp_no_msg(cloth.solver.iteration < cloth.solver.iteration_max);
+		}
+
+		// The fixed corners don't move, the cloth falls under the corners without exploding (bounded stretch of the structural springs)
+		assert_cgp_no_msg(is_equal(cloth.shape.position[corner[0]], vec3{ 0,0,0 }));
+		assert_cgp_no_msg(is_equal(cloth.shape.position[corner[1]], vec3{ 0,1,0 }));
+		float z_min = 0.0f;
+		for (int k = 0; k < N; ++k) {
+			vec3 const& p = cloth.shape.position[k];
+			assert_cgp_no_msg(std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z));
+			z_min = std::min(z_min, p.z);
+		}
+		assert_cgp_no_msg(z_min < -0.5f && z_min > -2.0f);
+		for (int k = 0; k < cloth.number_of_structural_spring; ++k) {
+			float const L = norm(cloth.shape.position[cloth.spring_j[k]] - cloth.shape.position[cloth.spring_i[k]]);
+			assert_cgp_no_msg(L < 1.5f * cloth.spring_L0[k]);
+		}
+	}
+}
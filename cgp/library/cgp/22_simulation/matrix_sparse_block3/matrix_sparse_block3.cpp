@@ -0,0 +1,230 @@
+#include "matrix_sparse_block3.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cgp
+{
+	void matrix_sparse_block3::initialize(adjacency_csr const& pattern)
+	{
+		int const N = pattern.size();
+		row_offset.resize(N + 1);
+		diagonal.resize(N);
+		column.resize(0);
+
+		// Block-row i: sorted indices of {i} U pattern(i) without duplicates
+		std::vector<int> row;
+		row_offset.at(0) = 0;
+		for (int i = 0; i < N; ++i) {
+			row.assign(pattern.index.data.begin() + pattern.begin(i), pattern.index.data.begin() + pattern.end(i));
+			row.push_back(i);
+			std::sort(row.begin(), row.end());
+			row.erase(std::unique(row.begin(), row.end()), row.end());
+			for (int j : row)
+				column.push_back(j);
+			row_offset.at(i + 1) = column.size();
+			diagonal.at(i) = find(i, i);
+		}
+
+		value.resize(column.size());
+		fill_zero();
+	}
+
+	int matrix_sparse_block3::find(int i, int j) const
+	{
+		auto const begin = column.data.begin() + row_offset.at(i);
+		auto const end = column.data.begin() + row_offset.at(i + 1);
+		auto const it = std::lower_bound(begin, end, j);
+		if (it == end || *it != j)
+			return -1;
+		return int(it - column.data.begin());
+	}
+
+	void matrix_sparse_block3::fill_zero()
+	{
+		mat3 const zero = mat3(0.0f);
+		value.fill(zero);
+	}
+
+	namespace
+	{
+		inline vec3 block_multiply(mat3 const& M, vec3 const& x)
+		{
+			return { M.at(0, 0) * x.x + M.at(0, 1) * x.y + M.at(0, 2) * x.z,
+				M.at(1, 0) * x.x + M.at(1, 1) * x.y + M.at(1, 2) * x.z,
+				M.at(2, 0) * x.x + M.at(2, 1) * x.y + M.at(2, 2) * x.z };
+		}
+
+		// Inverse of a symmetric positive definite block, or of its diagonal if it is close to singular
+		mat3 block_inverse(mat3 const& M)
+		{
+			float const c00 = M.at(1, 1) * M.at(2, 2) - M.at(1, 2) * M.at(2, 1);
+			float const c01 = M.at(0, 2) * M.at(2, 1) - M.at(0, 1) * M.at(2, 2);
+			float const c02 = M.at(0, 1) * M.at(1, 2) - M.at(0, 2) * M.at(1, 1);
+			float const d = M.at(0, 0) * c00 + M.at(1, 0) * c01 + M.at(2, 0) * c02;
+			float const scale = std::abs(M.at(0, 0) * M.at(1, 1) * M.at(2, 2));
+			if (!(std::abs(d) > 1e-6f * scale)) {
+				mat3 D = mat3(0.0f);
+				for (int k = 0; k < 3; ++k)
+					D.at(k, k) = M.at(k, k) != 0 ? 1.0f / M.at(k, k) : 1.0f;
+				return D;
+			}
+			float const d_inv = 1.0f / d;
+			mat3 I;
+			I.at(0, 0) = c00 * d_inv;
+			I.at(0, 1) = c01 * d_inv;
+			I.at(0, 2) = c02 * d_inv;
+			I.at(1, 0) = (M.at(1, 2) * M.at(2, 0) - M.at(1, 0) * M.at(2, 2)) * d_inv;
+			I.at(1, 1) = (M.at(0, 0) * M.at(2, 2) - M.at(0, 2) * M.at(2, 0)) * d_inv;
+			I.at(1, 2) = (M.at(0, 2) * M.at(1, 0) - M.at(0, 0) * M.at(1, 2)) * d_inv;
+			I.at(2, 0) = (M.at(1, 0) * M.at(2, 1) - M.at(1, 1) * M.at(2, 0)) * d_inv;
+			I.at(2, 1) = (M.at(0, 1) * M.at(2, 0) - M.at(0, 0) * M.at(2, 1)) * d_inv;
+			I.at(2, 2) = (M.at(0, 0) * M.at(1, 1) - M.at(0, 1) * M.at(1, 0)) * d_inv;
+			return I;
+		}
+
+		// The vectors are processed by blocks of fixed size, the partial dot products of each block are summed in order: same result for any number of threads
+		int const cg_block_size = 4096;
+
+		// Call f(k_begin, k_end, block) on each block of [0,N[ in parallel, and return the sum of the values stored in partial[block]
+		template <typename F>
+		double parallel_blocks_sum(int N, int number_of_threads, std::vector<double>& partial, F const& f)
+		{
+			int const N_block = (N + cg_block_size - 1) / cg_block_size;
+			partial.resize(N_block);
+			parallel_for_chunk(N_block, number_of_threads, [&](size_t b_begin, size_t b_end, int) {
+				for (int block = int(b_begin); block < int(b_end); ++block)
+					f(block * cg_block_size, std::min(N, (block + 1) * cg_block_size), block);
+			});
+			double s = 0.0;
+			for (double p : partial)
+				s += p;
+			return s;
+		}
+
+		inline double dot_double(vec3 const& u, vec3 const& v)
+		{
+			return double(u.x) * v.x + double(u.y) * v.y + double(u.z) * v.z;
+		}
+	}
+
+	void matrix_sparse_block3::multiply(numarray<vec3> const& x, numarray<vec3>& y, int number_of_threads) const
+	{
+		int const N = size();
+		assert_cgp(x.size() == N, "Size of the vector (" + str(x.size()) + ") doesn't match the number of block-rows of the matrix (" + str(N) + ")");
+		y.resize(N);
+		parallel_for_chunk(N, number_of_threads, [&](size_t i_begin, size_t i_end, int) {
+			for (int i = int(i_begin); i < int(i_end); ++i) {
+				vec3 s = { 0,0,0 };
+				for (int k = row_offset.at(i); k < row_offset.at(i + 1); ++k)
+					s += block_multiply(value.at(k), x.at(column.at(k)));
+				y.at(i) = s;
+			}
+		});
+	}
+
+	bool conjugate_gradient(matrix_sparse_block3 const& A, numarray<vec3> const& b, numarray<vec3>& x, conjugate_gradient_parameters& parameters)
+	{
+		int const N = A.size();
+		int const T = parameters.number_of_threads;
+		assert_cgp(b.size() == N, "Size of the right hand side (" + str(b.size()) + ") doesn't match the number of block-rows of the matrix (" + str(N) + ")");
+		if (x.size() != N) {
+			x.resize(N);
+			x.fill({ 0,0,0 });
+		}
+
+		std::vector<double> partial;
+		double const b_norm = std::sqrt(parallel_blocks_sum(N, T, partial, [&](int k_begin, int k_end, int block) {
+			double s = 0.0;
+			for (int k = k_begin; k < k_end; ++k)
+				s += dot_double(b.at(k), b.at(k));
+			partial[block] = s;
+		}));
+		parameters.iteration = 0;
+		parameters.residual = 0.0f;
+		if (b_norm == 0) {
+			x.fill({ 0,0,0 });
+			return true;
+		}
+
+		// Block-Jacobi preconditioner
+		numarray<mat3> P(N);
+		parallel_for_chunk(N, T, [&](size_t i_begin, size_t i_end, int) {
+			for (int i = int(i_begin); i < int(i_end); ++i)
+				P.at(i) = block_inverse(A.value.at(A.diagonal.at(i)));
+		});
+
+		// r = b - A x, z = P r, p = z
+		numarray<vec3> r, z(N), p(N), Ap;
+		std::vector<double> partial_rr;
+		A.multiply(x, r, T);
+		double rz = parallel_blocks_sum(N, T, partial, [&](int k_begin, int k_end, int block) {
+			double s = 0.0;
+			for (int i = k_begin; i < k_end; ++i) {
+				r.at(i) = b.at(i) - r.at(i);
+				z.at(i) = block_multiply(P.at(i), r.at(i));
+				p.at(i) = z.at(i);
+				s += dot_double(r.at(i), z.at(i));
+			}
+			partial[block] = s;
+		});
+		double r_norm = std::sqrt(parallel_blocks_sum(N, T, partial_rr, [&](int k_begin, int k_end, int block) {
+			double s = 0.0;
+			for (int i = k_begin; i < k_end; ++i)
+				s += dot_double(r.at(i), r.at(i));
+			partial_rr[block] = s;
+		}));
+		double const threshold = parameters.tolerance * b_norm;
+
+		// Each iteration runs 3 parallel passes over the vectors: Ap and p.Ap, then x,r,z with r.z and r.r, then p
+		Ap.resize(N);
+		int iteration = 0;
+		while (r_norm > threshold && iteration < parameters.iteration_max)
+		{
+			double const pAp = parallel_blocks_sum(N, T, partial, [&](int k_begin, int k_end, int block) {
+				double s = 0.0;
+				for (int i = k_begin; i < k_end; ++i) {
+					vec3 y = { 0,0,0 };
+					for (int k = A.row_offset.at(i); k < A.row_offset.at(i + 1); ++k)
+						y += block_multiply(A.value.at(k), p.at(A.column.at(k)));
+					Ap.at(i) = y;
+					s += dot_double(p.at(i), y);
+				}
+				partial[block] = s;
+			});
+			if (!(pAp > 0)) // The matrix is not positive definite (or p=0)
+				break;
+
+			float const alpha = float(rz / pAp);
+			double const rz_new = parallel_blocks_sum(N, T, partial, [&](int k_begin, int k_end, int block) {
+				double s = 0.0, s_rr = 0.0;
+				for (int i = k_begin; i < k_end; ++i) {
+					x.at(i) += alpha * p.at(i);
+					r.at(i) -= alpha * Ap.at(i);
+					z.at(i) = block_multiply(P.at(i), r.at(i));
+					s += dot_double(r.at(i), z.at(i));
+					s_rr += dot_double(r.at(i), r.at(i));
+				}
+				partial[block] = s;
+				partial_rr[block] = s_rr;
+			});
+			r_norm = 0.0;
+			for (double s_rr : partial_rr)
+				r_norm += s_rr;
+			r_norm = std::sqrt(r_norm);
+
+			float const beta = float(rz_new / rz);
+			rz = rz_new;
+			parallel_for_chunk(N, T, [&](size_t i_begin, size_t i_end, int) {
+				for (int i = int(i_begin); i < int(i_end); ++i)
+					p.at(i) = z.at(i) + beta * p.at(i);
+			});
+			++iteration;
+		}
+
+		parameters.iteration = iteration;
+		parameters.residual = float(r_norm / b_norm);
+		return r_norm <= threshold;
+	}
+}
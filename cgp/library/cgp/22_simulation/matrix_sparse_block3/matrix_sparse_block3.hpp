@@ -0,0 +1,55 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray.hpp"
+#include "cgp/06_mat/mat.hpp"
+#include "cgp/11_mesh/mesh.hpp"
+
+namespace cgp
+{
+	/** Sparse square matrix made of 3x3 blocks stored in block-CSR format (Compressed Sparse Row)
+	* The non-zero blocks of the block-row i are value[row_offset[i]], ..., value[row_offset[i+1]-1], in the block-columns column[row_offset[i]], ... sorted by increasing index.
+	* The pattern (row_offset, column) is set once by initialize, and the values can then be updated in place (ex. at each time step of a simulation).
+	* The matrix applies to vectors stored as numarray<vec3> (one vec3 per block). */
+	struct matrix_sparse_block3
+	{
+		numarray<int> row_offset;
+		numarray<int> column;
+		numarray<mat3> value;
+		/** Index in value of the diagonal block of each block-row */
+		numarray<int> diagonal;
+
+		/** Set the pattern: the block-row i has a diagonal block, and a block for each element of the adjacency list of i (ex. vertex to vertex adjacency of a mesh). Values are set to 0. */
+		void initialize(adjacency_csr const& pattern);
+		/** Number of block-rows */
+		int size() const { return row_offset.size() > 0 ? row_offset.size() - 1 : 0; }
+		/** Index in value of the block (i,j), -1 if it is not in the pattern (binary search in the block-row i) */
+		int find(int i, int j) const;
+		/** Set all the values to 0 (keep the pattern) */
+		void fill_zero();
+
+		/** y = A x, computed in parallel over the block-rows */
+		void multiply(numarray<vec3> const& x, numarray<vec3>& y, int number_of_threads = 0) const;
+	};
+
+	/** Parameters and result of conjugate_gradient */
+	struct conjugate_gradient_parameters
+	{
+		/** Maximal number of iterations */
+		int iteration_max = 200;
+		/** The solve stops when |b - A x| <= tolerance |b| */
+		float tolerance = 1e-5f;
+		/** Number of threads. 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+
+		/** Number of iterations and relative residual |b - A x|/|b| of the last solve */
+		int iteration = 0;
+		float residual = 0.0f;
+	};
+
+	/** Solve A x = b with a conjugate gradient preconditioned by the inverse of the diagonal blocks of A (block-Jacobi)
+	* A must be symmetric positive definite. x is used as the initial guess (resized and set to 0 if its size doesn't match).
+	* The products and dot products are computed in parallel, the dot products are summed in a fixed order: the result doesn't depend on the number of threads.
+	* Return true if the tolerance is reached. */
+	bool conjugate_gradient(matrix_sparse_block3 const& A, numarray<vec3> const& b, numarray<vec3>& x, conjugate_gradient_parameters& parameters);
+}
@@ -0,0 +1,87 @@
+#include "cgp/01_base/base.hpp"
+#include "../matrix_sparse_block3.hpp"
+
+#include <cmath>
+#include <cstring>
+
+
+namespace cgp_test {
+
+	void test_matrix_sparse_block3()
+	{
+		using namespace cgp;
+
+		// Block system of N unknowns where each block-row is coupled to its neighbors at distance 1 and 3
+		int const N = 12;
+		adjacency_csr pattern;
+		pattern.offset.push_back(0);
+		for (int i = 0; i < N; ++i) {
+			for (int j : { i - 3, i - 1, i + 1, i + 3 })
+				if (j >= 0 && j < N)
+					pattern.index.push_back(j);
+			pattern.offset.push_back(pattern.index.size());
+		}
+
+		matrix_sparse_block3 A;
+		A.initialize(pattern);
+		assert_cgp_no_msg(A.size() == N);
+		assert_cgp_no_msg(A.find(0, 0) == A.diagonal[0]);
+		assert_cgp_no_msg(A.find(4, 1) >= 0 && A.find(4, 3) >= 0 && A.find(4, 2) == -1);
+
+		// Symmetric values (A_ji = A_ij^T), strictly diagonally dominant: A is symmetric positive definite
+		mat3 const diagonal_block = { 5.0f, 0.4f, 0.2f, 0.4f, 6.0f, -0.3f, 0.2f, -0.3f, 7.0f };
+		for (int i = 0; i < N; ++i) {
+			for (int k = A.row_offset[i]; k < A.row_offset[i + 1]; ++k) {
+				int const j = A.column[k];
+				if (i == j)
+					A.value[k] = diagonal_block;
+				else {
+					float const c = -0.5f - 0.01f * float(std::min(i, j) + std::max(i, j));
+					A.value[k] = { c, 0.1f, 0.0f, 0.1f, c, 0.05f, 0.0f, 0.05f, c };
+				}
+			}
+		}
+
+		// Right hand side computed from a known solution (with the block-row sums written explicitly)
+		numarray<vec3> x_solution(N);
+		for (int i = 0; i < N; ++i)
+			x_solution[i] = { std::sin(float(i)), std::cos(float(i)), 0.1f * i - 0.5f };
+		numarray<vec3> b(N);
+		for (int i = 0; i < N; ++i) {
+			b[i] = { 0,0,0 };
+			for (int j = 0; j < N; ++j) {
+				int const k = A.find(i, j);
+				if (k >= 0)
+					b[i] += A.value[k] * x_solution[j];
+			}
+		}
+		numarray<vec3> Ax;
+		A.multiply(x_solution, Ax, 1);
+		for (int i = 0; i < N; ++i)
+			assert_cgp_no_msg(norm(Ax[i] - b[i]) < 1e-5f);
+
+		// Solve from a zero initial guess (x is resized), with one thread and with several threads
+		numarray<vec3> x_single;
+		conjugate_gradient_parameters parameters;
+		parameters.tolerance = 1e-6f;
+		parameters.number_of_threads = 1;
+		bool const converged = conjugate_gradient(A, b, x_single, parameters);
+		assert_cgp_no_msg(converged);
+		assert_cgp_no_msg(parameters.iteration > 0 && parameters.iteration <= 3 * N);
+		assert_cgp_no_msg(parameters.residual <= parameters.tolerance);
+		assert_cgp_no_msg(x_single.size() == N);
+		for (int i = 0; i < N; ++i)
+			assert_cgp_no_msg(norm(x_single[i] - x_solution[i]) < 1e-4f);
+
+		numarray<vec3> x_parallel;
+		parameters.number_of_threads = 4;
+		conjugate_gradient(A, b, x_parallel, parameters);
+		assert_cgp_no_msg(std::memcmp(x_single.data.data(), x_parallel.data.data(), N * sizeof(vec3)) == 0);
+
+		// Warm start from the solution: no iteration is needed
+		numarray<vec3> x_warm = x_solution;
+		parameters.tolerance = 1e-4f;
+		assert_cgp_no_msg(conjugate_gradient(A, b, x_warm, parameters));
+		assert_cgp_no_msg(parameters.iteration == 0);
+	}
+}
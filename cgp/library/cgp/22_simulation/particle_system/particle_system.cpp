@@ -0,0 +1,295 @@
+#include "particle_system.hpp"
+
+#include <cmath>
+
+namespace cgp
+{
+	void particle_stream::resize(int N)
+	{
+		x.resize(N);
+		y.resize(N);
+		z.resize(N);
+	}
+	void particle_stream::fill(vec3 const& value)
+	{
+		x.fill(value.x);
+		y.fill(value.y);
+		z.fill(value.z);
+	}
+	void particle_stream::push_back(vec3 const& value)
+	{
+		x.push_back(value.x);
+		y.push_back(value.y);
+		z.push_back(value.z);
+	}
+
+	namespace
+	{
+		// Pointer to the stream of the coordinate c (0:x, 1:y, 2:z)
+		float* component(particle_stream& s, int c) { return c == 0 ? s.x.data.data() : (c == 1 ? s.y.data.data() : s.z.data.data()); }
+		float const* component(particle_stream const& s, int c) { return c == 0 ? s.x.data.data() : (c == 1 ? s.y.data.data() : s.z.data.data()); }
+
+		// Call f(k_begin, k_end) on contiguous chunks of [0,N[ from several threads
+		template <typename F>
+		void particle_parallel(int N, int number_of_threads, F const& f)
+		{
+			parallel_for_chunk(N, number_of_threads, [&](size_t k_begin, size_t k_end, int) { f(int(k_begin), int(k_end)); });
+		}
+	}
+
+	int particle_system::add_particle(vec3 const& p, vec3 const& v, float m)
+	{
+		position.push_back(p);
+		velocity.push_back(v);
+		force.push_back({ 0,0,0 });
+		mass.push_back(m > 0 ? m : 0.0f);
+		mass_inverse.push_back(m > 0 ? 1.0f / m : 0.0f);
+		force_up_to_date = false;
+		adjacency_dirty = true;
+		return size() - 1;
+	}
+
+	int particle_system::add_spring(int i, int j, float K, float L0)
+	{
+		assert_cgp(i >= 0 && i < size() && j >= 0 && j < size(), "Spring between particles (" + str(i) + "," + str(j) + ") for a system of " + str(size()) + " particles");
+		spring_i.push_back(i);
+		spring_j.push_back(j);
+		spring_K.push_back(K);
+		spring_L0.push_back(L0 >= 0 ? L0 : norm(position.get(j) - position.get(i)));
+		force_up_to_date = false;
+		adjacency_dirty = true;
+		return spring_i.size() - 1;
+	}
+
+	void particle_system::clear()
+	{
+		position.resize(0);
+		velocity.resize(0);
+		force.resize(0);
+		mass.resize(0);
+		mass_inverse.resize(0);
+		spring_i.resize(0);
+		spring_j.resize(0);
+		spring_K.resize(0);
+		spring_L0.resize(0);
+		force_up_to_date = false;
+		adjacency_dirty = true;
+	}
+
+	void particle_system::invalidate_spring_adjacency()
+	{
+		adjacency_dirty = true;
+		force_up_to_date = false;
+	}
+
+	void particle_system::add_force(force_function const& f)
+	{
+		force_functions.push_back(f);
+		force_up_to_date = false;
+	}
+
+	void particle_system::update_spring_adjacency()
+	{
+		int const N = size();
+		int const N_spring = spring_i.size();
+		if (!adjacency_dirty)
+			return;
+		adjacency_dirty = false;
+
+		// Counting sort of the two extremities of the springs
+		particle_to_spring.offset.resize(N + 1);
+		particle_to_spring.offset.fill(0);
+		for (int k = 0; k < N_spring; ++k) {
+			particle_to_spring.offset.at(spring_i.at(k) + 1)++;
+			particle_to_spring.offset.at(spring_j.at(k) + 1)++;
+		}
+		for (int k = 0; k < N; ++k)
+			particle_to_spring.offset.at(k + 1) += particle_to_spring.offset.at(k);
+
+		numarray<int> counter = particle_to_spring.offset;
+		particle_to_spring.index.resize(2 * N_spring);
+		for (int k = 0; k < N_spring; ++k) {
+			particle_to_spring.index.at(counter.at(spring_i.at(k))++) = k + 1;
+			particle_to_spring.index.at(counter.at(spring_j.at(k))++) = -(k + 1);
+		}
+	}
+
+	void particle_system::evaluate_forces(particle_stream const& p, particle_stream const& v, particle_stream& f)
+	{
+		int const N = size();
+		int const N_spring = spring_i.size();
+		f.resize(N);
+
+		// Gravity and damping
+		particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+			float const* m = mass.data.data();
+			for (int c = 0; c < 3; ++c) {
+				float const g = gravity[c];
+				float const* vc = component(v, c);
+				float* fc = component(f, c);
+				for (int k = k_begin; k < k_end; ++k)
+					fc[k] = m[k] * g - damping * vc[k];
+			}
+		});
+
+		// Springs: force on the first particle computed per spring, then gathered on the particles
+		if (N_spring > 0) {
+			update_spring_adjacency();
+			spring_force.resize(N_spring);
+			particle_parallel(N_spring, number_of_threads, [&](int k_begin, int k_end) {
+				for (int k = k_begin; k < k_end; ++k) {
+					int const i = spring_i.at(k);
+					int const j = spring_j.at(k);
+					float const dx = p.x.at(j) - p.x.at(i);
+					float const dy = p.y.at(j) - p.y.at(i);
+					float const dz = p.z.at(j) - p.z.at(i);
+					float const L = std::sqrt(dx * dx + dy * dy + dz * dz);
+					float const s = L > 0 ? spring_K.at(k) * (L - spring_L0.at(k)) / L : 0.0f;
+					spring_force.x.at(k) = s * dx;
+					spring_force.y.at(k) = s * dy;
+					spring_force.z.at(k) = s * dz;
+				}
+			});
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int k = k_begin; k < k_end; ++k) {
+					for (int a = particle_to_spring.begin(k); a < particle_to_spring.end(k); ++a) {
+						int const s = particle_to_spring.index.at(a);
+						float const sign = s > 0 ? 1.0f : -1.0f;
+						int const k_spring = (s > 0 ? s : -s) - 1;
+						f.x.at(k) += sign * spring_force.x.at(k_spring);
+						f.y.at(k) += sign * spring_force.y.at(k_spring);
+						f.z.at(k) += sign * spring_force.z.at(k_spring);
+					}
+				}
+			});
+		}
+
+		for (auto const& force_function : force_functions)
+			force_function(p, v, f);
+	}
+
+	void particle_system::compute_forces()
+	{
+		evaluate_forces(position, velocity, force);
+		force_up_to_date = true;
+	}
+
+	void particle_system::step(float dt)
+	{
+		int const N = size();
+		float const* m_inv = mass_inverse.data.data();
+
+		if (integrator == particle_integrator::semi_implicit_euler)
+		{
+			evaluate_forces(position, velocity, force);
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int c = 0; c < 3; ++c) {
+					float* p = component(position, c);
+					float* v = component(velocity, c);
+					float const* f = component(force, c);
+					for (int k = k_begin; k < k_end; ++k) {
+						v[k] += dt * m_inv[k] * f[k];
+						p[k] += dt * v[k];
+					}
+				}
+			});
+			force_up_to_date = false;
+		}
+		else if (integrator == particle_integrator::velocity_verlet)
+		{
+			// The velocity at mid-step is used to evaluate the velocity dependent forces (damping)
+			if (!force_up_to_date || force.size() != N)
+				evaluate_forces(position, velocity, force);
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int c = 0; c < 3; ++c) {
+					float* p = component(position, c);
+					float* v = component(velocity, c);
+					float const* f = component(force, c);
+					for (int k = k_begin; k < k_end; ++k) {
+						v[k] += 0.5f * dt * m_inv[k] * f[k];
+						p[k] += dt * v[k];
+					}
+				}
+			});
+			evaluate_forces(position, velocity, force);
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int c = 0; c < 3; ++c) {
+					float* v = component(velocity, c);
+					float const* f = component(force, c);
+					for (int k = k_begin; k < k_end; ++k)
+						v[k] += 0.5f * dt * m_inv[k] * f[k];
+				}
+			});
+			force_up_to_date = true;
+		}
+		else if (integrator == particle_integrator::rk4)
+		{
+			p_stage.resize(N); v_stage.resize(N);
+			dp_sum.resize(N); dv_sum.resize(N);
+
+			// Stage 1: derivative at the current state
+			evaluate_forces(position, velocity, force);
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int c = 0; c < 3; ++c) {
+					float const* p = component(position, c);
+					float const* v = component(velocity, c);
+					float const* f = component(force, c);
+					float* ps = component(p_stage, c);
+					float* vs = component(v_stage, c);
+					float* dp = component(dp_sum, c);
+					float* dv = component(dv_sum, c);
+					for (int k = k_begin; k < k_end; ++k) {
+						float const a = m_inv[k] * f[k];
+						dp[k] = v[k];
+						dv[k] = a;
+						ps[k] = p[k] + 0.5f * dt * v[k];
+						vs[k] = v[k] + 0.5f * dt * a;
+					}
+				}
+			});
+
+			// Stages 2 and 3: derivative at the intermediate state, accumulated with a weight 2
+			for (int stage = 2; stage <= 3; ++stage) {
+				float const h = (stage == 2) ? 0.5f * dt : dt;
+				evaluate_forces(p_stage, v_stage, f_stage);
+				particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+					for (int c = 0; c < 3; ++c) {
+						float const* p = component(position, c);
+						float const* v = component(velocity, c);
+						float const* f = component(f_stage, c);
+						float* ps = component(p_stage, c);
+						float* vs = component(v_stage, c);
+						float* dp = component(dp_sum, c);
+						float* dv = component(dv_sum, c);
+						for (int k = k_begin; k < k_end; ++k) {
+							float const a = m_inv[k] * f[k];
+							float const vk = vs[k];
+							dp[k] += 2 * vk;
+							dv[k] += 2 * a;
+							ps[k] = p[k] + h * vk;
+							vs[k] = v[k] + h * a;
+						}
+					}
+				});
+			}
+
+			// Stage 4 and update
+			evaluate_forces(p_stage, v_stage, f_stage);
+			particle_parallel(N, number_of_threads, [&](int k_begin, int k_end) {
+				for (int c = 0; c < 3; ++c) {
+					float* p = component(position, c);
+					float* v = component(velocity, c);
+					float const* f = component(f_stage, c);
+					float const* vs = component(v_stage, c);
+					float const* dp = component(dp_sum, c);
+					float const* dv = component(dv_sum, c);
+					for (int k = k_begin; k < k_end; ++k) {
+						p[k] += dt / 6.0f * (dp[k] + vs[k]);
+						v[k] += dt / 6.0f * (dv[k] + m_inv[k] * f[k]);
+					}
+				}
+			});
+			force_up_to_date = false;
+		}
+	}
+}
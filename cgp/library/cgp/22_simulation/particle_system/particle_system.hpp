@@ -0,0 +1,110 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray.hpp"
+#include "cgp/05_vec/vec.hpp"
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace cgp
+{
+	/** Set of 3D vectors stored as three streams of floats (structure of arrays): the k-th vector is (x[k], y[k], z[k]) */
+	struct particle_stream
+	{
+		numarray<float> x;
+		numarray<float> y;
+		numarray<float> z;
+
+		int size() const { return x.size(); }
+		void resize(int N);
+		void fill(vec3 const& value);
+		void push_back(vec3 const& value);
+
+		vec3 get(int k) const { return { x.at(k), y.at(k), z.at(k) }; }
+		void set(int k, vec3 const& value) { x.at(k) = value.x; y.at(k) = value.y; z.at(k) = value.z; }
+		void add(int k, vec3 const& value) { x.at(k) += value.x; y.at(k) += value.y; z.at(k) += value.z; }
+	};
+
+	/** Time integration scheme used by particle_system::step */
+	enum class particle_integrator {
+		semi_implicit_euler, // v += dt f/m, then x += dt v. One force evaluation per step
+		velocity_verlet,     // Second order. One force evaluation per step (the forces at the end of a step are reused at the beginning of the next one)
+		rk4                  // Fourth order Runge-Kutta. Four force evaluations per step
+	};
+
+	/** System of particles with positions, velocities, masses and forces stored as streams of floats (structure of arrays)
+	* The forces are accumulated from: gravity (m g), linear damping (-damping v), springs between pairs of particles, and user-defined force functions.
+	* A particle with a mass <= 0 is fixed (infinite mass): forces don't move it, but its position and velocity can be set directly.
+	* Every stage of the step is computed in parallel over the particles (or the springs) with loops on contiguous streams of floats,
+	*  the spring forces are gathered on the particles without concurrent writes: the result doesn't depend on the number of threads.
+	*
+	* Ex.
+	*   particle_system particles;
+	*   int a = particles.add_particle({0,0,0}, {0,0,0}, 0.0f); // fixed
+	*   int b = particles.add_particle({1,0,0});
+	*   particles.add_spring(a, b, 5.0f);
+	*   ...
+	*   particles.step(dt);
+	*   vec3 p = particles.position.get(b); */
+	struct particle_system
+	{
+		/** Streams of the particles */
+		particle_stream position;
+		particle_stream velocity;
+		particle_stream force;         // Forces computed at the last evaluation (compute_forces or step)
+		numarray<float> mass;
+		numarray<float> mass_inverse;  // 0 for fixed particles
+
+		/** Springs between the particles spring_i[k] and spring_j[k] with stiffness K and rest length L0 (structure of arrays) */
+		numarray<int> spring_i;
+		numarray<int> spring_j;
+		numarray<float> spring_K;
+		numarray<float> spring_L0;
+
+		/** Force model */
+		vec3 gravity = { 0,0,-9.81f };
+		float damping = 0.0f;
+
+		/** User-defined force function: adds its contribution to force, given the position and velocity of the particles (called from a single thread) */
+		using force_function = std::function<void(particle_stream const& position, particle_stream const& velocity, particle_stream& force)>;
+		std::vector<force_function> force_functions;
+
+		particle_integrator integrator = particle_integrator::semi_implicit_euler;
+		/** Number of threads used by the step. 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+
+		/** Number of particles */
+		int size() const { return position.size(); }
+		/** Add a particle and return its index. mass<=0: fixed particle */
+		int add_particle(vec3 const& p, vec3 const& v = { 0,0,0 }, float m = 1.0f);
+		/** Add a spring between the particles i and j and return its index. L0<0: rest length set to the current distance between the particles */
+		int add_spring(int i, int j, float K, float L0 = -1.0f);
+		/** Remove all the particles and springs */
+		void clear();
+		/** Must be called after spring_i or spring_j are modified directly (the springs attached to each particle are rebuilt at the next evaluation of the forces) */
+		void invalidate_spring_adjacency();
+
+		/** Add a force function to the force model */
+		void add_force(force_function const& f);
+
+		/** Evaluate the forces at the current positions and velocities (stored in force) */
+		void compute_forces();
+		/** Advance the system by a time step dt using the selected integrator */
+		void step(float dt);
+
+	private:
+		// Evaluate the forces for the given state into f
+		void evaluate_forces(particle_stream const& p, particle_stream const& v, particle_stream& f);
+		void update_spring_adjacency();
+
+		bool force_up_to_date = false;  // force corresponds to the current state (used by velocity Verlet)
+		bool adjacency_dirty = true;     // particle_to_spring must be rebuilt (set when particles or springs are added or removed)
+		adjacency_csr particle_to_spring; // Springs attached to each particle (signed: spring k stored as k+1 for the first particle and -(k+1) for the second)
+		particle_stream spring_force;     // Force applied by each spring on its first particle
+
+		// RK4 stages
+		particle_stream p_stage, v_stage, f_stage, dp_sum, dv_sum;
+	};
+}
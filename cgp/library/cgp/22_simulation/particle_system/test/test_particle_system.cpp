@@ -0,0 +1,60 @@
+#include "cgp/01_base/base.hpp"
+#include "../particle_system.hpp"
+
+
+namespace cgp_test {
+
+	// Forces of springs (K=1, L0=0) between the pairs (i[k], j[k]), computed directly
+	static cgp::numarray<cgp::vec3> expected_spring_forces(cgp::particle_system const& particles, std::vector<cgp::int2> const& springs)
+	{
+		cgp::numarray<cgp::vec3> f(particles.size());
+		f.fill({ 0,0,0 });
+		for (cgp::int2 const& s : springs) {
+			cgp::vec3 const d = particles.position.get(s.y) - particles.position.get(s.x);
+			f[s.x] += d;
+			f[s.y] -= d;
+		}
+		return f;
+	}
+
+	static bool is_equal_forces(cgp::particle_system const& particles, cgp::numarray<cgp::vec3> const& expected)
+	{
+		if (particles.force.size() != expected.size())
+			return false;
+		for (int k = 0; k < expected.size(); ++k)
+			if (cgp::norm(particles.force.get(k) - expected[k]) > 1e-5f)
+				return false;
+		return true;
+	}
+
+	void test_particle_system()
+	{
+		std::vector<cgp::vec3> const p = { {0,0,0}, {1,0,0}, {0,2,0}, {0,0,3} };
+
+		cgp::particle_system particles;
+		particles.gravity = { 0,0,0 };
+		particles.number_of_threads = 1;
+		for (cgp::vec3 const& x : p)
+			particles.add_particle(x);
+		particles.add_spring(0, 1, 1.0f, 0.0f);
+		particles.add_spring(2, 3, 1.0f, 0.0f);
+		particles.compute_forces();
+		assert_cgp_no_msg(is_equal_forces(particles, expected_spring_forces(particles, { {0,1}, {2,3} })));
+
+		// Same number of particles and springs with another topology after clear
+		particles.clear();
+		for (cgp::vec3 const& x : p)
+			particles.add_particle(x);
+		particles.add_spring(0, 2, 1.0f, 0.0f);
+		particles.add_spring(1, 3, 1.0f, 0.0f);
+		particles.compute_forces();
+		assert_cgp_no_msg(is_equal_forces(particles, expected_spring_forces(particles, { {0,2}, {1,3} })));
+
+		// Springs modified in place
+		particles.spring_j[0] = 3;
+		particles.spring_j[1] = 2;
+		particles.invalidate_spring_adjacency();
+		particles.compute_forces();
+		assert_cgp_no_msg(is_equal_forces(particles, expected_spring_forces(particles, { {0,3}, {1,2} })));
+	}
+}
@@ -0,0 +1,401 @@
+#include "pbd_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace cgp
+{
+	namespace
+	{
+		float const pbd_pi = 3.14159265358979f;
+
+		// Greedy coloring of constraints acting on S particles each (particle indices of the constraint k: index[S*k], ..., index[S*k+S-1])
+		//  The constraints are visited in the given order and receive the smallest color not used by a constraint sharing a particle.
+		//  The colors already used by each particle are stored in 64 bits masks: constraints that can't be colored in [base,base+64[ are colored in a next pass.
+		void pbd_graph_coloring(adjacency_csr& color, int const* index, int S, int N_constraint, int N_particle, std::vector<int> const& order)
+		{
+			std::vector<int> constraint_color(N_constraint, -1);
+			std::vector<uint64_t> mask(N_particle);
+			std::vector<int> pending = order;
+			std::vector<int> next;
+			int N_color = 0;
+			for (int base = 0; !pending.empty(); base += 64) {
+				std::fill(mask.begin(), mask.end(), uint64_t(0));
+				next.clear();
+				for (int k : pending) {
+					uint64_t used = 0;
+					for (int s = 0; s < S; ++s)
+						used |= mask[index[S * k + s]];
+					if (used == ~uint64_t(0)) {
+						next.push_back(k);
+						continue;
+					}
+					int c = 0;
+					while (used & (uint64_t(1) << c))
+						++c;
+					for (int s = 0; s < S; ++s)
+						mask[index[S * k + s]] |= (uint64_t(1) << c);
+					constraint_color[k] = base + c;
+					N_color = std::max(N_color, base + c + 1);
+				}
+				pending.swap(next);
+			}
+
+			// Group the constraints by color (counting sort, increasing index within a color)
+			color.offset.resize(N_color + 1);
+			color.offset.fill(0);
+			for (int k = 0; k < N_constraint; ++k)
+				color.offset.at(constraint_color[k] + 1)++;
+			for (int c = 0; c < N_color; ++c)
+				color.offset.at(c + 1) += color.offset.at(c);
+			std::vector<int> counter(color.offset.data.begin(), color.offset.data.end() - 1);
+			color.index.resize(N_constraint);
+			for (int k = 0; k < N_constraint; ++k)
+				color.index.at(counter[constraint_color[k]]++) = k;
+		}
+
+		// Order of insertion shuffled from the seed (Fisher-Yates with the standard mt19937 engine: same order on all platforms)
+		std::vector<int> pbd_shuffled_order(int N, unsigned int seed)
+		{
+			std::vector<int> order(N);
+			for (int k = 0; k < N; ++k)
+				order[k] = k;
+			if (seed != 0) {
+				std::mt19937 generator(seed);
+				for (int k = N - 1; k > 0; --k)
+					std::swap(order[k], order[generator() % (k + 1)]);
+			}
+			return order;
+		}
+
+		// Sum of the values computed on fixed-size blocks of [0,N[, in a fixed order (same result for any number of threads)
+		int const pbd_block_size = 4096;
+		template <typename F>
+		double pbd_parallel_sum(int N, int number_of_threads, F const& f)
+		{
+			int const N_block = (N + pbd_block_size - 1) / pbd_block_size;
+			std::vector<double> partial(N_block);
+			parallel_for_chunk(N_block, number_of_threads, [&](size_t b_begin, size_t b_end, int) {
+				for (int block = int(b_begin); block < int(b_end); ++block)
+					partial[block] = f(block * pbd_block_size, std::min(N, (block + 1) * pbd_block_size));
+			});
+			double s = 0.0;
+			for (double p : partial)
+				s += p;
+			return s;
+		}
+
+		// Dihedral angle between the triangles (x1,x3,x4) and (x2,x4,x3) in ]-pi,pi], and its gradient with respect to the 4 positions if grad is not null
+		//  (Bridson et al. 2003, Simulation of clothing with folds and wrinkles)
+		float pbd_dihedral_angle(vec3 const& x1, vec3 const& x2, vec3 const& x3, vec3 const& x4, vec3* grad)
+		{
+			vec3 const e = x4 - x3;
+			vec3 const n1 = cross(x1 - x3, x1 - x4);
+			vec3 const n2 = cross(x2 - x4, x2 - x3);
+			float const L_e = norm(e);
+			float const a1 = dot(n1, n1);
+			float const a2 = dot(n2, n2);
+			if (L_e <= 0 || a1 <= 0 || a2 <= 0) {
+				if (grad != nullptr)
+					grad[0] = grad[1] = grad[2] = grad[3] = { 0,0,0 };
+				return 0.0f;
+			}
+			float const angle = std::atan2(dot(cross(n1, n2), e) / L_e, dot(n1, n2));
+			if (grad != nullptr) {
+				vec3 const m1 = n1 / a1;
+				vec3 const m2 = n2 / a2;
+				grad[0] = -L_e * m1;
+				grad[1] = -L_e * m2;
+				grad[2] = -(dot(x1 - x4, e) / L_e) * m1 - (dot(x2 - x4, e) / L_e) * m2;
+				grad[3] = (dot(x1 - x3, e) / L_e) * m1 + (dot(x2 - x3, e) / L_e) * m2;
+			}
+			return angle;
+		}
+	}
+
+	int pbd_solver::add_particle(vec3 const& p, float mass, vec3 const& v)
+	{
+		position.push_back(p);
+		velocity.push_back(v);
+		mass_inverse.push_back(mass > 0 ? 1.0f / mass : 0.0f);
+		return size() - 1;
+	}
+
+	int pbd_solver::add_distance_constraint(int i, int j, float compliance, float rest)
+	{
+		assert_cgp(i >= 0 && i < size() && j >= 0 && j < size() && i != j, "Invalid particles (" + str(i) + "," + str(j) + ") for a distance constraint");
+		distance_index.push_back({ i,j });
+		distance_rest.push_back(rest >= 0 ? rest : norm(position.at(j) - position.at(i)));
+		distance_compliance.push_back(compliance);
+		coloring_up_to_date = false;
+		return distance_index.size() - 1;
+	}
+
+	int pbd_solver::add_bending_constraint(int i, int j, int k, int l, float compliance)
+	{
+		assert_cgp(i >= 0 && i < size() && j >= 0 && j < size() && k >= 0 && k < size() && l >= 0 && l < size(), "Invalid particles for a bending constraint");
+		int4 const index = { i,j,k,l };
+		bending_index.push_back(index);
+		bending_rest.push_back(bending_angle(index));
+		bending_compliance.push_back(compliance);
+		coloring_up_to_date = false;
+		return bending_index.size() - 1;
+	}
+
+	int pbd_solver::add_volume_constraint(numarray<uint3> const& triangle, float compliance, float pressure)
+	{
+		pbd_volume_constraint constraint;
+		constraint.triangle = triangle;
+		constraint.rest_volume = pressure * volume_of(triangle);
+		constraint.compliance = compliance;
+
+		// Particles of the surface, and triangle corners around each of them
+		std::vector<int> local(size(), -1);
+		for (int k = 0; k < triangle.size(); ++k) {
+			for (int c = 0; c < 3; ++c) {
+				int const p = triangle.at(k)[c];
+				assert_cgp(p < size(), "Invalid particle " + str(p) + " in a volume constraint");
+				if (local[p] < 0) {
+					local[p] = constraint.particle.size();
+					constraint.particle.push_back(p);
+				}
+			}
+		}
+		int const N_local = constraint.particle.size();
+		adjacency_csr& adjacency = constraint.particle_to_corner;
+		adjacency.offset.resize(N_local + 1);
+		adjacency.offset.fill(0);
+		for (int k = 0; k < triangle.size(); ++k)
+			for (int c = 0; c < 3; ++c)
+				adjacency.offset.at(local[triangle.at(k)[c]] + 1)++;
+		for (int k = 0; k < N_local; ++k)
+			adjacency.offset.at(k + 1) += adjacency.offset.at(k);
+		numarray<int> counter = adjacency.offset;
+		adjacency.index.resize(3 * triangle.size());
+		for (int k = 0; k < triangle.size(); ++k)
+			for (int c = 0; c < 3; ++c)
+				adjacency.index.at(counter.at(local[triangle.at(k)[c]])++) = 3 * k + c;
+
+		volume.push_back(constraint);
+		return volume.size() - 1;
+	}
+
+	int pbd_solver::add_mesh(mesh const& m, float total_mass, float distance_compliance_arg, float bending_compliance_arg)
+	{
+		int const first = size();
+		int const N = m.position.size();
+		for (int k = 0; k < N; ++k)
+			add_particle(m.position.at(k), total_mass / N);
+
+		adjacency_csr const vertex_to_vertex = adjacency_vertex_to_vertex(m.connectivity, N);
+		for (int i = 0; i < N; ++i)
+			for (int a = vertex_to_vertex.begin(i); a < vertex_to_vertex.end(i); ++a)
+				if (vertex_to_vertex.index.at(a) > i)
+					add_distance_constraint(first + i, first + vertex_to_vertex.index.at(a), distance_compliance_arg);
+
+		adjacency_csr const face_to_face = adjacency_face_to_face(m.connectivity);
+		for (int f = 0; f < m.connectivity.size(); ++f) {
+			uint3 const& face_f = m.connectivity.at(f);
+			for (int a = face_to_face.begin(f); a < face_to_face.end(f); ++a) {
+				int const g = face_to_face.index.at(a);
+				if (g <= f)
+					continue;
+				uint3 const& face_g = m.connectivity.at(g);
+				// Corner of f opposite to the shared edge: the shared edge is then (face_f[c+1], face_f[c+2])
+				for (int c = 0; c < 3; ++c) {
+					int const i = face_f[c];
+					if (i == int(face_g.x) || i == int(face_g.y) || i == int(face_g.z))
+						continue;
+					int const k = face_f[(c + 1) % 3];
+					int const l = face_f[(c + 2) % 3];
+					int j = -1;
+					for (int d = 0; d < 3; ++d)
+						if (int(face_g[d]) != k && int(face_g[d]) != l)
+							j = face_g[d];
+					if (j >= 0 && j != i)
+						add_bending_constraint(first + i, first + j, first + k, first + l, bending_compliance_arg);
+					break;
+				}
+			}
+		}
+		return first;
+	}
+
+	float pbd_solver::bending_angle(int4 const& index) const
+	{
+		return pbd_dihedral_angle(position.at(index.x), position.at(index.y), position.at(index.z), position.at(index.w), nullptr);
+	}
+
+	float pbd_solver::volume_of(numarray<uint3> const& triangle) const
+	{
+		double V = 0.0;
+		for (int k = 0; k < triangle.size(); ++k) {
+			uint3 const& t = triangle.at(k);
+			V += dot(cross(position.at(t.x), position.at(t.y)), position.at(t.z));
+		}
+		return float(V / 6.0);
+	}
+
+	void pbd_solver::update_coloring()
+	{
+		int const N_distance = distance_index.size();
+		int const N_bending = bending_index.size();
+		pbd_graph_coloring(distance_color, N_distance > 0 ? &distance_index.at(0).x : nullptr, 2, N_distance, size(), pbd_shuffled_order(N_distance, seed));
+		pbd_graph_coloring(bending_color, N_bending > 0 ? &bending_index.at(0).x : nullptr, 4, N_bending, size(), pbd_shuffled_order(N_bending, seed));
+		coloring_up_to_date = true;
+	}
+
+	void pbd_solver::step(float dt)
+	{
+		if (!coloring_up_to_date)
+			update_coloring();
+		int const N_substep = std::max(substeps, 1);
+		for (int k = 0; k < N_substep; ++k)
+			substep(dt / N_substep);
+	}
+
+	void pbd_solver::substep(float dt)
+	{
+		int const N = size();
+		int const T = number_of_threads;
+		float const damping_factor = std::max(0.0f, 1.0f - damping * dt);
+
+		// Prediction
+		position_predicted.resize(N);
+		parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int) {
+			for (int k = int(k_begin); k < int(k_end); ++k) {
+				if (mass_inverse.at(k) > 0)
+					velocity.at(k) = damping_factor * (velocity.at(k) + dt * gravity);
+				position_predicted.at(k) = position.at(k) + dt * velocity.at(k);
+			}
+		});
+
+		distance_lambda.resize(distance_index.size());
+		distance_lambda.fill(0.0f);
+		bending_lambda.resize(bending_index.size());
+		bending_lambda.fill(0.0f);
+		volume_lambda.resize(volume.size());
+		volume_lambda.fill(0.0f);
+		float const dt2_inv = 1.0f / (dt * dt);
+		numarray<vec3>& p = position_predicted;
+
+		for (int iteration = 0; iteration < iterations; ++iteration)
+		{
+			// Distance constraints, color by color
+			for (int c = 0; c < distance_color.size(); ++c) {
+				int const begin = distance_color.begin(c);
+				parallel_for_chunk(distance_color.number_of_adjacent(c), T, [&](size_t a_begin, size_t a_end, int) {
+					for (int a = begin + int(a_begin); a < begin + int(a_end); ++a) {
+						int const k = distance_color.index.at(a);
+						int const i = distance_index.at(k).x;
+						int const j = distance_index.at(k).y;
+						float const w = mass_inverse.at(i) + mass_inverse.at(j);
+						if (w <= 0)
+							continue;
+						vec3 const d = p.at(i) - p.at(j);
+						float const L = norm(d);
+						if (L <= 0)
+							continue;
+						float const alpha = distance_compliance.at(k) * dt2_inv;
+						float const C = L - distance_rest.at(k);
+						float const d_lambda = (-C - alpha * distance_lambda.at(k)) / (w + alpha);
+						vec3 const n = d / L;
+						distance_lambda.at(k) += d_lambda;
+						p.at(i) += (mass_inverse.at(i) * d_lambda) * n;
+						p.at(j) -= (mass_inverse.at(j) * d_lambda) * n;
+					}
+				});
+			}
+
+			// Bending constraints, color by color
+			for (int c = 0; c < bending_color.size(); ++c) {
+				int const begin = bending_color.begin(c);
+				parallel_for_chunk(bending_color.number_of_adjacent(c), T, [&](size_t a_begin, size_t a_end, int) {
+					for (int a = begin + int(a_begin); a < begin + int(a_end); ++a) {
+						int const k = bending_color.index.at(a);
+						int4 const& index = bending_index.at(k);
+						int const id[4] = { index.x, index.y, index.z, index.w };
+						vec3 grad[4];
+						float const angle = pbd_dihedral_angle(p.at(id[0]), p.at(id[1]), p.at(id[2]), p.at(id[3]), grad);
+						float C = angle - bending_rest.at(k);
+						if (C > pbd_pi) C -= 2 * pbd_pi;
+						if (C < -pbd_pi) C += 2 * pbd_pi;
+
+						float w = 0.0f;
+						for (int s = 0; s < 4; ++s)
+							w += mass_inverse.at(id[s]) * dot(grad[s], grad[s]);
+						float const alpha = bending_compliance.at(k) * dt2_inv;
+						if (w + alpha <= 0)
+							continue;
+						float const d_lambda = (-C - alpha * bending_lambda.at(k)) / (w + alpha);
+						bending_lambda.at(k) += d_lambda;
+						for (int s = 0; s < 4; ++s)
+							p.at(id[s]) += (mass_inverse.at(id[s]) * d_lambda) * grad[s];
+					}
+				});
+			}
+
+			// Volume constraints: gradient on each triangle corner, then gathered on the particles
+			for (int k = 0; k < volume.size(); ++k) {
+				pbd_volume_constraint const& constraint = volume.at(k);
+				int const N_triangle = constraint.triangle.size();
+				int const N_particle = constraint.particle.size();
+				volume_corner_gradient.resize(3 * N_triangle);
+				volume_gradient.resize(N_particle);
+
+				double const V = pbd_parallel_sum(N_triangle, T, [&](int t_begin, int t_end) {
+					double s = 0.0;
+					for (int t = t_begin; t < t_end; ++t) {
+						uint3 const& tri = constraint.triangle.at(t);
+						vec3 const& a = p.at(tri.x);
+						vec3 const& b = p.at(tri.y);
+						vec3 const& c = p.at(tri.z);
+						s += dot(cross(a, b), c);
+						volume_corner_gradient.at(3 * t) = cross(b, c) / 6.0f;
+						volume_corner_gradient.at(3 * t + 1) = cross(c, a) / 6.0f;
+						volume_corner_gradient.at(3 * t + 2) = cross(a, b) / 6.0f;
+					}
+					return s;
+				}) / 6.0;
+
+				double const w = pbd_parallel_sum(N_particle, T, [&](int q_begin, int q_end) {
+					double s = 0.0;
+					for (int q = q_begin; q < q_end; ++q) {
+						vec3 g = { 0,0,0 };
+						for (int a = constraint.particle_to_corner.begin(q); a < constraint.particle_to_corner.end(q); ++a)
+							g += volume_corner_gradient.at(constraint.particle_to_corner.index.at(a));
+						volume_gradient.at(q) = g;
+						s += mass_inverse.at(constraint.particle.at(q)) * dot(g, g);
+					}
+					return s;
+				});
+
+				float const alpha = constraint.compliance * dt2_inv;
+				if (w + alpha <= 0)
+					continue;
+				float const C = float(V) - constraint.rest_volume;
+				float const d_lambda = float((-C - alpha * volume_lambda.at(k)) / (w + alpha));
+				volume_lambda.at(k) += d_lambda;
+				parallel_for_chunk(N_particle, T, [&](size_t q_begin, size_t q_end, int) {
+					for (int q = int(q_begin); q < int(q_end); ++q) {
+						int const i = constraint.particle.at(q);
+						p.at(i) += (mass_inverse.at(i) * d_lambda) * volume_gradient.at(q);
+					}
+				});
+			}
+		}
+
+		// Velocity from the displacement
+		float const dt_inv = 1.0f / dt;
+		parallel_for_chunk(N, T, [&](size_t k_begin, size_t k_end, int) {
+			for (int k = int(k_begin); k < int(k_end); ++k) {
+				if (mass_inverse.at(k) > 0)
+					velocity.at(k) = dt_inv * (p.at(k) - position.at(k));
+				position.at(k) = p.at(k);
+			}
+		});
+	}
+}
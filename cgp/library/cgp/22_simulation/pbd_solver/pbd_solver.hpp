@@ -0,0 +1,105 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/11_mesh/mesh.hpp"
+
+namespace cgp
+{
+	/** Volume constraint of a closed triangle mesh: volume(triangle) = rest_volume */
+	struct pbd_volume_constraint
+	{
+		/** Triangles of the closed surface, indexing the particles of the solver */
+		numarray<uint3> triangle;
+		float rest_volume = 0.0f;
+		float compliance = 0.0f;
+
+		/** Particles of the surface, and corners of the triangles (3*k_triangle + k_corner) adjacent to each of them */
+		numarray<int> particle;
+		adjacency_csr particle_to_corner;
+	};
+
+	/** Position based dynamics solver (XPBD: the stiffness of each constraint is given as a compliance, 0 for an infinitely stiff constraint)
+	* Constraints:
+	*  - distance between two particles (ropes, cloth edges),
+	*  - bending: dihedral angle between two triangles (i,k,l) and (j,l,k) sharing the edge (k,l),
+	*  - volume enclosed by a closed triangle surface (soft bodies, balloons).
+	* Each step predicts the positions, then runs a fixed number of iterations projecting all the constraints, and deduces the velocities from the displacement.
+	* The distance and bending constraints are partitioned by a greedy graph coloring: the constraints of a color don't share any particle and are projected in parallel without atomics.
+	*  The result is identical for any number of threads. The order in which the constraints are colored is shuffled from the seed (seed=0: order of insertion).
+	* The coloring is computed at the first step after a constraint has been added.
+	*
+	* Ex.
+	*   pbd_solver pbd;
+	*   pbd.add_mesh(mesh_primitive_grid(...), 1.0f, 0.0f, 1e-3f);
+	*   pbd.mass_inverse[0] = 0; // fixed particle
+	*   ...
+	*   pbd.step(dt);
+	*   cloth_drawable.vbo_position.update(pbd.position); */
+	struct pbd_solver
+	{
+		/** Particles */
+		numarray<vec3> position;
+		numarray<vec3> velocity;
+		numarray<float> mass_inverse; // 0 for a fixed particle
+
+		/** Distance constraints |p_i - p_j| = rest */
+		numarray<int2> distance_index;
+		numarray<float> distance_rest;
+		numarray<float> distance_compliance;
+
+		/** Bending constraints: the particles (i,j,k,l) of bending_index define the triangles (i,k,l) and (j,l,k), the constraint keeps their dihedral angle to rest */
+		numarray<int4> bending_index;
+		numarray<float> bending_rest;
+		numarray<float> bending_compliance;
+
+		numarray<pbd_volume_constraint> volume;
+
+		vec3 gravity = { 0,0,-9.81f };
+		/** Velocities are scaled by max(0, 1 - damping dt) at each substep */
+		float damping = 0.0f;
+		/** Each step is divided in substeps, each substep runs a fixed number of iterations over all the constraints */
+		int substeps = 1;
+		int iterations = 10;
+		/** Number of threads. 1: no threads, 0: number of hardware threads */
+		int number_of_threads = 0;
+		/** Seed of the shuffle of the constraints before their coloring (0: no shuffle) */
+		unsigned int seed = 0;
+
+		/** Number of particles */
+		int size() const { return position.size(); }
+		/** Add a particle, mass<=0: fixed particle. Return its index */
+		int add_particle(vec3 const& p, float mass = 1.0f, vec3 const& v = { 0,0,0 });
+		/** Add constraints and return their index. The rest configuration is the current one if rest is negative (or not given for bending) */
+		int add_distance_constraint(int i, int j, float compliance = 0.0f, float rest = -1.0f);
+		int add_bending_constraint(int i, int j, int k, int l, float compliance = 0.0f);
+		/** Volume constraint on a closed surface, the rest volume is pressure times the current volume */
+		int add_volume_constraint(numarray<uint3> const& triangle, float compliance = 0.0f, float pressure = 1.0f);
+		/** Add the vertices of a mesh as particles (of equal mass), with distance constraints along the edges and bending constraints between adjacent triangles.
+		*  Return the index of the first particle (the particle of the vertex k is first+k) */
+		int add_mesh(mesh const& m, float total_mass, float distance_compliance = 0.0f, float bending_compliance = 0.0f);
+
+		/** Advance the particles by a time step dt */
+		void step(float dt);
+
+		/** Dihedral angle of the bending constraint defined by the particles (i,j,k,l) at their current positions (0 for a flat configuration) */
+		float bending_angle(int4 const& index) const;
+		/** Current volume enclosed by the triangles */
+		float volume_of(numarray<uint3> const& triangle) const;
+
+		/** Colors of the distance and bending constraints: the constraints of the color c are distance_color.index[distance_color.begin(c)], ..., distance_color.index[distance_color.end(c)-1] */
+		adjacency_csr distance_color;
+		adjacency_csr bending_color;
+
+	private:
+		void update_coloring();
+		void substep(float dt);
+
+		bool coloring_up_to_date = false;
+		numarray<vec3> position_predicted;
+		numarray<float> distance_lambda;
+		numarray<float> bending_lambda;
+		numarray<float> volume_lambda;
+		numarray<vec3> volume_corner_gradient; // Scratch buffer for the gradient of a volume constraint on each triangle corner
+		numarray<vec3> volume_gradient;        // Scratch buffer for the gradient on each particle of a volume constraint
+	};
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "cloth_implicit/cloth_implicit.hpp"
+#include "matrix_sparse_block3/matrix_sparse_block3.hpp"
+#include "pbd_solver/pbd_solver.hpp"
+#include "particle_system/particle_system.hpp"
@@ -43,4 +43,8 @@
     double snoise3( double x, double y, double z );
     double snoise4( double x, double y, double z, double w );
 
+/** Permutation table used by the noise functions (values 0-255 repeated twice)
+ */
+    extern unsigned char perm[512];
+
 #endif
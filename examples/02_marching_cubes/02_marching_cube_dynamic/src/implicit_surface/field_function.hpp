@@ -26,6 +26,9 @@ struct field_function_structure {
 	float sb = 1.0f;
 	float sc = 0.0f; // note: The third blob is not visible initially has its magnitude is 0
 
+	// Distance beyond which the contribution of a blob is considered negligible (used to update only the modified regions of the field)
+	float blob_influence_radius = 3.0f;
+
 	// The parameters of the Perlin noise
 	float noise_magnitude   = 0.0f; // Magnitude of the noise
 	float noise_offset      = 0.0f; // An offset in the parametric domain (get a different value of noise with same parameters)
@@ -1,93 +1,95 @@
 #include "implicit_surface.hpp"
 
+#include <chrono>
+#include <exception>
+#include <iostream>
 
-using namespace cgp;
 
+using namespace cgp;
 
 
 
-static void update_normals(std::vector<vec3>& normals, int number_of_vertex, grid_3D<vec3> const& gradient, std::vector<marching_cube_relative_coordinates> const& relative_coords)
+// Mark as dirty the neighborhood of a blob if its position or magnitude changed (before and after the modification)
+static void set_dirty_blob(implicit_surface_bricks& bricks, vec3 const& p, float s, vec3 const& p_previous, float s_previous, float radius)
 {
-	// Compute the normal using linear interpolation of the gradients
-	for (int k = 0; k < number_of_vertex; ++k)
-	{
-		size_t const idx0 = relative_coords[k].k0;
-		size_t const idx1 = relative_coords[k].k1;
+	bool const same_position = p.x == p_previous.x && p.y == p_previous.y && p.z == p_previous.z;
+	if (s == s_previous && (same_position || s == 0))
+		return;
 
-		vec3 const& n0 = gradient.at_unsafe(idx0);
-		vec3 const& n1 = gradient.at_unsafe(idx1);
+	vec3 const r = { radius, radius, radius };
+	bricks.set_dirty(p_previous - r, p_previous + r);
+	bricks.set_dirty(p - r, p + r);
+}
 
-		float const alpha = relative_coords[k].alpha;
-		normals[k] = -normalize((1 - alpha) * n0 + alpha * n1, { 1,0,0 });
+// Mark as dirty the regions of the domain where the field function has been modified
+static void set_dirty_modified_regions(implicit_surface_bricks& bricks, field_function_structure const& f, field_function_structure const& f_previous)
+{
+	// The noise is defined everywhere: any modification requires to recompute the full field
+	bool const noise_modified = f.noise_magnitude != f_previous.noise_magnitude || f.noise_offset != f_previous.noise_offset || f.noise_scale != f_previous.noise_scale || f.noise_octave != f_previous.noise_octave || f.noise_persistance != f_previous.noise_persistance;
+	if (noise_modified && (f.noise_magnitude > 0 || f_previous.noise_magnitude > 0)) {
+		bricks.set_dirty_all();
+		return;
 	}
+
+	// Otherwise, only the neighborhood of the moving blobs is modified
+	set_dirty_blob(bricks, f.pa, f.sa, f_previous.pa, f_previous.sa, f.blob_influence_radius);
+	set_dirty_blob(bricks, f.pb, f.sb, f_previous.pb, f_previous.sb, f.blob_influence_radius);
+	set_dirty_blob(bricks, f.pc, f.sc, f_previous.pc, f_previous.sc, f.blob_influence_radius);
 }
 
-void implicit_surface_structure::update_marching_cube(float isovalue)
+void implicit_surface_structure::update_drawable()
 {
-	// Variable shortcut
-	std::vector<vec3>& position = data_param.position;
-	std::vector<vec3>& normal = data_param.normal;
-	size_t& number_of_vertex = data_param.number_of_vertex;
-	spatial_domain_grid_3D const& domain = field_param.domain;
-	std::vector<cgp::marching_cube_relative_coordinates> relative_coord = data_param.relative;
-	grid_3D<float> const& field = field_param.field;
-	grid_3D<vec3> const& gradient = field_param.gradient;
-
-	// Store the size of the previous position buffer
-	size_t const previous_size = position.size();
-
-	// Compute the Marching Cube
-	number_of_vertex = marching_cube(position, field.data.data, domain, isovalue, &relative_coord);
-
-	// Resize the vector of normals if needed
-	if (normal.size() < position.size())
-		normal.resize(position.size());
-
-	update_normals(normal, number_of_vertex, gradient, relative_coord);
-
-	// Update the display of the mesh
-	if (position.size() > previous_size) {
-		// If there is more position than allocated - perform a full clear and reallocation from scratch
+	if (bricks.buffer_resized) {
+		// If the buffers have been reallocated - perform a full clear and reallocation from scratch
 		drawable_param.shape.clear();
-		drawable_param.shape.initialize_data_on_gpu(position, normal);
+		drawable_param.shape.initialize_data_on_gpu(bricks.position, bricks.normal);
 	}
 	else {
-		// Otherwise simply update the new relevant values re-using the allocated buffers
-		drawable_param.shape.vbo_position.update(position, number_of_vertex);
-		drawable_param.shape.vbo_normal.update(normal, number_of_vertex);
-		drawable_param.shape.vertex_number = number_of_vertex;
+		// Otherwise only send the modified ranges of vertices re-using the allocated buffers
+		for (int2 const& range : bricks.modified_range) {
+			drawable_param.shape.vbo_position.update_range(bricks.position, range.x, range.y);
+			drawable_param.shape.vbo_normal.update_range(bricks.normal, range.x, range.y);
+		}
 	}
+	drawable_param.shape.vertex_number = bricks.position.size();
+}
 
+void implicit_surface_structure::update_marching_cube(float isovalue)
+{
+	// The field is not modified: only the bricks containing the surface are re-meshed
+	bricks.update(field_function_previous, isovalue);
+	update_drawable();
 }
 
 
 
 void implicit_surface_structure::update_field(field_function_structure const& field_function, float isovalue)
 {
-	// Variable shortcut
-	grid_3D<float>& field = field_param.field;
-	grid_3D<vec3>& gradient = field_param.gradient;
-	spatial_domain_grid_3D& domain = field_param.domain;
+	// Re-evaluate the field and the marching cube in the modified regions
+	set_dirty_modified_regions(bricks, field_function, field_function_previous);
+	bricks.update(field_function, isovalue);
+	field_function_previous = field_function;
+
+	update_drawable();
+}
 
-	// Compute the scalar field
-	field = compute_discrete_scalar_field(domain, field_function);
+void implicit_surface_structure::set_domain(int samples, cgp::vec3 const& length)
+{
+	spatial_domain_grid_3D const domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, length, samples * int3{ 1,1,1 });
 
-	// Compute the gradient of the scalar field
-	gradient = compute_gradient(field);
+	// A new domain requires to recompute everything
+	bool const same_domain = is_equal(domain.samples, bricks.domain.samples) && is_equal(domain.length, bricks.domain.length) && bricks.field.size() > 0;
+	if (same_domain)
+		return;
 
-	// Recompute the marching cube
-	update_marching_cube(isovalue);
+	bricks.number_of_threads = 0; // the field function can be evaluated in parallel
+	bricks.initialize(domain);
 
 	// Reset the domain visualization (lightweight - can be cleared at each call)
 	drawable_param.domain_box.clear();
 	drawable_param.domain_box.initialize_data_on_gpu(domain.export_segments_for_drawable_border());
 }
 
-void implicit_surface_structure::set_domain(int samples, cgp::vec3 const& length)
-{
-	field_param.domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, length, samples * int3{ 1,1,1 });
-}
-
 
 
 void implicit_surface_structure::gui_update(gui_parameters& gui, field_function_structure& field_function)
@@ -105,65 +107,28 @@ void implicit_surface_structure::gui_update(gui_parameters& gui, field_function_
 		update_field(field_function, gui.isovalue);
 	}
 
-	if (is_save_obj) {
-		data_param.position.resize(data_param.number_of_vertex);
-		data_param.normal.resize(data_param.number_of_vertex);
-		save_file_obj("mesh.obj", data_param.position, data_param.normal);
-	}
-		
-}
-
-
-
-grid_3D<float> compute_discrete_scalar_field(spatial_domain_grid_3D const& domain, field_function_structure const& func)
-{
-	grid_3D<float> field;
-	field.resize(domain.samples);
-
-	// Fill the discrete field values
-	for (int kz = 0; kz < domain.samples.z; kz++) {
-		for (int ky = 0; ky < domain.samples.y; ky++) {
-			for (int kx = 0; kx < domain.samples.x; kx++) {
-
-				vec3 const p = domain.position({ kx, ky, kz });
-				field(kx, ky, kz) = func(p);
-
-			}
+	// Report the end of the previous export (the exceptions raised in the background thread are rethrown by get)
+	//  Note: by default error_cgp aborts the program, so a failure to write the file only reaches this catch when CGP_ERROR_EXCEPTION is defined (see error.hpp)
+	if (export_obj.valid() && export_obj.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		try {
+			export_obj.get();
+			std::cout << "Mesh exported in mesh.obj" << std::endl;
+		}
+		catch (std::exception const& e) {
+			std::cerr << "Export of mesh.obj failed: " << e.what() << std::endl;
 		}
 	}
 
-	return field;
-}
-
-
-
-grid_3D<vec3> compute_gradient(grid_3D<float> const& field)
-{
-	grid_3D<vec3> gradient;
-	gradient.resize(field.dimension);
-
-	int const Nx = field.dimension.x;
-	int const Ny = field.dimension.y;
-	int const Nz = field.dimension.z;
-
-	// Use simple finite differences
-	//  g(k) = g(k+1)-g(k) // for k<N-1
-	//  otherwise g(k) = g(k)-g(k-1)
-
-	for (int kz = 0; kz < Nz; ++kz) {
-		for (int ky = 0; ky < Ny; ++ky) {
-			for (int kx = 0; kx < Nx; ++kx) {
-
-				vec3& g = gradient.at_unsafe(kx, ky, kz);
-				float const f = field.at_unsafe(kx, ky, kz);
-
-				g.x = kx != Nx - 1 ? field.at_unsafe(kx + 1, ky, kz) - f : f - field.at_unsafe(kx - 1, ky, kz);
-				g.y = ky != Ny - 1 ? field.at_unsafe(kx, ky + 1, kz) - f : f - field.at_unsafe(kx, ky - 1, kz);
-				g.z = kz != Nz - 1 ? field.at_unsafe(kx, ky, kz + 1) - f : f - field.at_unsafe(kx, ky, kz - 1);
-
-			}
+	if (is_save_obj) {
+		// A single export at a time: two threads writing mesh.obj would corrupt the file
+		if (export_obj.valid())
+			std::cout << "Export of mesh.obj already running, new export skipped" << std::endl;
+		else {
+			std::vector<vec3> position, normal;
+			bricks.export_triangle_soup(position, normal);
+			// Written in a background thread: the GUI doesn't wait for the export
+			export_obj = save_file_obj_async("mesh.obj", std::move(position), std::move(normal));
 		}
 	}
-
-	return gradient;
+		
 }
@@ -9,21 +9,6 @@
 // All the data used for the Implicit Surface 
 // ********************************************** //
 
-// Sub-structure that contains the discrete field data
-struct implicit_surface_field_structure {
-	cgp::spatial_domain_grid_3D domain;   // The domain where the discrete field is defined
-	cgp::grid_3D<float> field;            // The grid storing the value of the field
-	cgp::grid_3D<cgp::vec3> gradient;     // The discrete gradient of the field
-};
-
-// Sub-structure that contains the data of the surface
-struct implicit_surface_data {
-	size_t number_of_vertex;              // The valid number of vertex of the surface
-	std::vector<cgp::vec3> position;      // Positions of the mesh
-	std::vector<cgp::vec3> normal;        // Normals of the mesh
-	std::vector<cgp::marching_cube_relative_coordinates> relative; // Relative coordinates of the vertices expressed as an edge in the discrete grid 
-};
-
 // Sub-structure that contains the elements that are displayed
 struct implicit_surface_drawable_structure {
 	cgp::triangles_drawable shape;     // Structure used to display the geometry
@@ -34,15 +19,16 @@ struct implicit_surface_drawable_structure {
 // Global structure 
 struct implicit_surface_structure 
 {	
-	implicit_surface_data data_param;
+	cgp::implicit_surface_bricks bricks;              // The discrete field and the surface, partitioned in bricks that are updated incrementally
 	implicit_surface_drawable_structure drawable_param;
-	implicit_surface_field_structure field_param;	
+	field_function_structure field_function_previous; // The parameters of the field function used at the last update (to find the modified regions)
+	std::future<void> export_obj;                     // Export of the mesh in an obj file running in the background
 
 
 	// Helpers functions that should be called in the scene
 	// *************************************************** //
 
-	//   Recompute from scratch the field and the marching cube
+	//   Recompute the field and the marching cube only in the regions modified since the last update
 	void update_field(field_function_structure const& field_function, float isovalue);
 
 	//   Recompute only the marching cube for a different isovalue (while minimize re-allocations)
@@ -53,11 +39,7 @@ struct implicit_surface_structure
 	
 	//   Helper function to update the gui and call the associated update functions
 	void gui_update(gui_parameters& gui, field_function_structure& field_function);
-};
-
 
-// Compute a grid filled with the value of some scalar function - the size of the grid is given by the domain
-cgp::grid_3D<float> compute_discrete_scalar_field(cgp::spatial_domain_grid_3D const& domain, field_function_structure const& func);
-
-// Compute the gradient of the scalar field using finite differences on the voxels
-cgp::grid_3D<cgp::vec3> compute_gradient(cgp::grid_3D<float> const& field);
+	//   Send the modified vertices to the GPU
+	void update_drawable();
+};
@@ -0,0 +1,75 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cgp;
+
+// Benchmark of the marching cube using a min/max hierarchy to skip empty regions (minmax_hierarchy_grid_3D)
+//  compared to the full marching cube visiting all the voxels.
+// The field is the distance to a sphere (plus some noise): the radius sets the area of the surface, and therefore the occupancy (ratio of voxels crossed by the surface).
+
+grid_3D<float> compute_field(spatial_domain_grid_3D const& domain, float noise_magnitude)
+{
+	grid_3D<float> field(domain.samples);
+	for (int kz = 0; kz < domain.samples.z; ++kz) {
+		for (int ky = 0; ky < domain.samples.y; ++ky) {
+			for (int kx = 0; kx < domain.samples.x; ++kx) {
+				vec3 const p = domain.position({ kx,ky,kz });
+				field(kx, ky, kz) = norm(p) + noise_magnitude * noise_perlin(3.0f * p, 2);
+			}
+		}
+	}
+	return field;
+}
+
+// Ratio of voxels crossed by the iso-surface
+float occupancy(grid_3D<float> const& field, float iso)
+{
+	int3 const N = field.dimension;
+	size_t counter = 0;
+	for (int kz = 0; kz < N.z - 1; ++kz) {
+		for (int ky = 0; ky < N.y - 1; ++ky) {
+			for (int kx = 0; kx < N.x - 1; ++kx) {
+				float v_min = field(kx, ky, kz), v_max = v_min;
+				for (int k = 1; k < 8; ++k) {
+					float const v = field(kx + (k & 1), ky + ((k >> 1) & 1), kz + ((k >> 2) & 1));
+					v_min = std::min(v_min, v);
+					v_max = std::max(v_max, v);
+				}
+				if (v_min < iso && v_max >= iso)
+					counter++;
+			}
+		}
+	}
+	return counter / float((N.x - 1) * (N.y - 1) * (N.z - 1));
+}
+
+int main(int argc, char* argv[])
+{
+	std::cout << "Run " << argv[0] << std::endl;
+
+	int const samples = argc > 1 ? std::stoi(argv[1]) : 256;
+	spatial_domain_grid_3D const domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, { 2,2,2 }, samples * int3{ 1,1,1 });
+
+	std::cout << "Compute field with " << samples << "^3 samples ..." << std::endl;
+	grid_3D<float> const field = compute_field(domain, 0.02f);
+
+	minmax_hierarchy_grid_3D hierarchy;
+	double const t_hierarchy = time_best_ms([&]() { hierarchy.initialize(field, 8); });
+	std::cout << "Build min/max hierarchy (bricks of 8^3 voxels): " << t_hierarchy << " ms\n" << std::endl;
+
+	std::vector<vec3> position_full, position_sparse;
+	std::vector<marching_cube_relative_coordinates> relative_full, relative_sparse;
+
+	std::cout << "radius \t occupancy (%) \t triangles \t full (ms) \t hierarchy (ms) \t speedup" << std::endl;
+	for (float radius : { 0.05f, 0.1f, 0.2f, 0.4f, 0.6f, 0.8f, 0.95f }) {
+		size_t N_full = 0, N_sparse = 0;
+		double const t_full = time_best_ms([&]() { N_full = marching_cube(position_full, field.data.data, domain, radius, &relative_full); });
+		double const t_sparse = time_best_ms([&]() { N_sparse = marching_cube(position_sparse, field.data.data, domain, radius, hierarchy, &relative_sparse); });
+		assert_cgp(N_full == N_sparse, "Both marching cubes should generate the same number of triangles");
+
+		std::cout << radius << " \t " << 100 * occupancy(field, radius) << " \t " << N_full / 3 << " \t " << t_full << " \t " << t_sparse << " \t " << t_full / t_sparse << std::endl;
+	}
+
+	return 0;
+}
@@ -22,7 +22,8 @@ void scene_structure::initialize()
 	
 	// Unzip the files in assets/ before runing the code
 	//auto struct_shape = mesh_load_file_obj_advanced(project::path + "assets/f1/", "F1GenV3Backup.obj");
-	auto struct_shape = mesh_load_file_obj_advanced(project::path + "assets/sponza/", "sponza.obj");
+	//  The meshes are stored in a binary cache (sponza.obj.cgpmesh) at the first launch: the next launches don't parse the obj file again
+	auto struct_shape = mesh_load_file_obj_advanced_cached(project::path + "assets/sponza/", "sponza.obj");
 	shapes = mesh_obj_advanced_loader::convert_to_mesh_drawable(struct_shape);
 
 }
@@ -0,0 +1,66 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+#include <cmath>
+
+using namespace cgp;
+
+// Benchmark of the array versions of noise_perlin (vectorized with SSE2/AVX2)
+//  compared to the scalar version called on each point.
+// The noise is evaluated on N x N points in 2D, and on the same number of points in 3D, for an increasing number of octaves.
+
+// Compare the scalar and array versions on a set of points, and display the timings
+template <typename VEC>
+void run_benchmark(numarray<VEC> const& p, int octave)
+{
+	float const persistency = 0.35f;
+	float const frequency_gain = 2.0f;
+	int const N = p.size();
+
+	numarray<float> value_scalar(N), value_array(N);
+	double const t_scalar = time_best_ms([&]() {
+		for (int k = 0; k < N; ++k)
+			value_scalar[k] = noise_perlin(p[k], octave, persistency, frequency_gain);
+	});
+	double const t_array = time_best_ms([&]() {
+		noise_perlin(value_array, p, octave, persistency, frequency_gain);
+	});
+
+	float error = 0.0f;
+	for (int k = 0; k < N; ++k)
+		error = std::max(error, std::abs(value_scalar[k] - value_array[k]));
+
+	std::cout << octave << "\t" << t_scalar << "\t\t" << t_array << "\t\t" << N / (1000 * t_array) << "\t\t" << t_scalar / t_array << "\t" << error << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int const N = argc > 1 ? std::stoi(argv[1]) : 512;
+
+	std::cout << "Perlin noise on " << N * N << " points" << std::endl;
+	std::cout << "AVX2 support: " << (simd_support_avx2() ? "yes" : "no") << std::endl;
+
+	numarray<vec2> p2(N * N);
+	numarray<vec3> p3(N * N);
+	for (int ky = 0; ky < N; ++ky) {
+		for (int kx = 0; kx < N; ++kx) {
+			float const u = kx / (N - 1.0f);
+			float const v = ky / (N - 1.0f);
+			p2[kx + N * ky] = { u, v };
+			p3[kx + N * ky] = { u, v, 0.5f * u + 0.25f };
+		}
+	}
+
+	for (int dimension = 2; dimension <= 3; ++dimension) {
+		std::cout << "\n" << dimension << "D noise" << std::endl;
+		std::cout << "Octave\tScalar (ms)\tArray (ms)\tArray (Mpts/s)\tSpeedup\tMax error" << std::endl;
+		for (int octave : { 1, 3, 6, 9 }) {
+			if (dimension == 2)
+				run_benchmark(p2, octave);
+			else
+				run_benchmark(p3, octave);
+		}
+	}
+
+	return 0;
+}
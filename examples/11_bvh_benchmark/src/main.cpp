@@ -0,0 +1,118 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+#include <cmath>
+
+using namespace cgp;
+
+// Benchmark of the bounding volume hierarchy (bvh_mesh) used for ray/mesh queries.
+// The build time is measured with one thread and with all the hardware threads,
+//  then the throughput of closest_hit and any_hit is measured on a set of rays thrown from a sphere around the mesh toward its center.
+// A brute-force loop over all the triangles is run on a subset of the rays to check the results and give a reference.
+
+// Closest intersection computed by testing all the triangles (reference)
+float closest_hit_brute_force(mesh const& m, vec3 const& p, vec3 const& d)
+{
+	float t_closest = -1.0f;
+	for (int k = 0; k < m.connectivity.size(); ++k) {
+		uint3 const& f = m.connectivity[k];
+		vec3 const a = m.position[f.x];
+		vec3 const e1 = m.position[f.y] - a;
+		vec3 const e2 = m.position[f.z] - a;
+		vec3 const q = cross(d, e2);
+		float const det = dot(e1, q);
+		if (det == 0.0f)
+			continue;
+		vec3 const s = p - a;
+		float const u = dot(s, q) / det;
+		vec3 const r = cross(s, e1);
+		float const v = dot(d, r) / det;
+		float const t = dot(e2, r) / det;
+		if (u >= 0 && v >= 0 && u + v <= 1 && t > 0 && (t_closest < 0 || t < t_closest))
+			t_closest = t;
+	}
+	return t_closest;
+}
+
+int main(int argc, char** argv)
+{
+	// Mesh: an OBJ file given as argument, or a finely sampled torus
+	mesh shape;
+	if (argc > 1)
+		shape = mesh_load_file_obj(argv[1]);
+	else
+		shape = mesh_primitive_torus(1.0f, 0.4f, { 0,0,0 }, { 0,0,1 }, 1000, 500);
+	int const N_ray = argc > 2 ? std::stoi(argv[2]) : 1000000;
+
+	std::cout << "Mesh: " << shape.position.size() << " vertices, " << shape.connectivity.size() << " triangles" << std::endl;
+
+	// Build
+	bvh_mesh bvh;
+	bvh.number_of_threads = 1;
+	double const t_build_1 = time_best_ms([&]() { bvh.initialize(shape); }, 3);
+	bvh.number_of_threads = 0;
+	double const t_build = time_best_ms([&]() { bvh.initialize(shape); }, 3);
+	std::cout << "\nBuild (binned SAH, " << bvh.bins << " bins, leaf size " << bvh.leaf_size << "): " << bvh.nodes.size() << " nodes" << std::endl;
+	std::cout << "1 thread: " << t_build_1 << " ms\t" << parallel_number_of_threads() << " threads: " << t_build << " ms" << std::endl;
+
+	// Rays from a sphere enclosing the mesh toward a random point near the center
+	bounding_box box;
+	box.initialize(shape.position);
+	vec3 const center = (box.p_min + box.p_max) / 2.0f;
+	float const radius = norm(box.p_max - box.p_min);
+	numarray<vec3> ray_origin(N_ray), ray_direction(N_ray);
+	for (int k = 0; k < N_ray; ++k) {
+		vec3 const p = center + radius * normalize(vec3(rand_normal(), rand_normal(), rand_normal()));
+		vec3 const target = center + 0.25f * radius * vec3(rand_uniform(-1, 1), rand_uniform(-1, 1), rand_uniform(-1, 1));
+		ray_origin[k] = p;
+		ray_direction[k] = normalize(target - p);
+	}
+
+	// Queries
+	numarray<float> t_hit(N_ray);
+	numarray<int> any(N_ray);
+	double const t_closest_1 = time_best_ms([&]() {
+		for (int k = 0; k < N_ray; ++k) {
+			bvh_intersection const hit = bvh.closest_hit(ray_origin[k], ray_direction[k]);
+			t_hit[k] = hit.valid ? hit.t : -1.0f;
+		}
+	}, 3);
+	double const t_closest = time_best_ms([&]() {
+		parallel_for_chunk(N_ray, 0, [&](size_t k_begin, size_t k_end, int) {
+			for (size_t k = k_begin; k < k_end; ++k) {
+				bvh_intersection const hit = bvh.closest_hit(ray_origin.at(k), ray_direction.at(k));
+				t_hit.at(k) = hit.valid ? hit.t : -1.0f;
+			}
+		});
+	}, 3);
+	double const t_any_1 = time_best_ms([&]() {
+		for (int k = 0; k < N_ray; ++k)
+			any[k] = bvh.any_hit(ray_origin[k], ray_direction[k]);
+	}, 3);
+
+	int N_hit = 0;
+	for (int k = 0; k < N_ray; ++k)
+		N_hit += (t_hit[k] > 0);
+
+	std::cout << "\n" << N_ray << " rays (" << N_hit << " hits)" << std::endl;
+	std::cout << "Query\t\t\tTime (ms)\tMrays/s" << std::endl;
+	std::cout << "closest_hit (1 thread)\t" << t_closest_1 << "\t\t" << N_ray / (1000 * t_closest_1) << std::endl;
+	std::cout << "closest_hit (" << parallel_number_of_threads() << " threads)\t" << t_closest << "\t\t" << N_ray / (1000 * t_closest) << std::endl;
+	std::cout << "any_hit (1 thread)\t" << t_any_1 << "\t\t" << N_ray / (1000 * t_any_1) << std::endl;
+
+	// Reference on a subset of the rays
+	int const N_brute = std::min(N_ray, 100);
+	int error = 0;
+	double const t_brute = time_best_ms([&]() {
+		error = 0;
+		for (int k = 0; k < N_brute; ++k) {
+			float const t = closest_hit_brute_force(shape, ray_origin[k], ray_direction[k]);
+			if ((t < 0) != (t_hit[k] < 0) || std::abs(t - t_hit[k]) > 1e-4f * radius || (any[k] != 0) != (t > 0))
+				error++;
+		}
+	}, 1);
+	std::cout << "brute force (1 thread)\t" << t_brute * N_ray / N_brute << " (est.)\t" << N_brute / (1000 * t_brute) << std::endl;
+	std::cout << "\nMismatch with brute force: " << error << "/" << N_brute << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,56 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cgp;
+
+// Benchmark of particle_system::step for the three integrators.
+// N particles are placed on a square grid, with gravity and damping only ("free" particles),
+//  then with springs between the neighboring particles of the grid ("springs"). The first row of particles is fixed.
+// The throughput in particles/s is reported with one thread and with all the hardware threads.
+
+particle_system create_system(int N_side, bool springs)
+{
+	particle_system particles;
+	particles.damping = 0.01f;
+	float const h = 1.0f / N_side;
+	for (int ky = 0; ky < N_side; ++ky)
+		for (int kx = 0; kx < N_side; ++kx)
+			particles.add_particle({ kx * h, ky * h, 0.0f }, { 0,0,0 }, ky == 0 ? 0.0f : 1.0f / (N_side * N_side));
+	if (springs) {
+		for (int ky = 0; ky < N_side; ++ky) {
+			for (int kx = 0; kx < N_side; ++kx) {
+				int const k = kx + N_side * ky;
+				if (kx < N_side - 1) particles.add_spring(k, k + 1, 10.0f);
+				if (ky < N_side - 1) particles.add_spring(k, k + N_side, 10.0f);
+			}
+		}
+	}
+	return particles;
+}
+
+int main(int argc, char** argv)
+{
+	int const N_side = argc > 1 ? std::stoi(argv[1]) : 1000;
+	int const N = N_side * N_side;
+	float const dt = 1e-4f;
+
+	std::cout << "Particle system with " << N << " particles, " << parallel_number_of_threads() << " hardware threads" << std::endl;
+	std::cout << "\nForces\tIntegrator\t\t1 thread (ms)\tMparticles/s\tAll threads (ms)\tMparticles/s" << std::endl;
+
+	for (bool springs : { false, true }) {
+		particle_system particles = create_system(N_side, springs);
+		for (particle_integrator integrator : { particle_integrator::semi_implicit_euler, particle_integrator::velocity_verlet, particle_integrator::rk4 }) {
+			particles.integrator = integrator;
+			particles.number_of_threads = 1;
+			double const t_1 = time_best_ms([&]() { particles.step(dt); });
+			particles.number_of_threads = 0;
+			double const t_all = time_best_ms([&]() { particles.step(dt); });
+
+			std::string const name = integrator == particle_integrator::semi_implicit_euler ? "semi_implicit_euler" : (integrator == particle_integrator::velocity_verlet ? "velocity_verlet\t" : "rk4\t\t");
+			std::cout << (springs ? "springs" : "free") << "\t" << name << "\t" << t_1 << "\t\t" << N / (1000 * t_1) << "\t\t" << t_all << "\t\t\t" << N / (1000 * t_all) << std::endl;
+		}
+	}
+
+	return 0;
+}
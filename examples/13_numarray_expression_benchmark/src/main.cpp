@@ -0,0 +1,79 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cgp;
+
+// Benchmark of the evaluation of a = b*s + c*t - d on large numarrays.
+//  - eager: one numarray allocated and one loop per operator (behavior of the operators before the lazy expressions)
+//  - expression (new array): the expression is evaluated in a single loop into a newly allocated numarray
+//  - expression (in place): the expression is evaluated in a single loop into an existing numarray of the right size (no allocation)
+//  - hand-written loop: reference
+// The bandwidth is computed from the minimal memory traffic of the expression (read b, c, d and write a).
+
+// Operators allocating their result (one loop per operator)
+namespace eager
+{
+	template <typename T> numarray<T> scale(numarray<T> const& a, float s)
+	{
+		int const N = a.size();
+		numarray<T> res(N);
+		for (int k = 0; k < N; ++k)
+			res.at(k) = a.at(k) * s;
+		return res;
+	}
+	template <typename T> numarray<T> add(numarray<T> const& a, numarray<T> const& b)
+	{
+		numarray<T> res = a;
+		int const N = a.size();
+		for (int k = 0; k < N; ++k)
+			res.at(k) += b.at(k);
+		return res;
+	}
+	template <typename T> numarray<T> sub(numarray<T> const& a, numarray<T> const& b)
+	{
+		numarray<T> res = a;
+		int const N = a.size();
+		for (int k = 0; k < N; ++k)
+			res.at(k) -= b.at(k);
+		return res;
+	}
+}
+
+template <typename T>
+void benchmark(std::string const& name, int N, T const& value)
+{
+	numarray<T> b(N), c(N), d(N), a(N);
+	b.fill(value); c.fill(2.0f * value); d.fill(0.5f * value);
+	float const s = 1.5f, t = -0.25f;
+
+	double const bytes = 4.0 * N * sizeof(T);
+	auto report = [&](std::string const& method, double ms) {
+		std::cout << name << "\t" << method << "\t" << ms << "\t\t" << bytes / (ms * 1e6) << std::endl;
+	};
+
+	report("eager\t\t\t", time_best_ms([&]() { a = eager::sub(eager::add(eager::scale(b, s), eager::scale(c, t)), d); }));
+	report("expression (new array)\t", time_best_ms([&]() { numarray<T> r = b * s + c * t - d; a.data.swap(r.data); }));
+	report("expression (in place)\t", time_best_ms([&]() { a = b * s + c * t - d; }));
+	report("hand-written loop\t", time_best_ms([&]() {
+		for (int k = 0; k < N; ++k)
+			a.at(k) = b.at(k) * s + c.at(k) * t - d.at(k);
+	}));
+
+	// Check the result of the expression against the loop
+	numarray<T> const reference = a;
+	a = b * s + c * t - d;
+	std::cout << name << "\tmatch: " << (is_equal(a, reference) ? "yes" : "no") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int const N = argc > 1 ? std::stoi(argv[1]) : 10000000;
+
+	std::cout << "a = b*s + c*t - d on numarrays of " << N << " elements" << std::endl;
+	std::cout << "\nType\tMethod\t\t\t\tTime (ms)\tGB/s" << std::endl;
+	benchmark("float", N, 1.0f);
+	benchmark("vec3", N, vec3{ 1.0f, 2.0f, 3.0f });
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cgp;
+
+// Benchmark of the vectorized numarray kernels for each instruction set available on the CPU.
+//  - a += b, a *= b, a *= s: element-wise compound operators on float and vec3
+//  - sum, max: reductions (max on float only)
+// Each operation is timed with the scalar, SSE2 and AVX2 kernels (only the ones supported by the CPU), and with the deterministic mode for the sum.
+// The bandwidth is computed from the memory traffic of the operation (read b and read/write a for the compound operators).
+
+std::string instruction_set_str(numarray_simd_instruction_set set)
+{
+	if (set == numarray_simd_instruction_set::avx2) return "avx2";
+	if (set == numarray_simd_instruction_set::sse2) return "sse2";
+	return "scalar";
+}
+
+template <typename T>
+void benchmark(std::string const& name, int N, T const& value)
+{
+	numarray<T> a(N), b(N);
+	a.fill(value); b.fill(1.0000001f * value);
+	float const s = 0.9999999f;
+
+	double const bytes_compound = 3.0 * N * sizeof(T);
+	double const bytes_reduce = 1.0 * N * sizeof(T);
+	auto report = [&](std::string const& method, std::string const& set, double ms, double bytes) {
+		std::cout << name << "\t" << method << "\t" << set << "\t" << ms << "\t\t" << bytes / (ms * 1e6) << std::endl;
+	};
+
+	numarray_simd_instruction_set const best = numarray_simd_set_instruction_set(numarray_simd_instruction_set::avx2);
+	for (int k = 0; k <= int(best); ++k) {
+		numarray_simd_instruction_set const set = numarray_simd_set_instruction_set(numarray_simd_instruction_set(k));
+		std::string const set_name = instruction_set_str(set);
+
+		report("a += b", set_name, time_best_ms([&]() { a += b; }), bytes_compound);
+		report("a *= b", set_name, time_best_ms([&]() { a *= b; }), bytes_compound);
+		report("a *= s", set_name, time_best_ms([&]() { a *= s; }), 2.0 * N * sizeof(T));
+
+		T result;
+		report("sum(a)", set_name, time_best_ms([&]() { result = sum(a); }), bytes_reduce);
+		numarray_simd_set_deterministic(true);
+		report("sum(a) det.", set_name, time_best_ms([&]() { result = sum(a); }), bytes_reduce);
+		numarray_simd_set_deterministic(false);
+	}
+	numarray_simd_set_instruction_set(best);
+}
+
+void benchmark_max(int N)
+{
+	numarray<float> a(N);
+	for (int k = 0; k < N; ++k)
+		a[k] = float((k * 7919) % 10007);
+
+	numarray_simd_instruction_set const best = numarray_simd_set_instruction_set(numarray_simd_instruction_set::avx2);
+	for (int k = 0; k <= int(best); ++k) {
+		numarray_simd_instruction_set const set = numarray_simd_set_instruction_set(numarray_simd_instruction_set(k));
+		float result = 0;
+		double const ms = time_best_ms([&]() { result = max(a); });
+		std::cout << "float\tmax(a)\t\t" << instruction_set_str(set) << "\t" << ms << "\t\t" << N * sizeof(float) / (ms * 1e6) << "\t(max=" << result << ")" << std::endl;
+	}
+	numarray_simd_set_instruction_set(best);
+}
+
+int main(int argc, char** argv)
+{
+	int const N = argc > 1 ? std::stoi(argv[1]) : 10000000;
+
+	std::cout << "Vectorized numarray kernels on numarrays of " << N << " elements" << std::endl;
+	std::cout << "Best instruction set: " << instruction_set_str(numarray_simd_get_instruction_set()) << std::endl;
+	std::cout << "\nType\tOperation\tSet\tTime (ms)\tGB/s" << std::endl;
+	benchmark("float", N, 1.0f);
+	benchmark_max(N);
+	benchmark("vec3", N, vec3{ 1.0f, 2.0f, 3.0f });
+
+	return 0;
+}
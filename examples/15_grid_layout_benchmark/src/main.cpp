@@ -0,0 +1,97 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace cgp;
+
+// Benchmark of the traversal order of grid_3D on stencil operations over a scalar field of N^3 samples.
+//  - gradient: central differences along the 3 directions (6 neighbors), accumulated in the norm of the gradient
+//  - laplacian: 7 points stencil written in a second grid with the same layout
+//  - voxel corners: the 8 corners of each voxel are fetched and the voxels crossed by the iso-surface are counted (as in the marching cube)
+// Each stencil is run line per line (loops in k1,k2,k3 order) and block per block (grid.blocks(block_size)) with blocks of 4^3, 8^3 and 16^3.
+// Tiled and Morton storages of grid_3D were also measured with this benchmark: the index computation on every access cost more than
+//  the cache misses they saved, and the linear storage remained the fastest up to 512^3 samples.
+
+// Call f(k1,k2,k3) for all the indices, block per block
+template <typename F>
+void for_each_index(grid_block_range_3D const& blocks, F const& f)
+{
+	for (grid_block_3D const& block : blocks)
+		for (int k3 = block.index_begin.z; k3 < block.index_end.z; ++k3)
+			for (int k2 = block.index_begin.y; k2 < block.index_end.y; ++k2)
+				for (int k1 = block.index_begin.x; k1 < block.index_end.x; ++k1)
+					f(k1, k2, k3);
+}
+
+void benchmark(std::string const& name, grid_3D<float> const& field, int3 const& block_size)
+{
+	grid_3D<float> laplacian(field.dimension);
+	grid_block_range_3D const blocks = field.blocks(block_size);
+
+	int3 const N = field.dimension;
+	auto clamp_index = [](int k, int n) { return k < 0 ? 0 : (k >= n ? n - 1 : k); };
+
+	float gradient_norm = 0.0f;
+	double const t_gradient = time_best_ms([&]() {
+		gradient_norm = 0.0f;
+		for_each_index(blocks, [&](int k1, int k2, int k3) {
+			float const gx = field.at_unsafe(clamp_index(k1 + 1, N.x), k2, k3) - field.at_unsafe(clamp_index(k1 - 1, N.x), k2, k3);
+			float const gy = field.at_unsafe(k1, clamp_index(k2 + 1, N.y), k3) - field.at_unsafe(k1, clamp_index(k2 - 1, N.y), k3);
+			float const gz = field.at_unsafe(k1, k2, clamp_index(k3 + 1, N.z)) - field.at_unsafe(k1, k2, clamp_index(k3 - 1, N.z));
+			gradient_norm += gx * gx + gy * gy + gz * gz;
+		});
+	}, 3);
+
+	double const t_laplacian = time_best_ms([&]() {
+		for_each_index(blocks, [&](int k1, int k2, int k3) {
+			laplacian.at_unsafe(k1, k2, k3) =
+				field.at_unsafe(clamp_index(k1 + 1, N.x), k2, k3) + field.at_unsafe(clamp_index(k1 - 1, N.x), k2, k3)
+				+ field.at_unsafe(k1, clamp_index(k2 + 1, N.y), k3) + field.at_unsafe(k1, clamp_index(k2 - 1, N.y), k3)
+				+ field.at_unsafe(k1, k2, clamp_index(k3 + 1, N.z)) + field.at_unsafe(k1, k2, clamp_index(k3 - 1, N.z))
+				- 6.0f * field.at_unsafe(k1, k2, k3);
+		});
+	}, 3);
+
+	int crossed_voxels = 0;
+	grid_block_range_3D const voxel_blocks(N - int3{ 1,1,1 }, block_size);
+	double const t_voxel = time_best_ms([&]() {
+		crossed_voxels = 0;
+		for_each_index(voxel_blocks, [&](int k1, int k2, int k3) {
+			int inside = 0;
+			for (int c = 0; c < 8; ++c)
+				inside += field.at_unsafe(k1 + (c & 1), k2 + ((c >> 1) & 1), k3 + (c >> 2)) < 0.0f;
+			crossed_voxels += (inside > 0 && inside < 8);
+		});
+	}, 3);
+
+	double const samples = double(N.x) * N.y * N.z;
+	auto report = [&](std::string const& stencil, double ms) {
+		std::cout << name << "\t" << stencil << "\t" << ms << "\t\t" << samples / (ms * 1e3) << std::endl;
+	};
+	report("gradient  ", t_gradient);
+	report("laplacian ", t_laplacian);
+	report("voxel corners", t_voxel);
+	std::cout << "\t(check: gradient " << gradient_norm << ", crossed voxels " << crossed_voxels << ")" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int const N = argc > 1 ? std::atoi(argv[1]) : 256;
+	std::cout << "Stencils on a grid_3D<float> of " << N << "^3 samples" << std::endl;
+
+	// Sum of spheres sampled on the grid (the iso-surface 0 crosses a few percent of the voxels)
+	grid_3D<float> field(N, N, N);
+	parallel_for(field, [N](float& value, int k1, int k2, int k3) {
+		vec3 const p = vec3{ float(k1), float(k2), float(k3) } / float(N);
+		value = std::min(norm(p - vec3{ 0.3f,0.4f,0.5f }) - 0.25f, norm(p - vec3{ 0.7f,0.6f,0.4f }) - 0.2f);
+	});
+
+	std::cout << "traversal\tstencil\t\ttime (ms)\tsamples/us" << std::endl;
+	benchmark("lines\t", field, { N, 1, 1 });
+	benchmark("blocks 4^3", field, { 4, 4, 4 });
+	benchmark("blocks 8^3", field, { 8, 8, 8 });
+	benchmark("blocks 16^3", field, { 16, 16, 16 });
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace cgp;
+
+// Benchmark of the loading of an OBJ file.
+//  - legacy: one pass over the file per attribute with std::getline/istringstream (loader::obj_read_positions, obj_read_texture_uv, obj_read_normals, obj_read_faces)
+//  - single pass: the file is memory mapped and parsed once with hand-written number conversion (loader::obj_parse), on 1 thread and on all the threads
+//  - mesh_load_file_obj: complete loading (parsing, triangulation, creation of the unique vertices)
+//  - mesh_load_file_obj_cached: loading from the binary cache written next to the file (filename.cgpmesh)
+//  - mesh_save_file_obj: export of the loaded mesh, on 1 thread and on all the threads
+//  - mesh_load_file_ply, mesh_load_file_stl: loading of the same mesh exported in binary PLY and STL (with and without welding of the vertices), compared to the OBJ path in MB/s
+// The file is given as argument, or a synthetic grid of N x N vertices with positions, uv and normals is generated.
+
+// Write a grid of N x N vertices as quads with position/uv/normal indices
+void write_synthetic_obj(std::string const& filename, int N)
+{
+	std::ofstream stream(filename);
+	for (int ku = 0; ku < N; ++ku) {
+		for (int kv = 0; kv < N; ++kv) {
+			float const u = ku / (N - 1.0f);
+			float const v = kv / (N - 1.0f);
+			vec3 const p = { u, v, 0.1f * std::sin(10 * u) * std::cos(7 * v) };
+			stream << "v " << p.x << " " << p.y << " " << p.z << "\n";
+			stream << "vt " << u << " " << v << "\n";
+			stream << "vn " << 0.0f << " " << 0.0f << " " << 1.0f << "\n";
+		}
+	}
+	for (int ku = 0; ku < N - 1; ++ku) {
+		for (int kv = 0; kv < N - 1; ++kv) {
+			int const idx[4] = { ku * N + kv + 1, (ku + 1) * N + kv + 1, (ku + 1) * N + kv + 2, ku * N + kv + 2 };
+			stream << "f";
+			for (int i = 0; i < 4; ++i)
+				stream << " " << idx[i] << "/" << idx[i] << "/" << idx[i];
+			stream << "\n";
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string filename;
+	if (argc > 1 && std::string(argv[1]).find(".obj") != std::string::npos)
+		filename = argv[1];
+	else {
+		int const N = argc > 1 ? std::atoi(argv[1]) : 1000;
+		filename = "synthetic_grid.obj";
+		std::cout << "Generate " << filename << " (grid of " << N << "x" << N << " vertices)" << std::endl;
+		write_synthetic_obj(filename, N);
+	}
+	std::cout << "Load " << filename << " (" << file_map(filename).size() / (1024.0 * 1024.0) << " MB)" << std::endl;
+
+	size_t legacy_faces = 0;
+	double const t_legacy = time_best_ms([&]() {
+		std::vector<vec3> const position = loader::obj_read_positions(filename);
+		std::vector<vec2> const uv = loader::obj_read_texture_uv(filename);
+		std::vector<vec3> const normal = loader::obj_read_normals(filename);
+		loader::obj_type const type = uv.size() > 0 ? (normal.size() > 0 ? loader::obj_type::vertex_texture_normal : loader::obj_type::vertex_texture) : (normal.size() > 0 ? loader::obj_type::vertex_normal : loader::obj_type::vertex);
+		legacy_faces = loader::obj_read_faces(filename, type).size();
+	}, 1);
+
+	loader::obj_content content;
+	double const t_single_thread = time_best_ms([&]() { content = loader::obj_parse(filename, 1); }, 3);
+	double const t_parallel = time_best_ms([&]() { content = loader::obj_parse(filename); }, 3);
+
+	mesh m;
+	double const t_mesh = time_best_ms([&]() { m = mesh_load_file_obj(filename); }, 3);
+	mesh_load_file_obj_cached(filename); // writes the binary cache if needed
+	double const t_cached = time_best_ms([&]() { m = mesh_load_file_obj_cached(filename); }, 3);
+
+	// Export of the loaded mesh
+	double const t_export_single_thread = time_best_ms([&]() { mesh_save_file_obj("export_benchmark.obj", m, 1); }, 3);
+	double const t_export_parallel = time_best_ms([&]() { mesh_save_file_obj("export_benchmark.obj", m); }, 3);
+	std::remove("export_benchmark.obj");
+
+	// Same geometry in binary PLY and STL
+	mesh_save_file_ply("export_benchmark.ply", m);
+	mesh_save_file_stl("export_benchmark.stl", m);
+	double const size_obj = file_get_size(filename) / (1024.0 * 1024.0);
+	double const size_ply = file_get_size("export_benchmark.ply") / (1024.0 * 1024.0);
+	double const size_stl = file_get_size("export_benchmark.stl") / (1024.0 * 1024.0);
+	mesh m_ply, m_stl, m_stl_welded;
+	double const t_ply = time_best_ms([&]() { m_ply = mesh_load_file_ply("export_benchmark.ply"); }, 3);
+	double const t_stl = time_best_ms([&]() { m_stl = mesh_load_file_stl("export_benchmark.stl", false); }, 3);
+	double const t_stl_welded = time_best_ms([&]() { m_stl_welded = mesh_load_file_stl("export_benchmark.stl"); }, 3);
+	std::remove("export_benchmark.ply");
+	std::remove("export_benchmark.stl");
+
+	std::cout << "method\t\t\t\ttime (ms)" << std::endl;
+	std::cout << "legacy readers\t\t\t" << t_legacy << std::endl;
+	std::cout << "obj_parse (1 thread)\t\t" << t_single_thread << std::endl;
+	std::cout << "obj_parse (" << parallel_number_of_threads() << " threads)\t\t" << t_parallel << std::endl;
+	std::cout << "mesh_load_file_obj\t\t" << t_mesh << std::endl;
+	std::cout << "mesh_load_file_obj_cached\t" << t_cached << std::endl;
+	std::cout << "mesh_save_file_obj (1 thread)\t" << t_export_single_thread << std::endl;
+	std::cout << "mesh_save_file_obj (" << parallel_number_of_threads() << " threads)\t" << t_export_parallel << std::endl;
+	std::cout << "mesh_load_file_ply\t\t" << t_ply << std::endl;
+	std::cout << "mesh_load_file_stl (soup)\t" << t_stl << std::endl;
+	std::cout << "mesh_load_file_stl (welded)\t" << t_stl_welded << std::endl;
+	std::cout << "\t(check: " << content.position.size() << " positions, " << content.face_begin.size() - 1 << " faces (legacy: " << legacy_faces << "), mesh with " << m.position.size() << " vertices and " << m.connectivity.size() << " triangles)" << std::endl;
+
+	std::cout << "\t(check: PLY mesh with " << m_ply.position.size() << " vertices, STL welded mesh with " << m_stl_welded.position.size() << " vertices and " << m_stl_welded.connectivity.size() << " triangles, STL soup with " << m_stl.position.size() << " vertices)" << std::endl;
+
+	std::cout << "\nformat\tsize (MB)\tthroughput (MB/s)" << std::endl;
+	std::cout << "OBJ\t" << size_obj << "\t\t" << size_obj / (t_single_thread / 1000) << " (obj_parse, 1 thread)\t" << size_obj / (t_mesh / 1000) << " (mesh_load_file_obj)" << std::endl;
+	std::cout << "PLY\t" << size_ply << "\t\t" << size_ply / (t_ply / 1000) << std::endl;
+	std::cout << "STL\t" << size_stl << "\t\t" << size_stl / (t_stl / 1000) << " (soup)\t" << size_stl / (t_stl_welded / 1000) << " (welded)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,69 @@
+#include "cgp/cgp.hpp"
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+using namespace cgp;
+
+// Benchmark of cloth_implicit::step on a square cloth of N x N vertices (total mass 1) hanging from two corners.
+// The time step is compared to the stability bound of an explicit integration of the same springs,
+//  estimated by 2/sqrt(lambda_max) with lambda_max bounded by the Gershgorin bound of M^-1 K: max_i sum_j 2 K_ij / m_i.
+// The time of a step, the number of iterations of the conjugate gradient, and the maximal stretch of the structural springs are reported.
+
+int main(int argc, char** argv)
+{
+	int const N_side = argc > 1 ? std::stoi(argv[1]) : 316;
+	int const N_step = argc > 2 ? std::stoi(argv[2]) : 50;
+	float const dt = 1e-3f;
+
+	cloth_implicit cloth;
+	cloth.K = 5000.0f;
+	cloth.initialize(mesh_primitive_grid({ 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, N_side, N_side), 1.0f);
+	int const N = cloth.shape.position.size();
+	for (int k = 0; k < N; ++k) {
+		vec3 const& p = cloth.shape.position[k];
+		if (p.x == 0 && (p.y == 0 || p.y == 1))
+			cloth.set_fixed(k);
+	}
+
+	// Explicit stability bound
+	numarray<float> stiffness_sum(N);
+	stiffness_sum.fill(0.0f);
+	for (int k = 0; k < cloth.spring_i.size(); ++k) {
+		float const Ks = k < cloth.number_of_structural_spring ? cloth.K : cloth.K_bending;
+		stiffness_sum[cloth.spring_i[k]] += 2 * Ks;
+		stiffness_sum[cloth.spring_j[k]] += 2 * Ks;
+	}
+	float lambda_max = 0.0f;
+	for (int k = 0; k < N; ++k)
+		if (cloth.mass[k] > 0)
+			lambda_max = std::max(lambda_max, stiffness_sum[k] / cloth.mass[k]);
+	float const dt_explicit = 2.0f / std::sqrt(lambda_max);
+
+	std::cout << "Implicit cloth with " << N << " vertices, " << cloth.spring_i.size() << " springs, K=" << cloth.K << ", " << parallel_number_of_threads() << " hardware threads" << std::endl;
+	std::cout << "dt = " << dt << " s, explicit stability bound = " << dt_explicit << " s (x" << dt / dt_explicit << ")" << std::endl;
+
+	double time_total = 0;
+	int iteration_total = 0;
+	int iteration_max = 0;
+	for (int k_step = 0; k_step < N_step; ++k_step) {
+		time_total += time_best_ms([&]() { cloth.step(dt); }, 1);
+		iteration_total += cloth.solver.iteration;
+		iteration_max = std::max(iteration_max, cloth.solver.iteration);
+	}
+
+	float stretch_max = 0.0f;
+	bool is_finite = true;
+	for (int k = 0; k < N; ++k) {
+		vec3 const& p = cloth.shape.position[k];
+		is_finite = is_finite && std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+	}
+	for (int k = 0; k < cloth.number_of_structural_spring; ++k)
+		stretch_max = std::max(stretch_max, norm(cloth.shape.position[cloth.spring_j[k]] - cloth.shape.position[cloth.spring_i[k]]) / cloth.spring_L0[k]);
+
+	std::cout << "\nSteps\tTime/step (ms)\tCG iterations (mean)\tCG iterations (max)\tMax stretch\tStable" << std::endl;
+	std::cout << N_step << "\t" << time_total / N_step << "\t\t" << iteration_total / double(N_step) << "\t\t\t" << iteration_max << "\t\t\t" << stretch_max << "\t\t" << (is_finite && stretch_max < 2 ? "yes" : "no") << std::endl;
+
+	return 0;
+}
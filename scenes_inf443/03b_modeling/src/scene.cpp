@@ -23,9 +23,9 @@ void scene_structure::initialize()
 	int N_terrain_samples = 100;
 	float terrain_length = 20;
 
-	terrain_mesh = create_terrain_mesh(N_terrain_samples, terrain_length);
+	terrain_heightfield = create_terrain_mesh(N_terrain_samples, terrain_length);
 	// mesh terrain_mesh = create_naive_terrain(terrain_length);
-	terrain.initialize_data_on_gpu(terrain_mesh);
+	terrain.initialize_data_on_gpu(terrain_heightfield.shape);
 	terrain.texture.load_and_initialize_texture_2d_on_gpu(
 		project::path + "assets/texture_grass.jpg",
 		GL_REPEAT,
@@ -33,7 +33,7 @@ void scene_structure::initialize()
 	);
 
 	update_terrain(
-		terrain_mesh,
+		terrain_heightfield,
 		terrain,
 		parameters
 	);
@@ -91,7 +91,7 @@ void scene_structure::display_gui()
 	update |= ImGui::SliderFloat("Height", &parameters.terrain_height, 0.f, 1.5f);
 
 	if (update){// if any slider has been changed - then update the terrain
-		update_terrain(terrain_mesh, terrain, parameters);
+		update_terrain(terrain_heightfield, terrain, parameters);
 		
 	}
 }
@@ -43,7 +43,7 @@ struct scene_structure : cgp::scene_inputs_generic {
 
 	cgp::mesh_drawable terrain;
 	cgp::mesh_drawable tree;
-	mesh terrain_mesh;
+	heightfield_terrain terrain_heightfield;
 
 	vector<vec3> tree_position;
 
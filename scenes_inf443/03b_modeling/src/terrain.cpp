@@ -34,54 +34,18 @@ float evaluate_terrain_height(float x, float y)
     return z;
 }
 
-mesh create_terrain_mesh(int N, float terrain_length)
+heightfield_terrain create_terrain_mesh(int N, float terrain_length)
 {
 
-    mesh terrain; // temporary terrain storage (CPU only)
-    terrain.position.resize(N*N);
+    heightfield_terrain terrain;
 
-    // Fill terrain geometry
-    for(int ku=0; ku<N; ++ku)
-    {
-        for(int kv=0; kv<N; ++kv)
-        {
-            // Compute local parametric coordinates (u,v) \in [0,1]
-            float u = ku/(N-1.0f);
-            float v = kv/(N-1.0f);
+    // The real coordinates (x,y) of the terrain are in [-terrain_length/2, +terrain_length/2]
+    //  and the texture coordinates are repeated 10 times along each direction
+    terrain.initialize({N,N}, {-terrain_length/2, -terrain_length/2}, {terrain_length/2, terrain_length/2}, {10,10});
 
-            // Compute the real coordinates (x,y) of the terrain in [-terrain_length/2, +terrain_length/2]
-            float x = (u - 0.5f) * terrain_length;
-            float y = (v - 0.5f) * terrain_length;
-
-            // Compute the surface height function at the given sampled coordinate
-            float z = evaluate_terrain_height(x,y);
-
-            // Store vertex coordinates
-            terrain.position[kv+N*ku] = {x,y,z};
-            terrain.uv.push_back({10*u,10*v});
-        }
-    }
-
-    // Generate triangle organization
-    //  Parametric surface with uniform grid sampling: generate 2 triangles for each grid cell
-    for(int ku=0; ku<N-1; ++ku)
-    {
-        for(int kv=0; kv<N-1; ++kv)
-        {
-            unsigned int idx = kv + N*ku; // current vertex offset
-
-            uint3 triangle_1 = {idx, idx+1+N, idx+1};
-            uint3 triangle_2 = {idx, idx+N, idx+1+N};
-
-            terrain.connectivity.push_back(triangle_1);
-            terrain.connectivity.push_back(triangle_2);
-        }
-    }
-
-
-
-    // need to call this function to fill the other buffer with default values (normal, color, etc)
-	terrain.fill_empty_field(); 
+    // Compute the surface height function at each sampled coordinate, then the normals
+    terrain.update_height([](vec2 const& p, vec2 const&) { return evaluate_terrain_height(p.x, p.y); });
+    terrain.update_normal();
 
     return terrain;
 }
@@ -99,38 +63,25 @@ mesh create_naive_terrain(float terrain_length){
 	return terrain;
 }
 
-void update_terrain(mesh& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters parameters){
-	// Number of samples in each direction (assuming a square grid)
-	int const N = std::sqrt(terrain.position.size());
-
-	// Recompute the new vertices
-	for (int ku = 0; ku < N; ++ku) {
-		for (int kv = 0; kv < N; ++kv) {
-			
-			// Compute local parametric coordinates (u,v) \in [0,1]
-            const float u = ku/(N-1.0f);
-            const float v = kv/(N-1.0f);
-
-			int const idx = ku*N+kv;
-
-			// Compute the Perlin noise
-			float const noise = noise_perlin({u, v}, parameters.octave, parameters.persistency, parameters.frequency_gain);
-
-			// use the noise as height value
-			terrain.position[idx].z = parameters.terrain_height*noise;
-
-			// use also the noise as color value
-			terrain.color[idx] = 0.3f*vec3(0,0.5f,0)+0.7f*noise*vec3(1,1,1);
-		}
-	}
+void update_terrain(heightfield_terrain& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters parameters){
+	// Compute the Perlin noise at the local parametric coordinates (u,v) \in [0,1] of the vertices, and use it as height value
+	//  Each stage (height, normal, color) is computed in parallel over the rows of the terrain
+	terrain.update_height_noise_perlin(parameters.terrain_height, parameters.octave, parameters.persistency, parameters.frequency_gain);
 
 	// Update the normal of the mesh structure
-	terrain.normal_update();
+	terrain.update_normal();
+
+	// use also the noise as color value
+	float const terrain_height = parameters.terrain_height;
+	terrain.update_color([terrain_height](vec3 const& p, vec3 const&) {
+		float const noise = terrain_height>0 ? p.z/terrain_height : 0.0f;
+		return 0.3f*vec3(0,0.5f,0)+0.7f*noise*vec3(1,1,1);
+	});
 	
 	// Update step: Allows to update a mesh_drawable without creating a new one
-	terrain_visual.vbo_position.update(terrain.position);
-	terrain_visual.vbo_normal.update(terrain.normal);
-	terrain_visual.vbo_color.update(terrain.color);
+	terrain_visual.vbo_position.update(terrain.shape.position);
+	terrain_visual.vbo_normal.update(terrain.shape.normal);
+	terrain_visual.vbo_color.update(terrain.shape.color);
 	
 }
 
@@ -27,9 +27,9 @@ class perlin_noise_parameters {
 	// }
 
 };
-cgp::mesh create_terrain_mesh(int N, float length);
+cgp::heightfield_terrain create_terrain_mesh(int N, float length);
 mesh create_naive_terrain(float terrain_length);
 std::vector<cgp::vec3> generate_positions_on_terrain(int N, float terrain_length, perlin_noise_parameters& parameters);
-void update_terrain(mesh& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters parameters);
+void update_terrain(heightfield_terrain& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters parameters);
 
 
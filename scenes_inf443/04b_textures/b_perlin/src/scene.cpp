@@ -15,9 +15,9 @@ void scene_structure::initialize()
 	display_info();
 	global_frame.initialize_data_on_gpu(mesh_primitive_frame());
 
-	terrain_mesh = create_terrain_mesh();
-	terrain_drawable.initialize_data_on_gpu(terrain_mesh);
-	update_terrain(terrain_mesh, terrain_drawable, parameters);
+	terrain = create_terrain();
+	terrain_drawable.initialize_data_on_gpu(terrain.shape);
+	update_terrain(terrain, terrain_drawable, parameters);
 
 }
 
@@ -48,7 +48,7 @@ void scene_structure::display_gui()
 	update |= ImGui::SliderFloat("Height", &parameters.terrain_height, 0.1f, 1.5f);
 
 	if (update)// if any slider has been changed - then update the terrain
-		update_terrain(terrain_mesh, terrain_drawable, parameters);
+		update_terrain(terrain, terrain_drawable, parameters);
 }
 
 void scene_structure::mouse_move_event()
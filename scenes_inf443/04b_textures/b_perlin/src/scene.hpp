@@ -33,7 +33,7 @@ struct scene_structure : cgp::scene_inputs_generic {
 	// Elements and shapes of the scene
 	// ****************************** //
 
-	cgp::mesh terrain_mesh;
+	cgp::heightfield_terrain terrain;
 	cgp::mesh_drawable terrain_drawable;
 	perlin_noise_parameters parameters;
 
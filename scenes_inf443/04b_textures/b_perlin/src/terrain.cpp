@@ -3,46 +3,34 @@
 
 using namespace cgp;
 
-mesh create_terrain_mesh()
+heightfield_terrain create_terrain()
 {
 	int const terrain_sample = 180;
-	mesh terrain = mesh_primitive_grid({-1,-1,0},{1,-1,0},{1,1,0},{-1,1,0},terrain_sample,terrain_sample);
+	heightfield_terrain terrain;
+	terrain.initialize({terrain_sample,terrain_sample}, {-1,-1}, {1,1});
 	return terrain;
 }
 
-void update_terrain(mesh& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters const& parameters)
+void update_terrain(heightfield_terrain& terrain, mesh_drawable& terrain_visual, perlin_noise_parameters const& parameters)
 {
-	// Number of samples in each direction (assuming a square grid)
-	int const N = std::sqrt(terrain.position.size());
+	// Compute the Perlin noise at the local parametric coordinates (u,v) \in [0,1] of the vertices, and use it as height value
+	//  Each stage (height, normal, color) is computed in parallel over the rows of the terrain
+	terrain.update_height_noise_perlin(parameters.terrain_height, parameters.octave, parameters.persistency, parameters.frequency_gain);
 
-	// Recompute the new vertices
-	for (int ku = 0; ku < N; ++ku) {
-		for (int kv = 0; kv < N; ++kv) {
-			
-			// Compute local parametric coordinates (u,v) \in [0,1]
-            const float u = ku/(N-1.0f);
-            const float v = kv/(N-1.0f);
-
-			int const idx = ku*N+kv;
-
-			// Compute the Perlin noise
-			float const noise = noise_perlin({u, v}, parameters.octave, parameters.persistency, parameters.frequency_gain);
-
-			// use the noise as height value
-			terrain.position[idx].z = parameters.terrain_height*noise;
+	// Update the normal of the mesh structure
+	terrain.update_normal();
 
-			// use also the noise as color value
-			terrain.color[idx] = 0.3f*vec3(0,0.5f,0)+0.7f*noise*vec3(1,1,1);
-		}
-	}
+	// use also the noise as color value
+	float const terrain_height = parameters.terrain_height;
+	terrain.update_color([terrain_height](vec3 const& p, vec3 const&) {
+		float const noise = p.z/terrain_height;
+		return 0.3f*vec3(0,0.5f,0)+0.7f*noise*vec3(1,1,1);
+	});
 
-	// Update the normal of the mesh structure
-	terrain.normal_update();
-	
 	// Update step: Allows to update a mesh_drawable without creating a new one
-	terrain_visual.vbo_position.update(terrain.position);
-	terrain_visual.vbo_normal.update(terrain.normal);
-	terrain_visual.vbo_color.update(terrain.color);
+	terrain_visual.vbo_position.update(terrain.shape.position);
+	terrain_visual.vbo_normal.update(terrain.shape.normal);
+	terrain_visual.vbo_color.update(terrain.shape.color);
 	
 }
 
@@ -11,9 +11,9 @@ struct perlin_noise_parameters
 };
 
 
-// Initialize the mesh of the terrain
-cgp::mesh create_terrain_mesh();
+// Initialize the terrain as a flat grid
+cgp::heightfield_terrain create_terrain();
 
 // Recompute the vertices of the terrain everytime a parameter is modified
 //  and update the mesh_drawable accordingly
-void update_terrain(cgp::mesh& terrain, cgp::mesh_drawable& terrain_visual, perlin_noise_parameters const& parameters);
+void update_terrain(cgp::heightfield_terrain& terrain, cgp::mesh_drawable& terrain_visual, perlin_noise_parameters const& parameters);
@@ -44,7 +44,8 @@ void scene_structure::simulation_step(float dt)
 
 void scene_structure::draw_segment(vec3 const& a, vec3 const& b)
 {
-	segment.vbo_position.update(numarray<vec3>{ a, b });
+	vec3 const p[2] = { a, b };
+	segment.vbo_position.update(p); // view on the two points, no temporary numarray
 	draw(segment, environment);
 }
 
@@ -65,6 +66,7 @@ void scene_structure::initialize()
 
 	pB = { 0.0f,0.45f,0.0f };
 	vB = { 0,0,0 };
+	pB_previous = pB;
 
 	L0 = 0.4f;
 
@@ -89,21 +91,25 @@ void scene_structure::display_frame()
 	if (gui.display_frame)
 		draw(global_frame, environment);
 
-	// Update the current time
+	// Update the current time, and run the simulation steps corresponding to the elapsed time
 	timer.update();
+	for (int k = 0; k < timer.steps; ++k) {
+		pB_previous = pB;
+		simulation_step(timer.step);
+	}
 
-
-	simulation_step(timer.scale * 0.01f);
+	// Display the state interpolated between the two last simulation steps
+	vec3 const pB_display = (1 - timer.alpha) * pB_previous + timer.alpha * pB;
 
 	particle_sphere.model.translation = pA;
 	particle_sphere.material.color = { 0,0,0 };
 	draw(particle_sphere, environment);
 
-	particle_sphere.model.translation = pB;
+	particle_sphere.model.translation = pB_display;
 	particle_sphere.material.color = { 1,0,0 };
 	draw(particle_sphere, environment);
 
-	draw_segment(pA, pB);
+	draw_segment(pA, pB_display);
 
 }
 
@@ -10,7 +10,7 @@ using cgp::mesh;
 using cgp::mesh_drawable;
 using cgp::vec3;
 using cgp::numarray;
-using cgp::timer_basic;
+using cgp::timer_fixed_step;
 
 
 struct gui_parameters {
@@ -44,14 +44,15 @@ struct scene_structure : cgp::scene_inputs_generic {
 	mesh_drawable particle_sphere;
 	curve_drawable segment;
 
-	// Timer used for the animation
-	timer_basic timer;
+	// Timer used for the animation: the simulation runs with a fixed time step, independently of the display frame rate
+	timer_fixed_step timer;
 
 	// Particles:
 	vec3 pA; // position of particle A
 	vec3 pB; // position of particle B
 	vec3 vA; // velocity of particle A
 	vec3 vB; // velocity of particle B
+	vec3 pB_previous; // position of particle B before the last simulation step (interpolated for the display)
 	float L0; // Rest-length of spring
 
 